@@ -16,6 +16,7 @@ class ASTNormalizeConsumer : public clang::ASTConsumer {
         armor::APISession* session;
         armor::ASTNormalizedContext* context;
         ASTNormalizeConsumer(armor::APISession* session, armor::ASTNormalizedContext* context);
+        bool HandleTopLevelDecl(clang::DeclGroupRef DeclGroup) override;
         void HandleTranslationUnit(clang::ASTContext &Context) override;
 };
 
@@ -6,6 +6,7 @@
 #include <vector>
 #include "comm_def.hpp"
 #include "session.hpp"
+#include "report_generator.hpp"
 
 namespace armor { namespace alpha {
 
@@ -16,6 +17,45 @@ PARSING_STATUS processHeaderPairAlpha(const std::string& projectRoot1,
                        const std::string& reportFormat,
                        const std::vector<std::string>& IncludePaths,
                        const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang,
+                       bool dumpAstDiff,
+                       HeaderReportSummary* summary = nullptr);
+
+/**
+ * Alpha pass for a comparison against a snapshot: only file2 is parsed, and
+ * its fatal include failures are reported against a clean baseline.
+ */
+PARSING_STATUS processHeaderAgainstSnapshotAlpha(const std::string& projectRoot2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang,
+                       bool dumpAstDiff,
+                       HeaderReportSummary* summary = nullptr);
+
+/**
+ * Parse one version of a header with the alpha parser into session, for
+ * comparisons that reuse the result (see compareHeaderVersionsAlpha).
+ */
+PARSING_STATUS parseHeaderAlpha(armor::APISession& session,
+                       const std::string& projectRoot,
+                       const std::string& file,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
                        const LANG_OPTIONS lang);
 
+/**
+ * Report the fatal include failures of two versions parsed by parseHeaderAlpha.
+ * Reports are named reportName, or after file2 if it is empty.
+ */
+HeaderReportSummary compareHeaderVersionsAlpha(const armor::APISession& session1,
+                       const std::string& file1,
+                       const armor::APISession& session2,
+                       const std::string& projectRoot2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       bool dumpAstDiff,
+                       const std::string& reportName = "");
+
 } } // namespace armor::alpha
@@ -3,6 +3,7 @@
 #include "astnormalizer.hpp"
 #include "session.hpp"
 #include "preprocesor.hpp"
+#include "header_budget.hpp"
 
 #include "clang/Frontend/CompilerInstance.h"
 
@@ -13,6 +14,11 @@ namespace armor { namespace alpha {
 ASTNormalizeConsumer::ASTNormalizeConsumer(armor::APISession* session, armor::ASTNormalizedContext* context)
     : session(session), context(context) {}
 
+// Returning false stops the parser once the header ran over its budget.
+bool ASTNormalizeConsumer::HandleTopLevelDecl(clang::DeclGroupRef) {
+    return !armor::HeaderBudget::exceeded();
+}
+
 void ASTNormalizeConsumer::HandleTranslationUnit(clang::ASTContext &clangContext) {
     context->addClangASTContext(&clangContext);
     // Alpha is parse-error detection only: no AST traversal, no node building.
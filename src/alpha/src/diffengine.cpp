@@ -3,6 +3,7 @@
 #include "diffengine.hpp"
 #include "diff_utils.hpp"
 #include "logger.hpp"
+#include "trace.hpp"
 
 using json = nlohmann::json;
 
@@ -28,6 +29,7 @@ json diffTrees(
     const armor::ASTNormalizedContext* context1,
     const armor::ASTNormalizedContext* context2)
 {
+    armor::TraceScope span("alpha diff", "diff");
     json report;
 
     report[AST_DIFF] = {};
@@ -17,6 +17,7 @@
 #include "diffengine.hpp"
 #include "logger.hpp"
 #include "header_processor.hpp"
+#include "header_budget.hpp"
 #include "header_processor_utils.hpp"
 
 using namespace clang;
@@ -32,7 +33,9 @@ PARSING_STATUS processHeaderPairAlpha(const std::string& project1,
                        const std::string& reportFormat,
                        const std::vector<std::string>& IncludePaths,
                        const std::vector<std::string>& macroFlags,
-                       const LANG_OPTIONS lang) {
+                       const LANG_OPTIONS lang,
+                       bool dumpAstDiff,
+                       HeaderReportSummary* summary) {
 
     if (!DebugConfig::getInstance().initialize()) {
         armor::user_error() << "Failed to open diagnostics log <" << LOG_FILE_PATH << ">, using stderr\n";
@@ -64,6 +67,12 @@ PARSING_STATUS processHeaderPairAlpha(const std::string& project1,
     PARSING_STATUS header1ParsingStatus = session->processFileAlpha(
         file1, std::move(compDB1), createNormalizeActionFactory(session.get(), file1));
 
+    // Over budget: leave the report to the caller's cheaper fallback.
+    if (armor::HeaderBudget::exceeded()) {
+        armor::info() << "Alpha parser stopped: " << armor::HeaderBudget::describe() << " exceeded\n";
+        return FATAL_ERRORS;
+    }
+
     armor::info() << "Processing File2 : " << file2 << "\n";
     for (auto& x : Flags2) {
         armor::info() << "Clang search path : " << x << "\n";
@@ -72,6 +81,11 @@ PARSING_STATUS processHeaderPairAlpha(const std::string& project1,
     PARSING_STATUS header2ParsingStatus = session->processFileAlpha(
         file2, std::move(compDB2), createNormalizeActionFactory(session.get(), file2));
 
+    if (armor::HeaderBudget::exceeded()) {
+        armor::info() << "Alpha parser stopped: " << armor::HeaderBudget::describe() << " exceeded\n";
+        return FATAL_ERRORS;
+    }
+
     // 3. Retrieve the results from the session
     armor::ASTNormalizedContext* context1 = session->getAlphaContext(file1);
     armor::ASTNormalizedContext* context2 = session->getAlphaContext(file2);
@@ -86,7 +100,9 @@ PARSING_STATUS processHeaderPairAlpha(const std::string& project1,
     // 4. Perform the diff using the retrieved contexts
     nlohmann::json diffResult = diffTrees(context1, context2);
 
-    armor::emitHeaderDiffReport(diffResult, file1, project1, reportFormat, ALPHA_PARSER);
+    HeaderReportSummary reportSummary =
+        armor::emitHeaderDiffReport(diffResult, file1, project1, reportFormat, ALPHA_PARSER, dumpAstDiff);
+    if (summary) *summary = std::move(reportSummary);
 
     DebugConfig::getInstance().flush();
 
@@ -94,4 +110,92 @@ PARSING_STATUS processHeaderPairAlpha(const std::string& project1,
 
 }
 
+PARSING_STATUS processHeaderAgainstSnapshotAlpha(const std::string& project2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang,
+                       bool dumpAstDiff,
+                       HeaderReportSummary* summary) {
+
+    if (!DebugConfig::getInstance().initialize()) {
+        armor::user_error() << "Failed to open diagnostics log <" << LOG_FILE_PATH << ">, using stderr\n";
+    }
+
+    std::vector<std::string> Flags2 = getHeaderClangFlags(project2, file2, IncludePaths, macroFlags, lang);
+    auto compDB2 = std::make_unique<FixedCompilationDatabase>(project2, Flags2);
+    auto session = std::make_unique<armor::APISession>();
+
+    armor::info() << "Processing File2 : " << file2 << "\n";
+    for (auto& x : Flags2) {
+        armor::info() << "Clang search path : " << x << "\n";
+    }
+
+    PARSING_STATUS header2ParsingStatus = session->processFileAlpha(
+        file2, std::move(compDB2), createNormalizeActionFactory(session.get(), file2));
+
+    if (armor::HeaderBudget::exceeded()) {
+        armor::info() << "Alpha parser stopped: " << armor::HeaderBudget::describe() << " exceeded\n";
+        return FATAL_ERRORS;
+    }
+
+    armor::ASTNormalizedContext* context2 = session->getAlphaContext(file2);
+    if (!context2) {
+        armor::user_error() << "Failed to retrieve processing results from session\n";
+        return FATAL_ERRORS;
+    }
+
+    // Snapshots are only written from baselines without fatal directives.
+    armor::ASTNormalizedContext baseline;
+    nlohmann::json diffResult = diffTrees(&baseline, context2);
+
+    HeaderReportSummary reportSummary =
+        armor::emitHeaderDiffReport(diffResult, file2, project2, reportFormat, ALPHA_PARSER, dumpAstDiff);
+    if (summary) *summary = std::move(reportSummary);
+
+    DebugConfig::getInstance().flush();
+
+    return header2ParsingStatus;
+}
+
+PARSING_STATUS parseHeaderAlpha(armor::APISession& session,
+                       const std::string& project,
+                       const std::string& file,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang) {
+
+    std::vector<std::string> Flags = getHeaderClangFlags(project, file, IncludePaths, macroFlags, lang);
+    auto compDB = std::make_unique<FixedCompilationDatabase>(project, Flags);
+
+    armor::info() << "Processing File : " << file << "\n";
+    for (auto& x : Flags) {
+        armor::info() << "Clang search path : " << x << "\n";
+    }
+
+    return session.processFileAlpha(file, std::move(compDB), createNormalizeActionFactory(&session, file));
+}
+
+HeaderReportSummary compareHeaderVersionsAlpha(const armor::APISession& session1,
+                       const std::string& file1,
+                       const armor::APISession& session2,
+                       const std::string& project2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       bool dumpAstDiff,
+                       const std::string& reportName) {
+
+    // A version that was not parsed has no context and no fatal directives to report.
+    armor::ASTNormalizedContext empty;
+    const armor::ASTNormalizedContext* context1 = session1.getAlphaContext(file1);
+    const armor::ASTNormalizedContext* context2 = session2.getAlphaContext(file2);
+    nlohmann::json diffResult = diffTrees(context1 ? context1 : &empty, context2 ? context2 : &empty);
+
+    HeaderReportSummary summary = armor::emitHeaderDiffReport(
+        diffResult, file2, project2, reportFormat, ALPHA_PARSER, dumpAstDiff, reportName);
+    DebugConfig::getInstance().flush();
+    return summary;
+}
+
 } } // namespace armor::alpha
\ No newline at end of file
@@ -0,0 +1,89 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#ifndef COMMAND_UTILS_HPP
+#define COMMAND_UTILS_HPP
+
+#include <list>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "comm_def.hpp"
+#include "diff_utils.hpp"
+#include "git_utils.hpp"
+#include "header_discovery.hpp"
+#include "logger.hpp"
+#include "report_generator.hpp"
+#include "trace.hpp"
+
+// --lang value, case-insensitive; anything but c is C++.
+LANG_OPTIONS stringToLangOption(const std::string& lang);
+
+// Diff result of a header whose tokens did not change.
+nlohmann::json lexicalDiffResult(ParsedDiffStatus parsedStatus);
+
+// Reports, named reportName, for a header that exists in only one of the two versions.
+HeaderReportSummary reportMissingHeader(const std::string& reportName, bool missingInOlder);
+
+// Called from worker threads under --jobs, so a summary is written in one piece.
+void printHeaderSummary(const std::string& headerPath, const HeaderReportSummary& summary);
+
+// Writes the --trace-out file on every exit path. Declared ahead of the
+// worktree guards so their removal is still part of the trace.
+struct TraceOutputGuard {
+    std::string path;
+
+    ~TraceOutputGuard() {
+        if (path.empty()) return;
+        if (armor::Tracer::getInstance().write(path))
+            armor::user_print() << "Trace written to: " << path << "\n";
+        else
+            armor::user_error() << "Failed to write trace: " << path << "\n";
+    }
+};
+
+// The -m option: macro flags separated by whitespace.
+std::vector<std::string> splitMacroFlags(const std::string& macroFlags);
+
+// A snapshot stands in for projectroot1 only if it was written with the
+// language, include paths and macros of this comparison; any other parse of
+// the baseline would show up as API changes.
+bool checkSnapshotFlags(const std::string& snapshotDir, LANG_OPTIONS lang,
+                        const std::vector<std::string>& includePaths, const std::vector<std::string>& macros);
+
+// A .tar, .tar.gz or .tgz project root is mounted and replaced by its mount
+// point; other roots are left as they are. False if the archive is unreadable.
+bool mountArchiveRoot(std::string& projectRoot);
+
+// Existence goes through the archive-aware file system, so mounted roots work too.
+bool fileExists(const std::string& path);
+
+// Selects the snapshot files of the headers the globs select; they are named
+// after their headers with APISnapshot::EXTENSION appended.
+std::optional<armor::HeaderFilter> createSnapshotFilter(const std::vector<std::string>& includeGlobs,
+                                                        const std::vector<std::string>& excludeGlobs,
+                                                        std::string& error);
+
+// Headers under each of dirs, found as a comparison with the same --recursive
+// and globs would find them; a directory flagged in snapshots is searched for
+// snapshot files instead. False, with the error reported, on a malformed glob.
+bool findVersionHeaders(const std::vector<std::string>& dirs, const std::vector<std::string>& includeGlobs,
+                        const std::vector<std::string>& excludeGlobs, bool recursive,
+                        std::vector<std::string>& headers, const std::vector<bool>& snapshots = {});
+
+// One version of a chain: a project root, or a worktree checked out for a git ref.
+struct ChainVersion {
+    std::string label;
+    std::string projectRoot;
+};
+
+// Characters of a version label that are safe in a report file name.
+std::string reportLabel(const std::string& label);
+
+// Resolves each version argument to a project root: existing directories are
+// used as is, archives are mounted, anything else is checked out as a git ref
+// of the current repository.
+bool resolveChainVersions(const std::vector<std::string>& arguments, std::list<GitWorktreeGuard>& worktrees,
+                          std::vector<ChainVersion>& versions);
+
+#endif
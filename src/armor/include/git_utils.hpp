@@ -10,25 +10,55 @@ bool isGitRepo(const std::string& path);
 std::string getGitRepoRoot(const std::string& path);
 bool hasUncommittedChanges(const std::string& repoRoot);
 std::string getRefInfo(const std::string& repoRoot, const std::string& gitRef);
+// Paths, relative to the repository root, of all files changed between the refs.
+std::vector<std::string> getChangedFiles(const std::string& repoRoot,
+                                          const std::string& oldRef,
+                                          const std::string& newRef);
 std::vector<std::string> getChangedHeaders(const std::string& repoRoot,
                                             const std::string& oldRef,
                                             const std::string& newRef);
 std::string createGitWorktree(const std::string& repoRoot, const std::string& gitRef);
 void removeGitWorktree(const std::string& repoRoot, const std::string& worktreePath);
 
+// Commit id gitRef resolves to, or "" if it does not name a commit.
+std::string resolveGitCommit(const std::string& repoRoot, const std::string& gitRef);
+
+// Pool directory from --worktree-pool, else from ARMOR_WORKTREE_POOL; "" when pooling is off.
+std::string getWorktreePoolDir(const std::string& option = "");
+
+// Checks out gitRef in a reusable worktree of the pool under poolDir. Slots
+// are kept per repository and locked while in use, so concurrent runs take
+// different ones; a slot already at the commit is preferred, otherwise one is
+// moved there with an incremental checkout. Either way the slot is reset and
+// cleaned of untracked and ignored files. At most 64 slots are kept.
+// Returns "" on failure, with the reason in error.
+std::string acquirePooledWorktree(const std::string& poolDir, const std::string& repoRoot,
+                                  const std::string& gitRef, int& lockFd, std::string& error);
+void releasePooledWorktree(int lockFd);
+
 struct GitWorktreeGuard {
     std::string repoRoot;
     std::string worktreePath;
     bool active = false;
+    // Lock on a pooled worktree, which is released rather than removed.
+    int poolLock = -1;
+    // Why a pooled worktree could not be prepared.
+    std::string error;
 
     GitWorktreeGuard() = default;
     GitWorktreeGuard(const GitWorktreeGuard&) = delete;
     GitWorktreeGuard& operator=(const GitWorktreeGuard&) = delete;
 
     ~GitWorktreeGuard() {
-        if (active && !worktreePath.empty())
+        if (poolLock >= 0)
+            releasePooledWorktree(poolLock);
+        else if (active && !worktreePath.empty())
             removeGitWorktree(repoRoot, worktreePath);
     }
 };
 
+// Checks out gitRef into guard, from the pool when poolDir is set, else into a fresh worktree.
+bool prepareGitWorktree(GitWorktreeGuard& guard, const std::string& repoRoot, const std::string& gitRef,
+                        const std::string& poolDir);
+
 #endif
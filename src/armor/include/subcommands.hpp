@@ -0,0 +1,26 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#ifndef SUBCOMMANDS_HPP
+#define SUBCOMMANDS_HPP
+
+// Each takes the arguments after `armor`, starting with the subcommand name.
+
+// `armor merge-reports`: combines the armor_reports directories of --shard runs.
+bool runMergeReports(int argc, const char **argv);
+
+// `armor snapshot`: writes the normalized API of headers as a baseline for later comparisons.
+bool runSnapshot(int argc, const char **argv);
+
+// `armor db`: builds and queries the multi-release API database.
+bool runDatabase(int argc, const char **argv);
+
+// `armor chain`: compares v1->v2->...->vN, parsing every version of a header once.
+bool runChain(int argc, const char **argv);
+
+// `armor multi`: compares one new version against several baselines, parsing the new version once.
+bool runMulti(int argc, const char **argv);
+
+// `armor configs`: compares two versions under every configuration of a matrix in one run.
+bool runConfigs(int argc, const char **argv);
+
+#endif
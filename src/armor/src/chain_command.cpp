@@ -0,0 +1,126 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "subcommands.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include "CLI/CLI.hpp"
+#include "command_utils.hpp"
+#include "alpha/include/header_processor.hpp"
+#include "beta/include/header_processor.hpp"
+#include "report_utils.hpp"
+#include "session.hpp"
+
+bool runChain(int argc, const char **argv) {
+    CLI::App app{"Compare a series of versions pairwise in order (v1->v2->...->vN),\n"
+                 "parsing each version of a header only once.\n"};
+    app.name("armor chain");
+    std::vector<std::string> versionArgs;
+    std::vector<std::string> headers;
+    std::string headerSubDir;
+    std::string reportFormat = "html";
+    std::string language = LANG_CPP;
+    bool dumpAstDiff = false;
+    std::vector<std::string> IncludePaths;
+    std::string macroFlags;
+    std::string traceOut;
+    app.add_option("versions", versionArgs, "Project roots or git refs, oldest first (at least two)")->required();
+    app.add_option("-H,--headers", headers,
+        "Headers to compare, relative to each project root or to --header-dir");
+    app.add_option("--header-dir", headerSubDir, "Subdirectory under each project root containing headers");
+    bool recursive = false;
+    std::vector<std::string> includeGlobs;
+    std::vector<std::string> excludeGlobs;
+    app.add_flag("--recursive", recursive, "Also find headers in subdirectories of --header-dir");
+    app.add_option("--include-glob", includeGlobs,
+        "Headers under --header-dir to compare (default: *.h and *.hpp), as for two versions");
+    app.add_option("--exclude-glob", excludeGlobs, "Files under --header-dir to skip, matched like --include-glob");
+    app.add_option("--report-format,-r", reportFormat, "Report format: html (default) or json")
+        ->check(CLI::IsMember({"html", "json"}));
+    app.add_option("--lang,-l", language, "Language mode: cpp (default) or c.")
+        ->transform(CLI::IsMember({LANG_C, LANG_CPP}, CLI::ignore_case));
+    app.add_flag("--dump-ast-diff", dumpAstDiff, "Dump AST diff JSON files for debugging");
+    app.add_option("-I,--include-paths", IncludePaths, "Include paths for header dependencies");
+    app.add_option("-m,--macro-flags", macroFlags, "Macro flags to be passed for headers.\n");
+    app.add_option("--trace-out", traceOut,
+        "Write a Chrome trace-event JSON of the run, with one parse span per version of a header");
+    CLI11_PARSE(app, argc, argv);
+
+    if (versionArgs.size() < 2) {
+        armor::user_error() << "A chain needs at least two versions.\n";
+        return false;
+    }
+    TraceOutputGuard traceOutput{traceOut};
+    if (!traceOut.empty()) armor::Tracer::getInstance().enable(false);
+    std::list<GitWorktreeGuard> worktrees;
+    std::vector<ChainVersion> versions;
+    if (!resolveChainVersions(versionArgs, worktrees, versions)) return false;
+
+    std::vector<std::string> macros = splitMacroFlags(macroFlags);
+    LANG_OPTIONS langOption = stringToLangOption(language);
+    DebugConfig::getInstance().initialize();
+    DebugConfig::getInstance().setLevel(DebugConfig::Level::NONE);
+
+    std::string subDir = headerSubDir.empty() ? "" : "/" + headerSubDir;
+    if (headers.empty() && !headerSubDir.empty()) {
+        std::vector<std::string> dirs;
+        for (const ChainVersion& version : versions) dirs.push_back(version.projectRoot + subDir);
+        if (!findVersionHeaders(dirs, includeGlobs, excludeGlobs, recursive, headers)) return false;
+    }
+    if (headers.empty()) {
+        armor::user_error() << "No headers to compare. Pass --headers or --header-dir.\n";
+        return false;
+    }
+
+    size_t steps = 0;
+    size_t incompatibleSteps = 0;
+    for (const std::string& header : headers) {
+        // Only the previous version stays parsed; older ones are released as the chain advances.
+        std::unique_ptr<armor::APISession> previous;
+        std::string previousFile;
+        bool previousExists = false;
+        PARSING_STATUS previousStatus = FATAL_ERRORS;
+
+        for (size_t i = 0; i < versions.size(); ++i) {
+            const ChainVersion& version = versions[i];
+            std::string file = version.projectRoot + subDir + "/" + header;
+            auto session = std::make_unique<armor::APISession>();
+            bool exists = fileExists(file);
+            PARSING_STATUS status = FATAL_ERRORS;
+            if (exists) {
+                status = armor::alpha::parseHeaderAlpha(*session, version.projectRoot, file, IncludePaths, macros, langOption);
+                if (status == NO_FATAL_ERRORS)
+                    armor::beta::parseHeaderBeta(*session, version.projectRoot, file, IncludePaths, macros, langOption);
+            }
+
+            if (i > 0 && (previousExists || exists)) {
+                const ChainVersion& older = versions[i - 1];
+                std::string reportName = report_name_for_header(file, version.projectRoot) + "_" +
+                                         reportLabel(older.label) + "_to_" + reportLabel(version.label);
+                HeaderReportSummary summary;
+                if (!previousExists || !exists)
+                    summary = reportMissingHeader(reportName, !previousExists);
+                else if (previousStatus == NO_FATAL_ERRORS && status == NO_FATAL_ERRORS)
+                    summary = armor::beta::compareHeaderVersionsBeta(*previous, previousFile, *session,
+                                                                     version.projectRoot, file, reportFormat,
+                                                                     dumpAstDiff, reportName);
+                else
+                    summary = armor::alpha::compareHeaderVersionsAlpha(*previous, previousFile, *session,
+                                                                       version.projectRoot, file, reportFormat,
+                                                                       dumpAstDiff, reportName);
+                ++steps;
+                if (summary.compatibility != "backward_compatible") ++incompatibleSteps;
+                printHeaderSummary(header + " (" + older.label + " -> " + version.label + ")", summary);
+            }
+
+            previous = std::move(session);
+            previousFile = file;
+            previousExists = exists;
+            previousStatus = status;
+        }
+    }
+
+    armor::user_print() << "Chain of " << versions.size() << " versions: " << steps << " comparison(s), "
+                        << incompatibleSteps << " backward incompatible\n";
+    return steps > 0;
+}
@@ -0,0 +1,218 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "command_utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "api_snapshot.hpp"
+#include "archive_file_system.hpp"
+#include "report_utils.hpp"
+
+LANG_OPTIONS stringToLangOption(const std::string& lang) {
+    // Convert to lowercase for case-insensitive comparison
+    std::string lowerLang = lang;
+    std::transform(lowerLang.begin(), lowerLang.end(), lowerLang.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    
+    if (lowerLang == LANG_C) {
+        return LANG_OPTIONS::C;
+    } else if (lowerLang == LANG_CPP) {
+        return LANG_OPTIONS::CPP;
+    }
+    return LANG_OPTIONS::CPP; // default to C++
+}
+
+nlohmann::json lexicalDiffResult(ParsedDiffStatus parsedStatus) {
+    nlohmann::json diffResult;
+    diffResult[PARSED_STATUS] = parsedStatus;
+    diffResult[UNPARSED_STATUS] = UnParsedDiffStatus::UN_CHANGED;
+    diffResult[HEADER_RESOLUTION_FAILURES] = nlohmann::json::array();
+    diffResult[AST_DIFF] = nlohmann::json::array();
+    return diffResult;
+}
+
+HeaderReportSummary reportMissingHeader(const std::string& reportName, bool missingInOlder) {
+    HeaderReportSummary summary;
+    summary.compatibility = missingInOlder ? "backward_compatible" : "backward_incompatible";
+    summary.overallStatus = missingInOlder ? "BACKWARD_COMPATIBLE" : "BACKWARD_INCOMPATIBLE";
+    summary.reason        = missingInOlder ? "Missing header in older version" : "Missing header in newer version";
+
+    const auto& [jsonReportFile, htmlReportFile] = prepare_report_output_dirs(reportName);
+    generate_json_report(
+            {},
+              jsonReportFile,
+              static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
+              static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
+              summary.compatibility,
+              summary.overallStatus.c_str(),
+              summary.reason.c_str()
+              );
+    generate_html_report(
+        {},
+              htmlReportFile,
+              NO_PARSER,
+              static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
+              static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
+              summary.compatibility,
+              summary.overallStatus.c_str(),
+              summary.reason.c_str(),
+              {!missingInOlder, missingInOlder}
+            );
+    return summary;
+}
+
+void printHeaderSummary(const std::string& headerPath, const HeaderReportSummary& summary) {
+    bool pass = (summary.compatibility == "backward_compatible");
+    std::string text;
+    llvm::raw_string_ostream console(text);
+
+    if (pass) {
+        console << headerPath << "  ->  BACKWARD_COMPATIBLE\n";
+    } else if (summary.compatibility == "unknown") {
+        console << headerPath << "  ->  " << summary.overallStatus << " (compatibility unknown)\n";
+    } else {
+        console << headerPath << "  ->  BACKWARD_INCOMPATIBLE\n";
+        for (const auto& line : summary.incompatibleChanges) {
+            console << "         - " << line << "\n";
+        }
+    }
+    DebugConfig::getInstance().writeToConsole(console.str());
+}
+
+std::vector<std::string> splitMacroFlags(const std::string& macroFlags) {
+    std::vector<std::string> macros;
+    std::istringstream iss(macroFlags);
+    for (std::string flag; iss >> flag;) macros.push_back(flag);
+    return macros;
+}
+
+bool checkSnapshotFlags(const std::string& snapshotDir, LANG_OPTIONS lang,
+                        const std::vector<std::string>& includePaths, const std::vector<std::string>& macros) {
+    std::ifstream in(snapshotDir + "/" + armor::APISnapshot::MANIFEST);
+    nlohmann::json manifest = nlohmann::json::parse(in, nullptr, false);
+    std::vector<std::string> mismatches;
+    try {
+        if (!manifest.is_object()) throw std::invalid_argument("not an object");
+        if (stringToLangOption(manifest.value("lang", std::string(LANG_CPP))) != lang)
+            mismatches.push_back("language");
+        if (manifest.value("include_paths", std::vector<std::string>()) != includePaths)
+            mismatches.push_back("include paths");
+        if (splitMacroFlags(manifest.value("macro_flags", std::string())) != macros)
+            mismatches.push_back("macro flags");
+    }
+    catch (const std::exception&) {
+        armor::user_error() << "Unreadable snapshot manifest: " << snapshotDir << "/" << armor::APISnapshot::MANIFEST << "\n";
+        return false;
+    }
+    if (mismatches.empty()) return true;
+    std::string list;
+    for (const std::string& mismatch : mismatches) list += (list.empty() ? "" : ", ") + mismatch;
+    armor::user_error() << "Snapshot " << snapshotDir << " was written with other " << list
+                        << " than this comparison. Write it again with the same --lang, -I and -m options.\n";
+    return false;
+}
+
+bool mountArchiveRoot(std::string& projectRoot) {
+    if (!armor::TarArchive::isArchive(projectRoot) || !std::filesystem::is_regular_file(projectRoot)) return true;
+    std::string error;
+    std::string mountPoint = armor::mountArchive(projectRoot, error);
+    if (mountPoint.empty()) {
+        armor::user_error() << error << "\n";
+        return false;
+    }
+    armor::user_print() << "Reading archive " << projectRoot << " at " << mountPoint << "\n";
+    projectRoot = mountPoint;
+    return true;
+}
+
+bool fileExists(const std::string& path) {
+    return armor::getFileSystem().exists(path);
+}
+
+std::optional<armor::HeaderFilter> createSnapshotFilter(const std::vector<std::string>& includeGlobs,
+                                                        const std::vector<std::string>& excludeGlobs,
+                                                        std::string& error) {
+    auto snapshotPatterns = [](std::vector<std::string> patterns) {
+        for (std::string& pattern : patterns) pattern += armor::APISnapshot::EXTENSION;
+        return patterns;
+    };
+    return armor::HeaderFilter::create(
+        snapshotPatterns(includeGlobs.empty() ? armor::HeaderFilter::defaultIncludes() : includeGlobs),
+        snapshotPatterns(excludeGlobs), error);
+}
+
+bool findVersionHeaders(const std::vector<std::string>& dirs, const std::vector<std::string>& includeGlobs,
+                        const std::vector<std::string>& excludeGlobs, bool recursive,
+                        std::vector<std::string>& headers, const std::vector<bool>& snapshots) {
+    std::string error;
+    std::optional<armor::HeaderFilter> filter = armor::HeaderFilter::create(includeGlobs, excludeGlobs, error);
+    std::optional<armor::HeaderFilter> snapshotFilter;
+    if (filter) snapshotFilter = createSnapshotFilter(includeGlobs, excludeGlobs, error);
+    if (!filter || !snapshotFilter) {
+        armor::user_error() << error << "\n";
+        return false;
+    }
+    std::set<std::string> found;
+    for (size_t i = 0; i < dirs.size(); ++i) {
+        if (i < snapshots.size() && snapshots[i]) {
+            for (const std::string& snapshot : armor::findHeaders(dirs[i], *snapshotFilter, recursive))
+                found.insert(snapshot.substr(0, snapshot.size() - std::strlen(armor::APISnapshot::EXTENSION)));
+            continue;
+        }
+        for (std::string& header : armor::findHeaders(dirs[i], *filter, recursive)) found.insert(std::move(header));
+    }
+    headers.assign(found.begin(), found.end());
+    return true;
+}
+
+std::string reportLabel(const std::string& label) {
+    std::string safe = label;
+    std::replace_if(safe.begin(), safe.end(),
+                    [](unsigned char c) { return !std::isalnum(c) && c != '.' && c != '-' && c != '_'; }, '_');
+    return safe;
+}
+
+bool resolveChainVersions(const std::vector<std::string>& arguments, std::list<GitWorktreeGuard>& worktrees,
+                          std::vector<ChainVersion>& versions) {
+    std::string cwd = std::filesystem::current_path().string();
+    for (const std::string& argument : arguments) {
+        if (armor::TarArchive::isArchive(argument) && std::filesystem::is_regular_file(argument)) {
+            std::string projectRoot = argument;
+            if (!mountArchiveRoot(projectRoot)) return false;
+            llvm::StringRef label = llvm::sys::path::filename(argument);
+            for (llvm::StringRef extension : {".tar.gz", ".tgz", ".tar"}) {
+                if (label.consume_back(extension)) break;
+            }
+            versions.push_back({label.str(), projectRoot});
+            continue;
+        }
+        if (std::filesystem::is_directory(argument)) {
+            std::string label = std::filesystem::path(argument).lexically_normal().filename().string();
+            versions.push_back({label.empty() ? argument : label, argument});
+            continue;
+        }
+        if (!isGitRepo(cwd)) {
+            armor::user_error() << "Not a directory, and not in a git repository to resolve it as a ref: " << argument << "\n";
+            return false;
+        }
+        std::string repoRoot = getGitRepoRoot(cwd);
+        GitWorktreeGuard& guard = worktrees.emplace_back();
+        if (!prepareGitWorktree(guard, repoRoot, argument, getWorktreePoolDir())) {
+            armor::user_error() << "Failed to create git worktree for ref '" << argument << "'"
+                                << (guard.error.empty() ? "" : ": " + guard.error) << ".\n";
+            return false;
+        }
+        const std::string& worktreePath = guard.worktreePath;
+        // Same subdirectory of the worktree as the current directory is of the repository.
+        std::filesystem::path relPath = std::filesystem::canonical(cwd)
+                                            .lexically_relative(std::filesystem::canonical(repoRoot));
+        versions.push_back({argument, (std::filesystem::path(worktreePath) / relPath).string()});
+    }
+    return true;
+}
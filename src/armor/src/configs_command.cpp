@@ -0,0 +1,223 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "subcommands.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include "CLI/CLI.hpp"
+#include "command_utils.hpp"
+#include "alpha/include/header_processor.hpp"
+#include "beta/include/header_processor.hpp"
+#include "configuration_report.hpp"
+#include "file_content_cache.hpp"
+#include "header_processor_utils.hpp"
+#include "header_scheduler.hpp"
+#include "lexical_diff.hpp"
+#include "report_utils.hpp"
+#include "session.hpp"
+
+// Configurations with the same language and macro flags parse identically, so they share one comparison.
+struct FlagClass {
+    LANG_OPTIONS lang;
+    std::vector<std::string> macros;
+    std::vector<size_t> configurations;
+    std::string label;      // report name suffix, from the first configuration of the class
+};
+
+// One header under one flag class, or under all configurations when no parse is needed.
+struct ConfigTask {
+    std::string header;
+    std::string file1;
+    std::string file2;
+    std::string reportName;
+    const FlagClass* flagClass = nullptr;
+    std::vector<size_t> configurations;
+    bool needsParse = false;
+    double cost = 0;
+    HeaderReportSummary summary;
+};
+
+bool runConfigs(int argc, const char **argv) {
+    CLI::App app{"Compare two versions under several named configurations (macro flags and\n"
+                 "language) in one run, merging the results into one report.\n"};
+    app.name("armor configs");
+    std::string matrixFile;
+    std::vector<std::string> versionArgs;
+    std::vector<std::string> headers;
+    std::string headerSubDir;
+    unsigned jobs = 1;
+    std::string reportFormat = "html";
+    bool dumpAstDiff = false;
+    std::vector<std::string> IncludePaths;
+    app.add_option("--matrix", matrixFile,
+        "JSON array of configurations: {\"name\", \"lang\", \"macro_flags\"}")->required();
+    app.add_option("versions", versionArgs, "Older and newer project root or git ref")->required()->expected(2);
+    app.add_option("-H,--headers", headers,
+        "Headers to compare, relative to each project root or to --header-dir");
+    app.add_option("--header-dir", headerSubDir, "Subdirectory under each project root containing headers");
+    bool recursive = false;
+    std::vector<std::string> includeGlobs;
+    std::vector<std::string> excludeGlobs;
+    app.add_flag("--recursive", recursive, "Also find headers in subdirectories of --header-dir");
+    app.add_option("--include-glob", includeGlobs,
+        "Headers under --header-dir to compare (default: *.h and *.hpp), as for two versions");
+    app.add_option("--exclude-glob", excludeGlobs, "Files under --header-dir to skip, matched like --include-glob");
+    app.add_option("-j,--jobs", jobs, "Header and configuration comparisons run in parallel (default 1)")
+        ->check(CLI::Range(1u, 1024u));
+    app.add_option("--report-format,-r", reportFormat, "Report format: html (default) or json")
+        ->check(CLI::IsMember({"html", "json"}));
+    app.add_flag("--dump-ast-diff", dumpAstDiff, "Dump AST diff JSON files for debugging");
+    app.add_option("-I,--include-paths", IncludePaths, "Include paths for header dependencies");
+    CLI11_PARSE(app, argc, argv);
+
+    std::vector<armor::Configuration> configurations;
+    std::string error;
+    if (!armor::loadConfigurations(matrixFile, configurations, error)) {
+        armor::user_error() << "Invalid configuration matrix: " << error << "\n";
+        return false;
+    }
+    // Both versions are materialized once, whatever the number of configurations.
+    std::list<GitWorktreeGuard> worktrees;
+    std::vector<ChainVersion> versions;
+    if (!resolveChainVersions(versionArgs, worktrees, versions)) return false;
+    const std::string& projectRoot1 = versions[0].projectRoot;
+    const std::string& projectRoot2 = versions[1].projectRoot;
+
+    std::vector<FlagClass> flagClasses;
+    std::map<std::string, size_t> flagClassIndex;
+    std::vector<std::string> configurationNames;
+    for (size_t i = 0; i < configurations.size(); ++i) {
+        std::vector<std::string> macros = splitMacroFlags(configurations[i].macroFlags);
+        std::string key = configurations[i].lang;
+        for (const std::string& flag : macros) key += " " + flag;
+        auto inserted = flagClassIndex.emplace(key, flagClasses.size());
+        if (inserted.second)
+            flagClasses.push_back({stringToLangOption(configurations[i].lang), std::move(macros), {},
+                                   reportLabel(configurations[i].name)});
+        flagClasses[inserted.first->second].configurations.push_back(i);
+        configurationNames.push_back(configurations[i].name);
+    }
+    std::vector<size_t> allConfigurations(configurations.size());
+    for (size_t i = 0; i < allConfigurations.size(); ++i) allConfigurations[i] = i;
+
+    DebugConfig::getInstance().initialize();
+    DebugConfig::getInstance().setLevel(DebugConfig::Level::NONE);
+
+    std::string subDir = headerSubDir.empty() ? "" : "/" + headerSubDir;
+    if (headers.empty() && !headerSubDir.empty() &&
+        !findVersionHeaders({projectRoot1 + subDir, projectRoot2 + subDir}, includeGlobs, excludeGlobs, recursive,
+                            headers)) {
+        return false;
+    }
+    if (headers.empty()) {
+        armor::user_error() << "No headers to compare. Pass --headers or --header-dir.\n";
+        return false;
+    }
+
+    // Configuration-invariant work first: existence, identical contents and
+    // the token-level fast path, which depends on the language only.
+    std::vector<ConfigTask> tasks;
+    armor::FileContentCache contentCache;
+    for (const std::string& header : headers) {
+        std::string file1 = projectRoot1 + subDir + "/" + header;
+        std::string file2 = projectRoot2 + subDir + "/" + header;
+        std::string headerName = report_name_for_header(file1, projectRoot1);
+        bool exists1 = fileExists(file1);
+        bool exists2 = fileExists(file2);
+        if (!exists1 && !exists2) {
+            armor::user_error() << "Missing old and new versions of header : \n" << file1 << "\n" << file2 << "\n";
+            continue;
+        }
+        if (!exists1 || !exists2) {
+            ConfigTask& task = tasks.emplace_back();
+            task.header = header;
+            task.reportName = headerName;
+            task.configurations = allConfigurations;
+            task.summary = reportMissingHeader(headerName, !exists1);
+            continue;
+        }
+        if (!contentCache.filesDiffer(file1, file2)) {
+            armor::user_print() << "No differences found between: " << file1 << " and " << file2 << "\n";
+            contentCache.release(file1);
+            contentCache.release(file2);
+            continue;
+        }
+
+        const llvm::MemoryBuffer* buffer1 = contentCache.getBuffer(file1);
+        const llvm::MemoryBuffer* buffer2 = contentCache.getBuffer(file2);
+        std::map<LANG_OPTIONS, std::optional<ParsedDiffStatus>> lexicalStatus;
+        double cost = static_cast<double>(buffer1 ? buffer1->getBufferSize() : 0) +
+                      static_cast<double>(buffer2 ? buffer2->getBufferSize() : 0);
+        for (const FlagClass& flagClass : flagClasses) {
+            auto lexical = lexicalStatus.find(flagClass.lang);
+            if (lexical == lexicalStatus.end()) {
+                std::optional<ParsedDiffStatus> status;
+                if (buffer1 && buffer2)
+                    status = armor::classifyLexicalChange(buffer1->getMemBufferRef(), buffer2->getMemBufferRef(),
+                                                          flagClass.lang);
+                lexical = lexicalStatus.emplace(flagClass.lang, status).first;
+            }
+
+            ConfigTask& task = tasks.emplace_back();
+            task.header = header;
+            task.file1 = file1;
+            task.file2 = file2;
+            task.reportName = headerName + "_" + flagClass.label;
+            task.flagClass = &flagClass;
+            task.configurations = flagClass.configurations;
+            task.needsParse = !lexical->second;
+            task.cost = cost;
+            if (lexical->second)
+                task.summary = armor::emitHeaderDiffReport(lexicalDiffResult(*lexical->second), file1, projectRoot1,
+                                                           reportFormat, BETA_PARSER, dumpAstDiff, task.reportName);
+        }
+        contentCache.release(file1);
+        contentCache.release(file2);
+    }
+
+    // Parses and diffs of different headers and flag classes are independent.
+    std::vector<size_t> parseTasks;
+    std::vector<double> costs;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        if (!tasks[i].needsParse) continue;
+        parseTasks.push_back(i);
+        costs.push_back(tasks[i].cost);
+    }
+    armor::runLongestFirst(costs, jobs, [&](size_t index) {
+        ConfigTask& task = tasks[parseTasks[index]];
+        const FlagClass& flagClass = *task.flagClass;
+        armor::APISession session1;
+        armor::APISession session2;
+        PARSING_STATUS status1 = armor::alpha::parseHeaderAlpha(session1, projectRoot1, task.file1, IncludePaths,
+                                                                flagClass.macros, flagClass.lang);
+        PARSING_STATUS status2 = armor::alpha::parseHeaderAlpha(session2, projectRoot2, task.file2, IncludePaths,
+                                                                flagClass.macros, flagClass.lang);
+        if (status1 == NO_FATAL_ERRORS && status2 == NO_FATAL_ERRORS) {
+            armor::beta::parseHeaderBeta(session1, projectRoot1, task.file1, IncludePaths, flagClass.macros, flagClass.lang);
+            armor::beta::parseHeaderBeta(session2, projectRoot2, task.file2, IncludePaths, flagClass.macros, flagClass.lang);
+            task.summary = armor::beta::compareHeaderVersionsBeta(session1, task.file1, session2, projectRoot2,
+                                                                  task.file2, reportFormat, dumpAstDiff, task.reportName);
+        }
+        else {
+            task.summary = armor::alpha::compareHeaderVersionsAlpha(session1, task.file1, session2, projectRoot2,
+                                                                    task.file2, reportFormat, dumpAstDiff, task.reportName);
+        }
+    });
+
+    armor::ConfigurationReport report(configurationNames);
+    for (const ConfigTask& task : tasks) {
+        for (size_t configuration : task.configurations)
+            report.addResult(task.header, configuration, task.summary, task.reportName);
+        std::string label = task.flagClass ? task.flagClass->label : "all configurations";
+        printHeaderSummary(task.header + " [" + label + "]", task.summary);
+    }
+    for (size_t i = 0; i < configurationNames.size(); ++i) {
+        armor::user_print() << configurationNames[i] << ": "
+                            << (report.isBackwardCompatible(i) ? "BACKWARD_COMPATIBLE" : "BACKWARD_INCOMPATIBLE") << "\n";
+    }
+    report.writeJson(armor::ConfigurationReport::JSON_PATH);
+    report.writeHtml(armor::ConfigurationReport::HTML_PATH);
+    armor::user_print() << "Configuration report: " << armor::ConfigurationReport::HTML_PATH << "\n";
+    return true;
+}
@@ -0,0 +1,159 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "subcommands.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+#include "CLI/CLI.hpp"
+#include "command_utils.hpp"
+#include "api_database.hpp"
+#include "api_snapshot.hpp"
+#include "ast_normalized_context.hpp"
+#include "beta/include/diffengine.hpp"
+#include "header_processor_utils.hpp"
+#include "report_utils.hpp"
+
+// Stores every header of a snapshot directory as a new database release.
+static bool addSnapshotRelease(armor::APIDatabase& db, const std::string& release, const std::string& snapshotDir) {
+    std::ifstream in(snapshotDir + "/" + armor::APISnapshot::MANIFEST);
+    nlohmann::json manifest = nlohmann::json::parse(in, nullptr, false);
+    if (manifest.is_discarded() || !manifest.contains("headers")) {
+        armor::user_error() << "Not a snapshot directory: " << snapshotDir << "\n";
+        return false;
+    }
+
+    std::string error;
+    if (!db.addRelease(release, error)) {
+        armor::user_error() << "Cannot add release: " << error << "\n";
+        return false;
+    }
+    for (const auto& header : manifest["headers"]) {
+        std::string name = header.get<std::string>();
+        std::string storedName;
+        std::unique_ptr<armor::ASTNormalizedContext> context = armor::APISnapshot::load(
+            snapshotDir + "/" + name + armor::APISnapshot::EXTENSION, storedName, error);
+        if (!context || !db.addHeader(name, *context, error)) {
+            armor::user_error() << "Cannot add " << name << ": " << error << "\n";
+            return false;
+        }
+    }
+    armor::user_print() << "Release " << release << ": " << manifest["headers"].size() << " header(s)\n";
+    return true;
+}
+
+// Compares headers between two stored releases without parsing anything.
+static bool compareReleases(const armor::APIDatabase& db, const std::string& from, const std::string& to,
+                     std::vector<std::string> headers, const std::string& reportFormat) {
+    for (const std::string& release : {from, to}) {
+        if (!db.hasRelease(release)) {
+            armor::user_error() << "Unknown release: " << release << "\n";
+            return false;
+        }
+    }
+    if (headers.empty()) {
+        headers = db.getHeaders(from);
+        for (const std::string& header : db.getHeaders(to)) {
+            if (!db.hasHeader(from, header)) headers.push_back(header);
+        }
+    }
+
+    bool compatible = true;
+    for (const std::string& header : headers) {
+        HeaderReportSummary summary;
+        if (!db.hasHeader(from, header) && !db.hasHeader(to, header)) {
+            armor::user_error() << "Header not stored in " << from << " or " << to << ": " << header << "\n";
+            continue;
+        }
+        if (!db.hasHeader(to, header) || !db.hasHeader(from, header)) {
+            summary = reportMissingHeader(report_name_for_header(header, "."), !db.hasHeader(from, header));
+        }
+        else if (db.sameAPI(from, to, header)) {
+            summary.compatibility = "backward_compatible";
+            summary.overallStatus = "BACKWARD_COMPATIBLE";
+        }
+        else {
+            std::unique_ptr<armor::ASTNormalizedContext> context1 = db.loadHeader(from, header);
+            std::unique_ptr<armor::ASTNormalizedContext> context2 = db.loadHeader(to, header);
+            if (!context1 || !context2) {
+                armor::user_error() << "Corrupt database entry for " << header << "\n";
+                return false;
+            }
+            nlohmann::json diffResult = armor::beta::diffTrees(context1.get(), context2.get());
+            summary = armor::emitHeaderDiffReport(diffResult, header, ".", reportFormat, BETA_PARSER, false);
+        }
+        if (summary.compatibility != "backward_compatible") compatible = false;
+        printHeaderSummary(header, summary);
+    }
+    armor::user_print() << from << " -> " << to << ": "
+                        << (compatible ? "BACKWARD_COMPATIBLE" : "BACKWARD_INCOMPATIBLE") << "\n";
+    return true;
+}
+
+bool runDatabase(int argc, const char **argv) {
+    CLI::App app{"Store the normalized APIs of releases and query them without parsing.\n"};
+    app.name("armor db");
+    app.require_subcommand(1);
+    std::string dbPath = armor::APIDatabase::DEFAULT_PATH;
+    app.add_option("--db", dbPath, "Database file (default: " + dbPath + ")");
+
+    CLI::App* add = app.add_subcommand("add", "Add a release from a directory written by 'armor snapshot'");
+    std::string release;
+    std::string snapshotDir;
+    add->add_option("release", release, "Release name, e.g. v7.3")->required();
+    add->add_option("snapshot-dir", snapshotDir, "Snapshot directory")->required()->check(CLI::ExistingDirectory);
+
+    CLI::App* list = app.add_subcommand("list", "List releases and storage statistics");
+
+    CLI::App* compat = app.add_subcommand("compat", "Check whether one release is backward compatible with another");
+    std::string from;
+    std::string to;
+    std::vector<std::string> headers;
+    std::string reportFormat = "html";
+    compat->add_option("from", from, "Older release")->required();
+    compat->add_option("to", to, "Newer release")->required();
+    compat->add_option("headers", headers, "Headers to check (default: all stored headers)");
+    compat->add_option("--report-format,-r", reportFormat, "Report format: html (default) or json")
+        ->check(CLI::IsMember({"html", "json"}));
+
+    CLI::App* history = app.add_subcommand("history", "Show the releases in which a symbol changed");
+    std::string symbol;
+    history->add_option("symbol", symbol, "USR or qualified name, e.g. ns::Foo::bar")->required();
+    CLI11_PARSE(app, argc, argv);
+
+    armor::APIDatabase db;
+    std::string error;
+    if (!db.open(dbPath, error)) {
+        armor::user_error() << "Cannot open API database " << dbPath << ": " << error << "\n";
+        return false;
+    }
+
+    if (*add) {
+        if (!addSnapshotRelease(db, release, snapshotDir)) return false;
+        if (!db.commit(error)) {
+            armor::user_error() << "Cannot write API database " << dbPath << ": " << error << "\n";
+            return false;
+        }
+        armor::user_print() << dbPath << ": " << db.getReleases().size() << " release(s), "
+                            << db.getNodeCount() << " distinct node(s), " << db.getStringCount() << " string(s)\n";
+        return true;
+    }
+    if (*list) {
+        for (const std::string& name : db.getReleases())
+            armor::user_print() << name << "  " << db.getHeaders(name).size() << " header(s)\n";
+        armor::user_print() << db.getNodeCount() << " distinct node(s), " << db.getStringCount() << " string(s)\n";
+        return true;
+    }
+    if (*compat) return compareReleases(db, from, to, headers, reportFormat);
+
+    std::vector<armor::APIDatabase::SymbolVersion> versions = db.history(symbol);
+    if (versions.empty()) {
+        armor::user_print() << "No release declares " << symbol << "\n";
+        return true;
+    }
+    for (const auto& version : versions) {
+        armor::user_print() << version.release << "  " << version.header << "  " << version.usr << "  "
+                            << version.dataType << (version.changed ? "  (changed)" : "") << "\n";
+    }
+    return true;
+}
@@ -1,9 +1,15 @@
 // Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
 // SPDX-License-Identifier: BSD-3-Clause
 #include "git_utils.hpp"
+#include "trace.hpp"
+#include <atomic>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <fcntl.h>
+#include <sys/file.h>
 #include <unistd.h>
 #include <string>
 #include <vector>
@@ -47,9 +53,10 @@ std::string getRefInfo(const std::string& repoRoot, const std::string& gitRef) {
     return readPipe(pipe);
 }
 
-std::vector<std::string> getChangedHeaders(const std::string& repoRoot,
-                                            const std::string& oldRef,
-                                            const std::string& newRef) {
+std::vector<std::string> getChangedFiles(const std::string& repoRoot,
+                                          const std::string& oldRef,
+                                          const std::string& newRef) {
+    armor::TraceScope span("git diff", "git", oldRef + (newRef.empty() ? "" : ".." + newRef));
     std::string cmd = "git -C \"" + repoRoot + "\" diff --name-only " + oldRef;
     if (!newRef.empty())
         cmd += " " + newRef;
@@ -62,9 +69,7 @@ std::vector<std::string> getChangedHeaders(const std::string& repoRoot,
     while (fgets(buffer, sizeof(buffer), pipe)) {
         std::string line(buffer);
         if (!line.empty() && line.back() == '\n') line.pop_back();
-        if (line.empty()) continue;
-        auto ext = std::filesystem::path(line).extension().string();
-        if (ext == ".h" || ext == ".hpp" || ext == ".hxx")
+        if (!line.empty())
             result.push_back(line);
     }
     if (pclose(pipe) < 0)
@@ -72,8 +77,21 @@ std::vector<std::string> getChangedHeaders(const std::string& repoRoot,
     return result;
 }
 
+std::vector<std::string> getChangedHeaders(const std::string& repoRoot,
+                                            const std::string& oldRef,
+                                            const std::string& newRef) {
+    std::vector<std::string> result;
+    for (std::string& file : getChangedFiles(repoRoot, oldRef, newRef)) {
+        auto ext = std::filesystem::path(file).extension().string();
+        if (ext == ".h" || ext == ".hpp" || ext == ".hxx")
+            result.push_back(std::move(file));
+    }
+    return result;
+}
+
 std::string createGitWorktree(const std::string& repoRoot, const std::string& gitRef) {
-    static int counter = 0;
+    armor::TraceScope span("git worktree add", "git", gitRef);
+    static std::atomic<int> counter{0};
     std::string tempPath = "/tmp/armor_worktree_"
         + std::to_string(getpid())
         + "_"
@@ -88,6 +106,160 @@ std::string createGitWorktree(const std::string& repoRoot, const std::string& gi
 }
 
 void removeGitWorktree(const std::string& repoRoot, const std::string& worktreePath) {
+    armor::TraceScope span("git worktree remove", "git", worktreePath);
     std::string cmd = "git -C \"" + repoRoot + "\" worktree remove --force \"" + worktreePath + "\" 2>/dev/null";
     std::system(cmd.c_str());
 }
+
+std::string resolveGitCommit(const std::string& repoRoot, const std::string& gitRef) {
+    std::string cmd = "git -C \"" + repoRoot + "\" rev-parse --verify --quiet \"" + gitRef + "^{commit}\" 2>/dev/null";
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe) return "";
+    return readPipe(pipe);
+}
+
+std::string getWorktreePoolDir(const std::string& option) {
+    if (!option.empty()) return option;
+    const char* env = std::getenv("ARMOR_WORKTREE_POOL");
+    return env ? env : "";
+}
+
+// Pool subdirectory of a repository: its name plus a hash of its path (FNV-1a).
+static std::string poolKey(const std::string& repoRoot) {
+    std::string path = std::filesystem::weakly_canonical(repoRoot).string();
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : path) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return std::filesystem::path(path).filename().string() + "_" + hex;
+}
+
+// Most slots of a repository's pool, so a run never keeps adding slots it cannot use.
+static constexpr int MAX_POOL_SLOTS = 64;
+
+// Takes the lock of a slot without waiting; -1 if another run holds it, or
+// -1 with error set to the errno of the lock file that could not be opened.
+static int tryLockSlot(const std::filesystem::path& lockPath, int& error) {
+    int fd = open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = errno;
+        return -1;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        if (errno != EWOULDBLOCK) error = errno;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static std::string readHead(const std::string& worktreePath) {
+    std::string cmd = "git -C \"" + worktreePath + "\" rev-parse --verify --quiet HEAD 2>/dev/null";
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe) return "";
+    return readPipe(pipe);
+}
+
+// Moves a locked slot to commit, (re)creating its worktree if it is missing or broken.
+static bool checkoutSlot(const std::string& repoRoot, const std::string& slotPath, const std::string& commit) {
+    std::string head = readHead(slotPath);
+    if (!head.empty()) {
+        armor::TraceScope span("git worktree checkout", "git", commit);
+        // Only files that differ from commit are rewritten. A slot already at
+        // commit is still reset, and ignored files and nested repositories are
+        // removed every time, so nothing an earlier or crashed run left behind
+        // reaches the comparison.
+        std::string move = head == commit ? "reset --quiet --hard" : "checkout --quiet --force --detach " + commit;
+        std::string cmd = "git -C \"" + slotPath + "\" " + move + " > /dev/null 2>&1 && git -C \"" + slotPath +
+                          "\" clean -ffdqx > /dev/null 2>&1";
+        if (std::system(cmd.c_str()) == 0) return true;
+    }
+    armor::TraceScope span("git worktree add", "git", commit);
+    std::error_code ec;
+    std::filesystem::remove_all(slotPath, ec);
+    // A prune racing another slot's add can delete that worktree's metadata
+    // halfway through, so adds to the pool of a repository run one at a time.
+    std::string addLockPath = (std::filesystem::path(slotPath).parent_path() / "add.lock").string();
+    int addLock = open(addLockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (addLock >= 0) flock(addLock, LOCK_EX);
+    std::string cmd = "git -C \"" + repoRoot + "\" worktree prune > /dev/null 2>&1; git -C \"" + repoRoot +
+                      "\" worktree add --detach \"" + slotPath + "\" " + commit + " > /dev/null 2>&1";
+    bool added = std::system(cmd.c_str()) == 0;
+    releasePooledWorktree(addLock);
+    return added;
+}
+
+std::string acquirePooledWorktree(const std::string& poolDir, const std::string& repoRoot,
+                                  const std::string& gitRef, int& lockFd, std::string& error) {
+    lockFd = -1;
+    std::string commit = resolveGitCommit(repoRoot, gitRef);
+    if (commit.empty()) {
+        error = "'" + gitRef + "' does not name a commit";
+        return "";
+    }
+    std::filesystem::path repoDir = std::filesystem::absolute(poolDir) / poolKey(repoRoot);
+    std::error_code ec;
+    std::filesystem::create_directories(repoDir, ec);
+    if (ec) {
+        error = "cannot create " + repoDir.string() + ": " + ec.message();
+        return "";
+    }
+
+    auto slotPath = [&repoDir](int slot) { return repoDir / ("slot-" + std::to_string(slot)); };
+    auto lockPath = [&repoDir](int slot) { return repoDir / ("slot-" + std::to_string(slot) + ".lock"); };
+    int slots = 0;
+    while (std::filesystem::exists(lockPath(slots))) ++slots;
+
+    // A free slot already at the commit only needs a reset; otherwise take any
+    // free slot, and only add a new one when all are in use.
+    int chosen = -1;
+    int lockError = 0;
+    for (int slot = 0; slot < slots && chosen < 0 && !lockError; ++slot) {
+        if (readHead(slotPath(slot).string()) != commit) continue;
+        if ((lockFd = tryLockSlot(lockPath(slot), lockError)) >= 0) chosen = slot;
+    }
+    for (int slot = 0; slot < slots && chosen < 0 && !lockError; ++slot) {
+        if ((lockFd = tryLockSlot(lockPath(slot), lockError)) >= 0) chosen = slot;
+    }
+    for (int slot = slots; slot < MAX_POOL_SLOTS && chosen < 0 && !lockError; ++slot) {
+        if ((lockFd = tryLockSlot(lockPath(slot), lockError)) >= 0) chosen = slot;
+    }
+    if (lockError) {
+        error = "cannot lock a slot in " + repoDir.string() + ": " + std::strerror(lockError);
+        return "";
+    }
+    if (chosen < 0) {
+        error = "all " + std::to_string(MAX_POOL_SLOTS) + " slots in " + repoDir.string() + " are in use";
+        return "";
+    }
+
+    std::string path = slotPath(chosen).string();
+    if (!checkoutSlot(repoRoot, path, commit)) {
+        releasePooledWorktree(lockFd);
+        lockFd = -1;
+        error = "cannot check out " + commit + " in " + path;
+        return "";
+    }
+    return path;
+}
+
+void releasePooledWorktree(int lockFd) {
+    if (lockFd < 0) return;
+    flock(lockFd, LOCK_UN);
+    close(lockFd);
+}
+
+bool prepareGitWorktree(GitWorktreeGuard& guard, const std::string& repoRoot, const std::string& gitRef,
+                        const std::string& poolDir) {
+    guard.repoRoot = repoRoot;
+    if (!poolDir.empty()) {
+        guard.worktreePath = acquirePooledWorktree(poolDir, repoRoot, gitRef, guard.poolLock, guard.error);
+        return !guard.worktreePath.empty();
+    }
+    guard.worktreePath = createGitWorktree(repoRoot, gitRef);
+    guard.active = !guard.worktreePath.empty();
+    return guard.active;
+}
@@ -0,0 +1,33 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "subcommands.hpp"
+#include <string>
+#include <vector>
+#include "CLI/CLI.hpp"
+#include "command_utils.hpp"
+#include "shard_report.hpp"
+
+bool runMergeReports(int argc, const char **argv) {
+    CLI::App app{"Combine the armor_reports directories of several --shard runs into one result.\n"};
+    app.name("armor merge-reports");
+    std::vector<std::string> shardDirs;
+    std::string outDir = "armor_reports";
+    app.add_option("shard-dirs", shardDirs, "armor_reports directories written by the shard runs")
+        ->required()
+        ->check(CLI::ExistingDirectory);
+    app.add_option("--output-dir,-o", outDir, "Directory for the merged reports (default: armor_reports)");
+    CLI11_PARSE(app, argc, argv);
+
+    armor::ShardSummary merged;
+    if (!armor::mergeShardReports(shardDirs, outDir, merged)) return false;
+
+    armor::user_print() << "Merged " << merged.getEntries().size() << " header(s) from " << shardDirs.size()
+                        << " shard(s) into " << outDir << "\n";
+    for (const auto& entry : merged.getEntries()) {
+        if (entry.summary.compatibility != "backward_compatible")
+            printHeaderSummary(entry.header, entry.summary);
+    }
+    armor::user_print() << "Overall: "
+                        << (merged.isBackwardCompatible() ? "BACKWARD_COMPATIBLE" : "BACKWARD_INCOMPATIBLE") << "\n";
+    return true;
+}
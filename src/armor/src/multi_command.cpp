@@ -0,0 +1,184 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "subcommands.hpp"
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <memory>
+#include "CLI/CLI.hpp"
+#include "llvm/Support/raw_ostream.h"
+#include "command_utils.hpp"
+#include "alpha/include/header_processor.hpp"
+#include "beta/include/header_processor.hpp"
+#include "api_snapshot.hpp"
+#include "archive_file_system.hpp"
+#include "baseline_matrix.hpp"
+#include "header_scheduler.hpp"
+#include "report_utils.hpp"
+#include "session.hpp"
+
+bool runMulti(int argc, const char **argv) {
+    CLI::App app{"Compare a new version against several baselines (project roots, git refs\n"
+                 "or snapshot directories), parsing the new version of a header only once.\n"};
+    app.name("armor multi");
+    std::vector<std::string> versionArgs;
+    std::vector<std::string> headers;
+    std::string headerSubDir;
+    unsigned jobs = 1;
+    std::string reportFormat = "html";
+    std::string language = LANG_CPP;
+    bool dumpAstDiff = false;
+    std::vector<std::string> IncludePaths;
+    std::string macroFlags;
+    app.add_option("versions", versionArgs, "The new version, then one or more baselines")->required();
+    app.add_option("-H,--headers", headers,
+        "Headers to compare, relative to each project root or to --header-dir");
+    app.add_option("--header-dir", headerSubDir, "Subdirectory under each project root containing headers");
+    bool recursive = false;
+    std::vector<std::string> includeGlobs;
+    std::vector<std::string> excludeGlobs;
+    app.add_flag("--recursive", recursive, "Also find headers in subdirectories of --header-dir");
+    app.add_option("--include-glob", includeGlobs,
+        "Headers under --header-dir to compare (default: *.h and *.hpp), as for two versions");
+    app.add_option("--exclude-glob", excludeGlobs, "Files under --header-dir to skip, matched like --include-glob");
+    app.add_option("-j,--jobs", jobs, "Versions of a header parsed in parallel (default 1)")
+        ->check(CLI::Range(1u, 1024u));
+    app.add_option("--report-format,-r", reportFormat, "Report format: html (default) or json")
+        ->check(CLI::IsMember({"html", "json"}));
+    app.add_option("--lang,-l", language, "Language mode: cpp (default) or c.")
+        ->transform(CLI::IsMember({LANG_C, LANG_CPP}, CLI::ignore_case));
+    app.add_flag("--dump-ast-diff", dumpAstDiff, "Dump AST diff JSON files for debugging");
+    app.add_option("-I,--include-paths", IncludePaths, "Include paths for header dependencies");
+    app.add_option("-m,--macro-flags", macroFlags, "Macro flags to be passed for headers.\n");
+    CLI11_PARSE(app, argc, argv);
+
+    if (versionArgs.size() < 2) {
+        armor::user_error() << "Give the new version and at least one baseline.\n";
+        return false;
+    }
+    // versions[0] is the new version; snapshot baselines are read, never parsed.
+    std::list<GitWorktreeGuard> worktrees;
+    std::vector<ChainVersion> versions;
+    std::vector<bool> isSnapshot;
+    for (size_t i = 0; i < versionArgs.size(); ++i) {
+        const std::string& argument = versionArgs[i];
+        bool snapshot = i > 0 && std::filesystem::exists(std::filesystem::path(argument) / armor::APISnapshot::MANIFEST);
+        if (snapshot) {
+            std::string label = std::filesystem::path(argument).lexically_normal().filename().string();
+            versions.push_back({label.empty() ? argument : label, argument});
+        }
+        else if (!resolveChainVersions({argument}, worktrees, versions)) {
+            return false;
+        }
+        isSnapshot.push_back(snapshot);
+    }
+
+    std::vector<std::string> macros = splitMacroFlags(macroFlags);
+    LANG_OPTIONS langOption = stringToLangOption(language);
+    for (size_t i = 1; i < versions.size(); ++i) {
+        if (isSnapshot[i] && !checkSnapshotFlags(versions[i].projectRoot, langOption, IncludePaths, macros))
+            return false;
+    }
+    DebugConfig::getInstance().initialize();
+    DebugConfig::getInstance().setLevel(DebugConfig::Level::NONE);
+
+    std::string subDir = headerSubDir.empty() ? "" : "/" + headerSubDir;
+    auto versionFile = [&](size_t i, const std::string& header) {
+        std::string file = versions[i].projectRoot + subDir + "/" + header;
+        return isSnapshot[i] ? file + armor::APISnapshot::EXTENSION : file;
+    };
+    if (headers.empty() && !headerSubDir.empty()) {
+        std::vector<std::string> dirs;
+        for (const ChainVersion& version : versions) dirs.push_back(version.projectRoot + subDir);
+        if (!findVersionHeaders(dirs, includeGlobs, excludeGlobs, recursive, headers, isSnapshot)) return false;
+    }
+    if (headers.empty()) {
+        armor::user_error() << "No headers to compare. Pass --headers or --header-dir.\n";
+        return false;
+    }
+
+    std::vector<std::string> baselineLabels;
+    for (size_t i = 1; i < versions.size(); ++i) baselineLabels.push_back(versions[i].label);
+    armor::BaselineMatrix matrix(baselineLabels);
+
+    for (const std::string& header : headers) {
+        std::vector<std::string> files(versions.size());
+        std::vector<bool> exists(versions.size());
+        std::vector<std::unique_ptr<armor::APISession>> sessions(versions.size());
+        std::vector<PARSING_STATUS> statuses(versions.size(), FATAL_ERRORS);
+        std::vector<size_t> toParse;
+        std::vector<double> costs;
+        for (size_t i = 0; i < versions.size(); ++i) {
+            files[i] = versionFile(i, header);
+            llvm::ErrorOr<llvm::vfs::Status> status = armor::getFileSystem().status(files[i]);
+            exists[i] = static_cast<bool>(status);
+            if (exists[i] && !isSnapshot[i]) {
+                toParse.push_back(i);
+                costs.push_back(static_cast<double>(status->getSize()));
+            }
+        }
+
+        // Parses are independent; each task fills only its own slot.
+        armor::runLongestFirst(costs, jobs, [&](size_t task) {
+            size_t i = toParse[task];
+            auto session = std::make_unique<armor::APISession>();
+            statuses[i] = armor::alpha::parseHeaderAlpha(*session, versions[i].projectRoot, files[i],
+                                                         IncludePaths, macros, langOption);
+            if (statuses[i] == NO_FATAL_ERRORS)
+                armor::beta::parseHeaderBeta(*session, versions[i].projectRoot, files[i], IncludePaths, macros, langOption);
+            sessions[i] = std::move(session);
+        });
+
+        // Diffs run one at a time: each one borrows the new version's context.
+        for (size_t i = 1; i < versions.size(); ++i) {
+            if (!exists[0] && !exists[i]) continue;
+            std::string reportName = report_name_for_header(files[0], versions[0].projectRoot) + "_vs_" +
+                                     reportLabel(versions[i].label);
+            HeaderReportSummary summary;
+            if (!exists[0] || !exists[i]) {
+                summary = reportMissingHeader(reportName, !exists[i]);
+            }
+            else if (isSnapshot[i]) {
+                std::string snapshotHeader, error;
+                std::unique_ptr<armor::ASTNormalizedContext> baseline =
+                    armor::APISnapshot::load(files[i], snapshotHeader, error);
+                if (!baseline) {
+                    armor::user_error() << "Failed to load snapshot " << files[i] << ": " << error << "\n";
+                    matrix.addFailure(header, i - 1, "Failed to load snapshot: " + error);
+                    continue;
+                }
+                armor::ASTNormalizedContext* context = sessions[0]->getBetaContext(files[0]);
+                if (statuses[0] == NO_FATAL_ERRORS && context)
+                    summary = armor::beta::compareHeaderContextsBeta(*baseline, *context, versions[0].projectRoot,
+                                                                     files[0], reportFormat, dumpAstDiff, reportName);
+                else
+                    summary = armor::alpha::compareHeaderVersionsAlpha(armor::APISession(), files[i], *sessions[0],
+                                                                       versions[0].projectRoot, files[0],
+                                                                       reportFormat, dumpAstDiff, reportName);
+            }
+            else if (statuses[i] == NO_FATAL_ERRORS && statuses[0] == NO_FATAL_ERRORS) {
+                summary = armor::beta::compareHeaderVersionsBeta(*sessions[i], files[i], *sessions[0],
+                                                                 versions[0].projectRoot, files[0], reportFormat,
+                                                                 dumpAstDiff, reportName);
+            }
+            else {
+                summary = armor::alpha::compareHeaderVersionsAlpha(*sessions[i], files[i], *sessions[0],
+                                                                   versions[0].projectRoot, files[0], reportFormat,
+                                                                   dumpAstDiff, reportName);
+            }
+            matrix.addResult(header, i - 1, summary, reportName);
+            printHeaderSummary(header + " (vs " + versions[i].label + ")", summary);
+            // A baseline is no longer needed once compared.
+            sessions[i].reset();
+        }
+    }
+
+    std::string table;
+    llvm::raw_string_ostream tableStream(table);
+    matrix.print(tableStream);
+    armor::user_print() << tableStream.str();
+    matrix.writeJson(armor::BaselineMatrix::JSON_PATH);
+    matrix.writeHtml(armor::BaselineMatrix::HTML_PATH);
+    armor::user_print() << "Baseline report: " << armor::BaselineMatrix::HTML_PATH << "\n";
+    return true;
+}
@@ -1,16 +1,21 @@
 // Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
 // SPDX-License-Identifier: BSD-3-Clause
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <string>
 #include <filesystem>
-#include <algorithm>
-#include <cctype>
+#include <cstring>
+#include <optional>
+#include <set>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include "CLI/CLI.hpp"
 #include "llvm/Support/raw_ostream.h"
 #include "comm_def.hpp"
 #include "options_handler.hpp"
+#include "command_utils.hpp"
+#include "subcommands.hpp"
 #include "git_utils.hpp"
 #include <nlohmann/json.hpp>
 
@@ -18,65 +23,365 @@
 
 #include "alpha/include/header_processor.hpp"
 #include "beta/include/header_processor.hpp"
+#include "api_snapshot.hpp"
+#include "archive_file_system.hpp"
 #include "report_utils.hpp"
+#include "report_generator.hpp"
+#include "categorization.hpp"
 #include "diff_utils.hpp"
+#include "file_content_cache.hpp"
+#include "header_budget.hpp"
+#include "header_discovery.hpp"
+#include "header_processor_utils.hpp"
+#include "header_scheduler.hpp"
+#include "header_search.hpp"
+#include "include_graph.hpp"
+#include "lexical_diff.hpp"
+#include "consolidated_report.hpp"
 #include "logger.hpp"
+#include "ndjson_writer.hpp"
+#include "progress_reporter.hpp"
+#include "run_stats.hpp"
+#include "shard_report.hpp"
+#include "trace.hpp"
 
 #ifndef TOOL_VERSION
 #define TOOL_VERSION ""
 #endif
 
-LANG_OPTIONS stringToLangOption(const std::string& lang) {
-    // Convert to lowercase for case-insensitive comparison
-    std::string lowerLang = lang;
-    std::transform(lowerLang.begin(), lowerLang.end(), lowerLang.begin(),
-                   [](unsigned char c){ return std::tolower(c); });
-    
-    if (lowerLang == LANG_C) {
-        return LANG_OPTIONS::C;
-    } else if (lowerLang == LANG_CPP) {
-        return LANG_OPTIONS::CPP;
+// Comment- and whitespace-only edits are classified from a raw lex of both
+// versions; the alpha and beta parsers only run when tokens actually changed.
+bool classifyWithoutParsing(armor::FileContentCache& contentCache,
+                            const std::string& projectRoot1,
+                            const std::string& file1,
+                            const std::string& file2,
+                            const std::string& reportFormat,
+                            LANG_OPTIONS lang,
+                            bool dumpAstDiff,
+                            HeaderReportSummary& summary) {
+    armor::TraceScope span("lexical classification", "lexical", file1);
+    const llvm::MemoryBuffer* buffer1 = contentCache.getBuffer(file1);
+    const llvm::MemoryBuffer* buffer2 = contentCache.getBuffer(file2);
+    if (!buffer1 || !buffer2) return false;
+
+    std::optional<ParsedDiffStatus> parsedStatus = armor::classifyLexicalChange(
+        buffer1->getMemBufferRef(), buffer2->getMemBufferRef(), lang);
+    if (!parsedStatus) return false;
+
+    armor::info() << "Only comments or whitespace changed, skipping alpha and beta parsers\n";
+    summary = armor::emitHeaderDiffReport(lexicalDiffResult(*parsedStatus), file1, projectRoot1, reportFormat,
+                                          BETA_PARSER, dumpAstDiff);
+    return true;
+}
+
+// Rewrites the reports of file1, a header of projectRoot1, from its summary.
+void writeHeaderReport(const std::string& file1, const std::string& projectRoot1, const std::string& reportFormat,
+                       const HeaderReportSummary& summary) {
+    const auto& [jsonReportFile, htmlReportFile] =
+        prepare_report_output_dirs(report_name_for_header(file1, projectRoot1));
+    generate_reports(summary.changes, htmlReportFile, reportFormat == "json" ? jsonReportFile : std::string(),
+                     summary.parser, summary.parsedStatus, summary.unparsedStatus,
+                     summary.compatibility, summary.overallStatus.c_str(), summary.reason.c_str());
+}
+
+// Reports a header whose alpha parse ran over its budget. The lexical pass
+// already found changed tokens, so compatibility is left undetermined. Against
+// a snapshot, or for a header changed only through its includes, there was no
+// token comparison to fall back on.
+HeaderReportSummary reportTokenLevelFallback(const std::string& file1, const std::string& projectRoot1,
+                                             const std::string& reportFormat, bool tokensCompared = true) {
+    armor::user_error() << "Header exceeded its " << armor::HeaderBudget::describe()
+                        << (tokensCompared ? ", reporting a token-level comparison: " : ", compatibility undetermined: ")
+                        << file1 << "\n";
+    HeaderReportSummary summary;
+    summary.overallStatus = serialize(OverAllStatus::NOT_CATEGORIZED);
+    summary.reason = "Processing stopped after exceeding the " + armor::HeaderBudget::describe() + " in the alpha parser." +
+                     (tokensCompared ? " Token-level comparison found code changes." : "") +
+                     " Cannot comment on compatibility.";
+    summary.parsedStatus = static_cast<int>(ParsedDiffStatus::UNSUPPORTED_UPDATES);
+    summary.unparsedStatus = static_cast<int>(UnParsedDiffStatus::UN_CHANGED);
+    summary.degradation = "token_level";
+    writeHeaderReport(file1, projectRoot1, reportFormat, summary);
+    return summary;
+}
+
+// Marks a header whose beta pass ran over its budget as reported by the alpha parser alone.
+void markAlphaOnly(const std::string& file1, const std::string& projectRoot1, const std::string& reportFormat,
+                   HeaderReportSummary& summary) {
+    armor::user_error() << "Header exceeded its " << armor::HeaderBudget::describe()
+                        << ", compatibility undetermined after the alpha parser: " << file1 << "\n";
+    armor::markAlphaOnly(summary);
+    writeHeaderReport(file1, projectRoot1, reportFormat, summary);
+}
+
+// Run-wide outputs that receive every header result.
+struct RunOutputs {
+    armor::NdjsonWriter ndjson;
+    bool consolidated = false;
+    armor::ConsolidatedReport consolidatedReport;
+    armor::ProgressReporter progress;
+    bool sharded = false;
+    armor::ShardSummary shardSummary;
+
+    std::mutex mutex;
+
+    void addHeader(const std::string& file, const std::string& projectRoot, const HeaderReportSummary& summary) {
+        if (!ndjson.isOpen() && !consolidated && !sharded) return;
+        std::string header = std::filesystem::relative(file, projectRoot).string();
+        std::scoped_lock<std::mutex> lock(mutex);
+        ndjson.writeHeader(header, summary);
+        if (consolidated) consolidatedReport.addHeader(header, summary);
+        if (sharded) shardSummary.addHeader(header, summary);
+    }
+
+    void finish() {
+        progress.finish();
+        if (consolidated && !consolidatedReport.empty()) {
+            if (consolidatedReport.write(armor::ConsolidatedReport::DEFAULT_PATH))
+                armor::user_print() << "Consolidated report generated at: " << armor::ConsolidatedReport::DEFAULT_PATH << "\n";
+            else
+                armor::user_error() << "Failed to write consolidated report: " << armor::ConsolidatedReport::DEFAULT_PATH << "\n";
+        }
+        if (sharded && !shardSummary.write(armor::ShardSummary::DEFAULT_PATH))
+            armor::user_error() << "Failed to write shard summary: " << armor::ShardSummary::DEFAULT_PATH << "\n";
+        if (armor::RunStats::isEnabled()) {
+            armor::RunStats& stats = armor::RunStats::getInstance();
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            stats.print(os);
+            armor::user_print() << os.str();
+            std::filesystem::create_directories(std::filesystem::path(armor::RunStats::DEFAULT_PATH).parent_path());
+            if (!stats.writeJson(armor::RunStats::DEFAULT_PATH))
+                armor::user_error() << "Failed to write run statistics: " << armor::RunStats::DEFAULT_PATH << "\n";
+        }
     }
-    return LANG_OPTIONS::CPP; // default to C++
+};
+
+// Accepts "ndjson", "ndjson=PATH" and "ndjson=-" (stdout).
+bool parseOutputSpec(const std::string& spec, std::string& ndjsonPath) {
+    const std::string kind = "ndjson";
+    if (spec == kind) {
+        ndjsonPath = armor::NdjsonWriter::DEFAULT_PATH;
+        return true;
+    }
+    if (spec.compare(0, kind.size() + 1, kind + "=") == 0 && spec.size() > kind.size() + 1) {
+        ndjsonPath = spec.substr(kind.size() + 1);
+        return true;
+    }
+    return false;
 }
 
-bool filesAreDifferentUsingDiff(const std::string &file1, const std::string &file2) {
-    std::string command = "diff -q " + file1 + " " + file2 + " > /dev/null";
-    return std::system(command.c_str()) != 0;
+// Settings shared by every header pair of a run.
+struct PairOptions {
+    const std::string& projectRoot1;
+    const std::string& projectRoot2;
+    const std::string& reportFormat;
+    const std::vector<std::string>& includePaths;
+    const std::vector<std::string>& macros;
+    LANG_OPTIONS lang;
+    bool dumpAstDiff;
+    bool gitDiff;
+    armor::HeaderBudget::Limits budget;
+    // projectRoot1 is a directory written by `armor snapshot`.
+    bool snapshotBaseline = false;
+};
+
+// Reports a header the beta parser could not compare against its snapshot,
+// e.g. because the snapshot file is truncated or of another version.
+void markSnapshotFailure(const std::string& file2, const std::string& projectRoot2, const std::string& reportFormat,
+                         HeaderReportSummary& summary) {
+    summary.compatibility = "unknown";
+    summary.overallStatus = serialize(OverAllStatus::FATAL_ERRORS);
+    summary.reason = "Beta parser could not compare the header against its snapshot. Cannot comment on compatibility.";
+    writeHeaderReport(file2, projectRoot2, reportFormat, summary);
 }
 
-void printHeaderSummary(const std::string& headerPath) {
-    std::string headerName = std::filesystem::path(headerPath).filename().string();
-    std::string jsonPath = "armor_reports/json_reports/api_diff_report_" + headerName + ".json";
-    std::ifstream f(jsonPath);
-    if (!f.is_open()) return;
-
-    nlohmann::json report;
-    try { f >> report; } catch (...) { return; }
-
-    std::string compatibility = report.value("compatibility", "unknown");
-    bool pass = (compatibility == "backward_compatible");
-
-    if (pass) {
-        llvm::outs() << headerPath << "  ->  BACKWARD_COMPATIBLE\n";
-    } else {
-        llvm::outs() << headerPath << "  ->  BACKWARD_INCOMPATIBLE\n";
-        if (report.contains("api_diff")) {
-            for (const auto& change : report["api_diff"]) {
-                if (change.value("compatibility", "") == "backward_incompatible") {
-                    std::string desc = change.value("description", "");
-                    auto nl = desc.find('\n');
-                    std::string line = (nl != std::string::npos) ? desc.substr(0, nl) : desc;
-                    if (!line.empty())
-                        llvm::outs() << "         - " << line << "\n";
-                }
+// Compares a header against its snapshot: both passes parse the new version only.
+HeaderReportSummary compareWithSnapshot(const std::string& snapshotFile, const std::string& file2,
+                                        const PairOptions& options) {
+    HeaderReportSummary summary;
+    PARSING_STATUS parsingStatus = armor::alpha::processHeaderAgainstSnapshotAlpha(
+        options.projectRoot2, file2, options.reportFormat, options.includePaths, options.macros,
+        options.lang, options.dumpAstDiff, &summary);
+    if (armor::HeaderBudget::exceeded()) {
+        return reportTokenLevelFallback(file2, options.projectRoot2, options.reportFormat, false);
+    }
+    switch (parsingStatus) {
+        case NO_FATAL_ERRORS: {
+            armor::info() << "Processing Headers again via beta parser\n";
+            PARSING_STATUS betaStatus = armor::beta::processHeaderAgainstSnapshotBeta(
+                snapshotFile, options.projectRoot2, file2, options.reportFormat, options.includePaths,
+                options.macros, options.lang, options.dumpAstDiff, &summary);
+            if (armor::HeaderBudget::exceeded())
+                markAlphaOnly(file2, options.projectRoot2, options.reportFormat, summary);
+            else if (betaStatus == FATAL_ERRORS)
+                markSnapshotFailure(file2, options.projectRoot2, options.reportFormat, summary);
+            break;
+        }
+        case FATAL_ERRORS:
+            armor::info() << "Processing Headers stopped at alpha parser\n";
+            break;
+    }
+    return summary;
+}
+
+// Unmaps both files of a pair on every exit path of its comparison.
+struct PairBufferRelease {
+    armor::FileContentCache& contentCache;
+    const std::string& file1;
+    const std::string& file2;
+
+    ~PairBufferRelease() {
+        contentCache.release(file1);
+        contentCache.release(file2);
+    }
+};
+
+// Compares one header between the two versions and reports it. Returns true
+// when both versions exist, i.e. the header was actually compared.
+bool processHeaderPair(const armor::HeaderPair& pair, const PairOptions& options,
+                       armor::FileContentCache& contentCache, RunOutputs& outputs) {
+    armor::HeaderStatsScope headerStats(pair.header);
+    armor::TraceScope headerSpan("header", "header", pair.header);
+    armor::HeaderBudget::Scope budget(options.budget);
+    const std::string& file1 = pair.file1;
+    const std::string& file2 = pair.file2;
+    PairBufferRelease releaseBuffers{contentCache, file1, file2};
+    // Reports for the baseline side are named after the header, not its snapshot file.
+    const std::string reportFile1 = options.snapshotBaseline
+        ? file1.substr(0, file1.size() - std::strlen(armor::APISnapshot::EXTENSION)) : file1;
+    armor::user_print() << "Processing files: " << file1 << " " << file2 << "\n";
+    outputs.progress.headerStarted(pair.header);
+
+    bool processed = false;
+    if ( !fileExists(file1) && !fileExists(file2) ){
+        armor::user_error() << "Missing old and new versions of header : \n" << file1 << "\n" << file2 << "\n";
+        std::filesystem::create_directories("armor_reports/html_reports");
+        std::filesystem::create_directories("armor_reports/json_reports");
+    }
+    else if (!fileExists(file1)) {
+        armor::user_error() << "Missing header in older version: " << file1 << "\n";
+        HeaderReportSummary summary = reportMissingHeader(report_name_for_header(file2, options.projectRoot2), true);
+        outputs.addHeader(file2, options.projectRoot2, summary);
+    }
+    else if (!fileExists(file2)) {
+        armor::user_error() << "Missing header in newer version: " << file2 << "\n";
+        HeaderReportSummary summary = reportMissingHeader(report_name_for_header(reportFile1, options.projectRoot1), false);
+        outputs.addHeader(reportFile1, options.projectRoot1, summary);
+    }
+    else if (options.snapshotBaseline) {
+        HeaderReportSummary summary = compareWithSnapshot(file1, file2, options);
+        processed = true;
+        outputs.progress.headerFinished(pair.header);
+        outputs.addHeader(file2, options.projectRoot2, summary);
+    }
+    else if (pair.dependenciesChanged || contentCache.filesDiffer(file1, file2)) {
+        HeaderReportSummary summary;
+        // The token-level fast path only sees the header's own text.
+        if (pair.dependenciesChanged || !classifyWithoutParsing(contentCache, options.projectRoot1, file1, file2, options.reportFormat,
+                                    options.lang, options.dumpAstDiff, summary)) {
+            PARSING_STATUS parsingStatus = armor::alpha::processHeaderPairAlpha(
+                options.projectRoot1, file1, options.projectRoot2, file2, options.reportFormat,
+                options.includePaths, options.macros, options.lang, options.dumpAstDiff, &summary);
+            if (armor::HeaderBudget::exceeded()) {
+                summary = reportTokenLevelFallback(file1, options.projectRoot1, options.reportFormat,
+                                                   !pair.dependenciesChanged);
+            }
+            else switch (parsingStatus) {
+                case NO_FATAL_ERRORS:
+                    armor::info() << "Processing Headers again via beta parser\n";
+                    armor::beta::processHeaderPairBeta(
+                        options.projectRoot1, file1, options.projectRoot2, file2, options.reportFormat,
+                        options.includePaths, options.macros, options.lang, options.dumpAstDiff, &summary);
+                    if (armor::HeaderBudget::exceeded())
+                        markAlphaOnly(file1, options.projectRoot1, options.reportFormat, summary);
+                    break;
+                case FATAL_ERRORS:
+                    armor::info() << "Processing Headers stopped at alpha parser\n";
+                    break;
             }
         }
+        processed = true;
+        outputs.progress.headerFinished(pair.header);
+        if (options.gitDiff)
+            printHeaderSummary(pair.header, summary);
+        outputs.addHeader(file1, options.projectRoot1, summary);
+    }
+    else {
+        armor::user_print() << "No differences found between: " << file1 << " and " << file2 << "\n";
+        processed = true;
+    }
+    outputs.progress.headerFinished(pair.header);
+    return processed;
+}
+
+// --affected-only: keeps the pairs whose header, or any project file it
+// includes, changed. changedFiles are project-relative paths from git; without
+// them, every file of the include graph is compared between the two roots.
+void selectAffectedPairs(std::vector<armor::HeaderPair>& pairs, const std::string& projectRoot1,
+                         const std::string& projectRoot2, const std::vector<std::string>& includePaths,
+                         const std::vector<std::string>* changedFiles) {
+    armor::IncludeGraph graph(includePaths);
+    graph.loadCache(armor::IncludeGraph::CACHE_PATH);
+    std::vector<std::string> relativeHeaders;
+    for (const armor::HeaderPair& pair : pairs) {
+        relativeHeaders.push_back(std::filesystem::path(pair.file2).lexically_relative(projectRoot2).generic_string());
+        graph.addHeader(projectRoot1, relativeHeaders.back());
+        graph.addHeader(projectRoot2, relativeHeaders.back());
+    }
+    graph.build();
+    graph.saveCache(armor::IncludeGraph::CACHE_PATH);
+
+    std::vector<std::string> changed;
+    if (changedFiles) {
+        changed = *changedFiles;
+    }
+    else {
+        armor::FileContentCache contentCache;
+        for (const std::string& file : graph.getFiles()) {
+            std::string file1 = projectRoot1 + "/" + file;
+            std::string file2 = projectRoot2 + "/" + file;
+            if (contentCache.filesDiffer(file1, file2)) changed.push_back(file);
+            contentCache.release(file1);
+            contentCache.release(file2);
+        }
+    }
+    std::vector<std::string> affectedList = graph.getAffectedHeaders(changed);
+    std::set<std::string> affected(affectedList.begin(), affectedList.end());
+    std::set<std::string> changedSet(changed.begin(), changed.end());
+
+    std::vector<armor::HeaderPair> selected;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (!affected.count(relativeHeaders[i])) continue;
+        pairs[i].dependenciesChanged = !changedSet.count(relativeHeaders[i]);
+        selected.push_back(std::move(pairs[i]));
     }
-    llvm::outs().flush();
+    armor::user_print() << "Include graph: " << selected.size() << " of " << pairs.size()
+                        << " header(s) affected by " << changed.size() << " changed file(s); "
+                        << graph.getFiles().size() << " file(s) in graph, "
+                        << graph.getScannedFileCount() << " scanned\n";
+    for (const armor::HeaderPair& pair : selected) {
+        armor::user_print() << "  " << pair.header << (pair.dependenciesChanged ? " (via includes)" : "") << "\n";
+    }
+    pairs = std::move(selected);
 }
 
 bool runArmorTool(int argc, const char **argv) {
+    // Trees are not modified while armor runs, so directory listings stay valid until it returns.
+    armor::DirectoryIndex::Scope directoryIndex;
+    if (argc > 1 && std::string(argv[1]) == "merge-reports")
+        return runMergeReports(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "snapshot")
+        return runSnapshot(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "db")
+        return runDatabase(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "chain")
+        return runChain(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "multi")
+        return runMulti(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "configs")
+        return runConfigs(argc - 1, argv + 1);
+
     // Pre-scan for --dev-mode so we can conditionally define positional args.
     // Without this, CLI11 greedily assigns the first header as projectroot2.
     bool gitDiffMode = false;
@@ -108,16 +413,33 @@ bool runArmorTool(int argc, const char **argv) {
     std::string gitRef = "origin/main";
     std::string newRef = "";
     std::string detectedRepoRoot;
+    std::string outputSpec;
+    bool consolidatedReport = false;
+    std::string traceOut;
+    bool traceClang = false;
+    bool stats = false;
+    bool progress = false;
+    unsigned jobs = 1;
+    std::string shardOption;
+    std::string shardBy = "hash";
+    double headerTimeBudget = 0;
+    uint64_t headerMemoryBudget = 0;
+    bool affectedOnly = false;
+    std::string worktreePool;
+    bool recursive = false;
+    std::vector<std::string> includeGlobs;
+    std::vector<std::string> excludeGlobs;
     auto fmt = std::make_shared<CLI::Formatter>();
     fmt->column_width(40);
     app.formatter(fmt);
     // Positional arguments — both roots are omitted in git-diff mode (CWD is used automatically)
     if (!gitDiffMode) {
         app.add_option("projectroot1", projectRoot1,
-            "Path to the project root of the older (baseline) version."
+            "Path to the project root of the older (baseline) version,\n"
+            "or a .tar/.tar.gz/.tgz archive of it."
         )->required();
         app.add_option("projectroot2", projectRoot2,
-            "Path to the project root of the newer version.\n"
+            "Path to the project root of the newer version, or an archive of it.\n"
             "Required in standard mode. Omit this when using --dev-mode."
         )->required();
     }
@@ -138,6 +460,13 @@ bool runArmorTool(int argc, const char **argv) {
     );
     // Optional arguments
     app.add_option("--header-dir", headerSubDir, "Subdirectory under each project root containing headers");
+    app.add_flag("--recursive", recursive,
+        "Also find headers in subdirectories of --header-dir");
+    app.add_option("--include-glob", includeGlobs,
+        "Headers under --header-dir to compare (default: *.h and *.hpp). A pattern\n"
+        "with a '/' matches the path relative to --header-dir, others the file name");
+    app.add_option("--exclude-glob", excludeGlobs,
+        "Files under --header-dir to skip, matched like --include-glob");
     app.add_option("--report-format,-r", reportFormat, "Report format: html (default).\n"
                                                        "If json is provided, both html and json reports will be generated.")
         ->check(CLI::IsMember({"html", "json"}));
@@ -145,6 +474,60 @@ bool runArmorTool(int argc, const char **argv) {
                                           "Use 'c' for C headers, 'cpp' for C++ headers.")
         ->transform(CLI::IsMember({LANG_C, LANG_CPP}, CLI::ignore_case));
     app.add_flag("--dump-ast-diff", dumpAstDiff, "Dump AST diff JSON files for debugging");
+    app.add_option("--output", outputSpec,
+        "Stream results as NDJSON while headers are processed:\n"
+        "one line per API change and one summary line per header.\n"
+        "  --output ndjson          Write to " + std::string(armor::NdjsonWriter::DEFAULT_PATH) + "\n"
+        "  --output ndjson=PATH     Write to PATH\n"
+        "  --output ndjson=-        Write to stdout (console messages go to stderr)")
+        ->check([](const std::string& spec) {
+            std::string path;
+            return parseOutputSpec(spec, path) ? std::string() : "expected ndjson, ndjson=PATH or ndjson=-";
+        });
+    app.add_flag("--consolidated-report", consolidatedReport,
+        "Also write one paginated HTML report covering all headers to\n" +
+        std::string(armor::ConsolidatedReport::DEFAULT_PATH));
+    CLI::Option* traceOutOption = app.add_option("--trace-out", traceOut,
+        "Write a Chrome trace-event JSON of the run (parse, diff, report and\n"
+        "git phases per header), viewable in chrome://tracing or Perfetto");
+    app.add_flag("--trace-clang", traceClang,
+        "Merge Clang's own frontend time-trace into the --trace-out file")
+        ->needs(traceOutOption);
+    app.add_flag("--stats", stats,
+        "Print per-header counters and stage times, and the peak RSS of the\n"
+        "process, at the end of the run and write them to " + std::string(armor::RunStats::DEFAULT_PATH));
+    app.add_flag("--progress", progress,
+        "Report headers done, throughput and ETA on stderr: one updating line\n"
+        "on a terminal, otherwise a JSON progress record every " + std::to_string(armor::ProgressReporter::RECORD_INTERVAL.count()) + "s");
+    app.add_option("-j,--jobs", jobs,
+        "Compare up to N headers in parallel (default 1). Headers are started\n"
+        "longest-first, using times from a previous --stats run when available")
+        ->check(CLI::Range(1u, 256u));
+    app.add_option("--header-time-budget", headerTimeBudget,
+        "Wall-time limit per header in seconds. A header over budget stops its\n"
+        "beta pass and keeps the alpha result, or, during the alpha pass, is\n"
+        "reported from a token-level comparison")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--header-memory-budget", headerMemoryBudget,
+        "Resident memory limit while a header is processed, e.g. 512M or 2G;\n"
+        "exceeding it degrades the header like --header-time-budget")
+        ->transform(CLI::AsSizeValue(false));
+    CLI::Option* shardOptionPtr = app.add_option("--shard", shardOption,
+        "Process only shard i of N (1-based) of the header list, for splitting a run\n"
+        "across machines; combine the outputs with 'armor merge-reports'")
+        ->check([](const std::string& spec) {
+            return armor::ShardSpec::parse(spec) ? std::string() : "expected i/N with 1 <= i <= N";
+        });
+    app.add_option("--shard-by", shardBy,
+        "Sharding plan: hash of the header name (default), or cost to balance by\n"
+        "size and " + std::string(armor::RunStats::DEFAULT_PATH) + " times; cost needs the same\n"
+        "inputs and stats file on every shard")
+        ->check(CLI::IsMember({"hash", "cost"}))
+        ->needs(shardOptionPtr);
+    app.add_flag("--affected-only", affectedOnly,
+        "Compare only the headers that changed or include, directly or not, a\n"
+        "changed project file. Uses an include graph cached in\n"
+        + std::string(armor::IncludeGraph::CACHE_PATH));
     app.set_version_flag("--version,-v", TOOL_VERSION);
     app.add_option("--log-level", debugLevel, "Set debug log level: ERROR, LOG, INFO (default), DEBUG")
         ->check(CLI::IsMember({"ERROR", "LOG", "INFO", "DEBUG"}));
@@ -178,6 +561,10 @@ bool runArmorTool(int argc, const char **argv) {
         "  --dev-mode --new-ref=HEAD --git-ref=origin/main  (HEAD vs origin/main)\n"
         "  --dev-mode --new-ref=HEAD --git-ref=HEAD~3        (last 3 commits)")
         ->default_val("");
+    app.add_option("--worktree-pool", worktreePool,
+        "Keep --dev-mode worktrees in DIR and reuse them across runs instead of\n"
+        "checking out afresh; each run locks the worktrees it uses. Defaults to\n"
+        "$ARMOR_WORKTREE_POOL, which also applies to chain, multi and configs");
     app.footer(
         "Examples:\n"
         "\n"
@@ -195,14 +582,24 @@ bool runArmorTool(int argc, const char **argv) {
         "    armor --header-dir include/api --dev-mode --new-ref=HEAD\n"
     );
     CLI11_PARSE(app, argc, argv);
-    std::istringstream iss(macroFlags);
-    std::string flag;
-    while (iss >> flag) {
-        macros.push_back(flag);
+    RunOutputs outputs;
+    outputs.consolidated = consolidatedReport;
+    std::string ndjsonPath;
+    if (parseOutputSpec(outputSpec, ndjsonPath)) {
+        if (!outputs.ndjson.open(ndjsonPath)) return false;
+        DebugConfig::getInstance().setConsoleInfoToStderr(outputs.ndjson.writesToStdout());
     }
+    TraceOutputGuard traceOutput{traceOut};
+    if (!traceOut.empty()) armor::Tracer::getInstance().enable(traceClang);
+    if (stats) armor::RunStats::getInstance().enable();
+    if (progress) outputs.progress.enable(armor::ProgressReporter::detectMode());
+
+    macros = splitMacroFlags(macroFlags);
 
     GitWorktreeGuard worktreeGuard;
     GitWorktreeGuard newRefWorktreeGuard;
+    // Project root's path within the repository, in git mode.
+    std::filesystem::path gitSubDir;
     if (gitDiff) {
         if (projectRoot1.empty())
             projectRoot1 = std::filesystem::current_path().string();
@@ -238,36 +635,47 @@ bool runArmorTool(int argc, const char **argv) {
             }
         }
 
-        std::string worktreePath = createGitWorktree(repoRoot, gitRef);
-        if (worktreePath.empty()) {
-            armor::user_error() << "Failed to create git worktree for ref '" << gitRef << "'.\n";
+        // In two-ref mode both worktrees are prepared at once.
+        std::string poolDir = getWorktreePoolDir(worktreePool);
+        bool newRefReady = true;
+        std::thread newRefCheckout;
+        if (!newRef.empty()) {
+            newRefCheckout = std::thread([&] {
+                newRefReady = prepareGitWorktree(newRefWorktreeGuard, repoRoot, newRef, poolDir);
+            });
+        }
+        bool refReady = prepareGitWorktree(worktreeGuard, repoRoot, gitRef, poolDir);
+        if (newRefCheckout.joinable()) newRefCheckout.join();
+        if (!refReady) {
+            armor::user_error() << "Failed to create git worktree for ref '" << gitRef << "'"
+                                << (worktreeGuard.error.empty() ? "" : ": " + worktreeGuard.error) << ".\n";
             return false;
         }
-        worktreeGuard.repoRoot = repoRoot;
-        worktreeGuard.worktreePath = worktreePath;
-        worktreeGuard.active = true;
+        if (!newRefReady) {
+            armor::user_error() << "Failed to create git worktree for new ref '" << newRef << "'"
+                                << (newRefWorktreeGuard.error.empty() ? "" : ": " + newRefWorktreeGuard.error)
+                                << ".\n";
+            return false;
+        }
+        const std::string& worktreePath = worktreeGuard.worktreePath;
 
         // The worktree is a full repo checkout. If CWD is a subdirectory of the
         // repo, navigate to the same subdirectory inside the worktree.
         std::filesystem::path relPath = std::filesystem::canonical(projectRoot1)
                                             .lexically_relative(
                                                 std::filesystem::canonical(repoRoot));
+        gitSubDir = relPath;
         projectRoot2 = projectRoot1;
         projectRoot1 = (std::filesystem::path(worktreePath) / relPath).string();
 
         if (!newRef.empty()) {
             // Two-ref mode: replace working tree with second git worktree
-            std::string newWorktreePath = createGitWorktree(repoRoot, newRef);
-            if (newWorktreePath.empty()) {
-                armor::user_error() << "Failed to create git worktree for new ref '" << newRef << "'.\n";
-                return false;
-            }
-            newRefWorktreeGuard.repoRoot = repoRoot;
-            newRefWorktreeGuard.worktreePath = newWorktreePath;
-            newRefWorktreeGuard.active = true;
-            projectRoot2 = (std::filesystem::path(newWorktreePath) / relPath).string();
+            projectRoot2 = (std::filesystem::path(newRefWorktreeGuard.worktreePath) / relPath).string();
         }
     }
+    else if (!mountArchiveRoot(projectRoot1) || !mountArchiveRoot(projectRoot2)) {
+        return false;
+    }
 
     // Set level and announce (now goes to the file)
     
@@ -300,7 +708,24 @@ bool runArmorTool(int argc, const char **argv) {
 
     bool processed = false;
 
-    // In git mode: force JSON so printHeaderSummary can read it,
+    // A directory written by `armor snapshot` stands in for the older source tree.
+    bool snapshotBaseline = !gitDiff && std::filesystem::exists(projectRoot1 + "/" + armor::APISnapshot::MANIFEST);
+    const std::string snapshotSuffix = snapshotBaseline ? armor::APISnapshot::EXTENSION : "";
+    if (snapshotBaseline) {
+        if (!checkSnapshotFlags(projectRoot1, langOption, IncludePaths, macros)) return false;
+        armor::user_print() << "Comparing against API snapshot: " << projectRoot1 << "\n";
+    }
+
+    if (affectedOnly && headers.empty() && headerSubDir.empty()) {
+        armor::user_error() << "--affected-only selects among the public headers: pass them or --header-dir.\n";
+        return false;
+    }
+    if (affectedOnly && snapshotBaseline) {
+        armor::user_error() << "--affected-only needs two source trees, not a snapshot.\n";
+        return false;
+    }
+
+    // In git mode: force JSON reports for CI consumers,
     // then auto-detect changed headers if none were specified.
     if (gitDiff) {
         reportFormat = "json";
@@ -319,198 +744,123 @@ bool runArmorTool(int argc, const char **argv) {
                 armor::user_print() << "  " << h << "\n";
         }
     }
-    std::vector<std::string> headersToCompare;
+    std::vector<armor::HeaderPair> pairs;
     if (!headers.empty()) {
         for (const auto &header : headers) {
-            std::string file1, file2;
-            if (!headerSubDir.empty()) {
-                file1 = projectRoot1 + "/" + headerSubDir + "/" + header;
-                file2 = projectRoot2 + "/" + headerSubDir + "/" + header;
-            } 
-            else {
-                file1 = projectRoot1 + "/" + header;
-                file2 = projectRoot2 + "/" + header;
-            }
-            armor::user_print() << "Processing files: " << file1 << " " << file2 << "\n";
-            if ( !std::filesystem::exists(file1) && !std::filesystem::exists(file2) ){
-                armor::user_error() << "Missing old and new versions of header : \n" << file1 << "\n" << file2 << "\n";
-                std::filesystem::create_directories("armor_reports/html_reports");
-                std::filesystem::create_directories("armor_reports/json_reports");
-            }
-            else if (!std::filesystem::exists(file1)) {
-                armor::user_error() << "Missing header in older version: " << file1 << "\n";
-                std::string headerName = std::filesystem::path(file2).filename().string();
-                const auto& [jsonReportFile, htmlReportFile] = prepare_report_output_dirs(headerName);
-                generate_json_report(
-                        {},
-                          jsonReportFile,
-                          static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
-                          static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
-                          "backward_compatible",
-                          "BACKWARD_COMPATIBLE",
-                          "Missing header in older version"
-                          );
-                generate_html_report(
-                    {},
-                          htmlReportFile,
-                          NO_PARSER,
-                          static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
-                          static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
-                          "backward_compatible",
-                          "BACKWARD_COMPATIBLE",
-                          "Missing header in older version",
-                          {false, true}
-                        );
-            } 
-            else if (!std::filesystem::exists(file2)) {
-                armor::user_error() << "Missing header in newer version: " << file2 << "\n";
-                std::string headerName = std::filesystem::path(file1).filename().string();
-                const auto& [jsonReportFile, htmlReportFile] = prepare_report_output_dirs(headerName);
-                generate_json_report(
-                        {},
-                          jsonReportFile,
-                          static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
-                          static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
-                          "backward_incompatible",
-                          "BACKWARD_INCOMPATIBLE",
-                          "Missing header in newer version"
-                          );
-                generate_html_report(
-                    {},
-                          htmlReportFile,
-                          NO_PARSER,
-                          static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
-                          static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
-                          "backward_incompatible",
-                          "BACKWARD_INCOMPATIBLE",
-                          "Missing header in newer version",
-                          {true, false}
-                        );
-            }
-            else{
-                if (filesAreDifferentUsingDiff(file1, file2)) {
-                    PARSING_STATUS parsingStatus = armor::alpha::processHeaderPairAlpha(projectRoot1, file1, projectRoot2, file2, reportFormat,
-                                    IncludePaths, macros, langOption);
-                    switch (parsingStatus) {
-                        case NO_FATAL_ERRORS:
-                            armor::info() << "Processing Headers again via beta parser\n";
-                            armor::beta::processHeaderPairBeta(projectRoot1, file1, projectRoot2, file2, reportFormat,
-                                        IncludePaths, macros, langOption);
-                            break;
-                        case FATAL_ERRORS:
-                            armor::info() << "Processing Headers stopped at alpha parser\n";
-                            break;
-                    }
-                    processed = true;
-                    if (gitDiff)
-                        printHeaderSummary(header);
-                } 
-                else {
-                    armor::user_print() << "No differences found between: " << file1 << " and " << file2 << "\n";
-                    return true;
-                }
+            if (!headerSubDir.empty())
+                pairs.push_back({header, projectRoot1 + "/" + headerSubDir + "/" + header + snapshotSuffix,
+                                 projectRoot2 + "/" + headerSubDir + "/" + header});
+            else
+                pairs.push_back({header, projectRoot1 + "/" + header + snapshotSuffix, projectRoot2 + "/" + header});
+        }
+    }
+    else if (!headerSubDir.empty() && !snapshotBaseline) {
+        std::string dir1 = projectRoot1 + "/" + headerSubDir;
+        std::string dir2 = projectRoot2 + "/" + headerSubDir;
+        std::string error;
+        std::optional<armor::HeaderFilter> filter = armor::HeaderFilter::create(includeGlobs, excludeGlobs, error);
+        if (!filter) {
+            armor::user_error() << error << "\n";
+            return false;
+        }
+        armor::user_print() << "List of headers to process:\n";
+        for (const armor::DiscoveredHeader& found : armor::discoverHeaders(dir1, dir2, *filter, recursive, jobs)) {
+            // Unchanged headers drop out here, unless an included file may have changed.
+            if (found.identical && !affectedOnly) {
+                armor::user_print() << "No differences found between: " << dir1 << "/" << found.oldPath << " and "
+                                    << dir2 << "/" << found.newPath << "\n";
+                processed = true;
+                continue;
             }
+            const std::string& header = found.newPath.empty() ? found.oldPath : found.newPath;
+            armor::user_print() << "  " << header;
+            if (found.isRenamed())
+                armor::user_print() << " (moved from " << found.oldPath << ", "
+                                    << static_cast<int>(found.similarity * 100) << "% similar)";
+            armor::user_print() << "\n";
+            // A header only one side has is looked up under its own path in the other.
+            pairs.push_back({header, dir1 + "/" + (found.oldPath.empty() ? header : found.oldPath),
+                             dir2 + "/" + header});
         }
     }
     else if (!headerSubDir.empty()) {
         std::string dir1 = projectRoot1 + "/" + headerSubDir;
         std::string dir2 = projectRoot2 + "/" + headerSubDir;
-        for (const auto &entry : std::filesystem::directory_iterator(dir1)) {
-            if (entry.path().extension() == ".h" || entry.path().extension() == ".hpp") {
-                headersToCompare.push_back(entry.path().filename().string());
-            }
+        std::string error;
+        std::optional<armor::HeaderFilter> filter = createSnapshotFilter(includeGlobs, excludeGlobs, error);
+        if (!filter) {
+            armor::user_error() << error << "\n";
+            return false;
         }
+        std::vector<std::string> headersToCompare;
+        for (const std::string& snapshot : armor::findHeaders(dir1, *filter, recursive))
+            headersToCompare.push_back(snapshot.substr(0, snapshot.size() - std::strlen(armor::APISnapshot::EXTENSION)));
         armor::user_print() << "List of headers to process:\n";
         for (const auto &h : headersToCompare) {
             armor::user_print() << "  " << h << "\n";
+            pairs.push_back({h, dir1 + "/" + h + snapshotSuffix, dir2 + "/" + h});
         }
-        for (const auto &header : headersToCompare) {
-            std::string file1 = dir1 + "/" + header;
-            std::string file2 = dir2 + "/" + header;
-            armor::user_print() << "Processing files: " << file1 << " " << file2 << "\n";
-            if ( !std::filesystem::exists(file1) && !std::filesystem::exists(file2) ){
-                armor::user_error() << "Missing old and new versions of header : \n" << file1 << "\n" << file2 << "\n";
+    }
+
+    if (affectedOnly) {
+        if (gitDiff) {
+            std::vector<std::string> changedFiles;
+            for (const std::string& file : getChangedFiles(detectedRepoRoot, gitRef, newRef)) {
+                std::string relative = std::filesystem::path(file).lexically_relative(gitSubDir).generic_string();
+                if (!llvm::StringRef(relative).startswith("..")) changedFiles.push_back(relative);
             }
-            else if (!std::filesystem::exists(file1)) {
-                armor::user_error() << "Missing header in older version: " << file1 << "\n";
-                std::string headerName = std::filesystem::path(file2).filename().string();
-                const auto& [jsonReportFile, htmlReportFile] = prepare_report_output_dirs(headerName);
-                generate_json_report(
-                        {},
-                          jsonReportFile,
-                          static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
-                          static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
-                          "backward_compatible",
-                          "BACKWARD_COMPATIBLE",
-                          "Missing header in older version"
-                          );
-                generate_html_report(
-                    {},
-                          htmlReportFile,
-                          NO_PARSER,
-                          static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
-                          static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
-                          "backward_compatible",
-                          "BACKWARD_COMPATIBLE",
-                          "Missing header in older version",
-                          {false, true}
-                        );
-            } else if (!std::filesystem::exists(file2)) {
-                armor::user_error() << "Missing header in newer version: " << file2 << "\n";
-                std::string headerName = std::filesystem::path(file1).filename().string();
-                const auto& [jsonReportFile, htmlReportFile] = prepare_report_output_dirs(headerName);
-                generate_json_report(
-                        {},
-                          jsonReportFile,
-                          static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
-                          static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
-                          "backward_incompatible",
-                          "BACKWARD_INCOMPATIBLE",
-                          "Missing header in newer version"
-                          );
-                generate_html_report(
-                    {},
-                          htmlReportFile,
-                          NO_PARSER,
-                          static_cast<int>(ParsedDiffStatus::SUPPORTED_UPDATES),
-                          static_cast<int>(UnParsedDiffStatus::UN_CHANGED),
-                          "backward_incompatible",
-                          "BACKWARD_INCOMPATIBLE",
-                          "Missing header in newer version",
-                          {true, false}
-                        );
-            } 
-            else{
-                if (filesAreDifferentUsingDiff(file1, file2)) {
-                    PARSING_STATUS parsingStatus = armor::alpha::processHeaderPairAlpha(projectRoot1, file1, projectRoot2, file2, reportFormat,
-                                    IncludePaths, macros, langOption);
-                    switch (parsingStatus) {
-                        case NO_FATAL_ERRORS:
-                            armor::info() << "Processing Headers again via v2\n";
-                            armor::beta::processHeaderPairBeta(projectRoot1, file1, projectRoot2, file2, reportFormat,
-                                        IncludePaths, macros, langOption);
-                            break;
-                        case FATAL_ERRORS:
-                            armor::info() << "Processing Headers stopped at v1\n";
-                            break;
-                    }
+            selectAffectedPairs(pairs, projectRoot1, projectRoot2, IncludePaths, &changedFiles);
+        }
+        else {
+            selectAffectedPairs(pairs, projectRoot1, projectRoot2, IncludePaths, nullptr);
+        }
+        // Nothing affected is a successful run.
+        if (pairs.empty()) processed = true;
+    }
+
+    if (std::optional<armor::ShardSpec> shard = armor::ShardSpec::parse(shardOption)) {
+        shard->strategy = shardBy == "cost" ? armor::ShardSpec::Strategy::Cost : armor::ShardSpec::Strategy::Hash;
+        std::vector<double> costs;
+        if (shard->strategy == armor::ShardSpec::Strategy::Cost) {
+            armor::HeaderCostModel costModel;
+            costModel.loadHistory(armor::RunStats::DEFAULT_PATH);
+            costs = costModel.estimate(pairs);
+        }
+        std::vector<armor::HeaderPair> shardPairs;
+        for (size_t index : armor::selectShard(pairs, costs, *shard))
+            shardPairs.push_back(std::move(pairs[index]));
+        armor::user_print() << "Shard " << shard->toString() << ": " << shardPairs.size() << " of "
+                            << pairs.size() << " header(s)\n";
+        pairs = std::move(shardPairs);
+        outputs.sharded = true;
+        outputs.shardSummary.setShard(shard->toString());
+        // A shard that drew no headers still has to report success.
+        if (pairs.empty()) processed = true;
+    }
+
+    PairOptions pairOptions{projectRoot1, projectRoot2, reportFormat, IncludePaths, macros,
+                            langOption, dumpAstDiff, gitDiff,
+                            {std::chrono::milliseconds(static_cast<int64_t>(headerTimeBudget * 1000)), headerMemoryBudget},
+                            snapshotBaseline};
+    if (!pairs.empty()) {
+        outputs.progress.start(pairs.size());
+        if (jobs <= 1) {
+            armor::FileContentCache contentCache;
+            for (const auto &pair : pairs) {
+                if (processHeaderPair(pair, pairOptions, contentCache, outputs))
                     processed = true;
-                    if (gitDiff)
-                        printHeaderSummary(header);
-                } 
-                else {
-                    llvm::outs()<<"No diff beta\n";
-                    armor::user_print() << "No differences found between: " << file1 << " and " << file2 << "\n";
-                    return true;
-                }
             }
         }
-    }
-    if (processed && !dumpAstDiff) {
-        try {
-            std::filesystem::remove_all("debug_output/ast_diffs");
-        } catch (const std::exception &e) {
-            armor::user_error() << "Failed to remove debug_output directory: " << e.what() << "\n";
+        else {
+            armor::HeaderCostModel costModel;
+            costModel.loadHistory(armor::RunStats::DEFAULT_PATH);
+            std::atomic<bool> anyProcessed{false};
+            armor::runLongestFirst(costModel.estimate(pairs), jobs, [&](size_t index) {
+                armor::FileContentCache contentCache;
+                if (processHeaderPair(pairs[index], pairOptions, contentCache, outputs))
+                    anyProcessed = true;
+            });
+            if (anyProcessed) processed = true;
         }
     }
     if (!processed && headers.empty() && headerSubDir.empty()) {
@@ -519,5 +869,6 @@ bool runArmorTool(int argc, const char **argv) {
             << "Or use --header-dir to compare all headers in a subdirectory.\n"
             << "Try '" << argv0 << " --help' for more information.\n";
     }
+    outputs.finish();
     return processed;
 }
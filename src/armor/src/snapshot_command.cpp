@@ -0,0 +1,104 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "subcommands.hpp"
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include "CLI/CLI.hpp"
+#include "command_utils.hpp"
+#include "api_snapshot.hpp"
+#include "beta/include/header_processor.hpp"
+
+bool runSnapshot(int argc, const char **argv) {
+    CLI::App app{"Write the normalized API of headers to binary snapshots that can be passed\n"
+                 "in place of projectroot1 in later comparisons.\n"};
+    app.name("armor snapshot");
+    std::string projectRoot;
+    std::vector<std::string> headers;
+    std::string headerSubDir;
+    std::string outDir = "armor_snapshot";
+    std::string language = LANG_CPP;
+    std::vector<std::string> IncludePaths;
+    std::string macroFlags;
+    app.add_option("projectroot", projectRoot, "Path to the project root, or a .tar/.tar.gz of it, to snapshot")
+        ->required()
+        ->check(CLI::ExistingPath);
+    app.add_option("headers", headers,
+        "Headers to snapshot, relative to the project root or to --header-dir");
+    app.add_option("--header-dir", headerSubDir, "Subdirectory under the project root containing headers");
+    bool recursive = false;
+    std::vector<std::string> includeGlobs;
+    std::vector<std::string> excludeGlobs;
+    app.add_flag("--recursive", recursive, "Also snapshot headers in subdirectories of --header-dir");
+    app.add_option("--include-glob", includeGlobs,
+        "Headers under --header-dir to snapshot (default: *.h and *.hpp), as for comparisons");
+    app.add_option("--exclude-glob", excludeGlobs, "Files under --header-dir to skip, matched like --include-glob");
+    app.add_option("--output-dir,-o", outDir, "Directory for the snapshot (default: armor_snapshot)");
+    app.add_option("--lang,-l", language, "Language mode: cpp (default) or c.")
+        ->transform(CLI::IsMember({LANG_C, LANG_CPP}, CLI::ignore_case));
+    app.add_option("-I,--include-paths", IncludePaths,
+        "Include paths for header dependencies, relative to the project root");
+    app.add_option("-m,--macro-flags", macroFlags, "Macro flags to be passed for headers.\n");
+    CLI11_PARSE(app, argc, argv);
+
+    std::vector<std::string> macros = splitMacroFlags(macroFlags);
+
+    if (!mountArchiveRoot(projectRoot)) return false;
+    std::string headerRoot = headerSubDir.empty() ? projectRoot : projectRoot + "/" + headerSubDir;
+    if (headers.empty() && !headerSubDir.empty()) {
+        // The headers a comparison with the same options would find; snapshots keep their relative paths.
+        std::string error;
+        std::optional<armor::HeaderFilter> filter = armor::HeaderFilter::create(includeGlobs, excludeGlobs, error);
+        if (!filter) {
+            armor::user_error() << error << "\n";
+            return false;
+        }
+        headers = armor::findHeaders(headerRoot, *filter, recursive);
+    }
+    if (headers.empty()) {
+        armor::user_error() << "No headers to snapshot. Pass headers or --header-dir.\n";
+        return false;
+    }
+
+    LANG_OPTIONS langOption = stringToLangOption(language);
+    std::string snapshotRoot = headerSubDir.empty() ? outDir : outDir + "/" + headerSubDir;
+    nlohmann::json written = nlohmann::json::array();
+    bool ok = true;
+    for (const auto& header : headers) {
+        std::string file = headerRoot + "/" + header;
+        std::string snapshotFile = snapshotRoot + "/" + header + armor::APISnapshot::EXTENSION;
+        if (!fileExists(file)) {
+            armor::user_error() << "Missing header: " << file << "\n";
+            ok = false;
+            continue;
+        }
+        std::string name = std::filesystem::relative(file, projectRoot).string();
+        if (!armor::beta::writeHeaderSnapshotBeta(projectRoot, file, name, IncludePaths, macros, langOption,
+                                                  snapshotFile)) {
+            armor::user_error() << "Failed to write snapshot: " << snapshotFile << "\n";
+            ok = false;
+            continue;
+        }
+        armor::user_print() << "Snapshot written: " << snapshotFile << "\n";
+        written.push_back(name);
+    }
+
+    // The manifest marks outDir as a baseline and records how it was parsed.
+    nlohmann::json manifest;
+    manifest["version"] = armor::APISnapshot::VERSION;
+    manifest["lang"] = language;
+    manifest["header_dir"] = headerSubDir;
+    manifest["include_paths"] = IncludePaths;
+    manifest["macro_flags"] = macroFlags;
+    manifest["headers"] = written;
+    std::filesystem::create_directories(outDir);
+    std::ofstream out(outDir + "/" + armor::APISnapshot::MANIFEST, std::ios::trunc);
+    out << manifest.dump(2) << "\n";
+    if (!out) {
+        armor::user_error() << "Failed to write snapshot manifest in " << outDir << "\n";
+        return false;
+    }
+    return ok;
+}
@@ -29,6 +29,7 @@ class ASTNormalize : public clang::RecursiveASTVisitor<ASTNormalize> {
 
         ASTNormalize(armor::APISession* session, armor::ASTNormalizedContext* context, clang::ASTContext* clangContext);
 
+        bool TraverseDecl(clang::Decl *Decl);
         bool TraverseNamespaceDecl(clang::NamespaceDecl *Decl);
         bool TraverseRecordDecl(clang::RecordDecl *Decl);
         bool TraverseCXXRecordDecl(clang::CXXRecordDecl *Decl);
@@ -58,6 +59,7 @@ class ASTNormalize : public clang::RecursiveASTVisitor<ASTNormalize> {
         bool TraverseNonTypeTemplateParmDecl(clang::NonTypeTemplateParmDecl *Decl);
         bool TraverseTemplateTemplateParmDecl(clang::TemplateTemplateParmDecl *Decl);
 
+        bool VisitDecl(clang::Decl *Decl);
         bool VisitNamespaceDecl(clang::NamespaceDecl *Decl);
         bool VisitRecordDecl(clang::RecordDecl *Decl);
         bool VisitCXXRecordDecl(clang::CXXRecordDecl *Decl);
@@ -88,6 +90,7 @@ class ASTNormalizeConsumer : public clang::ASTConsumer {
         armor::ASTNormalizedContext* context;
         ASTNormalize *visitor;
         ASTNormalizeConsumer(armor::APISession* session, armor::ASTNormalizedContext* context);
+        bool HandleTopLevelDecl(clang::DeclGroupRef DeclGroup) override;
         void HandleTranslationUnit(clang::ASTContext &Context) override;
 };
 
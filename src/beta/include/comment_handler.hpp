@@ -15,8 +15,6 @@
 
 namespace armor { namespace beta {
 
-void filterCommentsInInactiveRegions(armor::ASTNormalizedContext* context, clang::SourceManager* SM);
-
 class CommentHandler : public clang::CommentHandler {
 
     public:
@@ -27,13 +25,11 @@ class CommentHandler : public clang::CommentHandler {
         uint64_t generateHashFromSourceRange(clang::SourceRange Range);
         uint64_t generateHashFromOffsets(unsigned startOffset, unsigned endOffset);
 
+        // Builds the comments hash map; the region index must be classified first.
         void finalize();
 
     private:
 
-        llvm::SmallVector<armor::Range, 32> comments;
-        llvm::DenseMap<uint64_t, int> commentsHashMap;
-
         clang::SourceManager* SM;
         armor::ASTNormalizedContext* context;
 };
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include "session.hpp"
+#include "report_generator.hpp"
 
 namespace armor { namespace beta {
 
@@ -15,6 +16,73 @@ PARSING_STATUS processHeaderPairBeta(const std::string& projectRoot1,
                        const std::string& reportFormat,
                        const std::vector<std::string>& IncludePaths,
                        const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang,
+                       bool dumpAstDiff,
+                       HeaderReportSummary* summary = nullptr);
+
+/**
+ * Parse file of project and write its normalized context to snapshotFile,
+ * recorded under the name header. Fails when the header does not parse
+ * without fatal errors.
+ */
+bool writeHeaderSnapshotBeta(const std::string& projectRoot,
+                       const std::string& file,
+                       const std::string& header,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang,
+                       const std::string& snapshotFile);
+
+/**
+ * Compare file2 against a baseline loaded from snapshotFile instead of
+ * parsing an older source tree. Reports are named after file2.
+ */
+PARSING_STATUS processHeaderAgainstSnapshotBeta(const std::string& snapshotFile,
+                       const std::string& projectRoot2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang,
+                       bool dumpAstDiff,
+                       HeaderReportSummary* summary = nullptr);
+
+/**
+ * Parse one version of a header with the beta parser into session, for
+ * comparisons that reuse the result (see compareHeaderVersionsBeta).
+ */
+PARSING_STATUS parseHeaderBeta(armor::APISession& session,
+                       const std::string& projectRoot,
+                       const std::string& file,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
                        const LANG_OPTIONS lang);
 
+/**
+ * Diff two versions parsed by parseHeaderBeta and report the result, named
+ * reportName or after file2. Both contexts are left as parsed, so either
+ * can take part in further comparisons.
+ */
+HeaderReportSummary compareHeaderVersionsBeta(const armor::APISession& session1,
+                       const std::string& file1,
+                       armor::APISession& session2,
+                       const std::string& projectRoot2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       bool dumpAstDiff,
+                       const std::string& reportName = "");
+
+/**
+ * As compareHeaderVersionsBeta, for contexts from any source, e.g. a
+ * snapshot. context2 is restored after the diff, so it can be compared
+ * against several baselines in turn (not concurrently).
+ */
+HeaderReportSummary compareHeaderContextsBeta(armor::ASTNormalizedContext& context1,
+                       armor::ASTNormalizedContext& context2,
+                       const std::string& projectRoot2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       bool dumpAstDiff,
+                       const std::string& reportName = "");
+
 } } // namespace armor::beta
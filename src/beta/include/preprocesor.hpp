@@ -68,13 +68,10 @@ class ASTNormalizerPreprocessor : public clang::PPCallbacks {
     armor::ASTNormalizedContext* context;
 
     // Temporary storage for preprocessing
-    llvm::SmallVector<armor::Range, 16> PPDirectives;
-    std::map<unsigned, armor::Range> inactivePPDirectives;
     llvm::DenseMap<uint64_t, int> inactiveUnhandledDeclsHash;
     
     uint64_t generateHashFromOffsets(unsigned startOffset, unsigned endOffset, bool isActive);
     void addRange(clang::SourceRange range, bool active=true);
-    void removeNestedRanges();
     void printRanges();
 };
 
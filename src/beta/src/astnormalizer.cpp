@@ -15,6 +15,9 @@
 #include "tree_builder.hpp"
 #include "comment_handler.hpp"
 #include "preprocesor.hpp"
+#include "header_budget.hpp"
+#include "run_stats.hpp"
+#include "trace.hpp"
 #include "clang/AST/APValue.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclTemplate.h"
@@ -36,10 +39,24 @@ beta::ASTNormalize::ASTNormalize(armor::APISession* session, armor::ASTNormalize
 beta::ASTNormalizeConsumer::ASTNormalizeConsumer(armor::APISession* session, armor::ASTNormalizedContext* context)
     : session(session), context(context) {}
 
+// Returning false stops the parser once the header ran over its budget.
+bool beta::ASTNormalizeConsumer::HandleTopLevelDecl(clang::DeclGroupRef) {
+    return !armor::HeaderBudget::exceeded();
+}
+
 void beta::ASTNormalizeConsumer::HandleTranslationUnit(clang::ASTContext &clangContext) {
     // Creates the visitor, passing along the pointers to the session and the pre-existing context.
     context->addClangASTContext(&clangContext);
+    if (armor::HeaderBudget::exceeded()) return;
+
+    // Lex the main file once; every decl, stmt and directive range hash is
+    // then served from this table instead of re-lexing its range.
+    {
+        armor::TraceScope span("token table", "beta");
+        context->getSourceTokenTable().build(clangContext.getSourceManager());
+    }
 
+    armor::TraceScope span("tree building", "beta");
     beta::ASTNormalize visitor(session, context, &clangContext);
     visitor.TraverseDecl(clangContext.getTranslationUnitDecl());
 }
@@ -90,6 +107,10 @@ createNormalizeActionFactory(armor::APISession* session, const std::string& file
 }
 
 void beta::NormalizeAction::EndSourceFileAction() {
+    armor::TraceScope span("range hashing", "beta");
+
+    // Sort comments, directives and inactive blocks once; both finalizers below read the result
+    context->getSourceRangeTracker().getRegionIndex().classify();
 
     // Finalize preprocessor callbacks (must be done before Preprocessor is destroyed)
     if (preprocessor) {
@@ -105,14 +126,18 @@ void beta::NormalizeAction::EndSourceFileAction() {
         delete commentHandler; // Now we can safely delete it
         commentHandler = nullptr;
     }
-    
-    filterCommentsInInactiveRegions(context, &context->getClangASTContext()->getSourceManager());
-    
+
     // Call parent implementation
     clang::ASTFrontendAction::EndSourceFileAction();
 }
 
 // === Visit and Traverse Methods ===
+bool beta::ASTNormalize::TraverseDecl(clang::Decl *Decl) {
+    // Abandon the whole traversal once the header ran over its budget.
+    if (armor::HeaderBudget::exceeded()) return false;
+    return clang::RecursiveASTVisitor<ASTNormalize>::TraverseDecl(Decl);
+}
+
 bool beta::ASTNormalize::TraverseNamespaceDecl(clang::NamespaceDecl *Decl) {
     if(treeBuilder.IsDeclFromMainFileAndNotLocal(Decl)){
         if(Decl->isAnonymousNamespace()){
@@ -297,6 +322,13 @@ bool beta::ASTNormalize::TraverseTemplateTemplateParmDecl(clang::TemplateTemplat
 //     return true;
 // }
 
+bool beta::ASTNormalize::VisitDecl(clang::Decl *Decl) {
+    if (!armor::RunStats::isEnabled()) return true;
+    armor::RunStats::count(armor::StatCounter::DeclsVisited);
+    if (treeBuilder.IsDeclFromMainFileAndNotLocal(Decl)) armor::RunStats::count(armor::StatCounter::DeclsKept);
+    return true;
+}
+
 bool beta::ASTNormalize::VisitNamespaceDecl(clang::NamespaceDecl *Decl) {
     if(!treeBuilder.IsDeclFromMainFileAndNotLocal(Decl)) return false;
     return true;
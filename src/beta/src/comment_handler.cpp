@@ -7,7 +7,6 @@
 
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/StringRef.h"
-#include <cassert>
 #include <llvm-14/llvm/Support/raw_ostream.h>
 
 namespace armor { namespace beta {
@@ -63,64 +62,29 @@ bool CommentHandler::HandleComment(clang::Preprocessor& PP, clang::SourceRange C
     uint64_t hash = generateHashFromSourceRange(Comment);
     unsigned startOffset = SM->getFileOffset(Comment.getBegin());
     unsigned endOffset = SM->getFileOffset(Comment.getEnd());
-    comments.emplace_back(armor::Range(startOffset,endOffset,hash,true));
-    commentsHashMap[hash]++;
+    context->getSourceRangeTracker().getRegionIndex().addComment(startOffset, endOffset, hash);
 
     return false;
 }
 
 void CommentHandler::finalize(){
     armor::SourceRangeTracker& SRT = context->getSourceRangeTracker();
-    SRT.moveComments(comments);
-    SRT.moveCommentsHashMap(commentsHashMap);
-}
+    llvm::DenseMap<uint64_t, int>& commentsHashMap = SRT.getCommentsHashMap();
 
-void filterCommentsInInactiveRegions(armor::ASTNormalizedContext* context, clang::SourceManager* SM) {
-    
-    if (!context || !SM) return;
-    
-    auto& tracker = context->getSourceRangeTracker();
-    const llvm::SmallVector<armor::Range, 32>& comments = tracker.getComments();
-    const std::map<unsigned,armor::Range>& inactiveRegions = tracker.getInactivePPDirectives();
-    llvm::DenseMap<uint64_t, int>& commentsHashMap = tracker.getCommentsHashMap();
-    
-    if (inactiveRegions.empty()) return;
-    
-    llvm::SmallVector<uint64_t, 32> hashesToDecrement;
-    
     llvm::StringRef buffer = SM->getBufferData(SM->getMainFileID());
 
-    for (const auto& commentRange : comments) {
-        unsigned commentStartOffset = commentRange.startOffset;
-        unsigned commentEndOffset = commentRange.endOffset;
-        
-        llvm::StringRef sourceText = buffer.substr(commentStartOffset, commentEndOffset - commentStartOffset);
-        
-        auto it = inactiveRegions.lower_bound(commentStartOffset);
-        
-        if (it != inactiveRegions.begin()) it--;
-
-        const auto& [regionStartOffset, regionRange] = *it;
-        unsigned regionEndOffset = regionRange.endOffset;
-        
-        assert(regionRange.hash != -1);
-
-        if (commentStartOffset >= regionRange.startOffset && commentEndOffset <= regionRange.endOffset) {
-            hashesToDecrement.push_back(commentRange.hash);
-            TEST_LOG << "Flush : \n" << buffer.substr(commentStartOffset, commentEndOffset - commentStartOffset)
+    // Comments inside inactive blocks are already covered by the block's hash.
+    for (const armor::SourceRegion& region : SRT.getRegionIndex().getRegions()) {
+        if (region.isDirective()) continue;
+
+        if (region.inInactiveBlock) {
+            TEST_LOG << "Flush : \n" << buffer.substr(region.startOffset, region.endOffset - region.startOffset)
             << "\n-------------------------------------------\n";
+            continue;
         }
 
+        commentsHashMap[region.hash]++;
     }
-    
-    for (uint64_t hash : hashesToDecrement) {
-        auto it = commentsHashMap.find(hash);
-        if (it != commentsHashMap.end()) {
-            it->second--;
-            if (it->second <= 0) commentsHashMap.erase(it);
-        }
-    }
-    
 }
 
 } } // namespace armor::beta
\ No newline at end of file
@@ -15,6 +15,8 @@
 #include "logger.hpp"
 #include "node.hpp"
 #include "comm_def.hpp"
+#include "run_stats.hpp"
+#include "trace.hpp"
 
 using json = nlohmann::json;
 
@@ -123,7 +125,8 @@ json diffNodes(
     const std::shared_ptr<const armor::APINode>& a, 
     const std::shared_ptr<const armor::APINode>& b) // we are not using the map for now.
 {
-    
+    armor::RunStats::count(armor::StatCounter::DiffNodesCompared);
+
     // Any node can have children.
     assert(a->kind == b->kind);
 
@@ -287,7 +290,7 @@ json diffTrees(
     armor::ASTNormalizedContext* context1,
     armor::ASTNormalizedContext* context2
 ) {
-    
+    armor::TraceScope span("beta diff", "diff");
     json astDiff = json::array();
     llvm::StringMap<llvm::SmallVector<std::shared_ptr<armor::APINode>,16>> tree1 = context1->getTree();
     llvm::StringMap<llvm::SmallVector<std::shared_ptr<armor::APINode>,16>> tree2 = context2->getTree();
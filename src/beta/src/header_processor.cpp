@@ -10,10 +10,12 @@
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include "api_snapshot.hpp"
 #include "comm_def.hpp"
 #include "diffengine.hpp"
 #include "logger.hpp"
 #include "header_processor.hpp"
+#include "header_budget.hpp"
 #include "header_processor_utils.hpp"
 #include "session.hpp"
 #include "astnormalizer.hpp"
@@ -31,7 +33,9 @@ PARSING_STATUS processHeaderPairBeta(const std::string& project1,
                        const std::string& reportFormat,
                        const std::vector<std::string>& IncludePaths,
                        const std::vector<std::string>& macroFlags,
-                       const LANG_OPTIONS lang) {
+                       const LANG_OPTIONS lang,
+                       bool dumpAstDiff,
+                       HeaderReportSummary* summary) {
 
     if (!DebugConfig::getInstance().initialize()) {
         armor::user_error() << "Failed to open diagnostics log <" << LOG_FILE_PATH << ">, using stderr\n";
@@ -63,6 +67,12 @@ PARSING_STATUS processHeaderPairBeta(const std::string& project1,
     PARSING_STATUS header1ParsingStatus = session->processFileBeta(
         file1, std::move(compDB1), createNormalizeActionFactory(session.get(), file1));
 
+    // Over budget: leave the report to the caller's cheaper fallback.
+    if (armor::HeaderBudget::exceeded()) {
+        armor::info() << "Beta parser stopped: " << armor::HeaderBudget::describe() << " exceeded\n";
+        return FATAL_ERRORS;
+    }
+
     armor::info() << "Processing File2 : " << file2 << "\n";
     for (auto& x : Flags2) {
         armor::info() << "Clang search path : " << x << "\n";
@@ -71,6 +81,11 @@ PARSING_STATUS processHeaderPairBeta(const std::string& project1,
     PARSING_STATUS header2ParsingStatus = session->processFileBeta(
         file2, std::move(compDB2), createNormalizeActionFactory(session.get(), file2));
 
+    if (armor::HeaderBudget::exceeded()) {
+        armor::info() << "Beta parser stopped: " << armor::HeaderBudget::describe() << " exceeded\n";
+        return FATAL_ERRORS;
+    }
+
     // 3. Retrieve the results from the session
     armor::ASTNormalizedContext* context1 = session->getBetaContext(file1);
     armor::ASTNormalizedContext* context2 = session->getBetaContext(file2);
@@ -83,7 +98,9 @@ PARSING_STATUS processHeaderPairBeta(const std::string& project1,
     // 4. Perform the diff using the retrieved contexts
     nlohmann::json diffResult = diffTrees(context1, context2);
 
-    armor::emitHeaderDiffReport(diffResult, file1, project1, reportFormat, BETA_PARSER);
+    HeaderReportSummary reportSummary =
+        armor::emitHeaderDiffReport(diffResult, file1, project1, reportFormat, BETA_PARSER, dumpAstDiff);
+    if (summary) *summary = std::move(reportSummary);
 
     DebugConfig::getInstance().flush();
 
@@ -91,4 +108,154 @@ PARSING_STATUS processHeaderPairBeta(const std::string& project1,
 
 }
 
+bool writeHeaderSnapshotBeta(const std::string& project,
+                       const std::string& file,
+                       const std::string& header,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang,
+                       const std::string& snapshotFile) {
+
+    if (!DebugConfig::getInstance().initialize()) {
+        armor::user_error() << "Failed to open diagnostics log <" << LOG_FILE_PATH << ">, using stderr\n";
+    }
+
+    std::vector<std::string> Flags = getHeaderClangFlags(project, file, IncludePaths, macroFlags, lang);
+    auto compDB = std::make_unique<FixedCompilationDatabase>(project, Flags);
+    auto session = std::make_unique<armor::APISession>();
+
+    armor::info() << "Processing File : " << file << "\n";
+    for (auto& x : Flags) {
+        armor::info() << "Clang search path : " << x << "\n";
+    }
+
+    PARSING_STATUS parsingStatus = session->processFileBeta(
+        file, std::move(compDB), createNormalizeActionFactory(session.get(), file));
+    armor::ASTNormalizedContext* context = session->getBetaContext(file);
+
+    DebugConfig::getInstance().flush();
+
+    // A baseline with unresolved includes would make every later comparison report them.
+    if (parsingStatus != NO_FATAL_ERRORS || !context) {
+        armor::user_error() << "Not writing a snapshot of " << file << ": header did not parse cleanly\n";
+        return false;
+    }
+    return armor::APISnapshot::write(*context, header, snapshotFile);
+}
+
+PARSING_STATUS processHeaderAgainstSnapshotBeta(const std::string& snapshotFile,
+                       const std::string& project2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang,
+                       bool dumpAstDiff,
+                       HeaderReportSummary* summary) {
+
+    if (!DebugConfig::getInstance().initialize()) {
+        armor::user_error() << "Failed to open diagnostics log <" << LOG_FILE_PATH << ">, using stderr\n";
+    }
+
+    // 1. The baseline side comes from the snapshot; no Clang involved.
+    std::string header, error;
+    std::unique_ptr<armor::ASTNormalizedContext> context1 = armor::APISnapshot::load(snapshotFile, header, error);
+    if (!context1) {
+        armor::user_error() << "Failed to load snapshot " << snapshotFile << ": " << error << "\n";
+        return FATAL_ERRORS;
+    }
+    armor::info() << "Loaded snapshot of " << header << " : " << snapshotFile << "\n";
+
+    std::vector<std::string> Flags2 = getHeaderClangFlags(project2, file2, IncludePaths, macroFlags, lang);
+    auto compDB2 = std::make_unique<FixedCompilationDatabase>(project2, Flags2);
+    auto session = std::make_unique<armor::APISession>();
+
+    armor::info() << "Processing File2 : " << file2 << "\n";
+    for (auto& x : Flags2) {
+        armor::info() << "Clang search path : " << x << "\n";
+    }
+
+    // 2. Parse the new version only.
+    PARSING_STATUS header2ParsingStatus = session->processFileBeta(
+        file2, std::move(compDB2), createNormalizeActionFactory(session.get(), file2));
+
+    if (armor::HeaderBudget::exceeded()) {
+        armor::info() << "Beta parser stopped: " << armor::HeaderBudget::describe() << " exceeded\n";
+        return FATAL_ERRORS;
+    }
+
+    armor::ASTNormalizedContext* context2 = session->getBetaContext(file2);
+    if (!context2) {
+        armor::user_error() << "Failed to retrieve processing results from session\n";
+        return FATAL_ERRORS;
+    }
+
+    // 3. Diff as for a pair of sources; the report is named after the new version.
+    nlohmann::json diffResult = diffTrees(context1.get(), context2);
+
+    HeaderReportSummary reportSummary =
+        armor::emitHeaderDiffReport(diffResult, file2, project2, reportFormat, BETA_PARSER, dumpAstDiff);
+    if (summary) *summary = std::move(reportSummary);
+
+    DebugConfig::getInstance().flush();
+
+    return header2ParsingStatus;
+}
+
+PARSING_STATUS parseHeaderBeta(armor::APISession& session,
+                       const std::string& project,
+                       const std::string& file,
+                       const std::vector<std::string>& IncludePaths,
+                       const std::vector<std::string>& macroFlags,
+                       const LANG_OPTIONS lang) {
+
+    std::vector<std::string> Flags = getHeaderClangFlags(project, file, IncludePaths, macroFlags, lang);
+    auto compDB = std::make_unique<FixedCompilationDatabase>(project, Flags);
+
+    armor::info() << "Processing File : " << file << "\n";
+    for (auto& x : Flags) {
+        armor::info() << "Clang search path : " << x << "\n";
+    }
+
+    return session.processFileBeta(file, std::move(compDB), createNormalizeActionFactory(&session, file));
+}
+
+HeaderReportSummary compareHeaderContextsBeta(armor::ASTNormalizedContext& context1,
+                       armor::ASTNormalizedContext& context2,
+                       const std::string& project2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       bool dumpAstDiff,
+                       const std::string& reportName) {
+
+    // diffTrees consumes the unhandled-decl hashes of the newer side; keep them
+    // intact for the next comparison this context takes part in.
+    llvm::DenseMap<uint64_t, int> unhandledDecls = context2.getSourceRangeTracker().getUnhandledDeclsHashMap();
+    nlohmann::json diffResult = diffTrees(&context1, &context2);
+    context2.getSourceRangeTracker().getUnhandledDeclsHashMap() = std::move(unhandledDecls);
+
+    HeaderReportSummary summary = armor::emitHeaderDiffReport(
+        diffResult, file2, project2, reportFormat, BETA_PARSER, dumpAstDiff, reportName);
+    DebugConfig::getInstance().flush();
+    return summary;
+}
+
+HeaderReportSummary compareHeaderVersionsBeta(const armor::APISession& session1,
+                       const std::string& file1,
+                       armor::APISession& session2,
+                       const std::string& project2,
+                       const std::string& file2,
+                       const std::string& reportFormat,
+                       bool dumpAstDiff,
+                       const std::string& reportName) {
+
+    armor::ASTNormalizedContext* context1 = session1.getBetaContext(file1);
+    armor::ASTNormalizedContext* context2 = session2.getBetaContext(file2);
+    if (!context1 || !context2) {
+        armor::user_error() << "Failed to retrieve processing results from session\n";
+        return HeaderReportSummary();
+    }
+    return compareHeaderContextsBeta(*context1, *context2, project2, file2, reportFormat, dumpAstDiff, reportName);
+}
+
 } } // namespace armor::beta
@@ -68,26 +68,25 @@ ASTNormalizerPreprocessor::ASTNormalizerPreprocessor(clang::SourceManager* SM, a
 
 void ASTNormalizerPreprocessor::finalize(){
     
-    removeNestedRanges();
     armor::SourceRangeTracker& SRT = context->getSourceRangeTracker();
     
-    llvm::StringRef buffer = SM->getBufferData(SM->getMainFileID());
-    
-    for(armor::Range& R : PPDirectives){
-        uint64_t hash = generateHashFromOffsets(R.startOffset, R.endOffset,R.isActive);
+    // Nested directives were already dropped when the region index was classified.
+    for(armor::SourceRegion& R : SRT.getRegionIndex().getRegions()){
+        if(!R.isDirective()) continue;
+
+        bool isActive = R.kind == armor::SourceRegion::Kind::Directive;
+        uint64_t hash = generateHashFromOffsets(R.startOffset, R.endOffset, isActive);
         if(hash != 0) {
             R.hash = hash;
-            if(R.isActive) {
+            if(isActive) {
                 SRT.addUnhandledDeclHash(hash);
             } 
             else {
                 inactiveUnhandledDeclsHash[hash]++;;
-                inactivePPDirectives[R.startOffset] = R;
             }
         }
     }
     
-    SRT.moveInactivePPDirectives(inactivePPDirectives);
     SRT.moveInactiveUnhandledDeclsHashMap(inactiveUnhandledDeclsHash);
 
 }
@@ -102,7 +101,7 @@ uint64_t ASTNormalizerPreprocessor::generateHashFromOffsets(unsigned startOffset
     llvm::StringRef sourceText = buffer.substr(startOffset, endOffset - startOffset);
     uint64_t semanticHash = -1;
     if(isActive){
-        semanticHash = FibonacciHash::hashFromOffsets(SM, startOffset, endOffset);
+        semanticHash = FibonacciHash::hashFromOffsets(SM, startOffset, endOffset, &context->getSourceTokenTable());
     }
     else{
         semanticHash = FibonacciHash::hash(sourceText);
@@ -123,57 +122,7 @@ void ASTNormalizerPreprocessor::addRange(clang::SourceRange range, bool active)
         range.getEnd(), 0, *SM, clang::LangOptions());
 
     unsigned endOffset = SM->getFileOffset(endLoc);
-    PPDirectives.emplace_back(armor::Range(startOffset, endOffset, -1, active));
-}
-
-void ASTNormalizerPreprocessor::removeNestedRanges() {
-    if (PPDirectives.size() <= 1) return;
-    
-    llvm::SmallVector<armor::Range, 16> filteredRanges;
-    
-    size_t size = PPDirectives.size();
-    unsigned refStartOffset = PPDirectives[size-1].startOffset;
-    unsigned refEndOffset = PPDirectives[size-1].endOffset;
-    bool refStatus = PPDirectives[size-1].isActive;
-
-    llvm::StringRef buffer = SM->getBufferData(SM->getMainFileID());
-
-    for (int idx = size - 2; idx >= 0; --idx) {
-        unsigned currentStart = PPDirectives[idx].startOffset;
-        unsigned currentEnd = PPDirectives[idx].endOffset;
-        bool currentStatus = PPDirectives[idx].isActive;
-    
-        if (refStartOffset <= currentStart && currentEnd <= refEndOffset) {
-            continue;
-        }
-        else if (currentStart < refStartOffset && (currentEnd <= refStartOffset || refStartOffset < currentEnd)) {
-            filteredRanges.emplace_back(armor::Range(refStartOffset, refEndOffset,-1,refStatus));
-            refStatus = currentStatus;
-            refStartOffset = currentStart;
-            refEndOffset = currentEnd;
-        }
-        else {
-            armor::user_error()<<"Out of order PPDirective ranges detected\n";
-            armor::user_error()<<"["<<currentStart<<","<<currentEnd<<"]"<<"\n";
-            armor::user_error()<<"["<<refStartOffset<<","<<refEndOffset<<"]"<<"\n";
-            // physically never possible
-            assert(false && "Out of order ranges detected");
-        }
-    }
-    
-    filteredRanges.emplace_back(
-        armor::Range(
-            refStartOffset, 
-            refEndOffset ,
-            -1,
-            refStatus
-        )
-    );
-    
-    std::reverse(filteredRanges.begin(), filteredRanges.end());
-
-    PPDirectives = std::move(filteredRanges);
-
+    context->getSourceRangeTracker().getRegionIndex().addDirective(startOffset, endOffset, active);
 }
 
 void ASTNormalizerPreprocessor::InclusionDirective(
@@ -35,9 +35,16 @@
 #include <string_view>
 #include <utility>
 #include "logger.hpp"
+#include "run_stats.hpp"
 
 namespace armor { namespace beta {
 
+// Every node the builder creates goes through here so --stats can count them.
+static std::shared_ptr<armor::APINode> makeApiNode() {
+    armor::RunStats::count(armor::StatCounter::ApiNodesBuilt);
+    return std::make_shared<armor::APINode>();
+}
+
 beta::TreeBuilder::TreeBuilder(armor::ASTNormalizedContext* context): context(context) {}
 
 inline bool beta::TreeBuilder::IsDeclFromMainFileAndNotLocal(const clang::Decl* Decl) {
@@ -121,7 +128,7 @@ uint64_t beta::TreeBuilder::generateSemanticHashFromDecl(const clang::Decl* Decl
     if (StartLoc.isValid() && EndLoc.isValid()) {
         clang::CharSourceRange Range = clang::CharSourceRange::getTokenRange(StartLoc, EndLoc);
         sourceText = clang::Lexer::getSourceText(Range, SM, Decl->getASTContext().getLangOpts());
-        uint64_t semanticHash = FibonacciHash::hashFromSourceRange(&SM,clang::SourceRange(StartLoc, EndLoc));
+        uint64_t semanticHash = FibonacciHash::hashFromSourceRange(&SM,clang::SourceRange(StartLoc, EndLoc), &context->getSourceTokenTable());
         TEST_LOG << semanticHash << "\n";
         TEST_LOG << sourceText << "\n----------------------------------------\n";
         return semanticHash;
@@ -142,7 +149,7 @@ uint64_t beta::TreeBuilder::generateSemanticHashFromStmt(const clang::Stmt* Stmt
     if (StartLoc.isValid() && EndLoc.isValid()) {
         clang::CharSourceRange Range = clang::CharSourceRange::getTokenRange(StartLoc, EndLoc);
         sourceText = clang::Lexer::getSourceText(Range, SM, context->getClangASTContext()->getLangOpts());
-        uint64_t semanticHash = FibonacciHash::hashFromSourceRange(&SM, clang::SourceRange(StartLoc, EndLoc));
+        uint64_t semanticHash = FibonacciHash::hashFromSourceRange(&SM, clang::SourceRange(StartLoc, EndLoc), &context->getSourceTokenTable());
         TEST_LOG << semanticHash << "\n";
         TEST_LOG << sourceText << "\n----------------------------------------\n";
         return semanticHash;
@@ -208,7 +215,7 @@ void beta::TreeBuilder::popOverridenQualifiedName(llvm::StringRef usr){
 }
 
 void beta::TreeBuilder::BuildReturnTypeNode(clang::QualType type) {
-    auto returnNode = std::make_shared<armor::APINode>();
+    auto returnNode = makeApiNode();
     returnNode->kind = NodeKind::ReturnType;
     auto [dataType,canonicalType] = getTypesWithAndWithoutTypeResolution(type, *context->getClangASTContext());    
     PushName("(ReturnType)");
@@ -223,7 +230,7 @@ void beta::TreeBuilder::BuildReturnTypeNode(clang::QualType type) {
 }
 
 void beta::TreeBuilder::normalizeFunctionPointerType(std::string_view typeModifiers, const clang::FunctionProtoTypeLoc FTL, const clang::NamedDecl* Decl) {
-    auto functionPointerNode = std::make_shared<armor::APINode>();
+    auto functionPointerNode = makeApiNode();
     functionPointerNode->kind = NodeKind::FunctionPointer;
     functionPointerNode->qualifiedName = GetCurrentQualifiedName();
     functionPointerNode->dataType = typeModifiers;
@@ -255,7 +262,7 @@ void beta::TreeBuilder::normalizeValueDeclNode(const clang::ValueDecl *Decl, uns
     const std::string USR = ::generateUSRForDecl(Decl);
     const auto it = context->usrNodeMap.find(USR);
     bool isCached = (it != context->usrNodeMap.end());
-    std::shared_ptr<armor::APINode> ValueNode = isCached ? it->second : std::make_shared<armor::APINode>();
+    std::shared_ptr<armor::APINode> ValueNode = isCached ? it->second : makeApiNode();
     clang::QualType unDecayedDeclType = clang::QualType();
     clang::TypeSourceInfo *TSI = nullptr;
     llvm::SmallString<128> nameBuf;
@@ -400,7 +407,7 @@ bool beta::TreeBuilder::BuildRecordNode(clang::RecordDecl* Decl) {
         }
     }
 
-    std::shared_ptr<armor::APINode> recordNode = isCached ? it->second : std::make_shared<armor::APINode>();
+    std::shared_ptr<armor::APINode> recordNode = isCached ? it->second : makeApiNode();
     recordNode->NSR = NSR;
     recordNode->USR = USR;
     if (!isCached) {
@@ -485,7 +492,7 @@ bool beta::TreeBuilder::BuildCXXRecordNode(clang::CXXRecordDecl* Decl) {
         }
     }
     
-    std::shared_ptr<armor::APINode> cxxRecordNode = isCached ? it->second : std::make_shared<armor::APINode>();
+    std::shared_ptr<armor::APINode> cxxRecordNode = isCached ? it->second : makeApiNode();
     cxxRecordNode->NSR = NSR;
     cxxRecordNode->USR = USR;
     
@@ -593,7 +600,7 @@ bool beta::TreeBuilder::BuildEnumNode(clang::EnumDecl* Decl){
         }
     }
 
-    std::shared_ptr<armor::APINode> enumNode = isCached ? it->second : std::make_shared<armor::APINode>();
+    std::shared_ptr<armor::APINode> enumNode = isCached ? it->second : makeApiNode();
     enumNode->NSR = NSR;
     enumNode->USR = USR;
 
@@ -613,11 +620,12 @@ bool beta::TreeBuilder::BuildEnumNode(clang::EnumDecl* Decl){
 
     const clang::QualType enumType = Decl->getIntegerType();
     std::string enumaratorDataType = enumType.getAsString();
+    armor::RunStats::count(armor::StatCounter::TypeStrings);
     enumNode->access = getAccessSpecifier(Decl->getAccess());
      
     for (const auto* EnumConstDecl : Decl->enumerators()) {
         if(!Decl->isThisDeclarationADefinition()) continue;
-        auto enumValNode = std::make_shared<armor::APINode>();
+        auto enumValNode = makeApiNode();
         llvm::StringRef enumConstName = EnumConstDecl->getName();
         PushName(enumConstName);
         enumValNode->qualifiedName = GetCurrentQualifiedName();
@@ -669,7 +677,7 @@ bool beta::TreeBuilder::BuildFunctionNode(clang::FunctionDecl* Decl){
     llvm::SmallString<128> nameBuf;
     llvm::raw_svector_ostream OS(nameBuf);
 
-    auto functionNode = isCached ? it->second : std::make_shared<armor::APINode>();
+    auto functionNode = isCached ? it->second : makeApiNode();
     Decl->printName(OS);
     
     if(Decl->isThisDeclarationADefinition() && Decl->getBody() && !Decl->isExplicitlyDefaulted()){
@@ -755,7 +763,7 @@ bool beta::TreeBuilder::BuildTypedefDecl(clang::TypedefDecl *Decl) {
 
     const clang::QualType underlyingType = Decl->getUnderlyingType();
 
-    auto typeDefNode = std::make_shared<armor::APINode>();
+    auto typeDefNode = makeApiNode();
     Decl->printName(OS);
     PushName(nameBuf);
     typeDefNode->qualifiedName = GetCurrentQualifiedName();
@@ -829,7 +837,7 @@ void inline beta::TreeBuilder::BuildBaseClassDecl(clang::CXXBaseSpecifier Decl){
     if(Type->getAsCXXRecordDecl() == nullptr) return;
 
     const clang::CXXRecordDecl * cxxBaseRecordDecl = Type->getAsCXXRecordDecl();
-    const auto cxxBaseRecord = std::make_shared<armor::APINode>();
+    const auto cxxBaseRecord = makeApiNode();
     cxxBaseRecord->qualifiedName = ::generateQualifiedNameForDecl(cxxBaseRecordDecl);
     cxxBaseRecord->kind = NodeKind::BaseClass;
     cxxBaseRecord->NSR = ::generateNSRForDecl(cxxBaseRecordDecl);
@@ -885,7 +893,7 @@ void beta::TreeBuilder::BuildFriendCxxRecordDecl(const clang::CXXRecordDecl *Dec
     OS << nodeStack.back()->USR << ':' << USR;
 
     const auto it = context->usrNodeMap.find(keyBuf);
-    std::shared_ptr<armor::APINode> friendCxxRecordNode = (it != context->usrNodeMap.end()) ? it->second : std::make_shared<armor::APINode>();
+    std::shared_ptr<armor::APINode> friendCxxRecordNode = (it != context->usrNodeMap.end()) ? it->second : makeApiNode();
     friendCxxRecordNode->NSR = NSR;
     friendCxxRecordNode->USR = USR;
     friendCxxRecordNode->access = getAccessSpecifier(Decl->getAccess());
@@ -923,7 +931,7 @@ void beta::TreeBuilder::BuildFriendFunctionDecl(const clang::FunctionDecl *Decl,
 
     if( context->usrNodeMap.find(keyBuf) != context->usrNodeMap.end() ) return;
 
-    auto friendFunctionNode = std::make_shared<armor::APINode>();
+    auto friendFunctionNode = makeApiNode();
     friendFunctionNode->qualifiedName = ::generateQualifiedNameForDecl(Decl);
 
     qualifiedName.overridePush(friendFunctionNode->qualifiedName, USR);
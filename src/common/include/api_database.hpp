@@ -0,0 +1,191 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "ast_normalized_context.hpp"
+
+namespace armor {
+
+/**
+ * @class APIDatabase
+ * @brief Append-only store of the normalized APIs of many releases.
+ *
+ * The file is a log of blocks: interned strings, API nodes, release markers
+ * and per-header entries. A node refers to its strings and children by id
+ * and is stored only if no identical node (same fields, same child ids)
+ * exists yet, so a symbol unchanged between releases costs nothing and an
+ * unchanged header shares its whole tree. A header entry holds its root
+ * node ids, its USR map keyed by interned USR and its comment, unhandled and
+ * inactive hash tables: everything the beta diff needs.
+ *
+ * Every commit() ends in an index block and a trailer pointing at it. An
+ * index block holds sorted tables of the strings, nodes, headers and
+ * symbol occurrences (keyed by interned USR) stored since the previous
+ * index block; a commit merges the newest blocks into its own while they
+ * are no larger, so there are about log2(commits) of them. open() maps the
+ * file and follows the trailer; lookups binary-search the mapped tables,
+ * so nothing is read per block. A commit that did not complete (a torn
+ * tail) is cut off on open.
+ *
+ * Writers hold an exclusive lock on the file from their first addRelease()
+ * or addHeader() until commit(), so appends never interleave; a database
+ * changed by another writer since open() is reloaded before adding.
+ */
+class APIDatabase {
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr const char* DEFAULT_PATH = "armor_api.db";
+
+    /// One release in which a symbol was found.
+    struct SymbolVersion {
+        std::string release;
+        std::string header;
+        std::string usr;
+        std::string dataType;
+        // The signature (types, qualifiers or parameters) differs from the previous
+        // release that had the symbol; members and bodies do not count.
+        bool changed;
+    };
+
+    APIDatabase() = default;
+    ~APIDatabase();
+    APIDatabase(const APIDatabase&) = delete;
+    APIDatabase& operator=(const APIDatabase&) = delete;
+
+    /// Map path, creating an empty database if it does not exist.
+    bool open(const std::string& path, std::string& error);
+
+    /// Start a new release; fails if one with that name already exists.
+    bool addRelease(llvm::StringRef release, std::string& error);
+
+    /// Add header of the release last started with addRelease().
+    bool addHeader(llvm::StringRef header, const ASTNormalizedContext& context, std::string& error);
+
+    /// Append everything added since open() or the last commit() and release the lock.
+    bool commit(std::string& error);
+
+    /// Release names in the order they were added.
+    std::vector<std::string> getReleases() const;
+    bool hasRelease(llvm::StringRef release) const;
+    std::vector<std::string> getHeaders(llvm::StringRef release) const;
+    bool hasHeader(llvm::StringRef release, llvm::StringRef header) const;
+
+    /// Rebuild the context of header in release, or nullptr if it is not stored.
+    std::unique_ptr<ASTNormalizedContext> loadHeader(llvm::StringRef release, llvm::StringRef header) const;
+
+    /// True when header is stored with the same nodes and hash tables in both releases.
+    bool sameAPI(llvm::StringRef release1, llvm::StringRef release2, llvm::StringRef header) const;
+
+    /// Every release declaring symbol, given as a USR or a qualified name, oldest first.
+    std::vector<SymbolVersion> history(llvm::StringRef symbol) const;
+
+    size_t getStringCount() const { return indexedStrings + addedStrings.size(); }
+    size_t getNodeCount() const { return indexedNodes + addedNodes.size(); }
+    size_t getIndexLevelCount() const { return levels.size(); }
+
+private:
+    struct Block {
+        uint64_t offset;   // of the payload
+        uint32_t size;
+    };
+
+    struct Release {
+        std::string name;
+        llvm::StringMap<Block> headers;
+        std::vector<std::string> headerOrder;
+    };
+
+    struct HeaderEntry;
+
+    // A header of a release declaring a USR with a node; stored as is in index blocks.
+    struct SymbolOccurrence {
+        uint32_t sequence;   // header entries in the order they were stored
+        uint32_t release;    // index into releases
+        uint32_t header;     // interned header name
+        uint32_t usr;        // interned USR
+        uint32_t node;
+    };
+
+    // A header entry added since open(), for the next index block.
+    struct StoredHeader {
+        uint32_t release;
+        uint32_t name;
+        Block block;
+    };
+
+    // An index block of the mapped file: its id ranges and the file offsets of its tables.
+    struct IndexLevel {
+        uint64_t offset;     // of the payload
+        uint64_t previous;   // payload offset of the older index block, 0 if none
+        uint32_t firstString, stringCount;
+        uint32_t firstNode, nodeCount;
+        uint32_t firstRelease, releaseCount;
+        uint32_t firstSequence, headerCount;
+        uint32_t occurrenceCount, nameCount;
+        uint64_t strings, stringKeys, nodes, nodeKeys, releases, headers, occurrences, names;
+    };
+
+    bool load(std::string& error);
+    bool mapFile(std::string& error);
+    bool loadIndex();
+    bool recover(std::string& error);
+    bool lockForWriting(std::string& error);
+    void unlock();
+    std::string buildIndex() const;
+
+    void indexSymbols(size_t release, uint32_t header, llvm::StringRef entry);
+    bool lastOccurrence(uint32_t usr, SymbolOccurrence& last) const;
+    void collectOccurrences(uint32_t usr, std::vector<SymbolOccurrence>& out) const;
+    uint64_t signatureHash(uint32_t node) const;
+    void appendBlock(uint32_t kind, llvm::StringRef payload, Block* block);
+    llvm::StringRef payload(const Block& block) const;
+
+    uint32_t findString(llvm::StringRef text) const;
+    uint32_t intern(llvm::StringRef text);
+    llvm::StringRef getString(uint32_t id) const;
+    llvm::StringRef getNode(uint32_t id) const;
+    uint32_t addNode(const APINode& node, llvm::DenseMap<const APINode*, uint32_t>& added);
+    bool readHeader(const Block& block, HeaderEntry& entry) const;
+    const Block* findHeader(llvm::StringRef release, llvm::StringRef header) const;
+
+    std::string path;
+    std::unique_ptr<llvm::MemoryBuffer> mapped;
+    // Blocks added since the last commit; offsets continue after the mapped file.
+    std::string pending;
+    uint64_t fileSize = 0;
+    // Held from the first addition until commit().
+    int lockFd = -1;
+
+    // Index blocks of the mapped file, newest first, and the ids they cover.
+    std::vector<IndexLevel> levels;
+    uint32_t indexedStrings = 0;
+    uint32_t indexedNodes = 0;
+    uint32_t indexedReleases = 0;
+
+    // Added since open(); ids continue after the indexed ones.
+    std::vector<Block> addedStrings;
+    llvm::StringMap<uint32_t> addedStringIds;
+    std::vector<Block> addedNodes;
+    // Hash of a node record to the ids of added nodes with that hash.
+    llvm::DenseMap<uint64_t, llvm::SmallVector<uint32_t, 1>> addedNodeIds;
+    std::vector<StoredHeader> addedHeaders;
+    llvm::DenseMap<uint32_t, std::vector<SymbolOccurrence>> symbolIndex;
+    // Interned qualified name to the USRs first declared with it since open().
+    llvm::DenseMap<uint32_t, llvm::SmallVector<uint32_t, 1>> usrsByName;
+
+    std::vector<Release> releases;
+    llvm::StringMap<size_t> releaseIndex;
+    uint32_t headerSequence = 0;
+};
+
+} // namespace armor
@@ -0,0 +1,54 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "llvm/ADT/StringRef.h"
+
+#include "ast_normalized_context.hpp"
+
+namespace armor {
+
+/**
+ * @class APISnapshot
+ * @brief Versioned binary image of a beta ASTNormalizedContext.
+ *
+ * A snapshot holds everything the beta diff reads from the baseline side:
+ * the API node graph with its USR/NSR, type strings and statement hashes,
+ * the USR lookup maps, and the comment, unhandled-decl and inactive-code
+ * hash maps. Shared nodes are stored once.
+ *
+ * Layout, native byte order, every section 8-byte aligned:
+ *   FileHeader | string pool | nodes | child indices | statement hashes |
+ *   roots | USR map | unsupported USRs | 3 x (hash, count) tables
+ * Records are fixed size and strings are (offset, size) into the pool, so
+ * the mapped file is read in place; load() only materializes the nodes the
+ * diff engine works on.
+ */
+class APISnapshot {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr const char* EXTENSION = ".armorsnap";
+    // Marks a directory of snapshots that can stand in for projectroot1.
+    static constexpr const char* MANIFEST = "armor_snapshot.json";
+
+    /// Serialize a beta context of header to path; false on I/O error.
+    static bool write(const ASTNormalizedContext& context, llvm::StringRef header, const std::string& path);
+
+    /**
+     * Map path and rebuild the context it was written from.
+     * Returns nullptr and sets error when the file cannot be read, is not a
+     * snapshot, has another version or byte order, or is inconsistent.
+     */
+    static std::unique_ptr<ASTNormalizedContext> load(const std::string& path, std::string& header,
+                                                      std::string& error);
+
+    // The boolean qualifiers of a node as one flag word, shared by the on-disk formats.
+    static constexpr uint16_t HAS_CHILDREN = 1 << 15;   // children vector allocated, possibly empty
+    static uint16_t packFlags(const APINode& node);
+    static void unpackFlags(uint16_t flags, APINode& node);
+};
+
+} // namespace armor
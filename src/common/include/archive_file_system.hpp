@@ -0,0 +1,99 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+namespace armor {
+
+/**
+ * @class TarArchive
+ * @brief Read-only index of a .tar, .tar.gz or .tgz archive.
+ *
+ * open() reads the archive once to record every member's name, size and
+ * offset in the tar stream; member contents are not kept. For a gzip archive
+ * it also saves an inflate access point (bit position plus the preceding
+ * 32 KiB window) about every accessPointSpan bytes of output, so a member is
+ * later read by inflating from the nearest point before it, not from the
+ * start. Only members that are read are ever decompressed again.
+ *
+ * If every member sits under one top-level directory, as in most release
+ * tarballs, that directory is the archive's root.
+ *
+ * Safe to read from several threads once open() returned.
+ */
+class TarArchive {
+public:
+    static constexpr uint64_t DEFAULT_ACCESS_POINT_SPAN = 4u << 20;
+
+    struct Member {
+        uint64_t offset = 0;     // of the contents in the tar stream
+        uint64_t size = 0;
+        bool directory = false;
+        uint32_t index = 0;      // unique per member, for file ids
+        std::string linkTarget;  // symbolic links only
+    };
+
+    /// True if path names a tar archive by its extension.
+    static bool isArchive(llvm::StringRef path);
+
+    static std::shared_ptr<TarArchive> open(const std::string& path, std::string& error,
+                                            uint64_t accessPointSpan = DEFAULT_ACCESS_POINT_SPAN);
+
+    /// Member at a root-relative path, following symbolic links; nullptr if absent.
+    const Member* find(llvm::StringRef name) const;
+
+    /// Names of the entries directly in a root-relative directory ("" for the root).
+    std::vector<std::string> list(llvm::StringRef directory) const;
+
+    /// Contents of a regular member, null-terminated; nullptr on a read error.
+    std::unique_ptr<llvm::MemoryBuffer> read(const Member& member, llvm::StringRef bufferName) const;
+
+    size_t getMemberCount() const { return members.size(); }
+    size_t getAccessPointCount() const { return accessPoints.size(); }
+
+private:
+    // Where raw inflate can restart: the compressed byte holding the first
+    // bit of a deflate block, and the 32 KiB of output before it.
+    struct AccessPoint {
+        uint64_t out = 0;
+        uint64_t in = 0;
+        int bits = 0;
+        std::vector<unsigned char> window;
+    };
+    class Indexer;
+
+    bool resolve(llvm::StringRef key, std::string& resolved, unsigned depth = 0) const;
+
+    bool readStream(uint64_t offset, uint64_t size, char* out) const;
+
+    std::unique_ptr<llvm::MemoryBuffer> file;
+    bool compressed = false;
+    llvm::StringMap<Member> members;
+    llvm::StringMap<std::vector<std::string>> children;
+    std::string root;   // archive path of the directory shown as the root
+    std::vector<AccessPoint> accessPoints;
+};
+
+/**
+ * Make archivePath readable as a project root: returns a new empty directory
+ * under which createFileSystem() and getFileSystem() show the archive's
+ * contents. Mounts last until the process exits.
+ */
+std::string mountArchive(const std::string& archivePath, std::string& error);
+
+/// The real file system with every mounted archive on top, with its own working directory.
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> createFileSystem();
+
+/// A shared createFileSystem() instance for reads by absolute path; its working directory is never changed.
+llvm::vfs::FileSystem& getFileSystem();
+
+} // namespace armor
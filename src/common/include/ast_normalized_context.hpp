@@ -3,6 +3,8 @@
 #pragma once
 
 #include "node.hpp"
+#include "source_region_index.hpp"
+#include "source_token_table.hpp"
 #include "clang/AST/ASTContext.h"
 #include "clang/Basic/SourceLocation.h"
 #include <cstdint>
@@ -23,7 +25,7 @@ namespace armor {
  * @brief Unified tracker for source range information from both parsers.
  *
  * Alpha uses only the fatal directives interface.
- * Beta uses the full interface (comments, inactive PP directives, hash maps).
+ * Beta uses the full interface (source regions, hash maps).
  */
 class SourceRangeTracker {
 public:
@@ -40,18 +42,15 @@ public:
     void addFatalDirective(llvm::StringRef header, llvm::StringRef file);
     const llvm::SmallVector<FatalDirectiveRef, 8>& getFatalDirectives() const;
 
+    // --- Beta: comments, PP directives and inactive blocks ---
+    SourceRegionIndex& getRegionIndex();
+    const SourceRegionIndex& getRegionIndex() const;
+
     // --- Beta: comments ---
-    const llvm::SmallVector<armor::Range, 32>& getComments() const;
-    void moveComments(llvm::SmallVector<armor::Range, 32>& ranges);
     llvm::DenseMap<uint64_t, int>& getCommentsHashMap();
     const llvm::DenseMap<uint64_t, int>& getCommentsHashMap() const;
     void moveCommentsHashMap(llvm::DenseMap<uint64_t, int>& hashMap);
 
-    // --- Beta: inactive PP directives ---
-    const std::map<unsigned, armor::Range>& getInactivePPDirectives() const;
-    std::map<unsigned, armor::Range>& getInactivePPDirectives();
-    void moveInactivePPDirectives(std::map<unsigned, armor::Range>& map);
-
     // --- Beta: unhandled decl hashes ---
     void addUnhandledDeclHash(uint64_t hash);
     llvm::DenseMap<uint64_t, int>& getUnhandledDeclsHashMap();
@@ -66,8 +65,7 @@ public:
 private:
     llvm::SmallVector<FatalDirectiveRef, 8> fatalDirectives;
 
-    llvm::SmallVector<armor::Range, 32> comments;
-    std::map<unsigned, armor::Range> inactivePPDirectives;
+    SourceRegionIndex regionIndex;
     llvm::DenseMap<uint64_t, int> unhandledDeclsHashMap;
     llvm::DenseMap<uint64_t, int> commentsHashMap;
     llvm::DenseMap<uint64_t, int> inactiveUnhandledDeclsHashMap;
@@ -99,6 +97,9 @@ public:
     SourceRangeTracker& getSourceRangeTracker();
     const SourceRangeTracker& getSourceRangeTracker() const;
 
+    SourceTokenTable& getSourceTokenTable();
+    const SourceTokenTable& getSourceTokenTable() const;
+
     // Beta-specific lookup maps
     llvm::StringMap<std::shared_ptr<APINode>> usrNodeMap;
     llvm::StringSet<> unSupportedUsrNodeMap;
@@ -107,6 +108,7 @@ private:
     llvm::StringMap<llvm::SmallVector<std::shared_ptr<APINode>, 16>> apiNodesMap;
     llvm::SmallVector<std::shared_ptr<const APINode>, 64> apiNodes;
     SourceRangeTracker sourceRangeTracker;
+    SourceTokenTable sourceTokenTable;
     clang::ASTContext* clangContext = nullptr;
 };
 
@@ -0,0 +1,67 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
+#include "report_generator.hpp"
+
+namespace armor {
+
+/**
+ * @class BaselineMatrix
+ * @brief Verdicts of every header against each of several baselines.
+ *
+ * One row per header and one column per baseline; each cell links to the
+ * per-header report of that comparison. Cells without a result (header in
+ * neither version) are left empty; a comparison that could not be made is
+ * recorded as failed and makes its baseline incompatible.
+ */
+class BaselineMatrix {
+public:
+    static constexpr const char* HTML_PATH = "armor_reports/armor_baselines.html";
+    static constexpr const char* JSON_PATH = "armor_reports/armor_baselines.json";
+
+    explicit BaselineMatrix(std::vector<std::string> baselines) : baselines(std::move(baselines)) {}
+
+    /// Record the result of header against baselines[baseline]; reportName names its per-header report.
+    void addResult(const std::string& header, size_t baseline, const HeaderReportSummary& summary,
+                   const std::string& reportName);
+
+    /// Record that header could not be compared against baselines[baseline], and why.
+    void addFailure(const std::string& header, size_t baseline, const std::string& reason);
+
+    /// True when every recorded result against baseline is backward compatible.
+    bool isBackwardCompatible(size_t baseline) const;
+    bool isBackwardCompatible() const;
+
+    /// Console table: one line per header with a verdict per baseline.
+    void print(llvm::raw_ostream& os) const;
+
+    bool writeJson(const std::string& path) const;
+    bool writeHtml(const std::string& path) const;
+
+private:
+    struct Cell {
+        bool set = false;
+        bool failed = false;
+        std::string compatibility;
+        std::string overallStatus;
+        std::string reason;
+        std::string reportName;
+        size_t changeCount = 0;
+        size_t incompatibleCount = 0;
+    };
+
+    Cell& getCell(const std::string& header, size_t baseline);
+
+    std::vector<std::string> baselines;
+    std::vector<std::string> headers;
+    std::vector<std::vector<Cell>> rows;
+    llvm::StringMap<size_t> headerIndex;
+};
+
+} // namespace armor
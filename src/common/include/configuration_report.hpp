@@ -0,0 +1,85 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringMap.h"
+#include "report_generator.hpp"
+
+namespace armor {
+
+/// One named build configuration of the headers under comparison.
+struct Configuration {
+    std::string name;
+    std::string lang;        // LANG_C or LANG_CPP
+    std::string macroFlags;  // as for --macro-flags
+};
+
+/**
+ * Read a configuration matrix: a JSON array, or an object with a
+ * "configurations" array, of {"name", "lang", "macro_flags"} entries.
+ * Names must be unique; lang defaults to cpp.
+ */
+bool loadConfigurations(const std::string& path, std::vector<Configuration>& configurations, std::string& error);
+
+/**
+ * @class ConfigurationReport
+ * @brief Results of every header under several configurations, merged.
+ *
+ * A change reported by several configurations is listed once, with the
+ * configurations it was found in.
+ */
+class ConfigurationReport {
+public:
+    static constexpr const char* HTML_PATH = "armor_reports/armor_configurations.html";
+    static constexpr const char* JSON_PATH = "armor_reports/armor_configurations.json";
+
+    /// A change and the indexes of the configurations reporting it.
+    struct MergedChange {
+        std::string name;
+        std::string description;
+        bool backwardIncompatible = false;
+        std::vector<size_t> configurations;
+    };
+
+    explicit ConfigurationReport(std::vector<std::string> configurations)
+        : configurations(std::move(configurations)) {}
+
+    void addResult(const std::string& header, size_t configuration, const HeaderReportSummary& summary,
+                   const std::string& reportName);
+
+    bool isBackwardCompatible(size_t configuration) const;
+    bool isBackwardCompatible() const;
+
+    /// Changes of header across all configurations, in the order first reported.
+    std::vector<MergedChange> getChanges(const std::string& header) const;
+
+    bool writeJson(const std::string& path) const;
+    bool writeHtml(const std::string& path) const;
+
+private:
+    struct Result {
+        bool set = false;
+        std::string compatibility;
+        std::string overallStatus;
+        std::string reportName;
+    };
+
+    struct HeaderResults {
+        std::string header;
+        std::vector<Result> results;
+        std::vector<MergedChange> changes;
+        llvm::StringMap<size_t> changeIndex;
+    };
+
+    // Names of the configurations that reported change, or "all" if every one that compared the header did.
+    std::string describeConfigurations(const HeaderResults& header, const MergedChange& change) const;
+
+    std::vector<std::string> configurations;
+    std::vector<HeaderResults> headers;
+    llvm::StringMap<size_t> headerIndex;
+};
+
+} // namespace armor
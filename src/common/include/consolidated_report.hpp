@@ -0,0 +1,54 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "report_generator.hpp"
+
+namespace armor {
+
+/**
+ * @class ConsolidatedReport
+ * @brief One HTML page covering every header of a run.
+ *
+ * Header results are collected while the run progresses. write() then emits
+ * an index of per-header status and counts, with all change rows embedded as
+ * compact JSON that the page renders one page of rows at a time.
+ */
+class ConsolidatedReport {
+public:
+    static constexpr const char* DEFAULT_PATH = "armor_reports/armor_report.html";
+
+    ConsolidatedReport() = default;
+
+    void addHeader(const std::string& header, const HeaderReportSummary& summary);
+
+    bool empty() const;
+
+    /// Render the whole page and write it with a single write.
+    bool write(const std::string& path) const;
+
+private:
+    struct HeaderEntry {
+        std::string header;
+        std::string overallStatus;
+        std::string reason;
+        size_t changeCount;
+        size_t incompatibleCount;
+    };
+
+    struct ChangeEntry {
+        uint32_t headerIndex;
+        std::string name;
+        std::string description;
+        bool compatibilityChanged;
+        bool backwardIncompatible;
+    };
+
+    std::vector<HeaderEntry> headers;
+    std::vector<ChangeEntry> changes;
+};
+
+} // namespace armor
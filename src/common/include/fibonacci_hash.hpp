@@ -12,6 +12,10 @@ namespace clang {
     class SourceRange;
 }
 
+namespace armor {
+    class SourceTokenTable;
+}
+
 /**
  * FibonacciHash - A fast, non-cryptographic hash function based on the golden ratio.
  * 
@@ -25,6 +29,18 @@ namespace clang {
 class FibonacciHash {
 
 public:
+    /**
+     * Whitespace-skipping kernels behind hash(); all produce identical values.
+     */
+    enum class Kernel {
+        Scalar,
+        SSE42,
+        AVX2
+    };
+
+    // Golden ratio constant: 2^64 / φ where φ = (1 + √5) / 2
+    static constexpr uint64_t GOLDEN_RATIO_64 = 0x9E3779B97F4A7C15ULL;
+
     /**
      * Compute hash for std::string
      */
@@ -46,9 +62,11 @@ public:
      * 
      * @param SM Source manager for accessing source text
      * @param Range Source range to hash
+     * @param tokens Optional token table of the main file; avoids re-lexing the range
      * @return Hash value, or 0 if range is invalid
      */
-    static uint64_t hashFromSourceRange(clang::SourceManager* SM, clang::SourceRange Range);
+    static uint64_t hashFromSourceRange(clang::SourceManager* SM, clang::SourceRange Range,
+                                        const armor::SourceTokenTable* tokens = nullptr);
     
     /**
      * Compute normalized hash from file offsets using Clang Lexer.
@@ -57,16 +75,42 @@ public:
      * @param SM Source manager for accessing source text
      * @param startOffset Starting byte offset in the main file
      * @param endOffset Ending byte offset in the main file
+     * @param tokens Optional token table of the main file; avoids re-lexing the range
      * @return Hash value, or 0 if offsets are invalid
      */
-    static uint64_t hashFromOffsets(clang::SourceManager* SM, unsigned startOffset, unsigned endOffset);
+    static uint64_t hashFromOffsets(clang::SourceManager* SM, unsigned startOffset, unsigned endOffset,
+                                    const armor::SourceTokenTable* tokens = nullptr);
+
+    /**
+     * Kernel selected at first use: the widest one the running CPU supports
+     */
+    static Kernel activeKernel();
+
+    /**
+     * Whether the running CPU can execute the given kernel
+     */
+    static bool isKernelSupported(Kernel kernel);
+
+    /**
+     * Hash raw bytes with a specific kernel (falls back to Scalar if unsupported).
+     * Intended for tests and benchmarks; regular callers use hash().
+     */
+    static uint64_t hashWithKernel(Kernel kernel, const uint8_t* data, size_t length);
 
 private:
     /**
-     * Core hashing algorithm implementation
+     * Core hashing algorithm implementation, dispatched to activeKernel()
      */
     static uint64_t fibonacci_hash_impl(const uint8_t* data, size_t length);
 
-    // Golden ratio constant: 2^64 / φ where φ = (1 + √5) / 2
-    static constexpr uint64_t GOLDEN_RATIO_64 = 0x9E3779B97F4A7C15ULL;
+    /**
+     * Mix raw token bytes into the running token hash state
+     */
+    static void mixTokenBytes(const uint8_t* ptr, const uint8_t* end,
+                              uint64_t& hash, uint64_t& chunk, int& chunkPos);
+
+    /**
+     * Flush the pending chunk and apply the final avalanche mixing
+     */
+    static uint64_t finalizeTokenHash(uint64_t hash, uint64_t chunk, int chunkPos);
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace armor {
+
+/**
+ * @class FileContentCache
+ * @brief Memory-mapped header contents and their content hashes, keyed by path.
+ *
+ * filesDiffer() compares sizes first, then content hashes if both are
+ * known, and only maps the files when neither settles it. Files are read
+ * through getFileSystem(), so headers in mounted archives work too. A
+ * buffer stays mapped until release(), so callers release both files of a
+ * pair once it is done with.
+ *
+ * Content hashes (xxHash64) are shared by every cache in the process and
+ * outlive release(), so later stages key their caches on them without
+ * reading the file again. A hash is used only while the file keeps the
+ * size and modification time it had when hashed.
+ */
+class FileContentCache {
+public:
+    FileContentCache() = default;
+
+    /// True if the files differ or either cannot be read.
+    bool filesDiffer(const std::string& file1, const std::string& file2);
+
+    /// Mapped contents of path, or nullptr if it cannot be read.
+    const llvm::MemoryBuffer* getBuffer(const std::string& path);
+
+    /// xxHash64 of the contents of path, or nullopt if it cannot be read; maps path only if it is not known yet.
+    std::optional<uint64_t> getContentHash(const std::string& path);
+
+    /// Unmap path; its content hash, if computed, is kept.
+    void release(const std::string& path);
+
+private:
+    llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> buffers;
+};
+
+} // namespace armor
@@ -0,0 +1,71 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace armor {
+
+/**
+ * @class HeaderBudget
+ * @brief Wall-time and memory limits for processing one header.
+ *
+ * A Scope arms the limits for the calling thread. Parser and traversal
+ * callbacks poll exceeded() and wind down once it returns true, after which
+ * the header is reported from a cheaper classification. The memory limit
+ * applies to the resident set of the whole process, so with --jobs it is
+ * shared by all headers in flight.
+ */
+class HeaderBudget {
+public:
+    enum class Reason { None, Time, Memory };
+
+    struct Limits {
+        std::chrono::milliseconds time{0};   // 0 = unlimited
+        uint64_t memoryBytes = 0;            // 0 = unlimited
+
+        bool isSet() const { return time.count() > 0 || memoryBytes > 0; }
+    };
+
+private:
+    struct State {
+        Limits limits;
+        std::chrono::steady_clock::time_point deadline;
+        Reason reason = Reason::None;
+        unsigned polls = 0;
+    };
+
+    static inline thread_local State* current = nullptr;
+
+public:
+    // Resident memory is read from /proc; only every Nth poll looks at it.
+    static constexpr unsigned MEMORY_POLL_INTERVAL = 256;
+
+    class Scope {
+    public:
+        explicit Scope(const Limits& limits);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        State state;
+        State* previous;
+    };
+
+    /// True once the current thread's header ran over a limit; always false outside a Scope.
+    static bool exceeded();
+
+    /// Which limit the current thread's header ran over.
+    static Reason reason();
+
+    /// "time budget of 30s" or "memory budget of 2048 MiB" for the current thread's limits.
+    static std::string describe();
+
+    /// Current resident set size of the process, 0 if unknown.
+    static uint64_t residentBytes();
+};
+
+} // namespace armor
@@ -0,0 +1,78 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/GlobPattern.h"
+
+namespace armor {
+
+/**
+ * @class HeaderFilter
+ * @brief Which files under a header directory are headers to compare.
+ *
+ * A pattern without a '/' is matched against the file name, any other
+ * against the path relative to the header directory; '*' also matches '/'.
+ * A file is a header if it matches an include pattern and no exclude pattern.
+ */
+class HeaderFilter {
+public:
+    /// Include patterns when none are given.
+    static const std::vector<std::string>& defaultIncludes();
+
+    /// nullopt with error set if a pattern is malformed.
+    static std::optional<HeaderFilter> create(const std::vector<std::string>& includes,
+                                              const std::vector<std::string>& excludes, std::string& error);
+
+    bool matches(llvm::StringRef relativePath) const;
+
+private:
+    struct Pattern {
+        // GlobPattern refers into its source text, so copies share it.
+        std::shared_ptr<const std::string> text;
+        llvm::GlobPattern glob;
+        bool wholePath;
+    };
+
+    static bool anyMatches(const std::vector<Pattern>& patterns, llvm::StringRef relativePath);
+
+    std::vector<Pattern> includes;
+    std::vector<Pattern> excludes;
+};
+
+/// A header of the old and new version, matched up; one side is empty for an added or removed header.
+struct DiscoveredHeader {
+    std::string oldPath;   // relative to the old header directory
+    std::string newPath;   // relative to the new header directory
+    bool identical = false;
+    // Share of lines in common, for a header found under another path.
+    double similarity = 1.0;
+
+    bool isRenamed() const { return !oldPath.empty() && !newPath.empty() && oldPath != newPath; }
+};
+
+/// Headers directly in (or, if recursive, anywhere under) dir, as sorted '/'-separated relative paths.
+std::vector<std::string> findHeaders(const std::string& dir, const HeaderFilter& filter, bool recursive);
+
+/**
+ * Find the headers of both directories, walking them in parallel, and pair
+ * them up: by path first, then, among the rest, by identical content, then
+ * by the largest share of common lines, at least minSimilarity. A remaining
+ * old header is only scored against new ones whose line count could reach
+ * minSimilarity: those of the same file name and up to 64 others, nearest
+ * in line count first. Contents are hashed on up to jobs threads, so
+ * identical pairs can be skipped without being read again. Sorted by new
+ * path, removed headers by old path.
+ */
+std::vector<DiscoveredHeader> discoverHeaders(const std::string& oldDir, const std::string& newDir,
+                                              const HeaderFilter& filter, bool recursive, unsigned jobs,
+                                              double minSimilarity = 0.5);
+
+/// Share of lines, ignoring indentation and blank lines, that two texts have in common (0 to 1).
+double lineSimilarity(llvm::StringRef text1, llvm::StringRef text2);
+
+} // namespace armor
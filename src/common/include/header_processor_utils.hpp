@@ -7,6 +7,7 @@
 #include <nlohmann/json.hpp>
 
 #include "comm_def.hpp"
+#include "report_generator.hpp"
 
 namespace armor {
 
@@ -20,10 +21,33 @@ std::vector<std::string> resolveInternalIncludePaths(const std::vector<std::stri
 std::vector<std::string> generateIncludePaths(const std::string& projectPath,
                                               const std::string& headerPath);
 
-void emitHeaderDiffReport(const nlohmann::json& diffResult,
+/// Full Clang command line for parsing headerPath of projectPath on its own.
+std::vector<std::string> getHeaderClangFlags(const std::string& projectPath,
+                                             const std::string& headerPath,
+                                             const std::vector<std::string>& includePaths,
+                                             const std::vector<std::string>& macroFlags,
+                                             LANG_OPTIONS lang);
+
+/**
+ * Render the reports for one header straight from the in-memory diff.
+ * The AST diff is written to debug_output/ast_diffs only when dumpAstDiff is set.
+ * Report files are named after file1's path under project1 (see
+ * report_name_for_header) unless reportName is given.
+ */
+HeaderReportSummary emitHeaderDiffReport(const nlohmann::json& diffResult,
                           const std::string& file1,
                           const std::string& project1,
                           const std::string& reportFormat,
-                          PARSER parser);
+                          PARSER parser,
+                          bool dumpAstDiff,
+                          const std::string& reportName = "");
+
+/**
+ * Mark the summary of a header whose beta pass ran over its HeaderBudget as
+ * reported by the alpha parser alone. The alpha pass never diffs the AST, so
+ * compatibility becomes "unknown" and the status NOT_CATEGORIZED, which no
+ * verdict counts as backward compatible. The reports are left to the caller.
+ */
+void markAlphaOnly(HeaderReportSummary& summary);
 
 } // namespace armor
@@ -0,0 +1,97 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace armor {
+
+/// One header compared between the two project versions.
+struct HeaderPair {
+    std::string header;   // as given on the command line or found in --header-dir
+    std::string file1;
+    std::string file2;
+    // The header's text is unchanged but a file it includes changed, so it must be parsed anyway.
+    bool dependenciesChanged = false;
+};
+
+/**
+ * @class HeaderCostModel
+ * @brief Expected processing cost of header pairs, for longest-first scheduling.
+ *
+ * Headers timed by a previous --stats run keep their recorded time. Others
+ * are estimated from the bytes of both versions plus a fixed weight per
+ * #include, scaled to milliseconds by the median time/size ratio of the
+ * timed headers, or left in raw units when there is no history.
+ */
+class HeaderCostModel {
+public:
+    // An #include usually pulls in far more text than its own line.
+    static constexpr uint64_t INCLUDE_WEIGHT_BYTES = 16 * 1024;
+
+    /// Load per-header times from a RunStats JSON file; false if unreadable.
+    bool loadHistory(const std::string& statsPath);
+
+    void addHistory(llvm::StringRef header, double milliseconds);
+
+    /// Costs of pairs, in the order given.
+    std::vector<double> estimate(const std::vector<HeaderPair>& pairs) const;
+
+    /// Bytes of both versions plus INCLUDE_WEIGHT_BYTES per #include; missing files count as empty.
+    static uint64_t sizeCost(const std::string& file1, const std::string& file2);
+
+    static size_t countIncludes(llvm::StringRef source);
+
+private:
+    llvm::StringMap<double> history;
+};
+
+/**
+ * Run task(i) for every index of costs on up to workers threads, most
+ * expensive first.
+ *
+ * Tasks are dealt in descending cost to the worker with the least work so
+ * far. Each worker drains its own deque from the front; once empty it steals
+ * from the back of the deque with the most remaining work, so no worker
+ * idles while another still has a queue. The first exception thrown by a
+ * task is rethrown once all workers have stopped.
+ */
+void runLongestFirst(const std::vector<double>& costs, unsigned workers,
+                     const std::function<void(size_t)>& task);
+
+/// One of count independent runs that together cover the header list (--shard index/count).
+struct ShardSpec {
+    enum class Strategy {
+        Hash,   // by a stable hash of the header name
+        Cost    // greedy cost balancing over the whole list
+    };
+
+    unsigned index = 1;   // 1-based
+    unsigned count = 1;
+    Strategy strategy = Strategy::Hash;
+
+    /// Parse "i/N" with 1 <= i <= N.
+    static std::optional<ShardSpec> parse(llvm::StringRef spec);
+
+    std::string toString() const;
+};
+
+/**
+ * Indices of the pairs that belong to shard, in input order.
+ *
+ * The result only depends on the header names (Hash) or on the names and
+ * costs (Cost), so every shard computes the same partition without sharing
+ * state. Cost plans assign headers longest-first to the least loaded shard,
+ * breaking ties by header name and then by the lowest shard.
+ */
+std::vector<size_t> selectShard(const std::vector<HeaderPair>& pairs, const std::vector<double>& costs,
+                                const ShardSpec& shard);
+
+} // namespace armor
@@ -0,0 +1,100 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+namespace armor {
+
+/**
+ * Search directory options (-I, -isystem, -iquote, -idirafter) of a Clang
+ * command line with "." components and repeated or trailing slashes removed,
+ * a directory already searched in the same way dropped, and directories
+ * that do not exist dropped. Clang would ignore both, but only after
+ * looking them up for every parse. While the shared DirectoryIndex is
+ * enabled, existence is answered by it, so each directory is read once per
+ * run rather than checked for every parse. ".." is kept, as it may follow a
+ * symbolic link, and relative directories are not checked, as they are
+ * resolved against the compilation directory. Other arguments are
+ * returned unchanged.
+ */
+std::vector<std::string> canonicalizeSearchPaths(const std::vector<std::string>& arguments);
+
+/**
+ * @class DirectoryIndex
+ * @brief Entry names of directories, each read once, to fail lookups of absent files without a stat.
+ *
+ * Every #include probes each search directory in turn, so most lookups a
+ * parse makes are for files that do not exist. The index reads a directory
+ * the first time a lookup falls in it and afterwards answers from memory
+ * whether a name is there; a directory known to be missing answers for
+ * everything below it. Existing files are still read from the file system.
+ * Case-insensitive file systems find a file under another case than its
+ * entry, so a name is ruled out only if no entry matches it ignoring ASCII
+ * case, and a name with other characters never is.
+ *
+ * Directories are assumed not to change while the index is enabled: the
+ * instance shared by every parse is enabled only for the length of an
+ * armor run, through Scope.
+ */
+class DirectoryIndex {
+public:
+    explicit DirectoryIndex(llvm::vfs::FileSystem& fileSystem) : fileSystem(fileSystem) {}
+
+    /// Index shared by every parse; its lookups go through getFileSystem().
+    static DirectoryIndex& getInstance();
+
+    /// Enables the shared index, empty, until destroyed.
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    bool isEnabled() const { return enabled; }
+
+    /// True if absolutePath is known not to exist. False if it exists or cannot be ruled out.
+    bool isKnownMissing(llvm::StringRef absolutePath);
+
+    /// True if absolutePath is a directory; its listing is kept for later lookups below it.
+    bool isDirectory(llvm::StringRef absolutePath);
+
+    void clear();
+
+    size_t getListedDirectoryCount() const;
+    size_t getAvoidedLookupCount() const { return avoidedLookups; }
+
+private:
+    struct Directory {
+        enum class State { Unknown, Missing, Listed } state = State::Unknown;
+        llvm::StringSet<> names;
+        // names in ASCII lower case.
+        llvm::StringSet<> foldedNames;
+    };
+
+    bool isMissing(llvm::StringRef path);
+    std::shared_ptr<const Directory> getDirectory(llvm::StringRef path);
+
+    llvm::vfs::FileSystem& fileSystem;
+    std::atomic<bool> enabled{false};
+    std::atomic<size_t> avoidedLookups{0};
+    mutable std::mutex mutex;
+    llvm::StringMap<std::shared_ptr<const Directory>> directories;
+};
+
+/// base, except that lookups index knows to fail return no_such_file_or_directory without reaching it.
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> createIndexedFileSystem(
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base, DirectoryIndex& index);
+
+} // namespace armor
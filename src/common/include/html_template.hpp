@@ -51,3 +51,122 @@ inline const std::string SIMPLE_HEADER =
     "<table>\n";
 
 inline const std::string HTML_FOOTER = "</table></body></html>";
+
+// Consolidated report: the change data is embedded as JSON between the header
+// and the footer, and rendered client-side one page at a time.
+inline const std::string CONSOLIDATED_HTML_HEADER =
+    HTML_STYLE_AND_TITLE
+    "<style>\n"
+    ".pager { margin: 8px 0; }\n"
+    ".pager button { margin: 0 6px; }\n"
+    ".filters { margin: 8px 0; }\n"
+    ".filters > * { margin-right: 12px; }\n"
+    ".header-link { cursor: pointer; color: #1a73e8; }\n"
+    "</style>\n"
+    "<div id=\"summary\" style='margin:12px 0;padding:10px;border:1px solid #ccc;"
+    "border-radius:5px;background:#fafafa;font-size:14px;'></div>\n"
+    "<h3>Headers</h3>\n"
+    "<table id=\"headers\"></table>\n"
+    "<div class=\"pager\" id=\"headers-pager\"></div>\n"
+    "<h3>Changes</h3>\n"
+    "<div class=\"filters\">"
+    "<select id=\"filter-header\"><option value=\"-1\">All headers</option></select>"
+    "<label><input type=\"checkbox\" id=\"filter-incompatible\"> Backward incompatible only</label>"
+    "<input type=\"search\" id=\"filter-text\" placeholder=\"Filter by API name or description\" size=\"40\">"
+    "</div>\n"
+    "<table id=\"changes\"></table>\n"
+    "<div class=\"pager\" id=\"changes-pager\"></div>\n"
+    "<script type=\"application/json\" id=\"armor-data\">";
+
+inline const std::string CONSOLIDATED_HTML_FOOTER = R"html(</script>
+<script>
+(function () {
+  var data = JSON.parse(document.getElementById('armor-data').textContent);
+  var headers = data.headers;   // [name, overall_status, reason, changes, incompatible]
+  var changes = data.changes;   // [header index, api name, description, compatibility changed, incompatible]
+  var PAGE_SIZE = 100;
+
+  function esc(s) {
+    return String(s).replace(/[&<>"']/g, function (c) {
+      return { '&': '&amp;', '<': '&lt;', '>': '&gt;', '"': '&quot;', "'": '&#39;' }[c];
+    });
+  }
+  function compat(incompatible) {
+    return '<span style="color:' + (incompatible ? '#d32f2f' : '#2e7d32') + ';font-weight:600">' +
+           (incompatible ? 'backward_incompatible' : 'backward_compatible') + '</span>';
+  }
+
+  // Only the rows of the current page are ever in the DOM.
+  function pager(table, nav, head, render) {
+    var rows = [], page = 0;
+    function draw() {
+      var pages = Math.max(1, Math.ceil(rows.length / PAGE_SIZE));
+      if (page >= pages) page = pages - 1;
+      var html = head, end = Math.min(rows.length, (page + 1) * PAGE_SIZE);
+      for (var i = page * PAGE_SIZE; i < end; i++) html += render(rows[i]);
+      table.innerHTML = html;
+      nav.innerHTML =
+        '<button data-page="' + (page - 1) + '"' + (page > 0 ? '' : ' disabled') + '>&lsaquo; Prev</button>' +
+        'Page ' + (page + 1) + ' of ' + pages + ' (' + rows.length + ' rows)' +
+        '<button data-page="' + (page + 1) + '"' + (page + 1 < pages ? '' : ' disabled') + '>Next &rsaquo;</button>';
+    }
+    nav.onclick = function (e) {
+      var p = e.target.getAttribute('data-page');
+      if (p !== null) { page = +p; draw(); }
+    };
+    return function (newRows) { rows = newRows; page = 0; draw(); };
+  }
+
+  var totalIncompatible = 0, incompatibleHeaders = 0;
+  headers.forEach(function (h) {
+    totalIncompatible += h[4];
+    if (h[1] === 'BACKWARD_INCOMPATIBLE') incompatibleHeaders++;
+  });
+  document.getElementById('summary').innerHTML =
+    '<b>Headers:</b> ' + headers.length + ' (' + incompatibleHeaders + ' backward incompatible)<br/>' +
+    '<b>Changes:</b> ' + changes.length + ' (' + totalIncompatible + ' backward incompatible)';
+
+  var headerSelect = document.getElementById('filter-header');
+  var options = '';
+  headers.forEach(function (h, i) { options += '<option value="' + i + '">' + esc(h[0]) + '</option>'; });
+  headerSelect.insertAdjacentHTML('beforeend', options);
+
+  var showHeaders = pager(document.getElementById('headers'), document.getElementById('headers-pager'),
+    '<tr><th>Header Name</th><th>Overall Status</th><th>Reason</th><th>Changes</th><th>Backward Incompatible</th></tr>',
+    function (i) {
+      var h = headers[i];
+      return '<tr><td><span class="header-link" data-header="' + i + '">' + esc(h[0]) + '</span></td><td>' +
+             esc(h[1]) + '</td><td>' + esc(h[2]) + '</td><td>' + h[3] + '</td><td>' + h[4] + '</td></tr>';
+    });
+
+  var showChanges = pager(document.getElementById('changes'), document.getElementById('changes-pager'),
+    '<tr><th>Header Name</th><th>API Name</th><th>Description</th><th>Change Type</th><th>Source Compatibility</th></tr>',
+    function (c) {
+      return '<tr><td>' + esc(headers[c[0]][0]) + '</td><td>' + esc(c[1]) + '</td><td>' +
+             esc(c[2]).replace(/\n/g, '<br/>') + '</td><td>' +
+             (c[3] ? 'Compatibility Changed' : 'Functionality Added') + '</td><td>' + compat(c[4]) + '</td></tr>';
+    });
+
+  var incompatibleOnly = document.getElementById('filter-incompatible');
+  var textFilter = document.getElementById('filter-text');
+  function applyFilters() {
+    var header = +headerSelect.value, text = textFilter.value.toLowerCase();
+    showChanges(changes.filter(function (c) {
+      return (header < 0 || c[0] === header) && (!incompatibleOnly.checked || c[4]) &&
+             (!text || c[1].toLowerCase().indexOf(text) >= 0 || c[2].toLowerCase().indexOf(text) >= 0);
+    }));
+  }
+  var pending;
+  textFilter.oninput = function () { clearTimeout(pending); pending = setTimeout(applyFilters, 200); };
+  headerSelect.onchange = applyFilters;
+  incompatibleOnly.onchange = applyFilters;
+  document.getElementById('headers').onclick = function (e) {
+    var i = e.target.getAttribute('data-header');
+    if (i !== null) { headerSelect.value = i; applyFilters(); headerSelect.scrollIntoView(); }
+  };
+
+  showHeaders(headers.map(function (h, i) { return i; }));
+  applyFilters();
+})();
+</script>
+</body></html>)html";
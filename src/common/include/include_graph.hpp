@@ -0,0 +1,101 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+#include "file_content_cache.hpp"
+
+namespace armor {
+
+/// One #include, #include_next or #import directive.
+struct IncludeDirective {
+    std::string name;     // as written between the quotes or angle brackets
+    bool angled = false;
+};
+
+/// Include directives of a file; computed is set if one names a macro instead of a file.
+struct FileIncludes {
+    std::vector<IncludeDirective> directives;
+    bool computed = false;
+};
+
+/// Include directives of source, found without preprocessing; commented-out ones are skipped.
+FileIncludes scanIncludes(llvm::StringRef source);
+
+/**
+ * @class IncludeGraph
+ * @brief Project files included by a set of public headers, in one or more versions of a project.
+ *
+ * Files are keyed by their project-relative path, so the graphs of both
+ * versions are merged: an edge found in either counts. Directives are found
+ * without preprocessing, so includes in inactive conditional blocks count
+ * too, and a name is linked to every project file it could resolve to (the
+ * including file's directory for quoted names, the -I paths, and every
+ * directory from a public header up to the project root). The graph can
+ * thus have edges the compiler never takes, but misses none.
+ *
+ * Scan results are keyed by content hash and kept in a cache file, so files
+ * unchanged since the last run, or between the two versions, are not scanned
+ * again. Hashes come from FileContentCache, so files already hashed by
+ * header discovery are not even read.
+ */
+class IncludeGraph {
+public:
+    static constexpr const char* CACHE_PATH = "armor_reports/armor_include_cache.json";
+
+    explicit IncludeGraph(std::vector<std::string> includePaths) : includePaths(std::move(includePaths)) {}
+
+    bool loadCache(const std::string& path);
+    /// Write the scan results used by this graph only, so the cache does not grow without bound.
+    bool saveCache(const std::string& path) const;
+
+    /// Add a public header (relative to projectRoot) of one version of the project.
+    void addHeader(const std::string& projectRoot, const std::string& header);
+
+    /// Scan every added header and the project files they reach.
+    void build();
+
+    /// Project files a file includes directly, in any version.
+    std::vector<std::string> getIncludes(llvm::StringRef file) const;
+
+    /// Every file reached from the public headers.
+    std::vector<std::string> getFiles() const;
+
+    /**
+     * Public headers that are, or transitively include, one of changed
+     * (project-relative paths). Headers reaching a computed include are
+     * always returned, since its target is unknown.
+     */
+    std::vector<std::string> getAffectedHeaders(const std::vector<std::string>& changed) const;
+
+    size_t getScannedFileCount() const { return scannedFiles; }
+
+private:
+    // Resolve include of file in projectRoot to every existing candidate.
+    void resolve(const std::string& projectRoot, const std::string& file, const IncludeDirective& include,
+                 std::vector<std::string>& targets) const;
+    FileIncludes scan(const std::string& path);
+
+    std::vector<std::string> includePaths;
+    std::vector<std::pair<std::string, std::string>> roots;   // project root, public header
+    llvm::StringSet<> headers;
+    // Project-relative directories searched for every file, from the public headers' locations.
+    std::vector<std::string> headerDirs;
+
+    llvm::StringMap<llvm::StringSet<>> edges;
+    llvm::StringSet<> computedFiles;
+
+    FileContentCache contentCache;
+    llvm::DenseMap<uint64_t, FileIncludes> cache;
+    llvm::DenseSet<uint64_t> usedHashes;
+    size_t scannedFiles = 0;
+};
+
+} // namespace armor
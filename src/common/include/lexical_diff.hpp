@@ -0,0 +1,35 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <optional>
+#include <string>
+#include "llvm/Support/MemoryBufferRef.h"
+
+#include "comm_def.hpp"
+#include "diff_utils.hpp"
+
+namespace armor {
+
+/**
+ * Classify a header change from a raw lex of both versions, without
+ * preprocessing or parsing.
+ *
+ * Returns COMMENTS_UPDATED or NON_FUNCTIONAL_CHANGES when the token streams
+ * are identical and the beta parser is guaranteed to reach the same verdict.
+ * Returns std::nullopt whenever a full parse is needed, including:
+ *  - any token changed
+ *  - a line break moved in or out of a preprocessor directive
+ *  - a comment changed inside a conditional block other than the include
+ *    guard, because that block may be inactive
+ */
+std::optional<ParsedDiffStatus> classifyLexicalChange(const std::string& file1,
+                                                      const std::string& file2,
+                                                      LANG_OPTIONS lang);
+
+/// Same as above, on buffers the caller already holds. Both must be null-terminated.
+std::optional<ParsedDiffStatus> classifyLexicalChange(llvm::MemoryBufferRef buffer1,
+                                                      llvm::MemoryBufferRef buffer2,
+                                                      LANG_OPTIONS lang);
+
+} // namespace armor
@@ -104,11 +104,38 @@ enum class ConsoleOption{
         externalSink = sink;
     }
 
+    // Keep stdout free for machine-readable output, e.g. NDJSON on "-".
+    void setConsoleInfoToStderr(bool enable) {
+        consoleInfoToStderr.store(enable, std::memory_order_relaxed);
+    }
+
+    llvm::raw_ostream& consoleInfoStream() const {
+        return consoleInfoToStderr.load(std::memory_order_relaxed) ? llvm::errs() : llvm::outs();
+    }
+
     llvm::raw_ostream* getSink() const {
         std::scoped_lock<std::mutex> lock(mutex);
         return externalSink ? externalSink : activeStream;
     }
 
+    // Append text produced outside the log streams, e.g. buffered Clang diagnostics.
+    void writeToSink(llvm::StringRef text) const {
+        if (text.empty()) return;
+        std::scoped_lock<std::mutex> lock(mutex);
+        llvm::raw_ostream* out = externalSink ? externalSink : activeStream;
+        *out << text;
+        out->flush();
+    }
+
+    // Write text to the console info stream at once, so lines of concurrent callers never mix.
+    void writeToConsole(llvm::StringRef text) const {
+        if (text.empty()) return;
+        std::scoped_lock<std::mutex> lock(mutex);
+        llvm::raw_ostream& console = consoleInfoStream();
+        console << text;
+        console.flush();
+    }
+
     LogStream getStream(Level lvl) const;
 
     LogStream getConsoleAndStream(Level lvl, ConsoleOption consoleOption) const;
@@ -157,6 +184,7 @@ private:
     mutable std::mutex mutex;
     std::atomic<Level> logLevel;
     std::atomic<bool> isInitialized;
+    std::atomic<bool> consoleInfoToStderr{false};
     std::unique_ptr<llvm::raw_fd_ostream> fileStream;
     llvm::raw_ostream* activeStream;
     #ifdef TESTING_ENABLED
@@ -285,10 +313,12 @@ public:
             }
             if(shouldLogToConsole){
                 switch (consoleOption) {
-                    case DebugConfig::ConsoleOption::INFO:
-                        llvm::outs() << consoleBufferStorage;
-                        llvm::outs().flush();
+                    case DebugConfig::ConsoleOption::INFO: {
+                        llvm::raw_ostream& console = config.consoleInfoStream();
+                        console << consoleBufferStorage;
+                        console.flush();
                         break;
+                    }
                     case DebugConfig::ConsoleOption::ERROR:
                         llvm::errs() << consoleBufferStorage;
                         llvm::errs().flush();
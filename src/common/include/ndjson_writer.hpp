@@ -0,0 +1,40 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <memory>
+#include <string>
+#include "llvm/Support/raw_ostream.h"
+#include "report_generator.hpp"
+
+namespace armor {
+
+/**
+ * @class NdjsonWriter
+ * @brief Streams report results as newline-delimited JSON.
+ *
+ * Each header produces one compact "change" line per grouped API change,
+ * followed by one "header" summary line. The stream is flushed after every
+ * header so consumers can process results while the run continues.
+ */
+class NdjsonWriter {
+public:
+    static constexpr const char* DEFAULT_PATH = "armor_reports/armor_report.ndjson";
+
+    NdjsonWriter() = default;
+
+    /// Open path for writing, truncating it; "-" selects stdout.
+    bool open(const std::string& path);
+
+    bool isOpen() const;
+    bool writesToStdout() const;
+
+    /// Emit the change lines and the summary line of one header.
+    void writeHeader(const std::string& header, const HeaderReportSummary& summary);
+
+private:
+    std::unique_ptr<llvm::raw_fd_ostream> file;
+    llvm::raw_ostream* out = nullptr;
+};
+
+} // namespace armor
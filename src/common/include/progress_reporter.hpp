@@ -0,0 +1,99 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "llvm/Support/raw_ostream.h"
+
+namespace armor {
+
+/**
+ * @class ProgressReporter
+ * @brief Headers done and remaining, throughput and ETA for batch runs.
+ *
+ * On a terminal it keeps one status line updated on stderr; otherwise it
+ * emits a JSON "progress" record per interval, so a run never goes quiet
+ * for longer than that even while a single header takes minutes.
+ * The ETA is the remaining count times the mean of the last
+ * AVERAGE_WINDOW header durations, divided by the most headers seen
+ * running at once, as that many workers share what remains. Headers may
+ * run concurrently; the one running longest is shown.
+ */
+class ProgressReporter {
+public:
+    enum class Mode { Off, Line, Records };
+
+    static constexpr size_t AVERAGE_WINDOW = 20;
+    static constexpr std::chrono::seconds LINE_INTERVAL{1};
+    static constexpr std::chrono::seconds RECORD_INTERVAL{10};
+
+    struct Snapshot {
+        size_t done = 0;
+        size_t total = 0;
+        double elapsedSeconds = 0;
+        double headersPerSecond = 0;
+        double etaSeconds = -1;        // negative until a header has finished
+        size_t running = 0;
+        std::string current;           // longest-running header, empty if none
+        double currentSeconds = 0;
+    };
+
+    explicit ProgressReporter(llvm::raw_ostream& os = llvm::errs());
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    /// Line when stderr is a terminal, Records otherwise.
+    static Mode detectMode();
+
+    void enable(Mode mode);
+    bool isEnabled() const;
+
+    /// Begin a batch of total headers; may be called once per run.
+    void start(size_t total);
+    void headerStarted(const std::string& header);
+    /// Ignored if header is not running, so it may be called more than once.
+    void headerFinished(const std::string& header);
+    /// Emit the final state and stop the heartbeat.
+    void finish();
+
+    Snapshot snapshot() const;
+
+    static std::string formatLine(const Snapshot& snapshot, size_t width);
+    static std::string formatRecord(const Snapshot& snapshot);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Snapshot snapshotLocked() const;
+    void emitLocked(bool final);
+    void clearLineLocked();
+    void heartbeat();
+
+    llvm::raw_ostream& os;
+    Mode mode = Mode::Off;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread heartbeatThread;
+    bool stopping = false;
+    bool lineShown = false;
+
+    Clock::time_point runStart;
+    size_t total = 0;
+    size_t done = 0;
+    std::vector<std::pair<std::string, Clock::time_point>> running;   // in start order
+    size_t workers = 0;                                                 // most headers running at once
+    std::deque<double> recentSeconds;
+};
+
+} // namespace armor
@@ -0,0 +1,45 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace armor {
+
+/**
+ * @class ReportBuffer
+ * @brief In-memory report text, written to disk with a single write.
+ */
+class ReportBuffer {
+public:
+    explicit ReportBuffer(size_t expectedSize) { data.reserve(expectedSize); }
+
+    ReportBuffer& operator<<(std::string_view s) {
+        data.append(s.data(), s.size());
+        return *this;
+    }
+
+    ReportBuffer& operator<<(size_t value) {
+        data += std::to_string(value);
+        return *this;
+    }
+
+    /// HTML-escape for table cells, with '\n' turned into <br/>.
+    void appendHtml(std::string_view s);
+
+    /**
+     * Quoted JSON string, escaped the way nlohmann::json::dump() does.
+     * With forScript set, '<' is also escaped so the text can sit inside a
+     * <script> element.
+     */
+    void appendJsonString(std::string_view s, bool forScript = false);
+
+    bool writeTo(const std::string& path) const;
+
+private:
+    std::string data;
+};
+
+} // namespace armor
@@ -3,12 +3,34 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
 #include "comm_def.hpp"
+#include "report_utils.hpp"
 
-void report_generator(const std::string& diff_json_path,
+/**
+ * @brief Per-header outcome of report generation.
+ *
+ * Carries what callers need after a header has been reported (e.g. the
+ * git-mode console summary) so they do not have to re-read the JSON report.
+ */
+struct HeaderReportSummary {
+    std::string compatibility = "unknown";
+    std::string overallStatus;
+    std::string reason;
+    std::vector<std::string> incompatibleChanges;   // first description line per incompatible API
+    std::vector<ApiChangeGroup> changes;            // grouped rows of the report
+    // Inputs of the rendered report, so it can be rewritten from the summary.
+    PARSER parser = NO_PARSER;
+    int parsedStatus = 0;
+    int unparsedStatus = 0;
+    std::string degradation;                        // "alpha_only" or "token_level" when a budget cut processing short
+};
+
+HeaderReportSummary report_generator(const nlohmann::json& diff_root,
                           const std::string& header_file_path,
                           const std::string& output_html_path,
                           const std::string& output_json_path,
                           PARSER parser,
                           bool generate_json = false
-                        );
\ No newline at end of file
+                        );
@@ -9,30 +9,61 @@
 
 using json = nlohmann::json;
 
+/**
+ * @brief One atomic API change, as produced by preprocess_api_changes().
+ */
+struct ApiChangeRecord {
+    std::string headerfile;
+    std::string name;                   // API name
+    std::string description;            // human-readable detail
+    bool compatibilityChanged = true;   // "Compatibility_changed", else "Functionality_changed"
+    bool backwardIncompatible = false;
+};
+
+/**
+ * @brief All changes of one API, rendered as a single report row.
+ */
+struct ApiChangeGroup {
+    std::string headerfile;
+    std::string name;
+    std::string description;            // newline-joined descriptions of the records
+    bool compatibilityChanged = false;  // any record changed compatibility
+    bool backwardIncompatible = false;  // any record is backward incompatible
+
+    const char* changeType() const {
+        return compatibilityChanged ? "Compatibility Changed" : "Functionality Added";
+    }
+    const char* compatibility() const {
+        return backwardIncompatible ? "backward_incompatible" : "backward_compatible";
+    }
+};
+
 /**
  * @brief Preprocess API differences into a normalized list of change records.
  *
  * @param api_differences JSON array describing API changes (diff tree).
  * @param header_file_path Path to the header file being analyzed.
- * @return std::vector<json> Each element contains:
- *         {
- *           "headerfile": <string>,
- *           "name": <API name>,
- *           "description": <human-readable detail>,
- *           "changetype": "Functionality_changed" | "Compatibility_changed",
- *           "compatibility": "backward_compatible" | "backward_incompatible"
- *         }
+ * @return std::vector<ApiChangeRecord> One record per atomic change.
+ */
+std::vector<ApiChangeRecord> preprocess_api_changes(const json& api_differences,
+                                                    const std::string& header_file_path);
+
+/**
+ * @brief Group processed change records by (headerfile, name) so each API has
+ *        a single, newline-joined description and an aggregated compatibility.
+ *
+ * @param processed_data Records from preprocess_api_changes().
+ * @return std::vector<ApiChangeGroup> One group per API, ordered by (headerfile, name).
  */
-std::vector<json> preprocess_api_changes(const json& api_differences,
-                                         const std::string& header_file_path);
+std::vector<ApiChangeGroup> group_api_changes(const std::vector<ApiChangeRecord>& processed_data);
 
 /**
- * @brief Generate an HTML report from processed API changes.
+ * @brief Generate an HTML report from grouped API changes.
  *
- * @param processed_data Vector of JSON records from preprocess_api_changes().
+ * @param grouped Groups from group_api_changes().
  * @param output_html_path Path to write the HTML file.
  */
-void generate_html_report(const std::vector<json>& processed_data,
+void generate_html_report(const std::vector<ApiChangeGroup>& grouped,
                           const std::string& output_html_path,
                           PARSER parser,
                           int parsed_status,
@@ -58,12 +89,34 @@ void generate_html_report(const std::vector<json>& processed_data,
 std::pair<std::string, std::string> prepare_report_output_dirs(const std::string& headerName);
 
 /**
- * @brief Generate a JSON report from processed API changes.
+ * @brief Name of the reports of a header: its path relative to projectRoot
+ *        with directory separators replaced by '_'.
+ *
+ * Headers with the same file name in different directories thus get their
+ * own reports ("a/config.h" -> "a_config.h"). A file that is not below
+ * projectRoot is named after its file name alone.
+ *
+ * @param file         Path of the header in one version.
+ * @param projectRoot  Project root of that version.
+ */
+std::string report_name_for_header(const std::string& file, const std::string& projectRoot);
+
+/**
+ * @brief Create the directories a report file will be written in, if missing.
+ *
+ * Failures are left for the write of the report itself to surface.
+ *
+ * @param path  Path of the report file (e.g. "armor_reports/armor_baselines.json").
+ */
+void create_parent_dirs(const std::string& path);
+
+/**
+ * @brief Generate a JSON report from grouped API changes.
  *
- * @param processed_data Vector of JSON records from preprocess_api_changes().
+ * @param grouped Groups from group_api_changes().
  * @param output_json_path Path to write the JSON file.
  */
-void generate_json_report(const std::vector<json>& processed_data,
+void generate_json_report(const std::vector<ApiChangeGroup>& grouped,
                           const std::string& output_json_path,
                           int parsed_status,
                           int unparsed_status,
@@ -71,3 +124,17 @@ void generate_json_report(const std::vector<json>& processed_data,
                           const char* overall_status,
                           const char* reason);
 
+/**
+ * @brief Render the HTML report and, unless output_json_path is empty, the
+ *        JSON report in a single pass over the groups.
+ */
+void generate_reports(const std::vector<ApiChangeGroup>& grouped,
+                      const std::string& output_html_path,
+                      const std::string& output_json_path,
+                      PARSER parser,
+                      int parsed_status,
+                      int unparsed_status,
+                      const std::string& agg_compatibility,
+                      const char* overall_status,
+                      const char* reason);
+
@@ -0,0 +1,121 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "llvm/Support/raw_ostream.h"
+
+namespace armor {
+
+enum class StatCounter : size_t {
+    DeclsVisited,
+    DeclsKept,           // passed IsDeclFromMainFileAndNotLocal
+    ApiNodesBuilt,
+    UnhandledHashes,
+    TypeStrings,
+    DiffNodesCompared,
+    ReportBytes,
+    Count
+};
+
+/**
+ * @class RunStats
+ * @brief Per-header counters and stage times, and the process's peak RSS, for --stats.
+ *
+ * Counters accumulate into the header the calling thread opened with
+ * beginHeader(), so headers processed in parallel are kept apart; counts
+ * made outside any header only show in the run total.
+ * Peak RSS is process-wide and never decreases, so it is reported once per
+ * run rather than per header.
+ * When disabled, count() is a single relaxed atomic load.
+ */
+class RunStats {
+public:
+    static constexpr const char* DEFAULT_PATH = "armor_reports/armor_stats.json";
+    static constexpr size_t COUNTER_COUNT = static_cast<size_t>(StatCounter::Count);
+
+    struct HeaderStats {
+        std::string header;
+        std::array<uint64_t, COUNTER_COUNT> counters{};
+        // Summed span time per stage, in order of first appearance.
+        std::vector<std::pair<const char*, uint64_t>> stageUs;
+    };
+
+    static RunStats& getInstance() {
+        static RunStats inst;
+        return inst;
+    }
+
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    static void count(StatCounter counter, uint64_t amount = 1) {
+        if (!isEnabled()) return;
+        size_t index = static_cast<size_t>(counter);
+        if (threadHeader) threadHeader->counters[index] += amount;
+        else getInstance().counters[index].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    void enable();
+
+    /// Open header on the calling thread.
+    void beginHeader(const std::string& header);
+    /// Close the calling thread's header.
+    void endHeader();
+
+    /// Add a finished span's duration to its stage; stage must be a string literal.
+    void addStageTime(const char* stage, uint64_t durationUs);
+
+    /// Finished headers plus a "(total)" entry covering the whole run.
+    std::vector<HeaderStats> collect();
+
+    void print(llvm::raw_ostream& os);
+    bool writeJson(const std::string& path);
+
+    static const char* counterName(StatCounter counter);
+    /// Peak resident memory of the whole process so far.
+    static uint64_t peakRssBytes();
+
+private:
+    RunStats() = default;
+    RunStats(const RunStats&) = delete;
+    RunStats& operator=(const RunStats&) = delete;
+
+    static inline std::atomic<bool> enabled{false};
+    static inline thread_local std::unique_ptr<HeaderStats> threadHeader;
+
+    // Counts made outside any header.
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+    std::mutex mutex;
+    std::vector<HeaderStats> headers;
+    HeaderStats unattributed;
+};
+
+/**
+ * @class HeaderStatsScope
+ * @brief Opens a RunStats header for the lifetime of the scope.
+ */
+class HeaderStatsScope {
+public:
+    explicit HeaderStatsScope(const std::string& header) {
+        if (RunStats::isEnabled()) RunStats::getInstance().beginHeader(header);
+    }
+
+    ~HeaderStatsScope() {
+        if (RunStats::isEnabled()) RunStats::getInstance().endHeader();
+    }
+
+    HeaderStatsScope(const HeaderStatsScope&) = delete;
+    HeaderStatsScope& operator=(const HeaderStatsScope&) = delete;
+};
+
+} // namespace armor
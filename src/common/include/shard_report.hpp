@@ -0,0 +1,61 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <string>
+#include <vector>
+#include "report_generator.hpp"
+
+namespace armor {
+
+/**
+ * @class ShardSummary
+ * @brief Machine-readable result of every header of one run or shard.
+ *
+ * A --shard run writes this next to its per-header reports so that
+ * `armor merge-reports` can rebuild the combined outputs without access to
+ * the sources. The file also carries the verdict over all its headers.
+ */
+class ShardSummary {
+public:
+    static constexpr const char* FILE_NAME = "armor_summary.json";
+    static constexpr const char* DEFAULT_PATH = "armor_reports/armor_summary.json";
+
+    struct Entry {
+        std::string header;
+        HeaderReportSummary summary;
+    };
+
+    void setShard(const std::string& spec) { shard = spec; }
+    const std::string& getShard() const { return shard; }
+
+    void addHeader(const std::string& header, const HeaderReportSummary& summary);
+
+    const std::vector<Entry>& getEntries() const { return entries; }
+
+    /// True when every header is backward compatible.
+    bool isBackwardCompatible() const;
+
+    bool write(const std::string& path) const;
+
+    /// Replace the contents with the summary stored at path; false if missing or malformed.
+    bool read(const std::string& path);
+
+private:
+    std::string shard;
+    std::vector<Entry> entries;
+};
+
+/**
+ * Combine the armor_reports directories of several shard runs into outDir.
+ *
+ * Per-header JSON and HTML reports are copied, and the summary, NDJSON
+ * stream and consolidated HTML report are rebuilt over all headers, sorted
+ * by header. Inconsistent shard specs, missing shards and headers reported
+ * by more than one shard are warned about; the first report of a header wins.
+ * Returns false if a shard summary cannot be read or an output cannot be written.
+ */
+bool mergeShardReports(const std::vector<std::string>& shardDirs, const std::string& outDir,
+                       ShardSummary& merged);
+
+} // namespace armor
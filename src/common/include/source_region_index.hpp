@@ -0,0 +1,65 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "llvm/ADT/ArrayRef.h"
+
+namespace armor {
+
+/**
+ * @struct SourceRegion
+ * @brief A main-file byte range that is not part of any handled decl.
+ */
+struct SourceRegion {
+    enum class Kind : uint8_t {
+        Comment,
+        Directive,      // active preprocessor directive line
+        InactiveBlock   // range skipped by a false conditional
+    };
+
+    unsigned startOffset;
+    unsigned endOffset;
+    uint64_t hash;
+    Kind kind;
+    bool inInactiveBlock;   // comments only: lies inside a kept InactiveBlock
+
+    bool isDirective() const { return kind != Kind::Comment; }
+    bool contains(const SourceRegion& other) const {
+        return startOffset <= other.startOffset && other.endOffset <= endOffset;
+    }
+};
+
+/**
+ * @class SourceRegionIndex
+ * @brief Flat, offset-sorted index of comments, directives and inactive blocks of one main file.
+ *
+ * Regions are appended in callback order while the file is parsed. classify()
+ * then sorts them once and, in a single sweep:
+ *  - drops directives nested in an enclosing directive or inactive block
+ *    (e.g. the #if/#endif lines of a skipped block), and
+ *  - flags comments that lie inside a kept inactive block.
+ */
+class SourceRegionIndex {
+public:
+    SourceRegionIndex() = default;
+
+    void addComment(unsigned startOffset, unsigned endOffset, uint64_t hash);
+    void addDirective(unsigned startOffset, unsigned endOffset, bool isActive);
+
+    void classify();
+    bool isClassified() const;
+
+    llvm::ArrayRef<SourceRegion> getRegions() const;
+    llvm::MutableArrayRef<SourceRegion> getRegions();
+
+    void clear();
+    bool empty() const;
+
+private:
+    std::vector<SourceRegion> regions;
+    bool classified = false;
+};
+
+} // namespace armor
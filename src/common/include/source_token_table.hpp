@@ -0,0 +1,64 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "llvm/ADT/ArrayRef.h"
+
+namespace clang {
+    class SourceManager;
+}
+
+namespace armor {
+
+/**
+ * @class SourceTokenTable
+ * @brief Offsets of every raw token in the main file, lexed once per translation unit.
+ *
+ * Range hashing used to re-lex the main file token by token for every decl,
+ * statement and directive range, so nested ranges were lexed repeatedly. The
+ * table is built with a single raw lex of the main-file buffer and lets
+ * FibonacciHash locate the tokens of any range with a binary search.
+ */
+class SourceTokenTable {
+public:
+    struct Token {
+        unsigned startOffset;
+        unsigned endOffset;
+        bool isComment;
+    };
+
+    SourceTokenTable() = default;
+
+    /**
+     * Raw-lex the main file of SM (comments retained) and record every token.
+     */
+    void build(const clang::SourceManager& SM);
+
+    /**
+     * True if the table was built from the main-file buffer currently held by SM.
+     */
+    bool covers(const clang::SourceManager& SM) const;
+
+    /**
+     * Tokens starting inside [startOffset, endOffset), in file order.
+     *
+     * Returns false when startOffset falls in the middle of a token; re-lexing
+     * from such an offset yields different tokens, so callers must fall back
+     * to lexing the range directly.
+     */
+    bool tokensInRange(unsigned startOffset, unsigned endOffset,
+                       llvm::ArrayRef<Token>& result) const;
+
+    bool empty() const;
+    void clear();
+
+private:
+    std::vector<Token> tokens;
+    const clang::SourceManager* sourceManager = nullptr;
+    const char* bufferStart = nullptr;
+    size_t bufferSize = 0;
+};
+
+} // namespace armor
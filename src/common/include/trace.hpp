@@ -0,0 +1,97 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringRef.h"
+
+namespace armor {
+
+/**
+ * @class Tracer
+ * @brief Records phase spans and writes them as Chrome trace-event JSON,
+ *        loadable in chrome://tracing or Perfetto.
+ *
+ * Tracing is off unless enable() is called; with neither tracing nor
+ * RunStats enabled a TraceScope costs two atomic loads.
+ */
+class Tracer {
+public:
+    static Tracer& getInstance() {
+        static Tracer inst;
+        return inst;
+    }
+
+    /**
+     * Start recording. With includeClang, Clang's frontend time-trace is
+     * turned on for this thread and its events are merged into the output.
+     */
+    void enable(bool includeClang);
+
+    bool isEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Start Clang's time-trace on a worker thread; a no-op unless enabled with includeClang.
+    void attachThread();
+    /// Hand a worker thread's Clang events back before the thread exits.
+    void detachThread();
+
+    /// Write every recorded span; returns false if the file cannot be written.
+    bool write(const std::string& path);
+
+private:
+    friend class TraceScope;
+
+    struct Event {
+        const char* name;
+        const char* category;
+        std::string detail;
+        uint64_t startUs;
+        uint64_t durationUs;
+        uint64_t threadId;
+    };
+
+    Tracer() = default;
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    uint64_t sinceStartUs(std::chrono::steady_clock::time_point time) const;
+    void record(Event event);
+
+    std::atomic<bool> enabled{false};
+    std::atomic<bool> clangTrace{false};
+    std::chrono::steady_clock::time_point start;
+    std::mutex mutex;
+    std::vector<Event> events;
+};
+
+/**
+ * @class TraceScope
+ * @brief RAII span; name and category must be string literals.
+ *
+ * Also feeds the span's duration to RunStats as the stage time of name.
+ */
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category, llvm::StringRef detail = "");
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    const char* category;
+    std::string detail;
+    std::chrono::steady_clock::time_point begin;
+    bool traced;
+    bool timed;
+};
+
+} // namespace armor
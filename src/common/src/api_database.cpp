@@ -0,0 +1,1054 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "api_database.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <sys/file.h>
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+#include "api_snapshot.hpp"
+
+namespace {
+
+constexpr char MAGIC[8] = {'A', 'R', 'M', 'O', 'R', 'A', 'P', 'I'};
+constexpr char INDEX_MAGIC[8] = {'A', 'R', 'M', 'O', 'R', 'I', 'D', 'X'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32_t NO_ID = ~0u;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+};
+
+enum BlockKind : uint32_t {
+    StringBlock = 1,
+    NodeBlock,
+    ReleaseBlock,
+    HeaderBlock,
+    IndexBlock
+};
+
+struct BlockHeader {
+    uint32_t kind;
+    uint32_t size;
+};
+
+// Followed by childCount child ids and hashCount statement hashes.
+struct NodeFields {
+    uint32_t qualifiedName;
+    uint32_t dataType;
+    uint32_t canonicalType;
+    uint32_t usr;
+    uint32_t nsr;
+    uint16_t flags;
+    uint8_t kind;
+    uint8_t access;
+    uint8_t storage;
+    uint8_t virtualQualifier;
+    uint8_t padding[2];
+    uint32_t childCount;
+    uint32_t hashCount;
+};
+
+// Followed by the roots, (USR, node) pairs, unsupported USRs and the three hash tables.
+struct HeaderFields {
+    uint32_t release;
+    uint32_t header;
+    uint32_t rootCount;
+    uint32_t usrCount;
+    uint32_t unsupportedCount;
+    uint32_t commentCount;
+    uint32_t unhandledCount;
+    uint32_t inactiveCount;
+};
+
+struct HashRecord {
+    uint64_t hash;
+    int64_t count;
+};
+
+// Followed by the tables, in the order of the fields.
+struct IndexFields {
+    uint64_t previous;
+    uint32_t firstString;
+    uint32_t stringCount;
+    uint32_t firstNode;
+    uint32_t nodeCount;
+    uint32_t firstRelease;
+    uint32_t releaseCount;
+    uint32_t firstSequence;
+    uint32_t headerCount;
+    uint32_t occurrenceCount;
+    uint32_t nameCount;
+};
+
+struct BlockRecord {
+    uint64_t offset;
+    uint32_t size;
+    uint32_t padding;
+};
+
+// Content hash of a string or node to its id; tables are sorted by hash.
+struct KeyRecord {
+    uint64_t hash;
+    uint32_t id;
+    uint32_t padding;
+};
+
+struct HeaderRecord {
+    uint32_t release;
+    uint32_t name;
+    BlockRecord block;
+};
+
+// Interned qualified name to a USR declared with it; tables are sorted.
+struct NameRecord {
+    uint32_t name;
+    uint32_t usr;
+};
+
+// Written right after each index block, so the newest one is found from the end of the file.
+struct Trailer {
+    uint64_t index;
+    char magic[8];
+};
+
+static_assert(sizeof(FileHeader) == 16 && sizeof(BlockHeader) == 8, "database headers are fixed size");
+static_assert(sizeof(NodeFields) == 36 && sizeof(HeaderFields) == 32, "database records are fixed size");
+static_assert(sizeof(IndexFields) == 48 && sizeof(BlockRecord) == 16 && sizeof(KeyRecord) == 16 &&
+                  sizeof(HeaderRecord) == 24 && sizeof(NameRecord) == 8 && sizeof(Trailer) == 16,
+              "index records are fixed size");
+
+template <typename T>
+void put(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Reads fixed-size values from a payload, failing once it runs past the end.
+class PayloadReader {
+public:
+    explicit PayloadReader(llvm::StringRef data) : data(data) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (data.size() - position < sizeof(T)) return false;
+        std::memcpy(&value, data.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+private:
+    llvm::StringRef data;
+    size_t position = 0;
+};
+
+// Hash tables sorted by hash so that equal tables serialize identically.
+void putHashTable(std::string& out, const llvm::DenseMap<uint64_t, int>& map) {
+    std::vector<HashRecord> records;
+    records.reserve(map.size());
+    for (const auto& [hash, count] : map) records.push_back({hash, count});
+    std::sort(records.begin(), records.end(),
+              [](const HashRecord& lhs, const HashRecord& rhs) { return lhs.hash < rhs.hash; });
+    for (const HashRecord& record : records) put(out, record);
+}
+
+// Record i of a table at offset of data; offsets are checked when the index is loaded.
+template <typename T>
+T record(llvm::StringRef data, uint64_t offset, size_t i = 0) {
+    T value;
+    std::memcpy(&value, data.data() + offset + i * sizeof(T), sizeof(T));
+    return value;
+}
+
+// First i in [0, count) for which before(i) is false.
+size_t partitionPoint(size_t count, llvm::function_ref<bool(size_t)> before) {
+    size_t low = 0;
+    while (count > 0) {
+        size_t half = count / 2;
+        if (before(low + half)) {
+            low += half + 1;
+            count -= half + 1;
+        }
+        else {
+            count = half;
+        }
+    }
+    return low;
+}
+
+// First id of a key table with hash for which match holds, or NO_ID.
+uint32_t findKey(llvm::StringRef data, uint64_t keys, uint32_t count, uint64_t hash,
+                 llvm::function_ref<bool(uint32_t)> match) {
+    for (size_t i = partitionPoint(count, [&](size_t i) { return record<KeyRecord>(data, keys, i).hash < hash; });
+         i < count; ++i) {
+        KeyRecord key = record<KeyRecord>(data, keys, i);
+        if (key.hash != hash) break;
+        if (match(key.id)) return key.id;
+    }
+    return NO_ID;
+}
+
+bool readHashTable(PayloadReader& reader, uint32_t count, llvm::DenseMap<uint64_t, int>& map) {
+    map.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        HashRecord record;
+        if (!reader.get(record)) return false;
+        map[record.hash] = static_cast<int>(record.count);
+    }
+    return true;
+}
+
+} // namespace
+
+struct armor::APIDatabase::HeaderEntry {
+    HeaderFields fields;
+    std::vector<uint32_t> roots;
+    std::vector<std::pair<uint32_t, uint32_t>> usrs;
+    std::vector<uint32_t> unsupported;
+    llvm::DenseMap<uint64_t, int> comments;
+    llvm::DenseMap<uint64_t, int> unhandled;
+    llvm::DenseMap<uint64_t, int> inactive;
+};
+
+armor::APIDatabase::~APIDatabase() {
+    unlock();
+}
+
+bool armor::APIDatabase::open(const std::string& dbPath, std::string& error) {
+    unlock();
+    path = dbPath;
+    return load(error);
+}
+
+bool armor::APIDatabase::load(std::string& error) {
+    mapped.reset();
+    pending.clear();
+    fileSize = 0;
+    levels.clear();
+    indexedStrings = 0;
+    indexedNodes = 0;
+    indexedReleases = 0;
+    addedStrings.clear();
+    addedStringIds.clear();
+    addedNodes.clear();
+    addedNodeIds.clear();
+    addedHeaders.clear();
+    symbolIndex.clear();
+    usrsByName.clear();
+    releases.clear();
+    releaseIndex.clear();
+    headerSequence = 0;
+
+    // An empty file is one a writer has just created.
+    std::error_code sizeEc;
+    if (!std::filesystem::exists(path) || std::filesystem::file_size(path, sizeEc) == 0) {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        put(pending, header);
+        return true;
+    }
+
+    if (!mapFile(error)) return false;
+    if (fileSize == sizeof(FileHeader) || loadIndex()) return true;
+    // The last commit is incomplete: a writer is still appending it, or was interrupted.
+    return recover(error);
+}
+
+bool armor::APIDatabase::mapFile(std::string& error) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+        llvm::MemoryBuffer::getFile(path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!buffer) {
+        error = buffer.getError().message();
+        return false;
+    }
+    mapped = std::move(*buffer);
+    fileSize = mapped->getBufferSize();
+
+    llvm::StringRef data = mapped->getBuffer();
+    if (data.size() < sizeof(FileHeader) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        error = "not an armor API database";
+        return false;
+    }
+    FileHeader header = record<FileHeader>(data, 0);
+    if (header.byteOrder != BYTE_ORDER_MARK || header.version != VERSION) {
+        error = "database version " + std::to_string(header.version) + " or byte order not supported";
+        return false;
+    }
+    return true;
+}
+
+// Follows the trailer at the end of the file through the chain of index
+// blocks, checking that their tables fit and their id ranges adjoin, then
+// reads the releases and header entries. False if any of it does not hold.
+bool armor::APIDatabase::loadIndex() {
+    llvm::StringRef data = mapped->getBuffer();
+    if (data.size() < sizeof(FileHeader) + sizeof(BlockHeader) + sizeof(IndexFields) + sizeof(Trailer))
+        return false;
+    Trailer trailer = record<Trailer>(data, data.size() - sizeof(Trailer));
+    if (std::memcmp(trailer.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) return false;
+
+    levels.clear();
+    uint32_t strings = 0, nodes = 0, releaseCount = 0, sequence = 0;
+    bool newest = true;
+    for (uint64_t offset = trailer.index; offset != 0;) {
+        if (offset < sizeof(FileHeader) + sizeof(BlockHeader) || offset >= data.size()) return false;
+        BlockHeader block = record<BlockHeader>(data, offset - sizeof(BlockHeader));
+        if (block.kind != IndexBlock || block.size > data.size() - offset || block.size < sizeof(IndexFields))
+            return false;
+        IndexFields fields = record<IndexFields>(data, offset);
+
+        IndexLevel level{};
+        level.offset = offset;
+        level.previous = fields.previous;
+        level.firstString = fields.firstString;
+        level.stringCount = fields.stringCount;
+        level.firstNode = fields.firstNode;
+        level.nodeCount = fields.nodeCount;
+        level.firstRelease = fields.firstRelease;
+        level.releaseCount = fields.releaseCount;
+        level.firstSequence = fields.firstSequence;
+        level.headerCount = fields.headerCount;
+        level.occurrenceCount = fields.occurrenceCount;
+        level.nameCount = fields.nameCount;
+        uint64_t table = offset + sizeof(IndexFields);
+        auto next = [&table](uint64_t bytes) {
+            uint64_t start = table;
+            table += bytes;
+            return start;
+        };
+        level.strings = next(uint64_t(fields.stringCount) * sizeof(BlockRecord));
+        level.stringKeys = next(uint64_t(fields.stringCount) * sizeof(KeyRecord));
+        level.nodes = next(uint64_t(fields.nodeCount) * sizeof(BlockRecord));
+        level.nodeKeys = next(uint64_t(fields.nodeCount) * sizeof(KeyRecord));
+        level.releases = next(uint64_t(fields.releaseCount) * sizeof(uint32_t));
+        level.headers = next(uint64_t(fields.headerCount) * sizeof(HeaderRecord));
+        level.occurrences = next(uint64_t(fields.occurrenceCount) * sizeof(SymbolOccurrence));
+        level.names = next(uint64_t(fields.nameCount) * sizeof(NameRecord));
+        if (table - offset != block.size || fields.previous >= offset) return false;
+
+        // Each level's ranges end where the next newer one's start.
+        if (newest) {
+            strings = fields.firstString + fields.stringCount;
+            nodes = fields.firstNode + fields.nodeCount;
+            releaseCount = fields.firstRelease + fields.releaseCount;
+            sequence = fields.firstSequence + fields.headerCount;
+            indexedStrings = strings;
+            indexedNodes = nodes;
+            indexedReleases = releaseCount;
+            headerSequence = sequence;
+            newest = false;
+        }
+        if (fields.firstString + fields.stringCount != strings || fields.firstNode + fields.nodeCount != nodes ||
+            fields.firstRelease + fields.releaseCount != releaseCount ||
+            fields.firstSequence + fields.headerCount != sequence)
+            return false;
+        strings = fields.firstString;
+        nodes = fields.firstNode;
+        releaseCount = fields.firstRelease;
+        sequence = fields.firstSequence;
+        levels.push_back(level);
+        offset = fields.previous;
+    }
+    if (strings || nodes || releaseCount || sequence) return false;
+
+    for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+        for (uint32_t i = 0; i < level->releaseCount; ++i) {
+            uint32_t name = record<uint32_t>(data, level->releases, i);
+            if (name >= indexedStrings) return false;
+            releaseIndex[getString(name)] = releases.size();
+            releases.push_back({getString(name).str(), {}, {}});
+        }
+        for (uint32_t i = 0; i < level->headerCount; ++i) {
+            HeaderRecord header = record<HeaderRecord>(data, level->headers, i);
+            if (header.release >= releases.size() || header.name >= indexedStrings ||
+                header.block.offset > data.size() || header.block.size > data.size() - header.block.offset)
+                return false;
+            Release& release = releases[header.release];
+            release.headers[getString(header.name)] = {header.block.offset, header.block.size};
+            release.headerOrder.push_back(getString(header.name).str());
+        }
+    }
+    return true;
+}
+
+// Cuts the file back to the end of its last complete commit. Under the lock
+// no writer is appending, so a trailer still missing there never will be.
+bool armor::APIDatabase::recover(std::string& error) {
+    int fd = lockFd;
+    if (fd < 0) {
+        if (std::error_code ec = llvm::sys::fs::openFileForReadWrite(path, fd, llvm::sys::fs::CD_OpenExisting,
+                                                                     llvm::sys::fs::OF_None)) {
+            error = "incomplete last commit, and the file cannot be repaired: " + ec.message();
+            return false;
+        }
+        flock(fd, LOCK_EX);
+    }
+    auto release = [&](bool result) {
+        if (fd != lockFd) {
+            flock(fd, LOCK_UN);
+            llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+        }
+        return result;
+    };
+
+    if (!mapFile(error)) return release(false);
+    if (fileSize == sizeof(FileHeader) || loadIndex()) return release(true);
+
+    // Blocks up to the end of the last trailer that points at the index block before it.
+    llvm::StringRef data = mapped->getBuffer();
+    uint64_t offset = sizeof(FileHeader);
+    uint64_t end = offset;
+    while (data.size() - offset >= sizeof(BlockHeader)) {
+        BlockHeader block = record<BlockHeader>(data, offset);
+        uint64_t start = offset + sizeof(BlockHeader);
+        if (block.kind < StringBlock || block.kind > IndexBlock || block.size > data.size() - start) break;
+        uint64_t next = (start + block.size + 7) & ~uint64_t(7);
+        if (next > data.size()) break;
+        if (block.kind == IndexBlock) {
+            if (data.size() - next < sizeof(Trailer)) break;
+            Trailer trailer = record<Trailer>(data, next);
+            if (trailer.index != start || std::memcmp(trailer.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) break;
+            next += sizeof(Trailer);
+            end = next;
+        }
+        offset = next;
+    }
+
+    mapped.reset();
+    if (std::error_code ec = llvm::sys::fs::resize_file(fd, end)) {
+        error = "incomplete last commit, and the file cannot be repaired: " + ec.message();
+        return release(false);
+    }
+    if (!mapFile(error)) return release(false);
+    if (fileSize != sizeof(FileHeader) && !loadIndex()) {
+        error = "corrupt index";
+        return release(false);
+    }
+    return release(true);
+}
+
+// Takes the writer's lock for the additions up to commit(). If another writer
+// committed since open(), its state is loaded first; nothing was added yet.
+bool armor::APIDatabase::lockForWriting(std::string& error) {
+    if (lockFd >= 0) return true;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::error_code dirEc;
+        std::filesystem::create_directories(parent, dirEc);
+    }
+    if (std::error_code ec = llvm::sys::fs::openFileForReadWrite(path, lockFd, llvm::sys::fs::CD_OpenAlways,
+                                                                 llvm::sys::fs::OF_Append)) {
+        lockFd = -1;
+        error = ec.message();
+        return false;
+    }
+    if (flock(lockFd, LOCK_EX) != 0) {
+        error = std::error_code(errno, std::generic_category()).message();
+        unlock();
+        return false;
+    }
+
+    llvm::sys::fs::file_status status;
+    if (std::error_code ec = llvm::sys::fs::status(lockFd, status)) {
+        error = ec.message();
+        unlock();
+        return false;
+    }
+    if (status.getSize() == fileSize) return true;
+    if (!load(error)) {
+        unlock();
+        return false;
+    }
+    return true;
+}
+
+void armor::APIDatabase::unlock() {
+    if (lockFd < 0) return;
+    flock(lockFd, LOCK_UN);
+    llvm::sys::Process::SafelyCloseFileDescriptor(lockFd);
+    lockFd = -1;
+}
+
+void armor::APIDatabase::appendBlock(uint32_t kind, llvm::StringRef bytes, Block* block) {
+    put(pending, BlockHeader{kind, static_cast<uint32_t>(bytes.size())});
+    if (block) *block = {fileSize + pending.size(), static_cast<uint32_t>(bytes.size())};
+    pending.append(bytes.begin(), bytes.end());
+    pending.resize((pending.size() + 7) & ~size_t(7), '\0');
+}
+
+llvm::StringRef armor::APIDatabase::payload(const Block& block) const {
+    if (block.offset >= fileSize) return llvm::StringRef(pending).substr(block.offset - fileSize, block.size);
+    return mapped->getBuffer().substr(block.offset, block.size);
+}
+
+uint32_t armor::APIDatabase::findString(llvm::StringRef text) const {
+    auto added = addedStringIds.find(text);
+    if (added != addedStringIds.end()) return added->second;
+    if (levels.empty()) return NO_ID;
+    llvm::StringRef data = mapped->getBuffer();
+    uint64_t hash = llvm::xxHash64(text);
+    for (const IndexLevel& level : levels) {
+        uint32_t id = findKey(data, level.stringKeys, level.stringCount, hash,
+                              [&](uint32_t id) { return getString(id) == text; });
+        if (id != NO_ID) return id;
+    }
+    return NO_ID;
+}
+
+uint32_t armor::APIDatabase::intern(llvm::StringRef text) {
+    uint32_t id = findString(text);
+    if (id != NO_ID) return id;
+
+    Block block;
+    appendBlock(StringBlock, text, &block);
+    id = static_cast<uint32_t>(getStringCount());
+    addedStrings.push_back(block);
+    addedStringIds[text] = id;
+    return id;
+}
+
+llvm::StringRef armor::APIDatabase::getString(uint32_t id) const {
+    if (id >= indexedStrings) {
+        return id - indexedStrings < addedStrings.size() ? payload(addedStrings[id - indexedStrings])
+                                                         : llvm::StringRef();
+    }
+    for (const IndexLevel& level : levels) {
+        if (id < level.firstString) continue;
+        BlockRecord block = record<BlockRecord>(mapped->getBuffer(), level.strings, id - level.firstString);
+        return mapped->getBuffer().substr(block.offset, block.size);
+    }
+    return llvm::StringRef();
+}
+
+llvm::StringRef armor::APIDatabase::getNode(uint32_t id) const {
+    if (id >= indexedNodes) {
+        return id - indexedNodes < addedNodes.size() ? payload(addedNodes[id - indexedNodes]) : llvm::StringRef();
+    }
+    for (const IndexLevel& level : levels) {
+        if (id < level.firstNode) continue;
+        BlockRecord block = record<BlockRecord>(mapped->getBuffer(), level.nodes, id - level.firstNode);
+        return mapped->getBuffer().substr(block.offset, block.size);
+    }
+    return llvm::StringRef();
+}
+
+uint32_t armor::APIDatabase::addNode(const APINode& node, llvm::DenseMap<const APINode*, uint32_t>& added) {
+    auto known = added.find(&node);
+    if (known != added.end()) return known->second;
+
+    // Children first: a node is identified by its fields and its children's ids.
+    llvm::SmallVector<uint32_t, 16> children;
+    if (node.children) {
+        for (const auto& child : *node.children) children.push_back(addNode(*child, added));
+    }
+
+    NodeFields fields{};
+    fields.qualifiedName = intern(node.qualifiedName);
+    fields.dataType = intern(node.dataType);
+    fields.canonicalType = intern(node.caonicalType);
+    fields.usr = intern(node.USR);
+    fields.nsr = intern(node.NSR);
+    fields.flags = APISnapshot::packFlags(node);
+    fields.kind = static_cast<uint8_t>(node.kind);
+    fields.access = static_cast<uint8_t>(node.access);
+    fields.storage = static_cast<uint8_t>(node.storage);
+    fields.virtualQualifier = static_cast<uint8_t>(node.virtualQualifier);
+    fields.childCount = static_cast<uint32_t>(children.size());
+    fields.hashCount = static_cast<uint32_t>(node.stmtHashes.size());
+
+    std::string record;
+    put(record, fields);
+    for (uint32_t child : children) put(record, child);
+    for (uint64_t hash : node.stmtHashes) put(record, hash);
+
+    uint64_t hash = llvm::xxHash64(record);
+    llvm::SmallVector<uint32_t, 1>& candidates = addedNodeIds[hash];
+    for (uint32_t id : candidates) {
+        if (getNode(id) == record) return added[&node] = id;
+    }
+    for (const IndexLevel& level : levels) {
+        uint32_t id = findKey(mapped->getBuffer(), level.nodeKeys, level.nodeCount, hash,
+                              [&](uint32_t id) { return getNode(id) == record; });
+        if (id != NO_ID) return added[&node] = id;
+    }
+
+    Block block;
+    appendBlock(NodeBlock, record, &block);
+    uint32_t id = static_cast<uint32_t>(getNodeCount());
+    addedNodes.push_back(block);
+    candidates.push_back(id);
+    return added[&node] = id;
+}
+
+bool armor::APIDatabase::addRelease(llvm::StringRef release, std::string& error) {
+    if (!lockForWriting(error)) return false;
+    if (releaseIndex.count(release)) {
+        error = "release " + release.str() + " already exists";
+        return false;
+    }
+    std::string record;
+    put(record, intern(release));
+    appendBlock(ReleaseBlock, record, nullptr);
+    releaseIndex[release] = releases.size();
+    releases.push_back({release.str(), {}, {}});
+    return true;
+}
+
+bool armor::APIDatabase::addHeader(llvm::StringRef header, const ASTNormalizedContext& context, std::string& error) {
+    if (!lockForWriting(error)) return false;
+    if (releases.empty()) {
+        error = "no release started";
+        return false;
+    }
+    Release& release = releases.back();
+    if (release.headers.count(header)) {
+        error = "header " + header.str() + " already added to release " + release.name;
+        return false;
+    }
+
+    llvm::DenseMap<const APINode*, uint32_t> added;
+    std::vector<uint32_t> roots;
+    for (const auto& root : context.getRootNodes()) roots.push_back(addNode(*root, added));
+
+    std::vector<std::pair<uint32_t, uint32_t>> usrs;
+    for (const auto& entry : context.usrNodeMap)
+        usrs.emplace_back(intern(entry.getKey()), addNode(*entry.getValue(), added));
+    std::sort(usrs.begin(), usrs.end());
+
+    std::vector<uint32_t> unsupported;
+    for (const auto& entry : context.unSupportedUsrNodeMap) unsupported.push_back(intern(entry.getKey()));
+    std::sort(unsupported.begin(), unsupported.end());
+
+    const SourceRangeTracker& tracker = context.getSourceRangeTracker();
+    HeaderFields fields{};
+    fields.release = intern(release.name);
+    fields.header = intern(header);
+    fields.rootCount = static_cast<uint32_t>(roots.size());
+    fields.usrCount = static_cast<uint32_t>(usrs.size());
+    fields.unsupportedCount = static_cast<uint32_t>(unsupported.size());
+    fields.commentCount = static_cast<uint32_t>(tracker.getCommentsHashMap().size());
+    fields.unhandledCount = static_cast<uint32_t>(tracker.getUnhandledDeclsHashMap().size());
+    fields.inactiveCount = static_cast<uint32_t>(tracker.getInactiveUnhandledDeclsHashMap().size());
+
+    std::string record;
+    put(record, fields);
+    for (uint32_t root : roots) put(record, root);
+    for (const auto& [usr, node] : usrs) {
+        put(record, usr);
+        put(record, node);
+    }
+    for (uint32_t usr : unsupported) put(record, usr);
+    putHashTable(record, tracker.getCommentsHashMap());
+    putHashTable(record, tracker.getUnhandledDeclsHashMap());
+    putHashTable(record, tracker.getInactiveUnhandledDeclsHashMap());
+
+    Block block;
+    appendBlock(HeaderBlock, record, &block);
+    release.headers[header] = block;
+    release.headerOrder.push_back(header.str());
+    addedHeaders.push_back({static_cast<uint32_t>(releases.size() - 1), fields.header, block});
+    indexSymbols(releases.size() - 1, fields.header, payload(block));
+    return true;
+}
+
+void armor::APIDatabase::indexSymbols(size_t release, uint32_t header, llvm::StringRef entry) {
+    PayloadReader reader(entry);
+    HeaderFields fields;
+    if (!reader.get(fields)) return;
+    for (uint32_t i = 0, root; i < fields.rootCount; ++i) {
+        if (!reader.get(root)) return;
+    }
+    uint32_t sequence = headerSequence++;
+    for (uint32_t i = 0; i < fields.usrCount; ++i) {
+        uint32_t usr, node;
+        NodeFields nodeFields;
+        if (!reader.get(usr) || !reader.get(node) || node >= getNodeCount() ||
+            !PayloadReader(getNode(node)).get(nodeFields))
+            return;
+        SymbolOccurrence last;
+        bool seen = lastOccurrence(usr, last);
+        // A USR declared by several headers of one release is listed for the first.
+        if (seen && last.release == release) continue;
+        if (!seen) usrsByName[nodeFields.qualifiedName].push_back(usr);
+        symbolIndex[usr].push_back({sequence, static_cast<uint32_t>(release), header, usr, node});
+    }
+}
+
+// The occurrences of usr in an index level, which are sorted by USR and then sequence.
+static std::pair<size_t, size_t> occurrenceRange(llvm::StringRef data, uint64_t table, uint32_t count, uint32_t usr) {
+    using Occurrence = std::array<uint32_t, 5>;   // sequence, release, header, usr, node
+    size_t first = partitionPoint(count, [&](size_t i) { return record<Occurrence>(data, table, i)[3] < usr; });
+    size_t last = partitionPoint(count, [&](size_t i) { return record<Occurrence>(data, table, i)[3] <= usr; });
+    return {first, last};
+}
+
+bool armor::APIDatabase::lastOccurrence(uint32_t usr, SymbolOccurrence& last) const {
+    auto added = symbolIndex.find(usr);
+    if (added != symbolIndex.end()) {
+        last = added->second.back();
+        return true;
+    }
+    for (const IndexLevel& level : levels) {
+        auto [first, end] = occurrenceRange(mapped->getBuffer(), level.occurrences, level.occurrenceCount, usr);
+        if (first == end) continue;
+        last = record<SymbolOccurrence>(mapped->getBuffer(), level.occurrences, end - 1);
+        return true;
+    }
+    return false;
+}
+
+void armor::APIDatabase::collectOccurrences(uint32_t usr, std::vector<SymbolOccurrence>& out) const {
+    for (const IndexLevel& level : levels) {
+        auto [first, end] = occurrenceRange(mapped->getBuffer(), level.occurrences, level.occurrenceCount, usr);
+        for (size_t i = first; i < end; ++i)
+            out.push_back(record<SymbolOccurrence>(mapped->getBuffer(), level.occurrences, i));
+    }
+    auto added = symbolIndex.find(usr);
+    if (added != symbolIndex.end()) out.insert(out.end(), added->second.begin(), added->second.end());
+}
+
+// The index block of a commit: what was added since open(), merged with the
+// newest index blocks while each is no larger than what it is merged into.
+std::string armor::APIDatabase::buildIndex() const {
+    size_t size = addedStrings.size() + addedNodes.size() + addedHeaders.size();
+    for (const auto& entry : symbolIndex) size += entry.second.size();
+    auto levelSize = [](const IndexLevel& level) {
+        return size_t(level.stringCount) + level.nodeCount + level.headerCount + level.occurrenceCount;
+    };
+    size_t merged = 0;
+    while (merged < levels.size() && levelSize(levels[merged]) <= size) size += levelSize(levels[merged++]);
+
+    IndexFields fields{};
+    fields.previous = merged < levels.size() ? levels[merged].offset : 0;
+    fields.firstString = merged ? levels[merged - 1].firstString : indexedStrings;
+    fields.firstNode = merged ? levels[merged - 1].firstNode : indexedNodes;
+    fields.firstRelease = merged ? levels[merged - 1].firstRelease : indexedReleases;
+    fields.firstSequence = merged ? levels[merged - 1].firstSequence : headerSequence - addedHeaders.size();
+
+    std::vector<BlockRecord> strings, nodes;
+    std::vector<KeyRecord> stringKeys, nodeKeys;
+    std::vector<uint32_t> releaseNames;
+    std::vector<HeaderRecord> headers;
+    std::vector<SymbolOccurrence> occurrences;
+    std::vector<NameRecord> names;
+    auto copy = [this](auto& out, uint64_t table, uint32_t count) {
+        using T = typename std::decay_t<decltype(out)>::value_type;
+        for (uint32_t i = 0; i < count; ++i) out.push_back(record<T>(mapped->getBuffer(), table, i));
+    };
+    for (size_t i = merged; i-- > 0;) {
+        const IndexLevel& level = levels[i];
+        copy(strings, level.strings, level.stringCount);
+        copy(stringKeys, level.stringKeys, level.stringCount);
+        copy(nodes, level.nodes, level.nodeCount);
+        copy(nodeKeys, level.nodeKeys, level.nodeCount);
+        copy(releaseNames, level.releases, level.releaseCount);
+        copy(headers, level.headers, level.headerCount);
+        copy(occurrences, level.occurrences, level.occurrenceCount);
+        copy(names, level.names, level.nameCount);
+    }
+
+    for (size_t i = 0; i < addedStrings.size(); ++i) {
+        uint32_t id = indexedStrings + static_cast<uint32_t>(i);
+        strings.push_back({addedStrings[i].offset, addedStrings[i].size, 0});
+        stringKeys.push_back({llvm::xxHash64(getString(id)), id, 0});
+    }
+    for (size_t i = 0; i < addedNodes.size(); ++i) {
+        uint32_t id = indexedNodes + static_cast<uint32_t>(i);
+        nodes.push_back({addedNodes[i].offset, addedNodes[i].size, 0});
+        nodeKeys.push_back({llvm::xxHash64(getNode(id)), id, 0});
+    }
+    for (size_t i = indexedReleases; i < releases.size(); ++i) releaseNames.push_back(findString(releases[i].name));
+    for (const StoredHeader& header : addedHeaders)
+        headers.push_back({header.release, header.name, {header.block.offset, header.block.size, 0}});
+    for (const auto& entry : symbolIndex)
+        occurrences.insert(occurrences.end(), entry.second.begin(), entry.second.end());
+    for (const auto& entry : usrsByName) {
+        for (uint32_t usr : entry.second) names.push_back({entry.first, usr});
+    }
+
+    auto byKey = [](const KeyRecord& a, const KeyRecord& b) { return std::tie(a.hash, a.id) < std::tie(b.hash, b.id); };
+    std::sort(stringKeys.begin(), stringKeys.end(), byKey);
+    std::sort(nodeKeys.begin(), nodeKeys.end(), byKey);
+    std::sort(occurrences.begin(), occurrences.end(), [](const SymbolOccurrence& a, const SymbolOccurrence& b) {
+        return std::tie(a.usr, a.sequence) < std::tie(b.usr, b.sequence);
+    });
+    std::sort(names.begin(), names.end(),
+              [](const NameRecord& a, const NameRecord& b) { return std::tie(a.name, a.usr) < std::tie(b.name, b.usr); });
+
+    fields.stringCount = static_cast<uint32_t>(strings.size());
+    fields.nodeCount = static_cast<uint32_t>(nodes.size());
+    fields.releaseCount = static_cast<uint32_t>(releaseNames.size());
+    fields.headerCount = static_cast<uint32_t>(headers.size());
+    fields.occurrenceCount = static_cast<uint32_t>(occurrences.size());
+    fields.nameCount = static_cast<uint32_t>(names.size());
+
+    std::string index;
+    put(index, fields);
+    auto putAll = [&index](const auto& table) {
+        for (const auto& entry : table) put(index, entry);
+    };
+    putAll(strings);
+    putAll(stringKeys);
+    putAll(nodes);
+    putAll(nodeKeys);
+    putAll(releaseNames);
+    putAll(headers);
+    putAll(occurrences);
+    putAll(names);
+    return index;
+}
+
+bool armor::APIDatabase::commit(std::string& error) {
+    // Additions take the lock, so without it there is nothing to write.
+    if (lockFd < 0) return true;
+
+    Block index;
+    appendBlock(IndexBlock, buildIndex(), &index);
+    Trailer trailer{index.offset, {}};
+    std::memcpy(trailer.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    put(pending, trailer);
+
+    llvm::raw_fd_ostream out(lockFd, /*shouldClose=*/false);
+    out << pending;
+    out.flush();
+    if (out.has_error()) {
+        error = out.error().message();
+        out.clear_error();
+        // Leave no torn tail for the next open() to repair.
+        llvm::sys::fs::resize_file(lockFd, fileSize);
+        unlock();
+        return false;
+    }
+    unlock();
+    // Map the grown file; all offsets stay valid.
+    return load(error);
+}
+
+std::vector<std::string> armor::APIDatabase::getReleases() const {
+    std::vector<std::string> names;
+    for (const Release& release : releases) names.push_back(release.name);
+    return names;
+}
+
+bool armor::APIDatabase::hasRelease(llvm::StringRef release) const {
+    return releaseIndex.count(release);
+}
+
+std::vector<std::string> armor::APIDatabase::getHeaders(llvm::StringRef release) const {
+    auto it = releaseIndex.find(release);
+    return it == releaseIndex.end() ? std::vector<std::string>() : releases[it->second].headerOrder;
+}
+
+bool armor::APIDatabase::hasHeader(llvm::StringRef release, llvm::StringRef header) const {
+    return findHeader(release, header) != nullptr;
+}
+
+const armor::APIDatabase::Block* armor::APIDatabase::findHeader(llvm::StringRef release, llvm::StringRef header) const {
+    auto it = releaseIndex.find(release);
+    if (it == releaseIndex.end()) return nullptr;
+    const Release& entry = releases[it->second];
+    auto found = entry.headers.find(header);
+    return found == entry.headers.end() ? nullptr : &found->second;
+}
+
+bool armor::APIDatabase::readHeader(const Block& block, HeaderEntry& entry) const {
+    PayloadReader reader(payload(block));
+    if (!reader.get(entry.fields)) return false;
+    entry.roots.resize(entry.fields.rootCount);
+    for (uint32_t& root : entry.roots) {
+        if (!reader.get(root) || root >= getNodeCount()) return false;
+    }
+    entry.usrs.resize(entry.fields.usrCount);
+    for (auto& [usr, node] : entry.usrs) {
+        if (!reader.get(usr) || !reader.get(node) || node >= getNodeCount()) return false;
+    }
+    entry.unsupported.resize(entry.fields.unsupportedCount);
+    for (uint32_t& usr : entry.unsupported) {
+        if (!reader.get(usr)) return false;
+    }
+    return readHashTable(reader, entry.fields.commentCount, entry.comments) &&
+           readHashTable(reader, entry.fields.unhandledCount, entry.unhandled) &&
+           readHashTable(reader, entry.fields.inactiveCount, entry.inactive);
+}
+
+namespace {
+
+// Rebuilds APINodes from node records, sharing the ones referenced twice.
+class NodeMaterializer {
+public:
+    using Payload = std::function<llvm::StringRef(uint32_t)>;
+
+    NodeMaterializer(size_t nodeCount, Payload nodePayload, Payload string)
+        : nodeCount(nodeCount), nodePayload(std::move(nodePayload)), string(std::move(string)) {}
+
+    std::shared_ptr<armor::APINode> get(uint32_t id) {
+        if (id >= nodeCount) return nullptr;
+        auto known = nodes.find(id);
+        if (known != nodes.end()) return known->second;
+
+        PayloadReader reader(nodePayload(id));
+        NodeFields fields;
+        if (!reader.get(fields)) return nullptr;
+
+        auto node = std::make_shared<armor::APINode>();
+        node->qualifiedName = string(fields.qualifiedName).str();
+        node->dataType = string(fields.dataType).str();
+        node->caonicalType = string(fields.canonicalType).str();
+        node->USR = string(fields.usr).str();
+        node->NSR = string(fields.nsr).str();
+        node->kind = static_cast<NodeKind>(fields.kind);
+        node->access = static_cast<AccessSpec>(fields.access);
+        node->storage = static_cast<APINodeStorageClass>(fields.storage);
+        node->virtualQualifier = static_cast<VirtualQualifier>(fields.virtualQualifier);
+        armor::APISnapshot::unpackFlags(fields.flags, *node);
+
+        llvm::SmallVector<uint32_t, 16> children(fields.childCount);
+        for (uint32_t& child : children) {
+            if (!reader.get(child)) return nullptr;
+        }
+        node->stmtHashes.resize(fields.hashCount);
+        for (uint64_t& hash : node->stmtHashes) {
+            if (!reader.get(hash)) return nullptr;
+        }
+        if (fields.flags & armor::APISnapshot::HAS_CHILDREN) {
+            node->children = std::make_unique<llvm::SmallVector<std::shared_ptr<const armor::APINode>, 16>>();
+            for (uint32_t child : children) {
+                std::shared_ptr<armor::APINode> childNode = get(child);
+                if (!childNode) return nullptr;
+                node->children->push_back(std::move(childNode));
+            }
+        }
+        nodes[id] = node;
+        return node;
+    }
+
+private:
+    size_t nodeCount;
+    Payload nodePayload;
+    Payload string;
+    llvm::DenseMap<uint32_t, std::shared_ptr<armor::APINode>> nodes;
+};
+
+} // namespace
+
+std::unique_ptr<armor::ASTNormalizedContext> armor::APIDatabase::loadHeader(llvm::StringRef release,
+                                                                          llvm::StringRef header) const {
+    const Block* block = findHeader(release, header);
+    HeaderEntry entry;
+    if (!block || !readHeader(*block, entry)) return nullptr;
+
+    NodeMaterializer nodes(getNodeCount(),
+                           [this](uint32_t id) { return getNode(id); },
+                           [this](uint32_t id) { return getString(id); });
+    auto context = std::make_unique<ASTNormalizedContext>();
+    for (uint32_t id : entry.roots) {
+        std::shared_ptr<APINode> root = nodes.get(id);
+        if (!root) return nullptr;
+        context->addRootNode(root);
+        context->addNode(root->NSR, root);
+    }
+    for (const auto& [usr, id] : entry.usrs) {
+        std::shared_ptr<APINode> node = nodes.get(id);
+        if (!node) return nullptr;
+        context->usrNodeMap.insert_or_assign(getString(usr), node);
+    }
+    for (uint32_t usr : entry.unsupported) context->unSupportedUsrNodeMap.insert(getString(usr));
+
+    SourceRangeTracker& tracker = context->getSourceRangeTracker();
+    tracker.moveCommentsHashMap(entry.comments);
+    tracker.getUnhandledDeclsHashMap() = std::move(entry.unhandled);
+    tracker.moveInactiveUnhandledDeclsHashMap(entry.inactive);
+    return context;
+}
+
+bool armor::APIDatabase::sameAPI(llvm::StringRef release1, llvm::StringRef release2, llvm::StringRef header) const {
+    const Block* block1 = findHeader(release1, header);
+    const Block* block2 = findHeader(release2, header);
+    if (!block1 || !block2) return false;
+    // Entries are canonical and nodes deduplicated: equal APIs have equal bytes after the release id.
+    return payload(*block1).drop_front(sizeof(uint32_t)) == payload(*block2).drop_front(sizeof(uint32_t));
+}
+
+// Hash of what callers compile against: the node's types and qualifiers and
+// those of its parameters, return type and template parameters. Members,
+// statement hashes and parameter names are left out.
+uint64_t armor::APIDatabase::signatureHash(uint32_t node) const {
+    PayloadReader reader(getNode(node));
+    NodeFields fields;
+    if (!reader.get(fields)) return 0;
+    std::string signature;
+    auto addFields = [&](const NodeFields& part) {
+        put(signature, part.kind);
+        put(signature, part.dataType);
+        put(signature, part.canonicalType);
+        put(signature, static_cast<uint16_t>(part.flags & ~APISnapshot::HAS_CHILDREN));
+        put(signature, part.access);
+        put(signature, part.storage);
+        put(signature, part.virtualQualifier);
+    };
+    addFields(fields);
+    for (uint32_t i = 0; i < fields.childCount; ++i) {
+        uint32_t child;
+        NodeFields childFields;
+        if (!reader.get(child) || child >= getNodeCount() || !PayloadReader(getNode(child)).get(childFields))
+            break;
+        NodeKind kind = static_cast<NodeKind>(childFields.kind);
+        if (kind == NodeKind::Parameter || kind == NodeKind::ReturnType || kind == NodeKind::TemplateParam)
+            addFields(childFields);
+    }
+    return llvm::xxHash64(signature);
+}
+
+std::vector<armor::APIDatabase::SymbolVersion> armor::APIDatabase::history(llvm::StringRef symbol) const {
+    std::vector<SymbolVersion> versions;
+    uint32_t symbolId = findString(symbol);
+    if (symbolId == NO_ID) return versions;
+
+    // The symbol as a USR and every USR declared with it as qualified name.
+    std::vector<SymbolOccurrence> occurrences;
+    collectOccurrences(symbolId, occurrences);
+    llvm::SmallVector<uint32_t, 2> usrs;
+    for (const IndexLevel& level : levels) {
+        llvm::StringRef data = mapped->getBuffer();
+        for (size_t i = partitionPoint(level.nameCount, [&](size_t i) {
+                 return record<NameRecord>(data, level.names, i).name < symbolId;
+             });
+             i < level.nameCount && record<NameRecord>(data, level.names, i).name == symbolId; ++i)
+            usrs.push_back(record<NameRecord>(data, level.names, i).usr);
+    }
+    auto named = usrsByName.find(symbolId);
+    if (named != usrsByName.end()) usrs.append(named->second.begin(), named->second.end());
+    for (uint32_t usr : usrs) {
+        if (usr != symbolId) collectOccurrences(usr, occurrences);
+    }
+    std::sort(occurrences.begin(), occurrences.end(), [](const SymbolOccurrence& a, const SymbolOccurrence& b) {
+        return std::tie(a.sequence, a.usr) < std::tie(b.sequence, b.usr);
+    });
+
+    // Signature of the last release seen per USR, to flag releases where it changed.
+    llvm::DenseMap<uint32_t, uint64_t> lastSignature;
+    for (const SymbolOccurrence& occurrence : occurrences) {
+        NodeFields fields;
+        PayloadReader(getNode(occurrence.node)).get(fields);
+        uint64_t signature = signatureHash(occurrence.node);
+        auto previous = lastSignature.find(occurrence.usr);
+        bool changed = previous != lastSignature.end() && previous->second != signature;
+        lastSignature[occurrence.usr] = signature;
+        versions.push_back({releases[occurrence.release].name, getString(occurrence.header).str(),
+                            getString(occurrence.usr).str(), getString(fields.dataType).str(), changed});
+    }
+    return versions;
+}
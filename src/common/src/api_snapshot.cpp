@@ -0,0 +1,408 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "api_snapshot.hpp"
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace {
+
+constexpr char MAGIC[8] = {'A', 'R', 'M', 'O', 'R', 'S', 'N', 'P'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+enum Section : uint32_t {
+    Strings,
+    Nodes,
+    Children,
+    StmtHashes,
+    Roots,
+    UsrMap,
+    UnsupportedUsrs,
+    CommentHashes,
+    UnhandledHashes,
+    InactiveHashes,
+    SectionCount
+};
+
+struct StrRef {
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct SectionRef {
+    uint64_t offset;
+    uint64_t count;   // records, or bytes for Strings
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileSize;
+    StrRef header;
+    SectionRef sections[SectionCount];
+};
+
+struct NodeRecord {
+    StrRef qualifiedName;
+    StrRef dataType;
+    StrRef canonicalType;
+    StrRef usr;
+    StrRef nsr;
+    uint32_t firstChild;
+    uint32_t childCount;
+    uint32_t firstHash;
+    uint32_t hashCount;
+    uint16_t flags;
+    uint8_t kind;
+    uint8_t access;
+    uint8_t storage;
+    uint8_t virtualQualifier;
+    uint8_t padding[2];
+};
+
+struct UsrRecord {
+    StrRef usr;
+    uint32_t node;
+    uint32_t padding;
+};
+
+struct HashRecord {
+    uint64_t hash;
+    int64_t count;
+};
+
+static_assert(sizeof(NodeRecord) == 64, "snapshot node records are fixed size");
+static_assert(sizeof(UsrRecord) == 16 && sizeof(HashRecord) == 16, "snapshot records are fixed size");
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(const armor::ASTNormalizedContext& context) : context(context) {}
+
+    std::string build(llvm::StringRef headerName) {
+        for (const auto& root : context.getRootNodes()) roots.push_back(indexOf(root.get()));
+        for (const auto& entry : context.usrNodeMap) {
+            usrs.push_back({intern(entry.getKey()), indexOf(entry.getValue().get()), 0});
+        }
+        for (const auto& entry : context.unSupportedUsrNodeMap) unsupported.push_back(intern(entry.getKey()));
+
+        // Nodes are numbered on first sight; their records and children follow in that order.
+        for (size_t i = 0; i < order.size(); ++i) addRecord(*order[i]);
+
+        const armor::SourceRangeTracker& tracker = context.getSourceRangeTracker();
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = armor::APISnapshot::VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.header = intern(headerName);
+
+        std::string out(sizeof(FileHeader), '\0');
+        header.sections[Strings] = append(out, strings.data(), strings.size(), strings.size());
+        header.sections[Nodes] = appendVector(out, nodes);
+        header.sections[Children] = appendVector(out, children);
+        header.sections[StmtHashes] = appendVector(out, hashes);
+        header.sections[Roots] = appendVector(out, roots);
+        header.sections[UsrMap] = appendVector(out, usrs);
+        header.sections[UnsupportedUsrs] = appendVector(out, unsupported);
+        header.sections[CommentHashes] = appendHashMap(out, tracker.getCommentsHashMap());
+        header.sections[UnhandledHashes] = appendHashMap(out, tracker.getUnhandledDeclsHashMap());
+        header.sections[InactiveHashes] = appendHashMap(out, tracker.getInactiveUnhandledDeclsHashMap());
+        header.fileSize = out.size();
+        std::memcpy(&out[0], &header, sizeof(header));
+        return out;
+    }
+
+private:
+    uint32_t indexOf(const armor::APINode* node) {
+        auto [it, inserted] = indices.try_emplace(node, static_cast<uint32_t>(order.size()));
+        if (inserted) order.push_back(node);
+        return it->second;
+    }
+
+    StrRef intern(llvm::StringRef text) {
+        auto [it, inserted] = stringOffsets.try_emplace(text, static_cast<uint32_t>(strings.size()));
+        if (inserted) strings.append(text.begin(), text.end());
+        return {it->second, static_cast<uint32_t>(text.size())};
+    }
+
+    void addRecord(const armor::APINode& node) {
+        NodeRecord record{};
+        record.qualifiedName = intern(node.qualifiedName);
+        record.dataType = intern(node.dataType);
+        record.canonicalType = intern(node.caonicalType);
+        record.usr = intern(node.USR);
+        record.nsr = intern(node.NSR);
+        record.kind = static_cast<uint8_t>(node.kind);
+        record.access = static_cast<uint8_t>(node.access);
+        record.storage = static_cast<uint8_t>(node.storage);
+        record.virtualQualifier = static_cast<uint8_t>(node.virtualQualifier);
+        record.flags = armor::APISnapshot::packFlags(node);
+
+        record.firstHash = static_cast<uint32_t>(hashes.size());
+        record.hashCount = static_cast<uint32_t>(node.stmtHashes.size());
+        hashes.append(node.stmtHashes.begin(), node.stmtHashes.end());
+
+        record.firstChild = static_cast<uint32_t>(children.size());
+        if (node.children) {
+            record.childCount = static_cast<uint32_t>(node.children->size());
+            for (const auto& child : *node.children) children.push_back(indexOf(child.get()));
+        }
+        nodes.push_back(record);
+    }
+
+    static SectionRef append(std::string& out, const void* data, size_t bytes, size_t count) {
+        out.resize((out.size() + 7) & ~size_t(7), '\0');
+        SectionRef ref{out.size(), count};
+        out.append(static_cast<const char*>(data), bytes);
+        return ref;
+    }
+
+    template <typename Vector>
+    static SectionRef appendVector(std::string& out, const Vector& records) {
+        return append(out, records.data(), records.size() * sizeof(records[0]), records.size());
+    }
+
+    static SectionRef appendHashMap(std::string& out, const llvm::DenseMap<uint64_t, int>& map) {
+        std::vector<HashRecord> records;
+        records.reserve(map.size());
+        for (const auto& [hash, count] : map) records.push_back({hash, count});
+        return appendVector(out, records);
+    }
+
+    const armor::ASTNormalizedContext& context;
+    llvm::DenseMap<const armor::APINode*, uint32_t> indices;
+    std::vector<const armor::APINode*> order;
+    llvm::StringMap<uint32_t> stringOffsets;
+    std::string strings;
+    std::vector<NodeRecord> nodes;
+    std::vector<uint32_t> children;
+    llvm::SmallVector<uint64_t, 64> hashes;
+    std::vector<uint32_t> roots;
+    std::vector<UsrRecord> usrs;
+    std::vector<StrRef> unsupported;
+};
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(llvm::StringRef data) : data(data) {}
+
+    bool readHeader(std::string& error) {
+        if (data.size() < sizeof(FileHeader)) return fail(error, "file too small");
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return fail(error, "not an armor snapshot");
+        if (header.byteOrder != BYTE_ORDER_MARK) return fail(error, "written with another byte order");
+        if (header.version != armor::APISnapshot::VERSION)
+            return fail(error, "version " + std::to_string(header.version) + ", expected " +
+                               std::to_string(armor::APISnapshot::VERSION));
+        if (header.fileSize != data.size()) return fail(error, "truncated");
+
+        static const size_t recordSizes[SectionCount] = {
+            1, sizeof(NodeRecord), sizeof(uint32_t), sizeof(uint64_t), sizeof(uint32_t),
+            sizeof(UsrRecord), sizeof(StrRef), sizeof(HashRecord), sizeof(HashRecord), sizeof(HashRecord)};
+        for (uint32_t i = 0; i < SectionCount; ++i) {
+            const SectionRef& section = header.sections[i];
+            if (section.offset > data.size() || section.count > (data.size() - section.offset) / recordSizes[i])
+                return fail(error, "section out of bounds");
+        }
+        strings = data.substr(header.sections[Strings].offset, header.sections[Strings].count);
+        return true;
+    }
+
+    bool getString(const StrRef& ref, std::string& out) const {
+        if (ref.offset > strings.size() || ref.size > strings.size() - ref.offset) return false;
+        out.assign(strings.data() + ref.offset, ref.size);
+        return true;
+    }
+
+    template <typename T>
+    T record(Section section, uint64_t index) const {
+        T value;
+        std::memcpy(&value, data.data() + header.sections[section].offset + index * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    uint64_t count(Section section) const { return header.sections[section].count; }
+
+    const FileHeader& getHeader() const { return header; }
+
+    static bool fail(std::string& error, const std::string& message) {
+        error = message;
+        return false;
+    }
+
+private:
+    llvm::StringRef data;
+    llvm::StringRef strings;
+    FileHeader header{};
+};
+
+bool readHashMap(const SnapshotReader& reader, Section section, llvm::DenseMap<uint64_t, int>& map) {
+    map.clear();
+    map.reserve(reader.count(section));
+    for (uint64_t i = 0; i < reader.count(section); ++i) {
+        HashRecord record = reader.record<HashRecord>(section, i);
+        map[record.hash] = static_cast<int>(record.count);
+    }
+    return true;
+}
+
+} // namespace
+
+namespace {
+
+enum NodeFlag : uint16_t {
+    Inlined     = 1 << 0,
+    ConstExpr   = 1 << 1,
+    Override    = 1 << 2,
+    Final       = 1 << 3,
+    Delete      = 1 << 4,
+    Default     = 1 << 5,
+    Explicit    = 1 << 6,
+    Volatile    = 1 << 7,
+    Const       = 1 << 8,
+    Friend      = 1 << 9
+};
+
+static_assert(armor::APISnapshot::HAS_CHILDREN > Friend, "flag bits overlap");
+
+} // namespace
+
+uint16_t armor::APISnapshot::packFlags(const APINode& node) {
+    return (node.isInlined ? Inlined : 0) | (node.isConstExpr ? ConstExpr : 0) |
+           (node.isOveride ? Override : 0) | (node.isFinal ? Final : 0) |
+           (node.isDelete ? Delete : 0) | (node.isDefault ? Default : 0) |
+           (node.isExplicit ? Explicit : 0) | (node.isVolatile ? Volatile : 0) |
+           (node.isConst ? Const : 0) | (node.isFriend ? Friend : 0) |
+           (node.children ? HAS_CHILDREN : 0);
+}
+
+void armor::APISnapshot::unpackFlags(uint16_t flags, APINode& node) {
+    node.isInlined = flags & Inlined;
+    node.isConstExpr = flags & ConstExpr;
+    node.isOveride = flags & Override;
+    node.isFinal = flags & Final;
+    node.isDelete = flags & Delete;
+    node.isDefault = flags & Default;
+    node.isExplicit = flags & Explicit;
+    node.isVolatile = flags & Volatile;
+    node.isConst = flags & Const;
+    node.isFriend = flags & Friend;
+}
+
+bool armor::APISnapshot::write(const ASTNormalizedContext& context, llvm::StringRef header, const std::string& path) {
+    std::string image = SnapshotWriter(context).build(header);
+
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::error_code dirEc;
+        std::filesystem::create_directories(parent, dirEc);
+    }
+    std::error_code ec;
+    llvm::raw_fd_ostream out(path, ec, llvm::sys::fs::OF_None);
+    if (ec) return false;
+    out << image;
+    out.close();
+    return !out.has_error();
+}
+
+std::unique_ptr<armor::ASTNormalizedContext> armor::APISnapshot::load(const std::string& path, std::string& header,
+                                                                      std::string& error) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+        llvm::MemoryBuffer::getFile(path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!buffer) {
+        error = buffer.getError().message();
+        return nullptr;
+    }
+
+    SnapshotReader reader((*buffer)->getBuffer());
+    if (!reader.readHeader(error)) return nullptr;
+    if (!reader.getString(reader.getHeader().header, header)) {
+        error = "string out of bounds";
+        return nullptr;
+    }
+
+    const uint64_t nodeCount = reader.count(Nodes);
+    std::vector<std::shared_ptr<APINode>> nodes(nodeCount);
+    for (auto& node : nodes) node = std::make_shared<APINode>();
+
+    for (uint64_t i = 0; i < nodeCount; ++i) {
+        NodeRecord record = reader.record<NodeRecord>(Nodes, i);
+        APINode& node = *nodes[i];
+        if (!reader.getString(record.qualifiedName, node.qualifiedName) ||
+            !reader.getString(record.dataType, node.dataType) ||
+            !reader.getString(record.canonicalType, node.caonicalType) ||
+            !reader.getString(record.usr, node.USR) ||
+            !reader.getString(record.nsr, node.NSR)) {
+            error = "string out of bounds";
+            return nullptr;
+        }
+        node.kind = static_cast<NodeKind>(record.kind);
+        node.access = static_cast<AccessSpec>(record.access);
+        node.storage = static_cast<APINodeStorageClass>(record.storage);
+        node.virtualQualifier = static_cast<VirtualQualifier>(record.virtualQualifier);
+        unpackFlags(record.flags, node);
+
+        if (uint64_t(record.firstHash) + record.hashCount > reader.count(StmtHashes) ||
+            uint64_t(record.firstChild) + record.childCount > reader.count(Children)) {
+            error = "node out of bounds";
+            return nullptr;
+        }
+        node.stmtHashes.reserve(record.hashCount);
+        for (uint32_t h = 0; h < record.hashCount; ++h)
+            node.stmtHashes.push_back(reader.record<uint64_t>(StmtHashes, record.firstHash + h));
+
+        if (record.flags & HAS_CHILDREN) {
+            node.children = std::make_unique<llvm::SmallVector<std::shared_ptr<const APINode>, 16>>();
+            node.children->reserve(record.childCount);
+            for (uint32_t c = 0; c < record.childCount; ++c) {
+                uint32_t child = reader.record<uint32_t>(Children, record.firstChild + c);
+                if (child >= nodeCount) {
+                    error = "child out of bounds";
+                    return nullptr;
+                }
+                node.children->push_back(nodes[child]);
+            }
+        }
+    }
+
+    auto context = std::make_unique<ASTNormalizedContext>();
+    for (uint64_t i = 0; i < reader.count(Roots); ++i) {
+        uint32_t root = reader.record<uint32_t>(Roots, i);
+        if (root >= nodeCount) {
+            error = "root out of bounds";
+            return nullptr;
+        }
+        // The tree map holds exactly the roots, keyed by NSR, as TreeBuilder::AddNode builds it.
+        context->addRootNode(nodes[root]);
+        context->addNode(nodes[root]->NSR, nodes[root]);
+    }
+    for (uint64_t i = 0; i < reader.count(UsrMap); ++i) {
+        UsrRecord record = reader.record<UsrRecord>(UsrMap, i);
+        std::string usr;
+        if (record.node >= nodeCount || !reader.getString(record.usr, usr)) {
+            error = "USR entry out of bounds";
+            return nullptr;
+        }
+        context->usrNodeMap.insert_or_assign(usr, nodes[record.node]);
+    }
+    for (uint64_t i = 0; i < reader.count(UnsupportedUsrs); ++i) {
+        std::string usr;
+        if (!reader.getString(reader.record<StrRef>(UnsupportedUsrs, i), usr)) {
+            error = "string out of bounds";
+            return nullptr;
+        }
+        context->unSupportedUsrNodeMap.insert(usr);
+    }
+
+    SourceRangeTracker& tracker = context->getSourceRangeTracker();
+    readHashMap(reader, CommentHashes, tracker.getCommentsHashMap());
+    readHashMap(reader, UnhandledHashes, tracker.getUnhandledDeclsHashMap());
+    readHashMap(reader, InactiveHashes, tracker.getInactiveUnhandledDeclsHashMap());
+    return context;
+}
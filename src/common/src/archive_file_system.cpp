@@ -0,0 +1,636 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "archive_file_system.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <tuple>
+#include <zlib.h>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "trace.hpp"
+
+static constexpr size_t BLOCK_SIZE = 512;
+static constexpr size_t WINDOW_SIZE = 32768;
+static constexpr unsigned MAX_LINK_DEPTH = 16;
+// zlib takes input sizes as unsigned int.
+static constexpr size_t MAX_INFLATE_INPUT = 1u << 30;
+
+// Archive path of name: "." and ".." resolved, no leading or trailing slash, "" for the top.
+static std::string normalizeName(llvm::StringRef name) {
+    llvm::SmallString<256> path(name);
+    llvm::sys::path::remove_dots(path, /*remove_dot_dot=*/true, llvm::sys::path::Style::posix);
+    llvm::StringRef result = path;
+    while (result.consume_front("/")) {}
+    return result.rtrim('/').str();
+}
+
+static std::string joinName(llvm::StringRef dir, llvm::StringRef name) {
+    if (dir.empty()) return name.str();
+    if (name.empty()) return dir.str();
+    return (dir + "/" + name).str();
+}
+
+// Value of an octal or, for large files, base-256 header field.
+static uint64_t parseNumber(const char* field, size_t length) {
+    uint64_t value = 0;
+    if (static_cast<unsigned char>(field[0]) & 0x80) {
+        for (size_t i = 1; i < length; ++i) value = value << 8 | static_cast<unsigned char>(field[i]);
+        return value;
+    }
+    size_t i = 0;
+    while (i < length && field[i] == ' ') ++i;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) value = value * 8 + (field[i] - '0');
+    return value;
+}
+
+static std::string fieldString(const char* field, size_t length) {
+    return std::string(field, strnlen(field, length));
+}
+
+bool armor::TarArchive::isArchive(llvm::StringRef path) {
+    return path.endswith(".tar") || path.endswith(".tar.gz") || path.endswith(".tgz");
+}
+
+// Reads the tar stream as it is decompressed, recording members without keeping their contents.
+class armor::TarArchive::Indexer {
+public:
+    explicit Indexer(TarArchive& archive) : archive(archive) {}
+
+    void feed(const char* data, size_t size) {
+        while (size && !ended && error.empty()) {
+            if (skip) {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(skip, size));
+                if (captureLeft) {
+                    size_t c = static_cast<size_t>(std::min<uint64_t>(captureLeft, n));
+                    captured.append(data, c);
+                    captureLeft -= c;
+                    if (!captureLeft) finishCapture();
+                }
+                data += n;
+                size -= n;
+                skip -= n;
+                position += n;
+                continue;
+            }
+            size_t n = std::min(BLOCK_SIZE - headerFill, size);
+            std::memcpy(header + headerFill, data, n);
+            headerFill += n;
+            data += n;
+            size -= n;
+            position += n;
+            if (headerFill == BLOCK_SIZE) {
+                headerFill = 0;
+                onHeader();
+            }
+        }
+    }
+
+    bool finish(std::string& message) {
+        if (error.empty() && !ended && (headerFill || skip)) error = "archive is truncated";
+        if (error.empty()) return true;
+        message = error;
+        return false;
+    }
+
+    bool isEnded() const { return ended; }
+
+private:
+    void onHeader() {
+        if (std::all_of(header, header + BLOCK_SIZE, [](char c) { return c == 0; })) {
+            ended = true;
+            return;
+        }
+        uint64_t checksum = 0;
+        for (size_t i = 0; i < BLOCK_SIZE; ++i)
+            checksum += i >= 148 && i < 156 ? ' ' : static_cast<unsigned char>(header[i]);
+        if (checksum != parseNumber(header + 148, 8)) {
+            error = "bad tar header at offset " + std::to_string(position - BLOCK_SIZE);
+            return;
+        }
+
+        char type = header[156];
+        uint64_t size = parseNumber(header + 124, 12);
+        if (type == 'L' || type == 'K' || type == 'x') {
+            captureType = type;
+            captured.clear();
+            captureLeft = size;
+            skip = (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+            if (!captureLeft) finishCapture();
+            return;
+        }
+        if (paxSize) size = *paxSize;
+        skip = (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+
+        std::string name = !paxPath.empty() ? paxPath : longName;
+        if (name.empty()) {
+            name = fieldString(header, 100);
+            std::string prefix = fieldString(header + 345, 155);
+            if (std::memcmp(header + 257, "ustar", 5) == 0 && !prefix.empty()) name = prefix + "/" + name;
+        }
+        std::string link = !paxLinkPath.empty() ? paxLinkPath : longLink;
+        if (link.empty()) link = fieldString(header + 157, 100);
+        longName.clear();
+        longLink.clear();
+        paxPath.clear();
+        paxLinkPath.clear();
+        paxSize.reset();
+
+        name = normalizeName(name);
+        if (name.empty() || llvm::StringRef(name).startswith("..")) return;
+        Member member;
+        if (type == '0' || type == '\0' || type == '7') {
+            member.offset = position;
+            member.size = size;
+        } else if (type == '5') {
+            member.directory = true;
+        } else if (type == '2') {
+            member.linkTarget = link;
+        } else if (type == '1') {
+            // A hard link names an earlier member by its archive path.
+            auto target = archive.members.find(normalizeName(link));
+            if (target == archive.members.end()) return;
+            member = target->getValue();
+        } else {
+            return;   // devices, FIFOs and GNU extensions carry no headers
+        }
+        member.index = ++memberCount;
+        archive.members[name] = std::move(member);
+    }
+
+    void finishCapture() {
+        if (captureType == 'L') {
+            longName = captured.c_str();
+        } else if (captureType == 'K') {
+            longLink = captured.c_str();
+        } else {
+            // Records of the form "<length> <key>=<value>\n".
+            llvm::StringRef records = captured;
+            while (!records.empty()) {
+                size_t length = 0;
+                size_t space = records.find(' ');
+                if (space == llvm::StringRef::npos || records.substr(0, space).getAsInteger(10, length) ||
+                    length <= space || length > records.size())
+                    break;
+                llvm::StringRef record = records.substr(space + 1, length - space - 1).rtrim('\n');
+                records = records.substr(length);
+                llvm::StringRef key;
+                llvm::StringRef value;
+                std::tie(key, value) = record.split('=');
+                uint64_t number = 0;
+                if (key == "path") paxPath = value.str();
+                else if (key == "linkpath") paxLinkPath = value.str();
+                else if (key == "size" && !value.getAsInteger(10, number)) paxSize = number;
+            }
+        }
+        captured.clear();
+    }
+
+    TarArchive& archive;
+    uint64_t position = 0;
+    char header[BLOCK_SIZE];
+    size_t headerFill = 0;
+    uint64_t skip = 0;          // contents and padding left before the next header
+    uint64_t captureLeft = 0;   // of skip, bytes still to append to captured
+    char captureType = 0;
+    std::string captured;
+    std::string longName;
+    std::string longLink;
+    std::string paxPath;
+    std::string paxLinkPath;
+    std::optional<uint64_t> paxSize;
+    uint32_t memberCount = 0;
+    bool ended = false;
+    std::string error;
+};
+
+std::shared_ptr<armor::TarArchive> armor::TarArchive::open(const std::string& path, std::string& error,
+                                                           uint64_t accessPointSpan) {
+    armor::TraceScope span("archive index", "archive", path);
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+        llvm::MemoryBuffer::getFile(path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!buffer) {
+        error = "Cannot read " + path + ": " + buffer.getError().message();
+        return nullptr;
+    }
+
+    std::shared_ptr<TarArchive> archive(new TarArchive());
+    archive->file = std::move(*buffer);
+    const auto* input = reinterpret_cast<const unsigned char*>(archive->file->getBufferStart());
+    size_t inputSize = archive->file->getBufferSize();
+    archive->compressed = inputSize >= 2 && input[0] == 0x1f && input[1] == 0x8b;
+
+    Indexer indexer(*archive);
+    if (!archive->compressed) {
+        indexer.feed(archive->file->getBufferStart(), inputSize);
+    } else {
+        // As zlib's zran example: inflate one deflate block at a time and,
+        // at block boundaries accessPointSpan apart, save where raw inflate
+        // can restart.
+        z_stream strm{};
+        if (inflateInit2(&strm, 32 + MAX_WBITS) != Z_OK) {
+            error = "Cannot initialize zlib";
+            return nullptr;
+        }
+        std::vector<unsigned char> window(WINDOW_SIZE);
+        uint64_t totalIn = 0;
+        uint64_t totalOut = 0;
+        uint64_t last = 0;
+        int ret = Z_OK;
+        do {
+            if (!strm.avail_in) {
+                if (totalIn == inputSize) break;
+                strm.next_in = const_cast<unsigned char*>(input + totalIn);
+                strm.avail_in = static_cast<unsigned>(std::min<uint64_t>(inputSize - totalIn, MAX_INFLATE_INPUT));
+            }
+            if (!strm.avail_out) {
+                strm.next_out = window.data();
+                strm.avail_out = WINDOW_SIZE;
+            }
+            unsigned char* produced = strm.next_out;
+            totalIn += strm.avail_in;
+            totalOut += strm.avail_out;
+            ret = inflate(&strm, Z_BLOCK);
+            totalIn -= strm.avail_in;
+            totalOut -= strm.avail_out;
+            if (ret != Z_OK && ret != Z_STREAM_END) break;
+            indexer.feed(reinterpret_cast<const char*>(produced), strm.next_out - produced);
+            if (indexer.isEnded()) break;
+
+            if ((strm.data_type & 128) && !(strm.data_type & 64) &&
+                (totalOut == 0 || totalOut - last > accessPointSpan)) {
+                AccessPoint point;
+                point.out = totalOut;
+                point.in = totalIn;
+                point.bits = strm.data_type & 7;
+                point.window.resize(WINDOW_SIZE);
+                // The window is circular: its oldest bytes start at next_out.
+                size_t left = strm.avail_out;
+                std::memcpy(point.window.data(), window.data() + WINDOW_SIZE - left, left);
+                std::memcpy(point.window.data() + left, window.data(), WINDOW_SIZE - left);
+                archive->accessPoints.push_back(std::move(point));
+                last = totalOut;
+            }
+        } while (ret != Z_STREAM_END);
+        inflateEnd(&strm);
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            error = path + " is not a valid gzip file";
+            return nullptr;
+        }
+    }
+    if (!indexer.finish(error)) {
+        error = path + ": " + error;
+        return nullptr;
+    }
+
+    // Directories are often implied by their members only.
+    Member rootMember;
+    rootMember.directory = true;
+    std::vector<std::string> names;
+    for (const auto& entry : archive->members) names.push_back(entry.getKey().str());
+    uint32_t index = 0;
+    for (const auto& entry : archive->members) index = std::max(index, entry.getValue().index);
+    archive->members[""] = rootMember;
+    for (const std::string& name : names) {
+        llvm::StringRef child = name;
+        while (!child.empty()) {
+            llvm::StringRef parent = llvm::sys::path::parent_path(child, llvm::sys::path::Style::posix);
+            archive->children[parent].push_back(llvm::sys::path::filename(child, llvm::sys::path::Style::posix).str());
+            Member& parentMember = archive->members[parent];
+            if (parentMember.directory || parent.empty()) break;
+            parentMember.directory = true;
+            parentMember.index = ++index;
+            child = parent;
+        }
+    }
+    for (auto& entry : archive->children) {
+        std::vector<std::string>& list = entry.getValue();
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    const std::vector<std::string>& top = archive->children[""];
+    if (top.size() == 1 && archive->members[top.front()].directory) archive->root = top.front();
+    return archive;
+}
+
+bool armor::TarArchive::resolve(llvm::StringRef key, std::string& resolved, unsigned depth) const {
+    // Follow symbolic links in every component, as the kernel would.
+    std::string current;
+    while (!key.empty()) {
+        llvm::StringRef component;
+        std::tie(component, key) = key.split('/');
+        std::string candidate = joinName(current, component);
+        auto it = members.find(candidate);
+        if (it == members.end()) return false;
+        const std::string& link = it->getValue().linkTarget;
+        if (!link.empty()) {
+            if (depth == MAX_LINK_DEPTH || llvm::StringRef(link).startswith("/")) return false;
+            std::string target = normalizeName(joinName(current, link));
+            if (llvm::StringRef(target).startswith("..")) return false;
+            return resolve(joinName(target, key), resolved, depth + 1);
+        }
+        current = std::move(candidate);
+    }
+    resolved = std::move(current);
+    return true;
+}
+
+const armor::TarArchive::Member* armor::TarArchive::find(llvm::StringRef name) const {
+    std::string relative = normalizeName(name);
+    std::string key;
+    if (llvm::StringRef(relative).startswith("..") || !resolve(joinName(root, relative), key)) return nullptr;
+    auto it = members.find(key);
+    return it == members.end() ? nullptr : &it->getValue();
+}
+
+std::vector<std::string> armor::TarArchive::list(llvm::StringRef directory) const {
+    std::string relative = normalizeName(directory);
+    std::string key;
+    if (llvm::StringRef(relative).startswith("..") || !resolve(joinName(root, relative), key)) return {};
+    auto it = children.find(key);
+    return it == children.end() ? std::vector<std::string>() : it->getValue();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> armor::TarArchive::read(const Member& member, llvm::StringRef bufferName) const {
+    if (member.directory) return nullptr;
+    std::unique_ptr<llvm::WritableMemoryBuffer> buffer =
+        llvm::WritableMemoryBuffer::getNewUninitMemBuffer(member.size, bufferName);
+    if (!buffer || !readStream(member.offset, member.size, buffer->getBufferStart())) return nullptr;
+    return buffer;
+}
+
+bool armor::TarArchive::readStream(uint64_t offset, uint64_t size, char* out) const {
+    const auto* input = reinterpret_cast<const unsigned char*>(file->getBufferStart());
+    uint64_t inputSize = file->getBufferSize();
+    if (!compressed) {
+        if (offset > inputSize || size > inputSize - offset) return false;
+        std::memcpy(out, input + offset, size);
+        return true;
+    }
+    if (size == 0) return true;
+
+    auto next = std::upper_bound(accessPoints.begin(), accessPoints.end(), offset,
+                                 [](uint64_t value, const AccessPoint& point) { return value < point.out; });
+    if (next == accessPoints.begin()) return false;
+    const AccessPoint& point = *(next - 1);
+
+    z_stream strm{};
+    if (inflateInit2(&strm, -MAX_WBITS) != Z_OK) return false;
+    uint64_t inputOffset = point.in - (point.bits ? 1 : 0);
+    if (point.bits) inflatePrime(&strm, point.bits, input[inputOffset++] >> (8 - point.bits));
+    inflateSetDictionary(&strm, point.window.data(), WINDOW_SIZE);
+
+    std::vector<unsigned char> discard(WINDOW_SIZE);
+    uint64_t skip = offset - point.out;
+    uint64_t done = 0;
+    bool ok = true;
+    while (done < size) {
+        if (!strm.avail_in) {
+            if (inputOffset == inputSize) {
+                ok = false;
+                break;
+            }
+            strm.next_in = const_cast<unsigned char*>(input + inputOffset);
+            strm.avail_in = static_cast<unsigned>(std::min<uint64_t>(inputSize - inputOffset, MAX_INFLATE_INPUT));
+            inputOffset += strm.avail_in;
+        }
+        unsigned want;
+        if (skip) {
+            want = static_cast<unsigned>(std::min<uint64_t>(skip, WINDOW_SIZE));
+            strm.next_out = discard.data();
+        } else {
+            want = static_cast<unsigned>(std::min<uint64_t>(size - done, MAX_INFLATE_INPUT));
+            strm.next_out = reinterpret_cast<unsigned char*>(out + done);
+        }
+        strm.avail_out = want;
+        int ret = inflate(&strm, Z_NO_FLUSH);
+        unsigned produced = want - strm.avail_out;
+        if (skip) skip -= produced;
+        else done += produced;
+        if (ret == Z_STREAM_END && done < size) ret = Z_DATA_ERROR;
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            ok = false;
+            break;
+        }
+    }
+    inflateEnd(&strm);
+    return ok;
+}
+
+namespace {
+
+using armor::TarArchive;
+
+class ArchiveFile : public llvm::vfs::File {
+public:
+    ArchiveFile(std::shared_ptr<const TarArchive> archive, const TarArchive::Member& member,
+                llvm::vfs::Status fileStatus)
+        : archive(std::move(archive)), member(member), fileStatus(std::move(fileStatus)) {}
+
+    llvm::ErrorOr<llvm::vfs::Status> status() override { return fileStatus; }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> getBuffer(const llvm::Twine& name, int64_t, bool,
+                                                                 bool) override {
+        // Decompressed only now, when the contents are actually wanted.
+        std::unique_ptr<llvm::MemoryBuffer> buffer = archive->read(member, name.str());
+        if (!buffer) return std::make_error_code(std::errc::io_error);
+        return std::move(buffer);
+    }
+
+    std::error_code close() override { return {}; }
+
+private:
+    std::shared_ptr<const TarArchive> archive;
+    const TarArchive::Member& member;
+    llvm::vfs::Status fileStatus;
+};
+
+class ArchiveDirIterator : public llvm::vfs::detail::DirIterImpl {
+public:
+    explicit ArchiveDirIterator(std::vector<llvm::vfs::directory_entry> entries) : entries(std::move(entries)) {
+        increment();
+    }
+
+    std::error_code increment() override {
+        CurrentEntry = next < entries.size() ? entries[next++] : llvm::vfs::directory_entry();
+        return {};
+    }
+
+private:
+    std::vector<llvm::vfs::directory_entry> entries;
+    size_t next = 0;
+};
+
+// A mounted archive: paths under mountPoint name its members, anything else does not exist.
+class ArchiveFileSystem : public llvm::vfs::FileSystem {
+public:
+    ArchiveFileSystem(std::shared_ptr<const TarArchive> archive, std::string mountPoint, uint64_t device)
+        : archive(std::move(archive)), mountPoint(std::move(mountPoint)), device(device) {
+        llvm::SmallString<256> current;
+        if (!llvm::sys::fs::current_path(current)) workingDirectory = current.str().str();
+    }
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override {
+        std::string name;
+        const TarArchive::Member* member = lookup(path, name);
+        if (!member) return std::make_error_code(std::errc::no_such_file_or_directory);
+        return makeStatus(path, *member);
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> openFileForRead(const llvm::Twine& path) override {
+        std::string name;
+        const TarArchive::Member* member = lookup(path, name);
+        if (!member) return std::make_error_code(std::errc::no_such_file_or_directory);
+        if (member->directory) return std::make_error_code(std::errc::is_a_directory);
+        return std::unique_ptr<llvm::vfs::File>(new ArchiveFile(archive, *member, makeStatus(path, *member)));
+    }
+
+    llvm::vfs::directory_iterator dir_begin(const llvm::Twine& dir, std::error_code& ec) override {
+        std::string name;
+        const TarArchive::Member* member = lookup(dir, name);
+        if (!member) {
+            ec = std::make_error_code(std::errc::no_such_file_or_directory);
+            return {};
+        }
+        if (!member->directory) {
+            ec = std::make_error_code(std::errc::not_a_directory);
+            return {};
+        }
+        std::vector<llvm::vfs::directory_entry> entries;
+        std::string prefix = dir.str();
+        for (const std::string& child : archive->list(name)) {
+            const TarArchive::Member* entry = archive->find(joinName(name, child));
+            if (!entry) continue;   // dangling link
+            llvm::SmallString<256> path(prefix);
+            llvm::sys::path::append(path, child);
+            entries.emplace_back(path.str().str(), entry->directory ? llvm::sys::fs::file_type::directory_file
+                                                                    : llvm::sys::fs::file_type::regular_file);
+        }
+        return llvm::vfs::directory_iterator(std::make_shared<ArchiveDirIterator>(std::move(entries)));
+    }
+
+    llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override { return workingDirectory; }
+
+    std::error_code setCurrentWorkingDirectory(const llvm::Twine& path) override {
+        // Any directory is accepted, so the overlay can move into real ones too.
+        llvm::SmallString<256> absolute;
+        path.toVector(absolute);
+        if (std::error_code ec = makeAbsolute(absolute)) return ec;
+        llvm::sys::path::remove_dots(absolute, /*remove_dot_dot=*/true);
+        workingDirectory = absolute.str().str();
+        return {};
+    }
+
+    std::error_code getRealPath(const llvm::Twine& path, llvm::SmallVectorImpl<char>& output) const override {
+        std::string name;
+        if (!lookup(path, name)) return std::make_error_code(std::errc::no_such_file_or_directory);
+        output.clear();
+        llvm::SmallString<256> real(mountPoint);
+        llvm::sys::path::append(real, name);
+        output.append(real.begin(), real.end());
+        return {};
+    }
+
+private:
+    // Member at path and its root-relative name, or nullptr outside the mount point.
+    const TarArchive::Member* lookup(const llvm::Twine& path, std::string& name) const {
+        llvm::SmallString<256> absolute;
+        path.toVector(absolute);
+        if (makeAbsolute(absolute)) return nullptr;
+        llvm::sys::path::remove_dots(absolute, /*remove_dot_dot=*/true);
+        llvm::StringRef rest = absolute;
+        if (!rest.consume_front(mountPoint) || (!rest.empty() && !rest.consume_front("/"))) return nullptr;
+        name = rest.str();
+        return archive->find(name);
+    }
+
+    llvm::vfs::Status makeStatus(const llvm::Twine& path, const TarArchive::Member& member) const {
+        return llvm::vfs::Status(path, llvm::sys::fs::UniqueID(device, member.index), llvm::sys::TimePoint<>(), 0, 0,
+                                 member.size,
+                                 member.directory ? llvm::sys::fs::file_type::directory_file
+                                                  : llvm::sys::fs::file_type::regular_file,
+                                 member.directory ? llvm::sys::fs::all_read | llvm::sys::fs::all_exe
+                                                  : llvm::sys::fs::all_read);
+    }
+
+    std::shared_ptr<const TarArchive> archive;
+    std::string mountPoint;
+    uint64_t device;
+    std::string workingDirectory;
+};
+
+struct Mount {
+    std::shared_ptr<const TarArchive> archive;
+    std::string mountPoint;
+    uint64_t device;
+};
+
+// Mounted archives; their mount point directories are removed at exit.
+class MountRegistry {
+public:
+    ~MountRegistry() {
+        for (const Mount& mount : mounts) {
+            std::error_code ec;
+            std::filesystem::remove(mount.mountPoint, ec);
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<Mount> mounts;
+    llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> shared{
+        new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem())};
+};
+
+MountRegistry& registry() {
+    static MountRegistry instance;
+    return instance;
+}
+
+// File ids of archive members must not collide with real ones, whose device numbers are small.
+constexpr uint64_t ARCHIVE_DEVICE_BASE = 0xa7c4ull << 48;
+
+} // namespace
+
+std::string armor::mountArchive(const std::string& archivePath, std::string& error) {
+    std::shared_ptr<TarArchive> archive = TarArchive::open(archivePath, error);
+    if (!archive) return "";
+
+    // A real, empty directory, so tools can still change into the mount point.
+    llvm::SmallString<128> dir;
+    llvm::SmallString<128> real;
+    std::error_code ec = llvm::sys::fs::createUniqueDirectory("armor_archive", dir);
+    if (!ec) ec = llvm::sys::fs::real_path(dir, real);
+    if (ec) {
+        error = "Cannot create a mount point for " + archivePath + ": " + ec.message();
+        return "";
+    }
+
+    MountRegistry& mounts = registry();
+    std::lock_guard<std::mutex> lock(mounts.mutex);
+    Mount mount{archive, real.str().str(), ARCHIVE_DEVICE_BASE + mounts.mounts.size()};
+    mounts.shared->pushOverlay(new ArchiveFileSystem(mount.archive, mount.mountPoint, mount.device));
+    mounts.mounts.push_back(std::move(mount));
+    return real.str().str();
+}
+
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> armor::createFileSystem() {
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> physical(llvm::vfs::createPhysicalFileSystem().release());
+    MountRegistry& mounts = registry();
+    std::lock_guard<std::mutex> lock(mounts.mutex);
+    if (mounts.mounts.empty()) return physical;
+
+    llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay(new llvm::vfs::OverlayFileSystem(physical));
+    for (const Mount& mount : mounts.mounts)
+        overlay->pushOverlay(new ArchiveFileSystem(mount.archive, mount.mountPoint, mount.device));
+    return overlay;
+}
+
+llvm::vfs::FileSystem& armor::getFileSystem() {
+    return *registry().shared;
+}
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 #include "node.hpp"
 #include "ast_normalized_context.hpp"
+#include "run_stats.hpp"
 #include <llvm-14/llvm/ADT/SmallVector.h>
 #include <llvm-14/llvm/ADT/StringRef.h>
 #include <memory>
@@ -39,6 +40,7 @@ void armor::ASTNormalizedContext::clear() {
     apiNodesMap.clear();
     apiNodes.clear();
     sourceRangeTracker.clear();
+    sourceTokenTable.clear();
 }
 
 void armor::ASTNormalizedContext::addClangASTContext(clang::ASTContext* ASTContext) {
@@ -57,6 +59,14 @@ const armor::SourceRangeTracker& armor::ASTNormalizedContext::getSourceRangeTrac
     return sourceRangeTracker;
 }
 
+armor::SourceTokenTable& armor::ASTNormalizedContext::getSourceTokenTable() {
+    return sourceTokenTable;
+}
+
+const armor::SourceTokenTable& armor::ASTNormalizedContext::getSourceTokenTable() const {
+    return sourceTokenTable;
+}
+
 // --- SourceRangeTracker ---
 
 void armor::SourceRangeTracker::addFatalDirective(llvm::StringRef header, llvm::StringRef file) {
@@ -68,12 +78,12 @@ armor::SourceRangeTracker::getFatalDirectives() const {
     return fatalDirectives;
 }
 
-const llvm::SmallVector<armor::Range, 32>& armor::SourceRangeTracker::getComments() const {
-    return comments;
+armor::SourceRegionIndex& armor::SourceRangeTracker::getRegionIndex() {
+    return regionIndex;
 }
 
-void armor::SourceRangeTracker::moveComments(llvm::SmallVector<armor::Range, 32>& ranges) {
-    comments = std::move(ranges);
+const armor::SourceRegionIndex& armor::SourceRangeTracker::getRegionIndex() const {
+    return regionIndex;
 }
 
 llvm::DenseMap<uint64_t, int>& armor::SourceRangeTracker::getCommentsHashMap() {
@@ -88,20 +98,9 @@ void armor::SourceRangeTracker::moveCommentsHashMap(llvm::DenseMap<uint64_t, int
     commentsHashMap = std::move(hashMap);
 }
 
-const std::map<unsigned, armor::Range>& armor::SourceRangeTracker::getInactivePPDirectives() const {
-    return inactivePPDirectives;
-}
-
-std::map<unsigned, armor::Range>& armor::SourceRangeTracker::getInactivePPDirectives() {
-    return inactivePPDirectives;
-}
-
-void armor::SourceRangeTracker::moveInactivePPDirectives(std::map<unsigned, armor::Range>& ranges) {
-    inactivePPDirectives = std::move(ranges);
-}
-
 void armor::SourceRangeTracker::addUnhandledDeclHash(uint64_t hash) {
     unhandledDeclsHashMap[hash]++;
+    armor::RunStats::count(armor::StatCounter::UnhandledHashes);
 }
 
 llvm::DenseMap<uint64_t, int>& armor::SourceRangeTracker::getUnhandledDeclsHashMap() {
@@ -126,8 +125,7 @@ const llvm::DenseMap<uint64_t, int>& armor::SourceRangeTracker::getInactiveUnhan
 
 void armor::SourceRangeTracker::clear() {
     fatalDirectives.clear();
-    comments.clear();
-    inactivePPDirectives.clear();
+    regionIndex.clear();
     unhandledDeclsHashMap.clear();
     inactiveUnhandledDeclsHashMap.clear();
     commentsHashMap.clear();
@@ -135,6 +133,5 @@ void armor::SourceRangeTracker::clear() {
 
 bool armor::SourceRangeTracker::empty() const {
     return fatalDirectives.empty() &&
-           comments.empty() &&
-           inactivePPDirectives.empty();
+           regionIndex.empty();
 }
@@ -0,0 +1,158 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "baseline_matrix.hpp"
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include "llvm/Support/Format.h"
+#include "html_template.hpp"
+#include "report_buffer.hpp"
+#include "report_utils.hpp"
+
+armor::BaselineMatrix::Cell& armor::BaselineMatrix::getCell(const std::string& header, size_t baseline) {
+    auto inserted = headerIndex.try_emplace(header, headers.size());
+    if (inserted.second) {
+        headers.push_back(header);
+        rows.emplace_back(baselines.size());
+    }
+    return rows[inserted.first->second][baseline];
+}
+
+void armor::BaselineMatrix::addResult(const std::string& header, size_t baseline,
+                                      const HeaderReportSummary& summary, const std::string& reportName) {
+    Cell& cell = getCell(header, baseline);
+    cell.set = true;
+    cell.compatibility = summary.compatibility;
+    cell.overallStatus = summary.overallStatus;
+    cell.reason = summary.reason;
+    cell.reportName = reportName;
+    cell.changeCount = summary.changes.size();
+    cell.incompatibleCount = summary.incompatibleChanges.size();
+}
+
+void armor::BaselineMatrix::addFailure(const std::string& header, size_t baseline, const std::string& reason) {
+    Cell& cell = getCell(header, baseline);
+    cell = Cell();
+    cell.set = true;
+    cell.failed = true;
+    cell.compatibility = "unknown";
+    cell.overallStatus = "ERROR";
+    cell.reason = reason;
+}
+
+bool armor::BaselineMatrix::isBackwardCompatible(size_t baseline) const {
+    return std::all_of(rows.begin(), rows.end(), [baseline](const std::vector<Cell>& row) {
+        return !row[baseline].set || row[baseline].compatibility == "backward_compatible";
+    });
+}
+
+bool armor::BaselineMatrix::isBackwardCompatible() const {
+    for (size_t i = 0; i < baselines.size(); ++i) {
+        if (!isBackwardCompatible(i)) return false;
+    }
+    return true;
+}
+
+void armor::BaselineMatrix::print(llvm::raw_ostream& os) const {
+    size_t nameWidth = 6;
+    for (const std::string& header : headers) nameWidth = std::max(nameWidth, header.size());
+
+    os << llvm::left_justify("Header", nameWidth);
+    for (const std::string& baseline : baselines) os << "  " << baseline;
+    os << "\n";
+    for (size_t row = 0; row < headers.size(); ++row) {
+        os << llvm::left_justify(headers[row], nameWidth);
+        for (size_t i = 0; i < baselines.size(); ++i) {
+            const Cell& cell = rows[row][i];
+            llvm::StringRef verdict = !cell.set ? "-" : cell.failed ? "ERROR"
+                : cell.compatibility == "backward_compatible" ? "ok" : "INCOMPATIBLE";
+            os << "  " << llvm::left_justify(verdict, baselines[i].size());
+        }
+        os << "\n";
+    }
+    for (size_t i = 0; i < baselines.size(); ++i) {
+        os << baselines[i] << ": "
+           << (isBackwardCompatible(i) ? "BACKWARD_COMPATIBLE" : "BACKWARD_INCOMPATIBLE") << "\n";
+    }
+}
+
+bool armor::BaselineMatrix::writeJson(const std::string& path) const {
+    nlohmann::ordered_json out;
+    out["compatibility"] = isBackwardCompatible() ? "backward_compatible" : "backward_incompatible";
+    out["baselines"] = nlohmann::ordered_json::array();
+    for (size_t i = 0; i < baselines.size(); ++i) {
+        out["baselines"].push_back({{"baseline", baselines[i]},
+                                    {"compatibility", isBackwardCompatible(i) ? "backward_compatible"
+                                                                              : "backward_incompatible"}});
+    }
+    out["headers"] = nlohmann::ordered_json::array();
+    for (size_t row = 0; row < headers.size(); ++row) {
+        nlohmann::ordered_json header;
+        header["header"] = headers[row];
+        header["results"] = nlohmann::ordered_json::object();
+        for (size_t i = 0; i < baselines.size(); ++i) {
+            const Cell& cell = rows[row][i];
+            if (!cell.set) continue;
+            header["results"][baselines[i]] = {{"compatibility", cell.compatibility},
+                                               {"overall_status", cell.overallStatus},
+                                               {"reason", cell.reason},
+                                               {"changes", cell.changeCount},
+                                               {"incompatible_changes", cell.incompatibleCount}};
+            if (!cell.failed) header["results"][baselines[i]]["report"] = cell.reportName;
+        }
+        out["headers"].push_back(std::move(header));
+    }
+
+    create_parent_dirs(path);
+    std::ofstream file(path, std::ios::trunc);
+    file << out.dump(4, ' ', false, nlohmann::ordered_json::error_handler_t::replace) << "\n";
+    return static_cast<bool>(file);
+}
+
+bool armor::BaselineMatrix::writeHtml(const std::string& path) const {
+    ReportBuffer html(4096 + headers.size() * baselines.size() * 160);
+    html << HTML_STYLE_AND_TITLE "<table>\n<tr><th>Header Name</th>";
+    for (size_t i = 0; i < baselines.size(); ++i) {
+        html << "<th>";
+        html.appendHtml(baselines[i]);
+        html << (isBackwardCompatible(i) ? "<br/><span class='backward-compatible'>"
+                                         : "<br/><span class='backward-incompatible'>");
+        html << (isBackwardCompatible(i) ? "BACKWARD_COMPATIBLE" : "BACKWARD_INCOMPATIBLE") << "</span></th>";
+    }
+    html << "</tr>\n";
+
+    for (size_t row = 0; row < headers.size(); ++row) {
+        html << "<tr><td>";
+        html.appendHtml(headers[row]);
+        html << "</td>";
+        for (const Cell& cell : rows[row]) {
+            html << "<td>";
+            if (cell.failed) {
+                html << "<span class='backward-incompatible'>ERROR</span><br/>";
+                html.appendHtml(cell.reason);
+            }
+            else if (cell.set) {
+                bool compatible = cell.compatibility == "backward_compatible";
+                // Per-header reports sit next to this page under html_reports/.
+                html << "<a href='html_reports/api_diff_report_";
+                html.appendHtml(cell.reportName);
+                html << ".html' class='" << (compatible ? "backward-compatible" : "backward-incompatible") << "'>";
+                html.appendHtml(cell.overallStatus.empty() ? cell.compatibility : cell.overallStatus);
+                html << "</a>";
+                if (cell.changeCount) {
+                    html << "<br/>" << cell.changeCount << " changes, " << cell.incompatibleCount << " incompatible";
+                }
+                if (!cell.reason.empty()) {
+                    html << "<br/>";
+                    html.appendHtml(cell.reason);
+                }
+            }
+            html << "</td>";
+        }
+        html << "</tr>\n";
+    }
+    html << "</table></body></html>\n";
+
+    create_parent_dirs(path);
+    return html.writeTo(path);
+}
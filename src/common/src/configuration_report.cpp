@@ -0,0 +1,199 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "configuration_report.hpp"
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <nlohmann/json.hpp>
+#include "comm_def.hpp"
+#include "html_template.hpp"
+#include "report_buffer.hpp"
+#include "report_utils.hpp"
+
+bool armor::loadConfigurations(const std::string& path, std::vector<Configuration>& configurations,
+                               std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot read " + path;
+        return false;
+    }
+    nlohmann::json root = nlohmann::json::parse(in, nullptr, false);
+    if (root.is_object()) root = root.value("configurations", nlohmann::json());
+    if (!root.is_array() || root.empty()) {
+        error = path + ": expected a non-empty array of configurations";
+        return false;
+    }
+
+    std::set<std::string> names;
+    for (const auto& entry : root) {
+        if (!entry.is_object() || !entry.contains("name") || !entry["name"].is_string()) {
+            error = path + ": every configuration needs a \"name\"";
+            return false;
+        }
+        Configuration configuration;
+        configuration.name = entry["name"].get<std::string>();
+        configuration.lang = entry.value("lang", LANG_CPP);
+        configuration.macroFlags = entry.value("macro_flags", "");
+        std::transform(configuration.lang.begin(), configuration.lang.end(), configuration.lang.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        if (configuration.lang != LANG_C && configuration.lang != LANG_CPP) {
+            error = path + ": configuration '" + configuration.name + "' has unknown lang '" + configuration.lang + "'";
+            return false;
+        }
+        if (!names.insert(configuration.name).second) {
+            error = path + ": duplicate configuration '" + configuration.name + "'";
+            return false;
+        }
+        configurations.push_back(std::move(configuration));
+    }
+    return true;
+}
+
+void armor::ConfigurationReport::addResult(const std::string& header, size_t configuration,
+                                           const HeaderReportSummary& summary, const std::string& reportName) {
+    auto inserted = headerIndex.try_emplace(header, headers.size());
+    if (inserted.second) {
+        headers.emplace_back();
+        headers.back().header = header;
+        headers.back().results.resize(configurations.size());
+    }
+    HeaderResults& entry = headers[inserted.first->second];
+    Result& result = entry.results[configuration];
+    result.set = true;
+    result.compatibility = summary.compatibility;
+    result.overallStatus = summary.overallStatus;
+    result.reportName = reportName;
+
+    for (const ApiChangeGroup& group : summary.changes) {
+        std::string key = group.name + '\0' + group.description;
+        auto change = entry.changeIndex.try_emplace(key, entry.changes.size());
+        if (change.second) entry.changes.push_back({group.name, group.description, false, {}});
+        MergedChange& merged = entry.changes[change.first->second];
+        merged.backwardIncompatible |= group.backwardIncompatible;
+        merged.configurations.push_back(configuration);
+    }
+}
+
+bool armor::ConfigurationReport::isBackwardCompatible(size_t configuration) const {
+    return std::all_of(headers.begin(), headers.end(), [configuration](const HeaderResults& entry) {
+        const Result& result = entry.results[configuration];
+        return !result.set || result.compatibility == "backward_compatible";
+    });
+}
+
+bool armor::ConfigurationReport::isBackwardCompatible() const {
+    for (size_t i = 0; i < configurations.size(); ++i) {
+        if (!isBackwardCompatible(i)) return false;
+    }
+    return true;
+}
+
+std::vector<armor::ConfigurationReport::MergedChange>
+armor::ConfigurationReport::getChanges(const std::string& header) const {
+    auto it = headerIndex.find(header);
+    if (it == headerIndex.end()) return {};
+    return headers[it->second].changes;
+}
+
+std::string armor::ConfigurationReport::describeConfigurations(const HeaderResults& header,
+                                                               const MergedChange& change) const {
+    size_t compared = std::count_if(header.results.begin(), header.results.end(),
+                                    [](const Result& result) { return result.set; });
+    if (compared > 1 && change.configurations.size() == compared) return "all";
+    std::string names;
+    for (size_t configuration : change.configurations) {
+        if (!names.empty()) names += ", ";
+        names += configurations[configuration];
+    }
+    return names;
+}
+
+bool armor::ConfigurationReport::writeJson(const std::string& path) const {
+    nlohmann::ordered_json out;
+    out["compatibility"] = isBackwardCompatible() ? "backward_compatible" : "backward_incompatible";
+    out["configurations"] = nlohmann::ordered_json::array();
+    for (size_t i = 0; i < configurations.size(); ++i) {
+        out["configurations"].push_back({{"configuration", configurations[i]},
+                                         {"compatibility", isBackwardCompatible(i) ? "backward_compatible"
+                                                                                   : "backward_incompatible"}});
+    }
+    out["headers"] = nlohmann::ordered_json::array();
+    for (const HeaderResults& entry : headers) {
+        nlohmann::ordered_json header;
+        header["header"] = entry.header;
+        header["results"] = nlohmann::ordered_json::object();
+        for (size_t i = 0; i < configurations.size(); ++i) {
+            const Result& result = entry.results[i];
+            if (!result.set) continue;
+            header["results"][configurations[i]] = {{"compatibility", result.compatibility},
+                                                    {"overall_status", result.overallStatus},
+                                                    {"report", result.reportName}};
+        }
+        header["changes"] = nlohmann::ordered_json::array();
+        for (const MergedChange& change : entry.changes) {
+            std::vector<std::string> names;
+            for (size_t configuration : change.configurations) names.push_back(configurations[configuration]);
+            header["changes"].push_back({{"name", change.name},
+                                         {"description", change.description},
+                                         {"backward_incompatible", change.backwardIncompatible},
+                                         {"configurations", names}});
+        }
+        out["headers"].push_back(std::move(header));
+    }
+
+    create_parent_dirs(path);
+    std::ofstream file(path, std::ios::trunc);
+    file << out.dump(4, ' ', false, nlohmann::ordered_json::error_handler_t::replace) << "\n";
+    return static_cast<bool>(file);
+}
+
+bool armor::ConfigurationReport::writeHtml(const std::string& path) const {
+    ReportBuffer html(8192 + headers.size() * configurations.size() * 128);
+    html << HTML_STYLE_AND_TITLE "<table>\n<tr><th>Header Name</th>";
+    for (size_t i = 0; i < configurations.size(); ++i) {
+        html << "<th>";
+        html.appendHtml(configurations[i]);
+        html << "</th>";
+    }
+    html << "</tr>\n";
+    for (const HeaderResults& entry : headers) {
+        html << "<tr><td>";
+        html.appendHtml(entry.header);
+        html << "</td>";
+        for (const Result& result : entry.results) {
+            html << "<td>";
+            if (result.set) {
+                bool compatible = result.compatibility == "backward_compatible";
+                html << "<a href='html_reports/api_diff_report_";
+                html.appendHtml(result.reportName);
+                html << ".html' class='" << (compatible ? "backward-compatible" : "backward-incompatible") << "'>";
+                html.appendHtml(result.overallStatus.empty() ? result.compatibility : result.overallStatus);
+                html << "</a>";
+            }
+            html << "</td>";
+        }
+        html << "</tr>\n";
+    }
+    html << "</table>\n<h2>Changes</h2>\n<table>\n"
+            "<tr><th>Header Name</th><th>API Name</th><th>Description</th>"
+            "<th>Source Compatibility</th><th>Configurations</th></tr>\n";
+    for (const HeaderResults& entry : headers) {
+        for (const MergedChange& change : entry.changes) {
+            html << "<tr><td>";
+            html.appendHtml(entry.header);
+            html << "</td><td>";
+            html.appendHtml(change.name);
+            html << "</td><td>";
+            html.appendHtml(change.description);
+            html << (change.backwardIncompatible ? "</td><td class='backward-incompatible'>backward_incompatible"
+                                                 : "</td><td class='backward-compatible'>backward_compatible");
+            html << "</td><td>";
+            html.appendHtml(describeConfigurations(entry, change));
+            html << "</td></tr>\n";
+        }
+    }
+    html << "</table></body></html>\n";
+
+    create_parent_dirs(path);
+    return html.writeTo(path);
+}
@@ -0,0 +1,62 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "consolidated_report.hpp"
+#include "html_template.hpp"
+#include "report_buffer.hpp"
+#include "report_utils.hpp"
+
+void armor::ConsolidatedReport::addHeader(const std::string& header, const HeaderReportSummary& summary) {
+    const uint32_t headerIndex = static_cast<uint32_t>(headers.size());
+
+    size_t incompatible = 0;
+    for (const ApiChangeGroup& change : summary.changes) {
+        if (change.backwardIncompatible) ++incompatible;
+        changes.push_back({headerIndex, change.name, change.description,
+                           change.compatibilityChanged, change.backwardIncompatible});
+    }
+
+    headers.push_back({header, summary.overallStatus, summary.reason, summary.changes.size(), incompatible});
+}
+
+bool armor::ConsolidatedReport::empty() const {
+    return headers.empty();
+}
+
+bool armor::ConsolidatedReport::write(const std::string& path) const {
+    size_t expectedSize = CONSOLIDATED_HTML_HEADER.size() + CONSOLIDATED_HTML_FOOTER.size();
+    for (const HeaderEntry& entry : headers)
+        expectedSize += 64 + entry.header.size() + entry.overallStatus.size() + entry.reason.size();
+    for (const ChangeEntry& entry : changes)
+        expectedSize += 32 + entry.name.size() + entry.description.size();
+
+    ReportBuffer page(expectedSize);
+    page << CONSOLIDATED_HTML_HEADER;
+
+    // Rows are positional arrays to keep the embedded data compact.
+    page << "{\"headers\":[";
+    for (size_t i = 0; i < headers.size(); ++i) {
+        const HeaderEntry& entry = headers[i];
+        page << (i ? ",[" : "[");
+        page.appendJsonString(entry.header, true);
+        page << ",";
+        page.appendJsonString(entry.overallStatus, true);
+        page << ",";
+        page.appendJsonString(entry.reason, true);
+        page << "," << entry.changeCount << "," << entry.incompatibleCount << "]";
+    }
+    page << "],\n\"changes\":[";
+    for (size_t i = 0; i < changes.size(); ++i) {
+        const ChangeEntry& entry = changes[i];
+        page << (i ? ",\n[" : "[") << static_cast<size_t>(entry.headerIndex) << ",";
+        page.appendJsonString(entry.name, true);
+        page << ",";
+        page.appendJsonString(entry.description, true);
+        page << (entry.compatibilityChanged ? ",1" : ",0") << (entry.backwardIncompatible ? ",1]" : ",0]");
+    }
+    page << "]}";
+
+    page << CONSOLIDATED_HTML_FOOTER;
+
+    create_parent_dirs(path);
+    return page.writeTo(path);
+}
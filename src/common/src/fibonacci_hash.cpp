@@ -2,10 +2,12 @@
 // SPDX-License-Identifier: BSD-3-Clause
 #include "fibonacci_hash.hpp"
 #include "logger.hpp"
+#include "source_token_table.hpp"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Basic/LangOptions.h"
+#include <algorithm>
 
 uint64_t FibonacciHash::hash(const std::string& str) {
     return fibonacci_hash_impl(reinterpret_cast<const uint8_t*>(str.data()), str.length());
@@ -19,55 +21,8 @@ uint64_t FibonacciHash::hash(const llvm::StringRef& str) {
     return fibonacci_hash_impl(reinterpret_cast<const uint8_t*>(str.data()), str.size());
 }
 
-uint64_t FibonacciHash::fibonacci_hash_impl(const uint8_t* data, size_t length) {
-    uint64_t hash = 0x9E3779B97F4A7C15ULL; // Initial seed based on golden ratio
-
-    // Process bytes while skipping whitespace
-    uint64_t chunk = 0;
-    int chunkPos = 0;
-
-    for (size_t i = 0; i < length; ++i) {
-        uint8_t byte = data[i];
-
-        // Skip all whitespace characters (optimized with single comparison range check)
-        // ASCII whitespace: space(32), tab(9), LF(10), VT(11), FF(12), CR(13)
-        if (byte <= 32 && (byte == 32 || byte == 9 || (byte >= 10 && byte <= 13))) {
-            continue;
-        }
-
-        // Add byte to current chunk in little-endian order (reproducible)
-        chunk |= static_cast<uint64_t>(byte) << (chunkPos * 8);
-        chunkPos++;
-
-        // Process chunk when we have 8 bytes
-        if (chunkPos == 8) {
-            hash ^= chunk;
-            hash *= GOLDEN_RATIO_64;
-            hash ^= hash >> 32; // Avalanche effect
-
-            chunk = 0;
-            chunkPos = 0;
-        }
-    }
-
-    // Process remaining bytes (0-7 bytes)
-    if (chunkPos > 0) {
-        hash ^= chunk;
-        hash *= GOLDEN_RATIO_64;
-        hash ^= hash >> 32;
-    }
-
-    // Final avalanche mixing for better distribution
-    hash ^= hash >> 16;
-    hash *= 0x85EBCA6B;
-    hash ^= hash >> 13;
-    hash *= 0xC2B2AE35;
-    hash ^= hash >> 16;
-
-    return hash;
-}
-
-uint64_t FibonacciHash::hashFromSourceRange(clang::SourceManager* SM, clang::SourceRange Range) {
+uint64_t FibonacciHash::hashFromSourceRange(clang::SourceManager* SM, clang::SourceRange Range,
+                                            const armor::SourceTokenTable* tokens) {
     if (!SM || !Range.isValid()) return 0;
 
     clang::SourceLocation StartLoc = Range.getBegin();
@@ -99,10 +54,67 @@ uint64_t FibonacciHash::hashFromSourceRange(clang::SourceManager* SM, clang::Sou
         endOffset = SM->getFileOffset(EndLoc);
     }
 
-    return hashFromOffsets(SM, startOffset, endOffset);
+    return hashFromOffsets(SM, startOffset, endOffset, tokens);
+}
+
+void FibonacciHash::mixTokenBytes(const uint8_t* ptr, const uint8_t* end,
+                                  uint64_t& hash, uint64_t& chunk, int& chunkPos) {
+    // Process 8 bytes at a time when possible
+    while (ptr + 8 <= end && chunkPos == 0) {
+        // Fast path: directly load 8 bytes when chunk is empty
+        chunk = static_cast<uint64_t>(ptr[0]) |
+               (static_cast<uint64_t>(ptr[1]) << 8) |
+               (static_cast<uint64_t>(ptr[2]) << 16) |
+               (static_cast<uint64_t>(ptr[3]) << 24) |
+               (static_cast<uint64_t>(ptr[4]) << 32) |
+               (static_cast<uint64_t>(ptr[5]) << 40) |
+               (static_cast<uint64_t>(ptr[6]) << 48) |
+               (static_cast<uint64_t>(ptr[7]) << 56);
+
+        hash ^= chunk;
+        hash *= GOLDEN_RATIO_64;
+        hash ^= hash >> 32;
+
+        ptr += 8;
+        chunk = 0;
+    }
+
+    // Process remaining bytes
+    while (ptr < end) {
+        chunk |= static_cast<uint64_t>(*ptr) << (chunkPos * 8);
+        chunkPos++;
+        ptr++;
+
+        if (chunkPos == 8) {
+            hash ^= chunk;
+            hash *= GOLDEN_RATIO_64;
+            hash ^= hash >> 32;
+            chunk = 0;
+            chunkPos = 0;
+        }
+    }
+}
+
+uint64_t FibonacciHash::finalizeTokenHash(uint64_t hash, uint64_t chunk, int chunkPos) {
+    // Process remaining bytes (0-7 bytes)
+    if (chunkPos > 0) {
+        hash ^= chunk;
+        hash *= GOLDEN_RATIO_64;
+        hash ^= hash >> 32;
+    }
+
+    // Final avalanche mixing
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6B;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35;
+    hash ^= hash >> 16;
+
+    return hash;
 }
 
-uint64_t FibonacciHash::hashFromOffsets(clang::SourceManager* SM, unsigned startOffset, unsigned endOffset) {
+uint64_t FibonacciHash::hashFromOffsets(clang::SourceManager* SM, unsigned startOffset, unsigned endOffset,
+                                        const armor::SourceTokenTable* tokens) {
     if (!SM || startOffset >= endOffset){
         if(startOffset >= endOffset) TEST_LOG << "Error while computing Hash  startOffset >= endOffset \n";
         return 0;
@@ -121,6 +133,21 @@ uint64_t FibonacciHash::hashFromOffsets(clang::SourceManager* SM, unsigned start
     uint64_t chunk = 0;
     int chunkPos = 0;
 
+    // Fast path: tokens of the whole main file were lexed once up front, so
+    // only a binary search is needed to find the ones inside this range.
+    llvm::ArrayRef<armor::SourceTokenTable::Token> rangeTokens;
+    if (tokens && tokens->covers(*SM) && tokens->tokensInRange(startOffset, endOffset, rangeTokens)) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer.data());
+        for (const armor::SourceTokenTable::Token& token : rangeTokens) {
+            if (token.isComment) continue;
+
+            // Truncate token if it exceeds range
+            unsigned tokEndOffset = std::min(token.endOffset, endOffset);
+            mixTokenBytes(data + token.startOffset, data + tokEndOffset, hash, chunk, chunkPos);
+        }
+        return finalizeTokenHash(hash, chunk, chunkPos);
+    }
+
     clang::SourceLocation currentLoc = SM->getLocForStartOfFile(FID).getLocWithOffset(startOffset);
     clang::Token tok;
 
@@ -170,44 +197,7 @@ uint64_t FibonacciHash::hashFromOffsets(clang::SourceManager* SM, unsigned start
                     tokLen = endOffset - tokOffset;
                 }
 
-                // Hash token bytes with unrolled loop for better performance
-                const uint8_t* end = data + tokLen;
-                const uint8_t* ptr = data;
-
-                // Process 8 bytes at a time when possible
-                while (ptr + 8 <= end && chunkPos == 0) {
-                    // Fast path: directly load 8 bytes when chunk is empty
-                    chunk = static_cast<uint64_t>(ptr[0]) |
-                           (static_cast<uint64_t>(ptr[1]) << 8) |
-                           (static_cast<uint64_t>(ptr[2]) << 16) |
-                           (static_cast<uint64_t>(ptr[3]) << 24) |
-                           (static_cast<uint64_t>(ptr[4]) << 32) |
-                           (static_cast<uint64_t>(ptr[5]) << 40) |
-                           (static_cast<uint64_t>(ptr[6]) << 48) |
-                           (static_cast<uint64_t>(ptr[7]) << 56);
-
-                    hash ^= chunk;
-                    hash *= GOLDEN_RATIO_64;
-                    hash ^= hash >> 32;
-
-                    ptr += 8;
-                    chunk = 0;
-                }
-
-                // Process remaining bytes
-                while (ptr < end) {
-                    chunk |= static_cast<uint64_t>(*ptr) << (chunkPos * 8);
-                    chunkPos++;
-                    ptr++;
-
-                    if (chunkPos == 8) {
-                        hash ^= chunk;
-                        hash *= GOLDEN_RATIO_64;
-                        hash ^= hash >> 32;
-                        chunk = 0;
-                        chunkPos = 0;
-                    }
-                }
+                mixTokenBytes(data, data + tokLen, hash, chunk, chunkPos);
 
                 // Early exit if we've processed beyond range
                 if (tokEndOffset > endOffset) break;
@@ -218,19 +208,5 @@ uint64_t FibonacciHash::hashFromOffsets(clang::SourceManager* SM, unsigned start
         currentLoc = tok.getEndLoc();
     }
 
-    // Process remaining bytes (0-7 bytes)
-    if (chunkPos > 0) {
-        hash ^= chunk;
-        hash *= GOLDEN_RATIO_64;
-        hash ^= hash >> 32;
-    }
-
-    // Final avalanche mixing
-    hash ^= hash >> 16;
-    hash *= 0x85EBCA6B;
-    hash ^= hash >> 13;
-    hash *= 0xC2B2AE35;
-    hash ^= hash >> 16;
-
-    return hash;
-}
\ No newline at end of file
+    return finalizeTokenHash(hash, chunk, chunkPos);
+}
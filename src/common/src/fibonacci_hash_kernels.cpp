@@ -0,0 +1,289 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "fibonacci_hash.hpp"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ARMOR_FIBONACCI_HASH_X86 1
+#include <immintrin.h>
+#else
+#define ARMOR_FIBONACCI_HASH_X86 0
+#endif
+
+namespace {
+
+using KernelFn = uint64_t (*)(const uint8_t*, size_t);
+
+constexpr uint64_t HASH_SEED = 0x9E3779B97F4A7C15ULL; // Initial seed based on golden ratio
+
+inline bool isHashWhitespace(uint8_t byte) {
+    // ASCII whitespace: space(32), tab(9), LF(10), VT(11), FF(12), CR(13)
+    return byte <= 32 && (byte == 32 || byte == 9 || (byte >= 10 && byte <= 13));
+}
+
+inline uint64_t mixChunk(uint64_t hash, uint64_t chunk) {
+    hash ^= chunk;
+    hash *= FibonacciHash::GOLDEN_RATIO_64;
+    hash ^= hash >> 32; // Avalanche effect
+    return hash;
+}
+
+inline uint64_t finalMix(uint64_t hash) {
+    // Final avalanche mixing for better distribution
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6B;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+uint64_t hashScalar(const uint8_t* data, size_t length) {
+    uint64_t hash = HASH_SEED;
+
+    // Process bytes while skipping whitespace
+    uint64_t chunk = 0;
+    int chunkPos = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = data[i];
+
+        if (isHashWhitespace(byte)) {
+            continue;
+        }
+
+        // Add byte to current chunk in little-endian order (reproducible)
+        chunk |= static_cast<uint64_t>(byte) << (chunkPos * 8);
+        chunkPos++;
+
+        // Process chunk when we have 8 bytes
+        if (chunkPos == 8) {
+            hash = mixChunk(hash, chunk);
+            chunk = 0;
+            chunkPos = 0;
+        }
+    }
+
+    // Process remaining bytes (0-7 bytes)
+    if (chunkPos > 0) {
+        hash = mixChunk(hash, chunk);
+    }
+
+    return finalMix(hash);
+}
+
+#if ARMOR_FIBONACCI_HASH_X86
+
+// x86 is little-endian, so a plain 8-byte load yields the same chunk the
+// scalar loop assembles byte by byte.
+inline uint64_t loadChunk(const uint8_t* ptr) {
+    uint64_t chunk;
+    std::memcpy(&chunk, ptr, sizeof(chunk));
+    return chunk;
+}
+
+// pshufb controls that pack the bytes selected by an 8-bit keep-mask to the
+// front of an 8-byte group; unused lanes read 0x80 and come out as zero.
+struct CompactTable {
+    uint8_t shuffle[256][8];
+    uint8_t count[256];
+};
+
+constexpr CompactTable makeCompactTable() {
+    CompactTable table{};
+    for (int mask = 0; mask < 256; ++mask) {
+        int n = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            if (mask & (1 << bit)) table.shuffle[mask][n++] = static_cast<uint8_t>(bit);
+        }
+        table.count[mask] = static_cast<uint8_t>(n);
+        for (; n < 8; ++n) table.shuffle[mask][n] = 0x80;
+    }
+    return table;
+}
+
+constexpr CompactTable COMPACT_TABLE = makeCompactTable();
+
+// Non-whitespace bytes are compacted into a staging buffer and folded in
+// 8-byte words, exactly the chunks the scalar loop would form.
+struct CompactedStream {
+    uint64_t hash = HASH_SEED;
+    // Up to 7 pending bytes plus one 32-byte block, with slack for the
+    // full 8-byte stores of each compacted group.
+    uint8_t stage[64];
+    size_t pending = 0;
+
+    void append(const uint8_t* group, unsigned keepMask) {
+        std::memcpy(stage + pending, group, 8);
+        pending += COMPACT_TABLE.count[keepMask];
+    }
+
+    void fold() {
+        size_t pos = 0;
+        for (; pending - pos >= 8; pos += 8) {
+            hash = mixChunk(hash, loadChunk(stage + pos));
+        }
+        if (pos > 0) {
+            pending -= pos;
+            std::memmove(stage, stage + pos, pending);
+        }
+    }
+
+    uint64_t finish(const uint8_t* tail, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            if (isHashWhitespace(tail[i])) continue;
+            stage[pending++] = tail[i];
+            if (pending == 8) {
+                hash = mixChunk(hash, loadChunk(stage));
+                pending = 0;
+            }
+        }
+
+        if (pending > 0) {
+            uint64_t chunk = 0;
+            std::memcpy(&chunk, stage, pending);
+            hash = mixChunk(hash, chunk);
+        }
+
+        return finalMix(hash);
+    }
+};
+
+__attribute__((target("sse4.2")))
+inline __m128i whitespaceMask128(__m128i block) {
+    // space, or 9..13 tested as (byte - 9) <= 4 unsigned
+    __m128i isSpace = _mm_cmpeq_epi8(block, _mm_set1_epi8(32));
+    __m128i shifted = _mm_sub_epi8(block, _mm_set1_epi8(9));
+    __m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+    return _mm_or_si128(isSpace, isControl);
+}
+
+__attribute__((target("sse4.2")))
+uint64_t hashSSE42(const uint8_t* data, size_t length) {
+    CompactedStream stream;
+    const __m128i highGroupOffset = _mm_set_epi64x(0x0808080808080808LL, 0);
+    alignas(16) uint8_t packed[16];
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned keep = ~static_cast<unsigned>(_mm_movemask_epi8(whitespaceMask128(block))) & 0xFFFF;
+
+        if (keep == 0xFFFF && stream.pending == 0) {
+            stream.hash = mixChunk(stream.hash, loadChunk(data + i));
+            stream.hash = mixChunk(stream.hash, loadChunk(data + i + 8));
+            continue;
+        }
+        if (keep == 0) continue;
+
+        unsigned low = keep & 0xFF;
+        unsigned high = keep >> 8;
+        __m128i control = _mm_set_epi64x(static_cast<long long>(loadChunk(COMPACT_TABLE.shuffle[high])),
+                                         static_cast<long long>(loadChunk(COMPACT_TABLE.shuffle[low])));
+        control = _mm_add_epi8(control, highGroupOffset);
+        _mm_store_si128(reinterpret_cast<__m128i*>(packed), _mm_shuffle_epi8(block, control));
+
+        stream.append(packed, low);
+        stream.append(packed + 8, high);
+        stream.fold();
+    }
+
+    // Fewer than 16 bytes remain; finish them byte by byte.
+    return stream.finish(data + i, length - i);
+}
+
+__attribute__((target("avx2")))
+uint64_t hashAVX2(const uint8_t* data, size_t length) {
+    CompactedStream stream;
+    const __m256i oddGroupOffset = _mm256_set_epi64x(0x0808080808080808LL, 0, 0x0808080808080808LL, 0);
+    const __m256i space = _mm256_set1_epi8(32);
+    const __m256i controlBase = _mm256_set1_epi8(9);
+    const __m256i controlSpan = _mm256_set1_epi8(4);
+    alignas(32) uint8_t packed[32];
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i isSpace = _mm256_cmpeq_epi8(block, space);
+        __m256i shifted = _mm256_sub_epi8(block, controlBase);
+        __m256i isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, controlSpan), shifted);
+        uint32_t keep = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(isSpace, isControl)));
+
+        if (keep == 0xFFFFFFFFu && stream.pending == 0) {
+            stream.hash = mixChunk(stream.hash, loadChunk(data + i));
+            stream.hash = mixChunk(stream.hash, loadChunk(data + i + 8));
+            stream.hash = mixChunk(stream.hash, loadChunk(data + i + 16));
+            stream.hash = mixChunk(stream.hash, loadChunk(data + i + 24));
+            continue;
+        }
+        if (keep == 0) continue;
+
+        unsigned groups[4] = {keep & 0xFF, (keep >> 8) & 0xFF, (keep >> 16) & 0xFF, keep >> 24};
+        // vpshufb shuffles within each 128-bit lane, so the odd groups index bytes 8..15.
+        __m256i control = _mm256_set_epi64x(static_cast<long long>(loadChunk(COMPACT_TABLE.shuffle[groups[3]])),
+                                            static_cast<long long>(loadChunk(COMPACT_TABLE.shuffle[groups[2]])),
+                                            static_cast<long long>(loadChunk(COMPACT_TABLE.shuffle[groups[1]])),
+                                            static_cast<long long>(loadChunk(COMPACT_TABLE.shuffle[groups[0]])));
+        control = _mm256_add_epi8(control, oddGroupOffset);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(packed), _mm256_shuffle_epi8(block, control));
+
+        for (int group = 0; group < 4; ++group) {
+            stream.append(packed + group * 8, groups[group]);
+        }
+        stream.fold();
+    }
+
+    // Fewer than 32 bytes remain; finish them byte by byte.
+    return stream.finish(data + i, length - i);
+}
+
+#endif // ARMOR_FIBONACCI_HASH_X86
+
+KernelFn kernelFunction(FibonacciHash::Kernel kernel) {
+    switch (kernel) {
+#if ARMOR_FIBONACCI_HASH_X86
+        case FibonacciHash::Kernel::AVX2:
+            return hashAVX2;
+        case FibonacciHash::Kernel::SSE42:
+            return hashSSE42;
+#endif
+        default:
+            return hashScalar;
+    }
+}
+
+} // namespace
+
+bool FibonacciHash::isKernelSupported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+#if ARMOR_FIBONACCI_HASH_X86
+        case Kernel::SSE42:
+            return __builtin_cpu_supports("sse4.2");
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+FibonacciHash::Kernel FibonacciHash::activeKernel() {
+    static const Kernel kernel = [] {
+        if (isKernelSupported(Kernel::AVX2)) return Kernel::AVX2;
+        if (isKernelSupported(Kernel::SSE42)) return Kernel::SSE42;
+        return Kernel::Scalar;
+    }();
+    return kernel;
+}
+
+uint64_t FibonacciHash::hashWithKernel(Kernel kernel, const uint8_t* data, size_t length) {
+    if (!isKernelSupported(kernel)) kernel = Kernel::Scalar;
+    return kernelFunction(kernel)(data, length);
+}
+
+uint64_t FibonacciHash::fibonacci_hash_impl(const uint8_t* data, size_t length) {
+    static const KernelFn kernel = kernelFunction(activeKernel());
+    return kernel(data, length);
+}
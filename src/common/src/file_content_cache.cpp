@@ -0,0 +1,79 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "file_content_cache.hpp"
+#include <mutex>
+#include <utility>
+#include "llvm/Support/xxhash.h"
+#include "archive_file_system.hpp"
+
+namespace {
+
+struct ContentHash {
+    uint64_t size;
+    llvm::sys::TimePoint<> modified;
+    uint64_t hash;
+};
+
+// Hashes of every cache in the process: pairs are compared on worker threads, each with its own cache.
+std::mutex contentHashMutex;
+llvm::StringMap<ContentHash> contentHashes;
+
+std::optional<uint64_t> knownHash(const std::string& path, const llvm::vfs::Status& status) {
+    std::scoped_lock<std::mutex> lock(contentHashMutex);
+    auto it = contentHashes.find(path);
+    if (it == contentHashes.end() || it->second.size != status.getSize() ||
+        it->second.modified != status.getLastModificationTime())
+        return std::nullopt;
+    return it->second.hash;
+}
+
+} // namespace
+
+bool armor::FileContentCache::filesDiffer(const std::string& file1, const std::string& file2) {
+    llvm::vfs::FileSystem& fileSystem = armor::getFileSystem();
+    llvm::ErrorOr<llvm::vfs::Status> status1 = fileSystem.status(file1);
+    llvm::ErrorOr<llvm::vfs::Status> status2 = fileSystem.status(file2);
+    if (!status1 || !status2 || status1->getSize() != status2->getSize()) return true;
+
+    std::optional<uint64_t> hash1 = knownHash(file1, *status1);
+    std::optional<uint64_t> hash2 = knownHash(file2, *status2);
+    if (hash1 && hash2) return *hash1 != *hash2;
+
+    const llvm::MemoryBuffer* buffer1 = getBuffer(file1);
+    const llvm::MemoryBuffer* buffer2 = getBuffer(file2);
+    if (!buffer1 || !buffer2) return true;
+
+    return buffer1->getBuffer() != buffer2->getBuffer();
+}
+
+const llvm::MemoryBuffer* armor::FileContentCache::getBuffer(const std::string& path) {
+    std::unique_ptr<llvm::MemoryBuffer>& entry = buffers[path];
+    if (!entry) {
+        // Null-terminated so the lexer can run straight off the mapping.
+        llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer = armor::getFileSystem().getBufferForFile(path);
+        if (!buffer) {
+            buffers.erase(path);
+            return nullptr;
+        }
+        entry = std::move(*buffer);
+    }
+    return entry.get();
+}
+
+std::optional<uint64_t> armor::FileContentCache::getContentHash(const std::string& path) {
+    llvm::ErrorOr<llvm::vfs::Status> status = armor::getFileSystem().status(path);
+    if (!status) return std::nullopt;
+    if (std::optional<uint64_t> hash = knownHash(path, *status)) return hash;
+
+    const llvm::MemoryBuffer* buffer = getBuffer(path);
+    if (!buffer) return std::nullopt;
+    uint64_t hash = llvm::xxHash64(buffer->getBuffer());
+
+    std::scoped_lock<std::mutex> lock(contentHashMutex);
+    contentHashes[path] = {status->getSize(), status->getLastModificationTime(), hash};
+    return hash;
+}
+
+void armor::FileContentCache::release(const std::string& path) {
+    buffers.erase(path);
+}
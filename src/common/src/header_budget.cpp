@@ -0,0 +1,63 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "header_budget.hpp"
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+armor::HeaderBudget::Scope::Scope(const Limits& limits) : previous(current) {
+    state.limits = limits;
+    state.deadline = std::chrono::steady_clock::now() + limits.time;
+    current = &state;
+}
+
+armor::HeaderBudget::Scope::~Scope() {
+    current = previous;
+}
+
+bool armor::HeaderBudget::exceeded() {
+    State* state = current;
+    if (!state) return false;
+    if (state->reason != Reason::None) return true;
+
+    const Limits& limits = state->limits;
+    if (limits.time.count() > 0 && std::chrono::steady_clock::now() >= state->deadline) {
+        state->reason = Reason::Time;
+        return true;
+    }
+    if (limits.memoryBytes > 0 && state->polls++ % MEMORY_POLL_INTERVAL == 0 &&
+        residentBytes() > limits.memoryBytes) {
+        state->reason = Reason::Memory;
+        return true;
+    }
+    return false;
+}
+
+armor::HeaderBudget::Reason armor::HeaderBudget::reason() {
+    return current ? current->reason : Reason::None;
+}
+
+std::string armor::HeaderBudget::describe() {
+    if (!current) return "no budget";
+    const Limits& limits = current->limits;
+    switch (current->reason) {
+        case Reason::Time:
+        {
+            std::ostringstream seconds;
+            seconds << limits.time.count() / 1000.0;
+            return "time budget of " + seconds.str() + "s";
+        }
+        case Reason::Memory:
+            return "memory budget of " + std::to_string(limits.memoryBytes / (1024 * 1024)) + " MiB";
+        default:
+            return "no budget";
+    }
+}
+
+uint64_t armor::HeaderBudget::residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t sizePages = 0;
+    uint64_t residentPages = 0;
+    if (!(statm >> sizePages >> residentPages)) return 0;
+    return residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
@@ -0,0 +1,270 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "header_discovery.hpp"
+#include <algorithm>
+#include <thread>
+#include <tuple>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
+#include "archive_file_system.hpp"
+#include "file_content_cache.hpp"
+#include "header_scheduler.hpp"
+#include "trace.hpp"
+
+const std::vector<std::string>& armor::HeaderFilter::defaultIncludes() {
+    static const std::vector<std::string> patterns = {"*.h", "*.hpp"};
+    return patterns;
+}
+
+std::optional<armor::HeaderFilter> armor::HeaderFilter::create(const std::vector<std::string>& includes,
+                                                               const std::vector<std::string>& excludes,
+                                                               std::string& error) {
+    auto compile = [&](const std::vector<std::string>& patterns, std::vector<Pattern>& compiled) {
+        for (const std::string& pattern : patterns) {
+            auto text = std::make_shared<const std::string>(pattern);
+            llvm::Expected<llvm::GlobPattern> glob = llvm::GlobPattern::create(*text);
+            if (!glob) {
+                error = "Invalid pattern '" + pattern + "': " + llvm::toString(glob.takeError());
+                return false;
+            }
+            compiled.push_back({text, std::move(*glob), pattern.find('/') != std::string::npos});
+        }
+        return true;
+    };
+    HeaderFilter filter;
+    if (!compile(includes.empty() ? defaultIncludes() : includes, filter.includes) ||
+        !compile(excludes, filter.excludes))
+        return std::nullopt;
+    return filter;
+}
+
+bool armor::HeaderFilter::anyMatches(const std::vector<Pattern>& patterns, llvm::StringRef relativePath) {
+    llvm::StringRef name = llvm::sys::path::filename(relativePath, llvm::sys::path::Style::posix);
+    return std::any_of(patterns.begin(), patterns.end(), [&](const Pattern& pattern) {
+        return pattern.glob.match(pattern.wholePath ? relativePath : name);
+    });
+}
+
+bool armor::HeaderFilter::matches(llvm::StringRef relativePath) const {
+    return anyMatches(includes, relativePath) && !anyMatches(excludes, relativePath);
+}
+
+std::vector<std::string> armor::findHeaders(const std::string& dir, const HeaderFilter& filter, bool recursive) {
+    llvm::vfs::FileSystem& fileSystem = getFileSystem();
+    std::vector<std::string> headers;
+    auto consider = [&](const llvm::vfs::directory_entry& entry) {
+        if (entry.type() == llvm::sys::fs::file_type::directory_file) return;
+        llvm::StringRef relative = llvm::StringRef(entry.path()).substr(dir.size()).ltrim('/');
+        if (!filter.matches(relative)) return;
+        // Symbolic links to headers count; they are not followed into directories.
+        if (entry.type() != llvm::sys::fs::file_type::regular_file) {
+            llvm::ErrorOr<llvm::vfs::Status> status = fileSystem.status(entry.path());
+            if (!status || !status->isRegularFile()) return;
+        }
+        headers.push_back(relative.str());
+    };
+
+    std::error_code ec;
+    if (recursive) {
+        for (llvm::vfs::recursive_directory_iterator it(fileSystem, dir, ec), end; it != end && !ec; it.increment(ec))
+            consider(*it);
+    }
+    else {
+        for (llvm::vfs::directory_iterator it = fileSystem.dir_begin(dir, ec), end; it != end && !ec; it.increment(ec))
+            consider(*it);
+    }
+    std::sort(headers.begin(), headers.end());
+    return headers;
+}
+
+// Sorted hashes of the non-blank lines of text, without indentation.
+static std::vector<uint64_t> lineHashes(llvm::StringRef text) {
+    std::vector<uint64_t> hashes;
+    while (!text.empty()) {
+        llvm::StringRef line;
+        std::tie(line, text) = text.split('\n');
+        line = line.trim();
+        if (!line.empty()) hashes.push_back(llvm::xxHash64(line));
+    }
+    std::sort(hashes.begin(), hashes.end());
+    return hashes;
+}
+
+static double similarity(const std::vector<uint64_t>& lines1, const std::vector<uint64_t>& lines2) {
+    if (lines1.empty() && lines2.empty()) return 1.0;
+    size_t common = 0;
+    for (auto it1 = lines1.begin(), it2 = lines2.begin(); it1 != lines1.end() && it2 != lines2.end();) {
+        if (*it1 < *it2) ++it1;
+        else if (*it2 < *it1) ++it2;
+        else {
+            ++common;
+            ++it1;
+            ++it2;
+        }
+    }
+    return 2.0 * common / (lines1.size() + lines2.size());
+}
+
+double armor::lineSimilarity(llvm::StringRef text1, llvm::StringRef text2) {
+    return similarity(lineHashes(text1), lineHashes(text2));
+}
+
+// Most new headers a remaining old header is scored against, besides those of its file name.
+static constexpr size_t MAX_SIMILARITY_CANDIDATES = 64;
+
+static llvm::StringRef fileName(llvm::StringRef path) {
+    return llvm::sys::path::filename(path, llvm::sys::path::Style::posix);
+}
+
+std::vector<armor::DiscoveredHeader> armor::discoverHeaders(const std::string& oldDir, const std::string& newDir,
+                                                            const HeaderFilter& filter, bool recursive,
+                                                            unsigned jobs, double minSimilarity) {
+    armor::TraceScope span("header discovery", "discover", oldDir + " " + newDir);
+    std::vector<std::string> oldFiles;
+    std::vector<std::string> newFiles;
+    std::thread newWalk([&] { newFiles = findHeaders(newDir, filter, recursive); });
+    oldFiles = findHeaders(oldDir, filter, recursive);
+    newWalk.join();
+
+    // Content hashes of both sides; each task fills its own slot.
+    size_t oldCount = oldFiles.size();
+    auto fullPath = [&](size_t i) {
+        return i < oldCount ? oldDir + "/" + oldFiles[i] : newDir + "/" + newFiles[i - oldCount];
+    };
+    std::vector<std::optional<uint64_t>> hashes(oldCount + newFiles.size());
+    // Kept by FileContentCache, so the comparison and the include graph do not hash them again.
+    runLongestFirst(std::vector<double>(hashes.size(), 1.0), jobs, [&](size_t i) {
+        FileContentCache contentCache;
+        hashes[i] = contentCache.getContentHash(fullPath(i));
+    });
+    auto oldHash = [&](size_t i) { return hashes[i]; };
+    auto newHash = [&](size_t j) { return hashes[oldCount + j]; };
+
+    std::vector<DiscoveredHeader> result;
+    std::vector<bool> oldPaired(oldCount);
+    std::vector<bool> newPaired(newFiles.size());
+    auto pair = [&](size_t i, size_t j, double score) {
+        DiscoveredHeader& header = result.emplace_back();
+        header.oldPath = oldFiles[i];
+        header.newPath = newFiles[j];
+        header.identical = oldHash(i) && oldHash(i) == newHash(j);
+        header.similarity = score;
+        oldPaired[i] = true;
+        newPaired[j] = true;
+    };
+
+    // Same path.
+    llvm::StringMap<size_t> newByPath;
+    for (size_t j = 0; j < newFiles.size(); ++j) newByPath[newFiles[j]] = j;
+    for (size_t i = 0; i < oldCount; ++i) {
+        auto it = newByPath.find(oldFiles[i]);
+        if (it != newByPath.end()) pair(i, it->getValue(), 1.0);
+    }
+
+    // Moved without changes: same contents, preferring the same file name.
+    llvm::DenseMap<uint64_t, std::vector<size_t>> newByHash;
+    for (size_t j = 0; j < newFiles.size(); ++j) {
+        if (!newPaired[j] && newHash(j)) newByHash[*newHash(j)].push_back(j);
+    }
+    for (size_t i = 0; i < oldCount; ++i) {
+        if (oldPaired[i] || !oldHash(i)) continue;
+        auto it = newByHash.find(*oldHash(i));
+        if (it == newByHash.end()) continue;
+        std::optional<size_t> best;
+        for (size_t j : it->second) {
+            if (newPaired[j]) continue;
+            if (!best || (fileName(newFiles[j]) == fileName(oldFiles[i]) &&
+                          fileName(newFiles[*best]) != fileName(oldFiles[i])))
+                best = j;
+        }
+        if (best) pair(i, *best, 1.0);
+    }
+
+    // Moved and edited: the most similar remaining pairs, best first.
+    std::vector<size_t> oldLeft;
+    std::vector<size_t> newLeft;
+    for (size_t i = 0; i < oldCount; ++i) {
+        if (!oldPaired[i]) oldLeft.push_back(i);
+    }
+    for (size_t j = 0; j < newFiles.size(); ++j) {
+        if (!newPaired[j]) newLeft.push_back(j);
+    }
+    if (!oldLeft.empty() && !newLeft.empty()) {
+        std::vector<std::vector<uint64_t>> lines(hashes.size());
+        for (size_t i : oldLeft) {
+            if (auto buffer = getFileSystem().getBufferForFile(fullPath(i), -1, false))
+                lines[i] = lineHashes((*buffer)->getBuffer());
+        }
+        for (size_t j : newLeft) {
+            if (auto buffer = getFileSystem().getBufferForFile(fullPath(oldCount + j), -1, false))
+                lines[oldCount + j] = lineHashes((*buffer)->getBuffer());
+        }
+        struct Candidate {
+            double score;
+            bool sameName;
+            size_t oldIndex;
+            size_t newIndex;
+        };
+        // Two headers of n1 and n2 lines score at most 2 * min(n1, n2) / (n1 + n2),
+        // so only new headers whose line count is within this ratio of the old
+        // one's can reach minSimilarity. Of those, the same file name and the
+        // nearest line counts are scored, which bounds the work per header.
+        double ratio = minSimilarity >= 1.0 ? 1.0 : std::max(0.0, minSimilarity / (2.0 - minSimilarity));
+        auto lineCount = [&](size_t j) { return lines[oldCount + j].size(); };
+        std::sort(newLeft.begin(), newLeft.end(), [&](size_t a, size_t b) {
+            return std::make_pair(lineCount(a), a) < std::make_pair(lineCount(b), b);
+        });
+
+        std::vector<Candidate> candidates;
+        std::vector<std::pair<size_t, size_t>> nearest;   // (line count difference, new index)
+        for (size_t i : oldLeft) {
+            size_t count = lines[i].size();
+            double low = count * ratio;
+            double high = ratio > 0 ? count / ratio : static_cast<double>(SIZE_MAX);
+            auto first = std::lower_bound(newLeft.begin(), newLeft.end(), low,
+                                          [&](size_t j, double bound) { return lineCount(j) < bound; });
+            auto last = std::upper_bound(first, newLeft.end(), high,
+                                         [&](double bound, size_t j) { return bound < lineCount(j); });
+
+            nearest.clear();
+            auto score = [&](size_t j) {
+                double value = similarity(lines[i], lines[oldCount + j]);
+                if (value >= minSimilarity)
+                    candidates.push_back({value, fileName(oldFiles[i]) == fileName(newFiles[j]), i, j});
+            };
+            for (auto it = first; it != last; ++it) {
+                if (fileName(newFiles[*it]) == fileName(oldFiles[i]))
+                    score(*it);
+                else
+                    nearest.emplace_back(std::max(count, lineCount(*it)) - std::min(count, lineCount(*it)), *it);
+            }
+            if (nearest.size() > MAX_SIMILARITY_CANDIDATES) {
+                std::nth_element(nearest.begin(), nearest.begin() + MAX_SIMILARITY_CANDIDATES, nearest.end());
+                nearest.resize(MAX_SIMILARITY_CANDIDATES);
+            }
+            for (const auto& candidate : nearest) score(candidate.second);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return std::tie(b.score, b.sameName, a.oldIndex, a.newIndex) <
+                   std::tie(a.score, a.sameName, b.oldIndex, b.newIndex);
+        });
+        for (const Candidate& candidate : candidates) {
+            if (!oldPaired[candidate.oldIndex] && !newPaired[candidate.newIndex])
+                pair(candidate.oldIndex, candidate.newIndex, candidate.score);
+        }
+    }
+
+    for (size_t i = 0; i < oldCount; ++i) {
+        if (!oldPaired[i]) result.push_back({oldFiles[i], "", false, 0.0});
+    }
+    for (size_t j = 0; j < newFiles.size(); ++j) {
+        if (!newPaired[j]) result.push_back({"", newFiles[j], false, 0.0});
+    }
+    std::sort(result.begin(), result.end(), [](const DiscoveredHeader& a, const DiscoveredHeader& b) {
+        return (a.newPath.empty() ? a.oldPath : a.newPath) < (b.newPath.empty() ? b.oldPath : b.newPath);
+    });
+    return result;
+}
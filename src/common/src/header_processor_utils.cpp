@@ -11,10 +11,14 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Path.h"
 
+#include "categorization.hpp"
 #include "comm_def.hpp"
+#include "header_budget.hpp"
 #include "header_processor_utils.hpp"
 #include "logger.hpp"
 #include "report_generator.hpp"
+#include "report_utils.hpp"
+#include "trace.hpp"
 
 namespace fs = std::filesystem;
 
@@ -104,33 +108,48 @@ std::vector<std::string> generateIncludePaths(const std::string& projectPath, co
     return includePaths;
 }
 
-void emitHeaderDiffReport(const nlohmann::json& diffResult,
+std::vector<std::string> getHeaderClangFlags(const std::string& projectPath,
+                                             const std::string& headerPath,
+                                             const std::vector<std::string>& includePaths,
+                                             const std::vector<std::string>& macroFlags,
+                                             LANG_OPTIONS lang) {
+    std::vector<std::string> flags =
+        getClangFlags(resolveInternalIncludePaths(includePaths, projectPath), macroFlags, lang);
+    std::vector<std::string> headerPaths = generateIncludePaths(projectPath, headerPath);
+    flags.insert(flags.end(), headerPaths.begin(), headerPaths.end());
+    return flags;
+}
+
+HeaderReportSummary emitHeaderDiffReport(const nlohmann::json& diffResult,
                           const std::string& file1,
                           const std::string& project1,
                           const std::string& reportFormat,
-                          PARSER parser) {
+                          PARSER parser,
+                          bool dumpAstDiff,
+                          const std::string& reportName) {
+    TraceScope span("report generation", "report", file1);
 
-    std::string headerName = std::filesystem::path(file1).filename().string();
+    std::string headerName = reportName.empty() ? report_name_for_header(file1, project1) : reportName;
 
-    std::string dumpDir = "debug_output/ast_diffs";
-    std::filesystem::create_directories(dumpDir);
-    std::string outputFile = dumpDir + "/ast_diff_output_" + headerName + ".json";
-
-    try {
-        if (!diffResult.empty()) {
+    if (dumpAstDiff && !diffResult.empty()) {
+        try {
+            std::string dumpDir = "debug_output/ast_diffs";
+            std::filesystem::create_directories(dumpDir);
+            std::string outputFile = dumpDir + "/ast_diff_output_" + headerName + ".json";
             std::ofstream out(outputFile, std::ios::trunc);
             out << diffResult.dump(4);
             out.close();
         }
-    }
-    catch (const std::exception& e) {
-        armor::user_error() << "Error generating AST diff: " << e.what() << "\n";
+        catch (const std::exception& e) {
+            armor::user_error() << "Error generating AST diff: " << e.what() << "\n";
+        }
     }
 
     std::string reportDir = "armor_reports/html_reports";
     std::filesystem::create_directories(reportDir);
     std::string htmlReportFile = reportDir + "/api_diff_report_" + headerName + ".html";
 
+    HeaderReportSummary summary;
     if (!diffResult.empty()) {
         bool generate_json = (reportFormat == "json");
         std::string jsonReportFile;
@@ -141,7 +160,7 @@ void emitHeaderDiffReport(const nlohmann::json& diffResult,
         }
         fs::path relative_path = fs::relative(file1, project1);
         std::string trimmed_path = relative_path.string();
-        report_generator(outputFile, trimmed_path, htmlReportFile, jsonReportFile, parser, generate_json);
+        summary = report_generator(diffResult, trimmed_path, htmlReportFile, jsonReportFile, parser, generate_json);
     }
     else {
         try {
@@ -150,6 +169,15 @@ void emitHeaderDiffReport(const nlohmann::json& diffResult,
             armor::user_error() << "Failed to generate HTML report: " << e.what() << "\n";
         }
     }
+    return summary;
+}
+
+void markAlphaOnly(HeaderReportSummary& summary) {
+    summary.compatibility = "unknown";
+    summary.overallStatus = serialize(OverAllStatus::NOT_CATEGORIZED);
+    summary.reason = "Beta parser stopped after exceeding the " + HeaderBudget::describe() +
+                     "; the alpha parser found no fatal errors. Cannot comment on compatibility.";
+    summary.degradation = "alpha_only";
 }
 
 } // namespace armor
@@ -0,0 +1,216 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "header_scheduler.hpp"
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <tuple>
+#include <nlohmann/json.hpp>
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/xxhash.h"
+#include "archive_file_system.hpp"
+#include "trace.hpp"
+
+bool armor::HeaderCostModel::loadHistory(const std::string& statsPath) {
+    std::ifstream in(statsPath);
+    if (!in) return false;
+
+    nlohmann::json stats = nlohmann::json::parse(in, nullptr, false);
+    if (!stats.is_object() || !stats.contains("headers")) return false;
+
+    for (const auto& entry : stats["headers"]) {
+        if (!entry.contains("header") || !entry.contains("stages_ms")) continue;
+        const auto& stages = entry["stages_ms"];
+        if (stages.contains("header") && stages["header"].is_number()) {
+            addHistory(entry["header"].get<std::string>(), stages["header"].get<double>());
+        }
+    }
+    return true;
+}
+
+void armor::HeaderCostModel::addHistory(llvm::StringRef header, double milliseconds) {
+    history[header] = milliseconds;
+}
+
+std::vector<double> armor::HeaderCostModel::estimate(const std::vector<HeaderPair>& pairs) const {
+    std::vector<double> rawCosts;
+    rawCosts.reserve(pairs.size());
+    for (const HeaderPair& pair : pairs) {
+        rawCosts.push_back(static_cast<double>(sizeCost(pair.file1, pair.file2)));
+    }
+
+    std::vector<double> ratios;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        auto it = history.find(pairs[i].header);
+        if (it != history.end() && rawCosts[i] > 0) ratios.push_back(it->second / rawCosts[i]);
+    }
+    double scale = 1.0;
+    if (!ratios.empty()) {
+        std::nth_element(ratios.begin(), ratios.begin() + ratios.size() / 2, ratios.end());
+        scale = ratios[ratios.size() / 2];
+    }
+
+    std::vector<double> costs;
+    costs.reserve(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        auto it = history.find(pairs[i].header);
+        costs.push_back(it != history.end() ? it->second : rawCosts[i] * scale);
+    }
+    return costs;
+}
+
+uint64_t armor::HeaderCostModel::sizeCost(const std::string& file1, const std::string& file2) {
+    uint64_t cost = 0;
+    for (const std::string* file : {&file1, &file2}) {
+        llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer = armor::getFileSystem().getBufferForFile(*file);
+        if (!buffer) continue;
+        llvm::StringRef source = (*buffer)->getBuffer();
+        cost += source.size() + countIncludes(source) * INCLUDE_WEIGHT_BYTES;
+    }
+    return cost;
+}
+
+size_t armor::HeaderCostModel::countIncludes(llvm::StringRef source) {
+    size_t count = 0;
+    while (!source.empty()) {
+        llvm::StringRef line;
+        std::tie(line, source) = source.split('\n');
+        line = line.ltrim();
+        if (!line.consume_front("#")) continue;
+        if (line.ltrim().startswith("include")) ++count;
+    }
+    return count;
+}
+
+namespace {
+
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+    double remaining = 0;
+};
+
+} // namespace
+
+void armor::runLongestFirst(const std::vector<double>& costs, unsigned workers,
+                            const std::function<void(size_t)>& task) {
+    std::vector<size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&costs](size_t lhs, size_t rhs) { return costs[lhs] > costs[rhs]; });
+
+    workers = std::max(1u, std::min<unsigned>(workers, static_cast<unsigned>(costs.size())));
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    for (unsigned i = 0; i < workers; ++i) queues.push_back(std::make_unique<WorkerQueue>());
+
+    for (size_t index : order) {
+        auto lightest = std::min_element(queues.begin(), queues.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs->remaining < rhs->remaining;
+        });
+        (*lightest)->tasks.push_back(index);
+        (*lightest)->remaining += costs[index];
+    }
+
+    std::mutex errorMutex;
+    std::exception_ptr firstError;
+
+    auto takeOwn = [&](WorkerQueue& queue, size_t& index) {
+        std::scoped_lock<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        index = queue.tasks.front();
+        queue.tasks.pop_front();
+        queue.remaining -= costs[index];
+        return true;
+    };
+
+    auto steal = [&](unsigned thief, size_t& index) {
+        while (true) {
+            WorkerQueue* victim = nullptr;
+            double most = 0;
+            for (unsigned i = 0; i < workers; ++i) {
+                if (i == thief) continue;
+                std::scoped_lock<std::mutex> lock(queues[i]->mutex);
+                if (!queues[i]->tasks.empty() && (!victim || queues[i]->remaining > most)) {
+                    victim = queues[i].get();
+                    most = queues[i]->remaining;
+                }
+            }
+            if (!victim) return false;
+
+            std::scoped_lock<std::mutex> lock(victim->mutex);
+            if (victim->tasks.empty()) continue;   // drained meanwhile; look again
+            index = victim->tasks.back();
+            victim->tasks.pop_back();
+            victim->remaining -= costs[index];
+            return true;
+        }
+    };
+
+    auto work = [&](unsigned self) {
+        Tracer::getInstance().attachThread();
+        size_t index = 0;
+        while (takeOwn(*queues[self], index) || steal(self, index)) {
+            try {
+                task(index);
+            }
+            catch (...) {
+                std::scoped_lock<std::mutex> lock(errorMutex);
+                if (!firstError) firstError = std::current_exception();
+            }
+        }
+        Tracer::getInstance().detachThread();
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < workers; ++i) threads.emplace_back(work, i);
+    work(0);
+    for (std::thread& thread : threads) thread.join();
+
+    if (firstError) std::rethrow_exception(firstError);
+}
+
+std::optional<armor::ShardSpec> armor::ShardSpec::parse(llvm::StringRef spec) {
+    llvm::StringRef indexText, countText;
+    std::tie(indexText, countText) = spec.split('/');
+    ShardSpec shard;
+    if (indexText.getAsInteger(10, shard.index) || countText.getAsInteger(10, shard.count)) return std::nullopt;
+    if (shard.count == 0 || shard.index == 0 || shard.index > shard.count) return std::nullopt;
+    return shard;
+}
+
+std::string armor::ShardSpec::toString() const {
+    return std::to_string(index) + "/" + std::to_string(count);
+}
+
+std::vector<size_t> armor::selectShard(const std::vector<HeaderPair>& pairs, const std::vector<double>& costs,
+                                       const ShardSpec& shard) {
+    std::vector<size_t> selected;
+    if (shard.strategy == ShardSpec::Strategy::Hash) {
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            uint64_t hash = llvm::xxHash64(pairs[i].header);
+            if (hash % shard.count == shard.index - 1) selected.push_back(i);
+        }
+        return selected;
+    }
+
+    // Order only by cost and name so the plan does not depend on input order.
+    std::vector<size_t> order(pairs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        if (costs[lhs] != costs[rhs]) return costs[lhs] > costs[rhs];
+        return pairs[lhs].header < pairs[rhs].header;
+    });
+
+    std::vector<double> load(shard.count, 0.0);
+    for (size_t index : order) {
+        size_t lightest = std::min_element(load.begin(), load.end()) - load.begin();
+        load[lightest] += costs[index];
+        if (lightest == shard.index - 1) selected.push_back(index);
+    }
+    std::sort(selected.begin(), selected.end());
+    return selected;
+}
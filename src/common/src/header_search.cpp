@@ -0,0 +1,189 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "header_search.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <set>
+#include <system_error>
+#include <utility>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Path.h"
+#include "archive_file_system.hpp"
+
+static constexpr const char* SEARCH_OPTIONS[] = {"-I", "-isystem", "-iquote", "-idirafter"};
+
+// Directory without "." components and repeated or trailing separators.
+static std::string canonicalDirectory(llvm::StringRef dir) {
+    llvm::SmallString<256> path(dir);
+    llvm::sys::path::remove_dots(path, /*remove_dot_dot=*/false);
+    if (path.empty()) return ".";
+    return std::string(path.str());
+}
+
+// Answered by the shared index while it is enabled, so each directory is read once per run.
+static bool isExistingDirectory(llvm::StringRef absolutePath) {
+    armor::DirectoryIndex& index = armor::DirectoryIndex::getInstance();
+    if (index.isEnabled()) return index.isDirectory(absolutePath);
+    llvm::ErrorOr<llvm::vfs::Status> status = armor::getFileSystem().status(absolutePath);
+    return status && status->isDirectory();
+}
+
+// The parent of "link/.." is not "link"'s parent when link is a symbolic link.
+static bool hasDotDot(llvm::StringRef path) {
+    return std::find(llvm::sys::path::begin(path), llvm::sys::path::end(path), "..") != llvm::sys::path::end(path);
+}
+
+std::vector<std::string> armor::canonicalizeSearchPaths(const std::vector<std::string>& arguments) {
+    std::vector<std::string> result;
+    std::set<std::pair<std::string, std::string>> seen;
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        llvm::StringRef argument = arguments[i];
+        auto option = std::find_if(std::begin(SEARCH_OPTIONS), std::end(SEARCH_OPTIONS),
+                                   [&](const char* candidate) { return argument.startswith(candidate); });
+        if (option == std::end(SEARCH_OPTIONS) || (argument == *option && i + 1 == arguments.size())) {
+            result.push_back(arguments[i]);
+            continue;
+        }
+        llvm::StringRef dir = argument.drop_front(std::strlen(*option));
+        if (dir.empty()) dir = arguments[++i];
+
+        std::string canonical = canonicalDirectory(dir);
+        if (!seen.insert({*option, canonical}).second) continue;
+        // A relative directory is resolved against the compilation directory, not ours.
+        if (llvm::sys::path::is_absolute(canonical) && !isExistingDirectory(canonical)) continue;
+        result.push_back(*option + canonical);
+    }
+    return result;
+}
+
+armor::DirectoryIndex& armor::DirectoryIndex::getInstance() {
+    static DirectoryIndex instance(getFileSystem());
+    return instance;
+}
+
+armor::DirectoryIndex::Scope::Scope() {
+    DirectoryIndex& index = getInstance();
+    index.clear();
+    index.enabled = true;
+}
+
+armor::DirectoryIndex::Scope::~Scope() {
+    DirectoryIndex& index = getInstance();
+    index.enabled = false;
+    index.clear();
+}
+
+void armor::DirectoryIndex::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    directories.clear();
+    avoidedLookups = 0;
+}
+
+size_t armor::DirectoryIndex::getListedDirectoryCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::count_if(directories.begin(), directories.end(), [](const auto& entry) {
+        return entry.getValue()->state == Directory::State::Listed;
+    });
+}
+
+bool armor::DirectoryIndex::isKnownMissing(llvm::StringRef absolutePath) {
+    llvm::SmallString<256> path(absolutePath);
+    llvm::sys::path::remove_dots(path, /*remove_dot_dot=*/false);
+    if (!llvm::sys::path::is_absolute(path) || hasDotDot(path)) return false;
+    if (!isMissing(path)) return false;
+    ++avoidedLookups;
+    return true;
+}
+
+bool armor::DirectoryIndex::isDirectory(llvm::StringRef absolutePath) {
+    llvm::SmallString<256> path(absolutePath);
+    llvm::sys::path::remove_dots(path, /*remove_dot_dot=*/false);
+    if (llvm::sys::path::is_absolute(path) && !hasDotDot(path)) {
+        std::shared_ptr<const Directory> directory = getDirectory(path);
+        if (directory->state != Directory::State::Unknown) return directory->state == Directory::State::Listed;
+    }
+    llvm::ErrorOr<llvm::vfs::Status> status = fileSystem.status(path);
+    return status && status->isDirectory();
+}
+
+bool armor::DirectoryIndex::isMissing(llvm::StringRef path) {
+    llvm::StringRef parent = llvm::sys::path::parent_path(path);
+    if (parent.empty() || parent == path) return false;
+    std::shared_ptr<const Directory> directory = getDirectory(parent);
+    if (directory->state != Directory::State::Listed) return directory->state == Directory::State::Missing;
+    llvm::StringRef name = llvm::sys::path::filename(path);
+    if (directory->names.contains(name)) return false;
+    // The file system may fold case: only a name no entry matches in any case is missing.
+    return llvm::isASCII(name) && !directory->foldedNames.contains(name.lower());
+}
+
+std::shared_ptr<const armor::DirectoryIndex::Directory> armor::DirectoryIndex::getDirectory(llvm::StringRef path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = directories.find(path);
+        if (it != directories.end()) return it->getValue();
+    }
+
+    // Read outside the lock; a directory read twice at once is stored once.
+    auto directory = std::make_shared<Directory>();
+    if (isMissing(path)) {
+        directory->state = Directory::State::Missing;
+    }
+    else {
+        std::error_code ec;
+        llvm::vfs::directory_iterator it = fileSystem.dir_begin(path, ec);
+        if (ec == std::errc::no_such_file_or_directory || ec == std::errc::not_a_directory) {
+            directory->state = Directory::State::Missing;
+        }
+        else if (!ec) {
+            for (llvm::vfs::directory_iterator end; it != end && !ec; it.increment(ec)) {
+                llvm::StringRef name = llvm::sys::path::filename(it->path());
+                directory->names.insert(name);
+                directory->foldedNames.insert(name.lower());
+            }
+            // An unreadable directory may still hold files that can be opened.
+            directory->state = ec ? Directory::State::Unknown : Directory::State::Listed;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return directories.try_emplace(path, std::move(directory)).first->getValue();
+}
+
+namespace {
+
+class IndexedFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+    IndexedFileSystem(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base, armor::DirectoryIndex& index)
+        : ProxyFileSystem(std::move(base)), index(index) {}
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override {
+        if (isKnownMissing(path)) return std::make_error_code(std::errc::no_such_file_or_directory);
+        return ProxyFileSystem::status(path);
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> openFileForRead(const llvm::Twine& path) override {
+        if (isKnownMissing(path)) return std::make_error_code(std::errc::no_such_file_or_directory);
+        return ProxyFileSystem::openFileForRead(path);
+    }
+
+private:
+    bool isKnownMissing(const llvm::Twine& path) {
+        if (!index.isEnabled()) return false;
+        llvm::SmallString<256> absolute;
+        path.toVector(absolute);
+        if (makeAbsolute(absolute)) return false;
+        return index.isKnownMissing(absolute);
+    }
+
+    armor::DirectoryIndex& index;
+};
+
+} // namespace
+
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> armor::createIndexedFileSystem(
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base, DirectoryIndex& index) {
+    return llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>(new IndexedFileSystem(std::move(base), index));
+}
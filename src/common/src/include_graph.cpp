@@ -0,0 +1,257 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "include_graph.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <tuple>
+#include <nlohmann/json.hpp>
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "archive_file_system.hpp"
+#include "trace.hpp"
+
+static constexpr uint32_t CACHE_VERSION = 1;
+
+// Code of line with comments removed; inComment carries a block comment over to the next line.
+static std::string stripComments(llvm::StringRef line, bool& inComment) {
+    std::string code;
+    char quote = 0;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        char next = i + 1 < line.size() ? line[i + 1] : 0;
+        if (inComment) {
+            if (c == '*' && next == '/') {
+                inComment = false;
+                code += ' ';
+                ++i;
+            }
+            continue;
+        }
+        if (quote) {
+            code += c;
+            if (c == '\\' && next) code += line[++i];
+            else if (c == quote) quote = 0;
+            continue;
+        }
+        if (c == '/' && next == '/') break;
+        if (c == '/' && next == '*') {
+            inComment = true;
+            ++i;
+            continue;
+        }
+        if (c == '"' || c == '\'') quote = c;
+        code += c;
+    }
+    return code;
+}
+
+armor::FileIncludes armor::scanIncludes(llvm::StringRef source) {
+    FileIncludes result;
+    bool inComment = false;
+    while (!source.empty()) {
+        llvm::StringRef physical;
+        std::tie(physical, source) = source.split('\n');
+        // Join backslash-continued lines into one logical line.
+        std::string line = physical.rtrim('\r').str();
+        while (!line.empty() && line.back() == '\\' && !source.empty()) {
+            line.pop_back();
+            std::tie(physical, source) = source.split('\n');
+            line += physical.rtrim('\r').str();
+        }
+
+        // A line that starts inside a block comment can still hold a directive after its end.
+        std::string code = stripComments(line, inComment);
+        llvm::StringRef text = llvm::StringRef(code).ltrim();
+        if (!text.consume_front("#")) continue;
+        text = text.ltrim();
+        if (!text.consume_front("include") && !text.consume_front("import")) continue;
+        text.consume_front("_next");
+        text = text.ltrim();
+        if (text.empty()) continue;
+
+        char close = text.front() == '"' ? '"' : text.front() == '<' ? '>' : 0;
+        if (!close) {
+            result.computed = true;
+            continue;
+        }
+        size_t end = text.find(close, 1);
+        if (end == llvm::StringRef::npos) continue;
+        result.directives.push_back({text.substr(1, end - 1).str(), close == '>'});
+    }
+    return result;
+}
+
+bool armor::IncludeGraph::loadCache(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+    nlohmann::json root = nlohmann::json::parse(in, nullptr, false);
+    if (!root.is_object() || root.value("version", 0u) != CACHE_VERSION || !root.contains("files")) return false;
+
+    for (const auto& [key, entry] : root["files"].items()) {
+        uint64_t hash;
+        if (llvm::StringRef(key).getAsInteger(16, hash) || !entry.is_object()) continue;
+        FileIncludes includes;
+        includes.computed = entry.value("computed", false);
+        for (const auto& directive : entry.value("includes", nlohmann::json::array()))
+            includes.directives.push_back({directive.value("name", ""), directive.value("angled", false)});
+        cache[hash] = std::move(includes);
+    }
+    return true;
+}
+
+bool armor::IncludeGraph::saveCache(const std::string& path) const {
+    nlohmann::ordered_json out;
+    out["version"] = CACHE_VERSION;
+    out["files"] = nlohmann::ordered_json::object();
+    for (uint64_t hash : usedHashes) {
+        auto it = cache.find(hash);
+        if (it == cache.end()) continue;
+        nlohmann::ordered_json entry;
+        entry["includes"] = nlohmann::ordered_json::array();
+        for (const IncludeDirective& directive : it->second.directives)
+            entry["includes"].push_back({{"name", directive.name}, {"angled", directive.angled}});
+        if (it->second.computed) entry["computed"] = true;
+        out["files"][llvm::utohexstr(hash)] = std::move(entry);
+    }
+
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(parent, ec);
+    }
+    std::ofstream file(path, std::ios::trunc);
+    file << out.dump(-1, ' ', false, nlohmann::ordered_json::error_handler_t::replace) << "\n";
+    return static_cast<bool>(file);
+}
+
+void armor::IncludeGraph::addHeader(const std::string& projectRoot, const std::string& header) {
+    std::string relative = std::filesystem::path(header).lexically_normal().generic_string();
+    roots.emplace_back(projectRoot, relative);
+    headers.insert(relative);
+
+    // The parsers search every directory from the header up to the project root.
+    std::filesystem::path dir = std::filesystem::path(relative).parent_path();
+    while (true) {
+        std::string name = dir.generic_string();
+        if (std::find(headerDirs.begin(), headerDirs.end(), name) == headerDirs.end())
+            headerDirs.push_back(name);
+        if (dir.empty()) break;
+        dir = dir.parent_path();
+    }
+}
+
+armor::FileIncludes armor::IncludeGraph::scan(const std::string& path) {
+    // A file hashed by an earlier stage is only read if it was never scanned.
+    std::optional<uint64_t> hash = contentCache.getContentHash(path);
+    if (!hash) return {};
+    usedHashes.insert(*hash);
+    auto it = cache.find(*hash);
+    if (it == cache.end()) {
+        ++scannedFiles;
+        const llvm::MemoryBuffer* buffer = contentCache.getBuffer(path);
+        it = cache.try_emplace(*hash, buffer ? scanIncludes(buffer->getBuffer()) : FileIncludes()).first;
+    }
+    contentCache.release(path);
+    return it->second;
+}
+
+void armor::IncludeGraph::resolve(const std::string& projectRoot, const std::string& file,
+                                  const IncludeDirective& include, std::vector<std::string>& targets) const {
+    if (std::filesystem::path(include.name).is_absolute()) return;
+
+    std::vector<std::filesystem::path> dirs;
+    if (!include.angled) dirs.push_back(std::filesystem::path(file).parent_path());
+    for (const std::string& includePath : includePaths) dirs.emplace_back(includePath);
+    for (const std::string& headerDir : headerDirs) dirs.emplace_back(headerDir);
+
+    for (const std::filesystem::path& dir : dirs) {
+        std::string candidate = (dir / include.name).lexically_normal().generic_string();
+        // Files outside the project are not tracked.
+        if (candidate.empty() || llvm::StringRef(candidate).startswith("..")) continue;
+        if (std::find(targets.begin(), targets.end(), candidate) != targets.end()) continue;
+        llvm::ErrorOr<llvm::vfs::Status> status =
+            armor::getFileSystem().status((std::filesystem::path(projectRoot) / candidate).string());
+        if (status && status->isRegularFile()) targets.push_back(candidate);
+    }
+}
+
+void armor::IncludeGraph::build() {
+    armor::TraceScope span("include graph", "include", std::to_string(roots.size()) + " headers");
+    std::vector<std::string> projectRoots;
+    for (const auto& root : roots) {
+        if (std::find(projectRoots.begin(), projectRoots.end(), root.first) == projectRoots.end())
+            projectRoots.push_back(root.first);
+    }
+    for (const std::string& projectRoot : projectRoots) {
+        llvm::StringSet<> visited;
+        std::vector<std::string> pending;
+        for (const auto& root : roots) {
+            if (root.first == projectRoot) pending.push_back(root.second);
+        }
+        while (!pending.empty()) {
+            std::string file = std::move(pending.back());
+            pending.pop_back();
+            if (!visited.insert(file).second) continue;
+            llvm::StringSet<>& includes = edges[file];
+
+            FileIncludes scanned = scan((std::filesystem::path(projectRoot) / file).string());
+            if (scanned.computed) computedFiles.insert(file);
+            std::vector<std::string> targets;
+            for (const IncludeDirective& directive : scanned.directives) {
+                targets.clear();
+                resolve(projectRoot, file, directive, targets);
+                for (std::string& target : targets) {
+                    includes.insert(target);
+                    pending.push_back(std::move(target));
+                }
+            }
+        }
+    }
+}
+
+std::vector<std::string> armor::IncludeGraph::getIncludes(llvm::StringRef file) const {
+    std::vector<std::string> result;
+    auto it = edges.find(file);
+    if (it == edges.end()) return result;
+    for (const auto& include : it->second) result.push_back(include.getKey().str());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::string> armor::IncludeGraph::getFiles() const {
+    std::vector<std::string> result;
+    for (const auto& entry : edges) result.push_back(entry.getKey().str());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::string> armor::IncludeGraph::getAffectedHeaders(const std::vector<std::string>& changed) const {
+    llvm::StringMap<std::vector<llvm::StringRef>> includedBy;
+    for (const auto& entry : edges) {
+        for (const auto& include : entry.getValue())
+            includedBy[include.getKey()].push_back(entry.getKey());
+    }
+
+    llvm::StringSet<> reached;
+    std::vector<std::string> pending;
+    for (const std::string& file : changed)
+        pending.push_back(std::filesystem::path(file).lexically_normal().generic_string());
+    for (const auto& file : computedFiles) pending.push_back(file.getKey().str());
+    while (!pending.empty()) {
+        std::string file = std::move(pending.back());
+        pending.pop_back();
+        if (!reached.insert(file).second) continue;
+        auto it = includedBy.find(file);
+        if (it == includedBy.end()) continue;
+        for (llvm::StringRef includer : it->second) pending.push_back(includer.str());
+    }
+
+    std::vector<std::string> result;
+    for (const auto& header : headers) {
+        if (reached.contains(header.getKey())) result.push_back(header.getKey().str());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,273 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "fibonacci_hash.hpp"
+#include "lexical_diff.hpp"
+#include "logger.hpp"
+
+namespace armor {
+
+namespace {
+
+struct LexedToken {
+    clang::tok::TokenKind kind;
+    llvm::StringRef text;
+    bool atStartOfLine;
+    bool leadingSpace;
+    bool inDirective;
+    bool followsMacroName;   // "(" here decides function-like vs object-like #define
+};
+
+struct LexedComment {
+    uint64_t hash;
+    size_t nextToken;        // position relative to the token stream
+};
+
+struct LexedHeader {
+    std::vector<LexedToken> tokens;
+    // Comments beta hashes individually; compared as a multiset like commentsHashMap.
+    std::vector<LexedComment> comments;
+    // Comments inside (or on a directive line of) a non-guard conditional. They may
+    // belong to an inactive block, whose hash covers its full text, so they must match
+    // exactly and in place.
+    std::vector<LexedComment> conditionalComments;
+};
+
+clang::LangOptions makeLangOptions(LANG_OPTIONS lang) {
+    clang::LangOptions langOpts;
+    langOpts.LineComment = true;
+    if (lang == LANG_OPTIONS::C) {
+        langOpts.C99 = true;
+        langOpts.C11 = true;
+        langOpts.C17 = true;
+    }
+    else {
+        langOpts.CPlusPlus = true;
+        langOpts.CPlusPlus11 = true;
+        langOpts.CPlusPlus14 = true;
+        langOpts.CPlusPlus17 = true;
+    }
+    return langOpts;
+}
+
+class HeaderLexer {
+public:
+    explicit HeaderLexer(const clang::LangOptions& langOpts) : langOpts(langOpts) {}
+
+    LexedHeader lex(llvm::StringRef buffer) {
+        clang::Lexer lexer(clang::SourceLocation(), langOpts, buffer.begin(), buffer.begin(), buffer.end());
+        lexer.SetCommentRetentionState(true);
+
+        clang::Token tok;
+        while (true) {
+            lexer.LexFromRawLexer(tok);
+            if (tok.is(clang::tok::eof)) break;
+
+            llvm::StringRef text(lexer.getBufferLocation() - tok.getLength(), tok.getLength());
+
+            if (tok.isAtStartOfLine()) {
+                inDirective = false;
+                directiveClosedConditional = false;
+            }
+
+            if (tok.is(clang::tok::comment)) {
+                addComment(text);
+                continue;
+            }
+
+            LexedToken token{tok.getKind(), text, tok.isAtStartOfLine(), tok.hasLeadingSpace(), false, false};
+
+            if (tok.is(clang::tok::hash) && tok.isAtStartOfLine()) {
+                inDirective = true;
+                state = DirectiveState::Keyword;
+            }
+            else if (inDirective) {
+                token.followsMacroName = state == DirectiveState::AfterMacroName;
+                handleDirectiveToken(text);
+            }
+            else if (guardPending) {
+                // Code between #ifndef X and #define X: not the include-guard idiom.
+                demoteGuard();
+            }
+
+            token.inDirective = inDirective;
+            header.tokens.push_back(token);
+        }
+
+        return std::move(header);
+    }
+
+private:
+    enum class DirectiveState { None, Keyword, IfndefName, DefineName, AfterMacroName };
+
+    void addComment(llvm::StringRef text) {
+        LexedComment comment{FibonacciHash::hash(text), header.tokens.size()};
+        if (nonGuardDepth > 0 || (inDirective && directiveClosedConditional)) {
+            header.conditionalComments.push_back(comment);
+        }
+        else {
+            header.comments.push_back(comment);
+        }
+    }
+
+    void handleDirectiveToken(llvm::StringRef text) {
+        switch (state) {
+            case DirectiveState::Keyword:
+                handleDirectiveKeyword(text);
+                break;
+            case DirectiveState::IfndefName:
+                guardName = text;
+                state = DirectiveState::None;
+                break;
+            case DirectiveState::DefineName:
+                if (guardPending) {
+                    if (text == guardName) guardPending = false;
+                    else demoteGuard();
+                }
+                state = DirectiveState::AfterMacroName;
+                break;
+            default:
+                state = DirectiveState::None;
+                break;
+        }
+    }
+
+    void handleDirectiveKeyword(llvm::StringRef keyword) {
+        state = DirectiveState::None;
+
+        // Anything other than the matching #define right after #ifndef breaks the guard idiom.
+        if (guardPending && keyword != "define") demoteGuard();
+
+        if (keyword == "if" || keyword == "ifdef") {
+            pushConditional(false);
+        }
+        else if (keyword == "ifndef") {
+            bool guardCandidate = conditionals.empty() && header.tokens.size() == 1;
+            pushConditional(guardCandidate);
+            guardPending = guardCandidate;
+            guardFirstComment = header.comments.size();
+            state = DirectiveState::IfndefName;
+        }
+        else if (keyword == "elif" || keyword == "else" || keyword == "elifdef" || keyword == "elifndef") {
+            // The alternative branch of a guard is as uncertain as any other conditional.
+            if (!conditionals.empty() && conditionals.back()) {
+                conditionals.back() = false;
+                ++nonGuardDepth;
+            }
+        }
+        else if (keyword == "endif") {
+            if (!conditionals.empty()) {
+                if (!conditionals.back()) {
+                    --nonGuardDepth;
+                    directiveClosedConditional = true;
+                }
+                conditionals.pop_back();
+            }
+        }
+        else if (keyword == "define") {
+            state = DirectiveState::DefineName;
+        }
+    }
+
+    void pushConditional(bool isGuard) {
+        conditionals.push_back(isGuard);
+        if (!isGuard) ++nonGuardDepth;
+    }
+
+    void demoteGuard() {
+        guardPending = false;
+        if (!conditionals.empty() && conditionals.front()) {
+            conditionals.front() = false;
+            ++nonGuardDepth;
+
+            // Comments seen since the #ifndef turn out to be conditional after all.
+            header.conditionalComments.insert(header.conditionalComments.begin(),
+                                              header.comments.begin() + guardFirstComment,
+                                              header.comments.end());
+            header.comments.resize(guardFirstComment);
+        }
+    }
+
+    const clang::LangOptions& langOpts;
+    LexedHeader header;
+
+    // Conditional nesting; true marks the include-guard level.
+    std::vector<bool> conditionals;
+    size_t nonGuardDepth = 0;
+    bool guardPending = false;
+    llvm::StringRef guardName;
+    size_t guardFirstComment = 0;
+
+    bool inDirective = false;
+    bool directiveClosedConditional = false;
+    DirectiveState state = DirectiveState::None;
+};
+
+bool sameToken(const LexedToken& lhs, const LexedToken& rhs) {
+    if (lhs.kind != rhs.kind || lhs.text != rhs.text) return false;
+
+    // Line breaks delimit directives, so they only matter in or next to one.
+    if ((lhs.inDirective || rhs.inDirective) && lhs.atStartOfLine != rhs.atStartOfLine) return false;
+
+    if ((lhs.followsMacroName || rhs.followsMacroName) && lhs.leadingSpace != rhs.leadingSpace) return false;
+
+    return true;
+}
+
+} // namespace
+
+std::optional<ParsedDiffStatus> classifyLexicalChange(const std::string& file1,
+                                                      const std::string& file2,
+                                                      LANG_OPTIONS lang) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer1 = llvm::MemoryBuffer::getFile(file1);
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer2 = llvm::MemoryBuffer::getFile(file2);
+    if (!buffer1 || !buffer2) return std::nullopt;
+
+    return classifyLexicalChange((*buffer1)->getMemBufferRef(), (*buffer2)->getMemBufferRef(), lang);
+}
+
+std::optional<ParsedDiffStatus> classifyLexicalChange(llvm::MemoryBufferRef buffer1,
+                                                      llvm::MemoryBufferRef buffer2,
+                                                      LANG_OPTIONS lang) {
+    clang::LangOptions langOpts = makeLangOptions(lang);
+    LexedHeader header1 = HeaderLexer(langOpts).lex(buffer1.getBuffer());
+    LexedHeader header2 = HeaderLexer(langOpts).lex(buffer2.getBuffer());
+
+    if (header1.tokens.size() != header2.tokens.size()) return std::nullopt;
+    for (size_t i = 0; i < header1.tokens.size(); ++i) {
+        if (!sameToken(header1.tokens[i], header2.tokens[i])) return std::nullopt;
+    }
+
+    const auto& conditional1 = header1.conditionalComments;
+    const auto& conditional2 = header2.conditionalComments;
+    bool sameConditionalComments = std::equal(conditional1.begin(), conditional1.end(),
+                                              conditional2.begin(), conditional2.end(),
+        [](const LexedComment& lhs, const LexedComment& rhs) {
+            return lhs.hash == rhs.hash && lhs.nextToken == rhs.nextToken;
+        });
+    if (!sameConditionalComments) return std::nullopt;
+
+    std::vector<uint64_t> comments1;
+    std::vector<uint64_t> comments2;
+    for (const LexedComment& comment : header1.comments) comments1.push_back(comment.hash);
+    for (const LexedComment& comment : header2.comments) comments2.push_back(comment.hash);
+    std::sort(comments1.begin(), comments1.end());
+    std::sort(comments2.begin(), comments2.end());
+
+    armor::info() << "Token streams of " << buffer1.getBufferIdentifier() << " and " << buffer2.getBufferIdentifier() << " are identical\n";
+
+    return comments1 == comments2 ? ParsedDiffStatus::NON_FUNCTIONAL_CHANGES
+                                  : ParsedDiffStatus::COMMENTS_UPDATED;
+}
+
+} // namespace armor
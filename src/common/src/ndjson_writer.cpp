@@ -0,0 +1,73 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "ndjson_writer.hpp"
+#include <filesystem>
+#include <system_error>
+#include <nlohmann/json.hpp>
+#include "logger.hpp"
+
+// Compact, and tolerant of non-UTF-8 bytes copied from header sources.
+static std::string dumpLine(const nlohmann::ordered_json& line) {
+    return line.dump(-1, ' ', false, nlohmann::ordered_json::error_handler_t::replace);
+}
+
+bool armor::NdjsonWriter::open(const std::string& path) {
+    if (path == "-") {
+        out = &llvm::outs();
+        return true;
+    }
+
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::error_code dirEc;
+        std::filesystem::create_directories(parent, dirEc);
+    }
+
+    std::error_code ec;
+    file = std::make_unique<llvm::raw_fd_ostream>(path, ec, llvm::sys::fs::OF_Text);
+    if (ec) {
+        armor::user_error() << "Failed to open NDJSON output " << path << ": " << ec.message() << "\n";
+        file.reset();
+        return false;
+    }
+    out = file.get();
+    return true;
+}
+
+bool armor::NdjsonWriter::isOpen() const {
+    return out != nullptr;
+}
+
+bool armor::NdjsonWriter::writesToStdout() const {
+    return out != nullptr && file == nullptr;
+}
+
+void armor::NdjsonWriter::writeHeader(const std::string& header, const HeaderReportSummary& summary) {
+    if (!out) return;
+
+    size_t incompatible = 0;
+    for (const ApiChangeGroup& change : summary.changes) {
+        if (change.backwardIncompatible) ++incompatible;
+
+        nlohmann::ordered_json line;
+        line["type"]          = "change";
+        line["header"]        = change.headerfile;
+        line["name"]          = change.name;
+        line["description"]   = change.description;
+        line["changetype"]    = change.changeType();
+        line["compatibility"] = change.compatibility();
+        *out << dumpLine(line) << "\n";
+    }
+
+    nlohmann::ordered_json line;
+    line["type"]                 = "header";
+    line["header"]               = header;
+    line["compatibility"]        = summary.compatibility;
+    line["overall_status"]       = summary.overallStatus;
+    line["reason"]               = summary.reason;
+    line["changes"]              = summary.changes.size();
+    line["incompatible_changes"] = incompatible;
+    if (!summary.degradation.empty()) line["degradation"] = summary.degradation;
+    *out << dumpLine(line) << "\n";
+    out->flush();
+}
@@ -0,0 +1,193 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "progress_reporter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <nlohmann/json.hpp>
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Process.h"
+
+namespace {
+
+double secondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double>(to - from).count();
+}
+
+// "42s", "3m07s", "1h02m".
+std::string formatDuration(double seconds) {
+    long total = static_cast<long>(seconds + 0.5);
+    std::string text;
+    llvm::raw_string_ostream os(text);
+    if (total >= 3600) os << total / 3600 << "h" << llvm::format("%02ldm", (total % 3600) / 60);
+    else if (total >= 60) os << total / 60 << "m" << llvm::format("%02lds", total % 60);
+    else os << total << "s";
+    return os.str();
+}
+
+} // namespace
+
+armor::ProgressReporter::ProgressReporter(llvm::raw_ostream& os) : os(os) {}
+
+armor::ProgressReporter::~ProgressReporter() {
+    finish();
+}
+
+armor::ProgressReporter::Mode armor::ProgressReporter::detectMode() {
+    return llvm::sys::Process::StandardErrIsDisplayed() ? Mode::Line : Mode::Records;
+}
+
+void armor::ProgressReporter::enable(Mode newMode) {
+    std::scoped_lock<std::mutex> lock(mutex);
+    mode = newMode;
+}
+
+bool armor::ProgressReporter::isEnabled() const {
+    std::scoped_lock<std::mutex> lock(mutex);
+    return mode != Mode::Off;
+}
+
+void armor::ProgressReporter::start(size_t headerCount) {
+    std::scoped_lock<std::mutex> lock(mutex);
+    if (mode == Mode::Off || heartbeatThread.joinable()) return;
+
+    total = headerCount;
+    runStart = Clock::now();
+    stopping = false;
+    heartbeatThread = std::thread(&ProgressReporter::heartbeat, this);
+}
+
+void armor::ProgressReporter::headerStarted(const std::string& header) {
+    std::scoped_lock<std::mutex> lock(mutex);
+    if (mode == Mode::Off) return;
+
+    // The heartbeat draws the line, so headers that finish within one
+    // interval never interleave it with their own console output.
+    running.emplace_back(header, Clock::now());
+    workers = std::max(workers, running.size());
+}
+
+void armor::ProgressReporter::headerFinished(const std::string& header) {
+    std::scoped_lock<std::mutex> lock(mutex);
+    if (mode == Mode::Off) return;
+
+    auto it = std::find_if(running.begin(), running.end(), [&header](const auto& entry) { return entry.first == header; });
+    if (it == running.end()) return;
+
+    recentSeconds.push_back(secondsBetween(it->second, Clock::now()));
+    if (recentSeconds.size() > AVERAGE_WINDOW) recentSeconds.pop_front();
+    ++done;
+    running.erase(it);
+
+    // Take the line down so the caller's own output starts on a clean line.
+    if (mode == Mode::Line) clearLineLocked();
+}
+
+void armor::ProgressReporter::finish() {
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        if (!heartbeatThread.joinable()) return;
+        stopping = true;
+    }
+    wake.notify_all();
+    heartbeatThread.join();
+
+    std::scoped_lock<std::mutex> lock(mutex);
+    emitLocked(true);
+}
+
+armor::ProgressReporter::Snapshot armor::ProgressReporter::snapshot() const {
+    std::scoped_lock<std::mutex> lock(mutex);
+    return snapshotLocked();
+}
+
+armor::ProgressReporter::Snapshot armor::ProgressReporter::snapshotLocked() const {
+    Clock::time_point now = Clock::now();
+
+    Snapshot snapshot;
+    snapshot.done = done;
+    snapshot.total = total;
+    snapshot.elapsedSeconds = secondsBetween(runStart, now);
+    if (snapshot.elapsedSeconds > 0) snapshot.headersPerSecond = done / snapshot.elapsedSeconds;
+    if (!recentSeconds.empty()) {
+        double mean = std::accumulate(recentSeconds.begin(), recentSeconds.end(), 0.0) / recentSeconds.size();
+        size_t remaining = total > done ? total - done : 0;
+        // Fewer headers than workers left still take one header's time.
+        size_t parallel = std::max<size_t>(1, std::min(workers, remaining));
+        snapshot.etaSeconds = mean * remaining / parallel;
+    }
+    snapshot.running = running.size();
+    if (!running.empty()) {
+        snapshot.current = running.front().first;
+        snapshot.currentSeconds = secondsBetween(running.front().second, now);
+    }
+    return snapshot;
+}
+
+std::string armor::ProgressReporter::formatLine(const Snapshot& snapshot, size_t width) {
+    std::string line;
+    llvm::raw_string_ostream os(line);
+    double percent = snapshot.total ? 100.0 * snapshot.done / snapshot.total : 100.0;
+    os << "[" << snapshot.done << "/" << snapshot.total << "] " << llvm::format("%3.0f%%", percent)
+       << " | " << llvm::format("%.2f", snapshot.headersPerSecond) << " hdr/s"
+       << " | ETA " << (snapshot.etaSeconds < 0 ? std::string("--") : formatDuration(snapshot.etaSeconds));
+    if (snapshot.running > 1) os << " | " << snapshot.running << " running, longest";
+    else if (!snapshot.current.empty()) os << " |";
+    if (!snapshot.current.empty()) {
+        os << " " << snapshot.current << " (" << formatDuration(snapshot.currentSeconds) << ")";
+    }
+    os.flush();
+
+    if (width > 0 && line.size() > width) line.resize(width);
+    return line;
+}
+
+std::string armor::ProgressReporter::formatRecord(const Snapshot& snapshot) {
+    nlohmann::ordered_json record;
+    record["type"]          = "progress";
+    record["done"]          = snapshot.done;
+    record["total"]         = snapshot.total;
+    record["elapsed_s"]     = std::round(snapshot.elapsedSeconds * 10) / 10;
+    record["headers_per_s"] = std::round(snapshot.headersPerSecond * 100) / 100;
+    record["eta_s"]         = snapshot.etaSeconds < 0 ? nlohmann::ordered_json() : nlohmann::ordered_json(std::round(snapshot.etaSeconds));
+    record["running"]       = snapshot.running;
+    record["current"]       = snapshot.current.empty() ? nlohmann::ordered_json() : nlohmann::ordered_json(snapshot.current);
+    record["current_s"]     = std::round(snapshot.currentSeconds * 10) / 10;
+    return record.dump(-1, ' ', false, nlohmann::ordered_json::error_handler_t::replace);
+}
+
+void armor::ProgressReporter::emitLocked(bool final) {
+    Snapshot state = snapshotLocked();
+    if (mode == Mode::Line) {
+        if (final) {
+            clearLineLocked();
+            os << formatLine(state, 0) << "\n";
+        }
+        else {
+            // Leave the last column free so the terminal never wraps the line.
+            unsigned columns = llvm::sys::Process::StandardErrColumns();
+            os << "\r\x1b[K" << formatLine(state, columns > 1 ? columns - 1 : 0);
+            lineShown = true;
+        }
+    }
+    else if (mode == Mode::Records) {
+        os << formatRecord(state) << "\n";
+    }
+    os.flush();
+}
+
+void armor::ProgressReporter::clearLineLocked() {
+    if (!lineShown) return;
+    os << "\r\x1b[K";
+    os.flush();
+    lineShown = false;
+}
+
+void armor::ProgressReporter::heartbeat() {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::chrono::seconds interval = mode == Mode::Line ? LINE_INTERVAL : RECORD_INTERVAL;
+    while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+        // The line only stands while a header runs; records keep coming regardless.
+        if (mode == Mode::Records || !running.empty()) emitLocked(false);
+    }
+}
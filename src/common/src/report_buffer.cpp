@@ -0,0 +1,54 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "report_buffer.hpp"
+#include <fstream>
+#include "run_stats.hpp"
+
+void armor::ReportBuffer::appendHtml(std::string_view s) {
+    for (char c : s) {
+        switch (c) {
+            case '&':  data += "&amp;";  break;
+            case '<':  data += "&lt;";   break;
+            case '>':  data += "&gt;";   break;
+            case '\"': data += "&quot;"; break;
+            case '\'': data += "&#39;";  break;
+            case '\n': data += "<br/>";  break;
+            default:   data += c;        break;
+        }
+    }
+}
+
+void armor::ReportBuffer::appendJsonString(std::string_view s, bool forScript) {
+    static const char hex[] = "0123456789abcdef";
+    data += '"';
+    for (char c : s) {
+        switch (c) {
+            case '"':  data += "\\\""; break;
+            case '\\': data += "\\\\"; break;
+            case '\b': data += "\\b";  break;
+            case '\f': data += "\\f";  break;
+            case '\n': data += "\\n";  break;
+            case '\r': data += "\\r";  break;
+            case '\t': data += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20 || (forScript && c == '<')) {
+                    data += "\\u00";
+                    data += hex[(c >> 4) & 0xF];
+                    data += hex[c & 0xF];
+                }
+                else {
+                    data += c;
+                }
+                break;
+        }
+    }
+    data += '"';
+}
+
+bool armor::ReportBuffer::writeTo(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!out) return false;
+    RunStats::count(StatCounter::ReportBytes, data.size());
+    return true;
+}
@@ -15,16 +15,6 @@ using json = nlohmann::json;
 
 namespace fs = std::filesystem;
 
-static json load_json(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open JSON file: " + path);
-    }
-    json j;
-    file >> j;
-    return j;
-}
-
 static int read_status_safe(const json& obj, const char* key)
 {
     if (!obj.is_object() || !obj.contains(key) || obj[key].is_null())
@@ -101,28 +91,39 @@ static json extract_ast_diff(
     return root["astDiff"];
 }
 
-void report_generator(const std::string& diff_json_path,
+// First line of every grouped backward-incompatible description, used for
+// the short per-header console summary.
+static std::vector<std::string> collect_incompatible_changes(const std::vector<ApiChangeGroup>& grouped)
+{
+    std::vector<std::string> lines;
+    for (const auto& entry : grouped) {
+        if (!entry.backwardIncompatible) continue;
+        const std::string& desc = entry.description;
+        const auto nl = desc.find('\n');
+        std::string line = (nl != std::string::npos) ? desc.substr(0, nl) : desc;
+        if (!line.empty()) lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+HeaderReportSummary report_generator(const json& root,
                       const std::string& header_file_path,
                       const std::string& output_html_path,
                       const std::string& output_json_path,
                       PARSER parser,
                       bool generate_json) {
-    json root = load_json(diff_json_path);
-
     int parsed_status = 0, unparsed_status = 0;
     std::vector<std::string> header_failures;
 
     json diff_data =
         extract_ast_diff(root, &parsed_status, &unparsed_status, &header_failures);
-    std::vector<json> processed = preprocess_api_changes(diff_data, header_file_path);
+    std::vector<ApiChangeGroup> grouped =
+        group_api_changes(preprocess_api_changes(diff_data, header_file_path));
 
     // Determine compatibility
     bool hasBackwardIncompatible = false;
-    for (auto& r : processed) {
-        if (r.contains("compatibility") &&
-            r["compatibility"].is_string() &&
-            r["compatibility"].get<std::string>() == "backward_incompatible")
-        {
+    for (const auto& g : grouped) {
+        if (g.backwardIncompatible) {
             hasBackwardIncompatible = true;
             break;
         }
@@ -143,42 +144,36 @@ void report_generator(const std::string& diff_json_path,
                                    (unsigned)unparsed_status,
                                    !hasBackwardIncompatible);
 
-    // HTML
+    HeaderReportSummary summary;
+    summary.compatibility = aggCompatibility;
+    summary.overallStatus = overallStatus;
+    summary.reason        = reason;
+    summary.parser        = parser;
+    summary.parsedStatus  = parsed_status;
+    summary.unparsedStatus = unparsed_status;
+    if (hasBackwardIncompatible)
+        summary.incompatibleChanges = collect_incompatible_changes(grouped);
+
+    // HTML and JSON are rendered together in one pass over the groups.
     try {
-        generate_html_report(processed, output_html_path, parser,
-                             parsed_status, unparsed_status,
-                             aggCompatibility, overallStatus, reason);
+        std::string json_out = generate_json ? output_json_path : std::string();
+        if (!json_out.empty()) create_parent_dirs(json_out);
+
+        generate_reports(grouped, output_html_path, json_out, parser,
+                         parsed_status, unparsed_status,
+                         aggCompatibility, overallStatus, reason);
 
         armor::user_print() << "HTML report generated at: "
                             << output_html_path << "\n";
+        if (generate_json)
+            armor::user_print() << "JSON report generated at: "
+                                << json_out << "\n";
     }
     catch (const std::exception& e) {
-        armor::user_error() << "Failed to generate HTML report: "
+        armor::user_error() << "Failed to generate reports: "
                             << e.what() << "\n";
     }
 
-    // JSON
-    if (generate_json) {
-        try {
-            std::string header_name =
-                std::filesystem::path(header_file_path).filename().string();
-
-            std::string json_report_dir = "armor_reports/json_reports";
-            std::filesystem::create_directories(json_report_dir);
-
-            std::string json_out =
-                json_report_dir + "/api_diff_report_" + header_name + ".json";
-
-            generate_json_report(processed, json_out,
-                                 parsed_status, unparsed_status,
-                                 aggCompatibility, overallStatus, reason);
-
-            armor::user_print() << "JSON report generated at: "
-                                << json_out << "\n";
-        }
-        catch (const std::exception& e) {
-            armor::user_error() << "Failed to generate JSON report: "
-                                << e.what() << "\n";
-        }
-    }
+    summary.changes = std::move(grouped);
+    return summary;
 }
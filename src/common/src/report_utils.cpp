@@ -5,6 +5,7 @@
 #include <sstream>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <map>
@@ -13,10 +14,12 @@
 #include <tuple>
 #include <algorithm>
 #include <filesystem>
+#include <system_error>
 
 #include "comm_def.hpp"
 #include "report_utils.hpp"
 #include "html_template.hpp"
+#include "report_buffer.hpp"
 #include <nlohmann/json.hpp>
 #include "diff_utils.hpp"
 
@@ -44,44 +47,7 @@ static std::string compose_api_name(const nlohmann::json& node) {
     return nt.empty() ? qn : (qn + ":" + nt);
 }
 
-// Proper HTML escape for table cells
-static std::string html_escape(const std::string& s) {
-    std::string out;
-    out.reserve(s.size());
-    for (char c : s) {
-        switch (c) {
-            case '&':  out += "&amp;";  break;
-            case '<':  out += "&lt;";   break;
-            case '>':  out += "&gt;";   break;
-            case '\"': out += "&quot;"; break;
-            case '\'': out += "&#39;";  break;
-            default:   out += c;        break;
-        }
-    }
-    return out;
-}
-
-// Escape then convert '\n' to <br/> so lines render separately within a cell
-static std::string escape_nl2br(const std::string& s) {
-    const std::string e = html_escape(s);
-    std::string out;
-    out.reserve(e.size() + 8);
-    for (char c : e) {
-        if (c == '\n') out += "<br/>";
-        else out += c;
-    }
-    return out;
-}
-
-// Render colored compatibility text (only the text inside the cell, no classes)
-static std::string render_colored_compatibility(const std::string& compRaw) {
-    const bool isIncompatible = (compRaw == "backward_incompatible");
-    const char* color = isIncompatible ? "#d32f2f" : "#2e7d32"; // red / green
-    const std::string safe = escape_nl2br(compRaw);
-    std::ostringstream oss;
-    oss << "<span style=\"color:" << color << ";font-weight:600\">" << safe << "</span>";
-    return oss.str();
-}
+using armor::ReportBuffer;
 
 // Convenience for appending description lines
 static void add_desc_line(std::vector<std::string>& lines, const std::string& text) {
@@ -360,22 +326,16 @@ struct AtomicChange {
     std::string compatibility;    // optional override
 };
 
-static json to_record(const AtomicChange& c) {
-    const std::string category =
-        to_change_category(c.rawChange, c.topLevel);
+static ApiChangeRecord to_record(const AtomicChange& c) {
+    const bool compatibilityChanged =
+        to_change_category(c.rawChange, c.topLevel) == "Compatibility_changed";
 
-    const std::string compat =
+    const bool backwardIncompatible =
         !c.compatibility.empty()
-            ? c.compatibility
-            : ((category == "Compatibility_changed") ? "backward_incompatible" : "backward_compatible");
-
-    return json{
-        {"headerfile",    c.headerfile},
-        {"name",          c.apiName},
-        {"description",   c.detail},
-        {"changetype",    category},
-        {"compatibility", compat}
-    };
+            ? c.compatibility == "backward_incompatible"
+            : compatibilityChanged;
+
+    return ApiChangeRecord{c.headerfile, c.apiName, c.detail, compatibilityChanged, backwardIncompatible};
 }
 
 // -----------------------------------------------------------------------------
@@ -1376,64 +1336,115 @@ static std::string generate_non_function_description(const json& item) {
 }
 
 // -----------------------------------------------------------------------------
-// Group rows by (headerfile, name) so each API has a single description cell
+// Report rendering
 // -----------------------------------------------------------------------------
 
-static std::vector<json> group_records_by_function(const std::vector<json>& rows) {
-    using Key = std::pair<std::string,std::string>;
-    struct Agg {
-        std::string headerfile;
-        std::string name;
-        std::vector<std::string> descriptions;
-        bool anyCompatibilityChanged = false;
-        bool anyFunctionalityChanged = false;
-        bool anyBackwardIncompatible = false;
-    };
+static void render_html_begin(ReportBuffer& html, PARSER parser) {
+    switch (parser) {
+        case ALPHA_PARSER:
+            html << ALPHA_HTML_HEADER;
+            break;
+        case BETA_PARSER:
+            html << BETA_HTML_HEADER;
+            break;
+        default:
+            break;
+    }
+}
 
-    std::map<Key, Agg> buckets;
-    for (const auto& row : rows) {
-        const std::string hf   = row.value("headerfile", "");
-        const std::string nm   = row.value("name", "");
-        const std::string ct   = row.value("changetype", "");
-        const std::string desc = row.value("description", "");
-        const std::string comp = row.value("compatibility", "");
-
-        Key k{hf, nm};
-        auto& agg = buckets[k];
-        if (agg.headerfile.empty()) {
-            agg.headerfile = hf;
-            agg.name       = nm;
-        }
-        if (!desc.empty()) agg.descriptions.push_back(desc);
-        if (ct == "Compatibility_changed") agg.anyCompatibilityChanged = true;
-        else if (ct == "Functionality_changed") agg.anyFunctionalityChanged = true;
+static void render_html_row(ReportBuffer& html, const ApiChangeGroup& group) {
+    const char* color = group.backwardIncompatible ? "#d32f2f" : "#2e7d32"; // red / green
+    html << "<tr>\n<td> ";
+    html.appendHtml(group.headerfile);
+    html << " </td>\n<td> ";
+    html.appendHtml(group.name);
+    html << " </td>\n<td> ";
+    html.appendHtml(group.description);
+    html << " </td>\n<td> " << group.changeType() << " </td>\n";
+    html << "<td> <span style=\"color:" << color << ";font-weight:600\">"
+         << group.compatibility() << "</span> </td>\n</tr>\n";
+}
+
+static void render_status_box(ReportBuffer& html, const char* overall_status, const char* reason) {
+    html << "<div style='margin:12px 0;padding:10px;border:1px solid #ccc;"
+            "border-radius:5px;background:#fafafa;font-size:14px;'>\n";
+    html << "<b>Overall status:</b> " << overall_status << "<br/>\n";
+    html << "<b>Reason:</b> " << reason << "<br/>\n";
+    html << "</div>\n";
+}
 
-        if (comp == "backward_incompatible") agg.anyBackwardIncompatible = true;
+static void render_html_empty(ReportBuffer& html,
+                              const char* overall_status,
+                              const char* reason,
+                              std::pair<bool, bool> files_exists) {
+    const auto& [file1_exists, file2_exists] = files_exists;
+
+    if (file1_exists & file2_exists) {
+        html << "<h2 style=\"margin-bottom: 10px;\">ARMOR v" << TOOL_VERSION << " Report </h2>\n";
+        html << "<p style='margin:6px 0 12px;font-size:12px;'>"
+                "<a href='" << TOOL_DOCS_URL << "' target='_blank'"
+                " style='display:inline-block;padding:3px 10px;border-radius:4px;"
+                "background:#e8f0fe;color:#1a73e8;text-decoration:none;"
+                "font-weight:500;border:1px solid #c5d8fd;'>"
+                "&#128196; Docs: " << TOOL_DOCS_URL << "</a></p>\n";
+        html << "<table border=\"1\" style=\"border-collapse: collapse; width: 100%; background-color: #f2f2f2;\">\n";
+        html << "  <tr>\n";
+        html << "    <td style=\"text-align: center; padding: 10px;\">\n";
+        html << "      Skipping ARMOR report generation. Reason: " << reason << "<br>\n";
+        html << "    </td>\n";
+        html << "  </tr>\n";
+        html << "</table>\n";
     }
+    else {
+        assert(file1_exists | file2_exists);
+        html << SIMPLE_HEADER;
+        render_status_box(html, overall_status, reason);
+    }
+}
 
-    std::vector<json> out;
-    out.reserve(buckets.size());
-    for (const auto& kv : buckets) {
-        const Agg& a = kv.second;
-        const bool anyCompChanged = a.anyCompatibilityChanged;
-        const std::string changetype = anyCompChanged ? "Compatibility Changed" : "Functionality Added";
-        const std::string compatibility = a.anyBackwardIncompatible ? "backward_incompatible" : "backward_compatible";
-
-        std::ostringstream d;
-        for (size_t i = 0; i < a.descriptions.size(); ++i) {
-            if (i) d << "\n";
-            d << a.descriptions[i];
-        }
+// Matches nlohmann::json::dump(4) of the wrapper object, keys in sorted order.
+static void render_json_row(ReportBuffer& json_out, const ApiChangeGroup& group, bool first) {
+    json_out << (first ? "\n" : ",\n") << "        {\n";
+    json_out << "            \"changetype\": ";
+    json_out.appendJsonString(group.changeType());
+    json_out << ",\n            \"compatibility\": ";
+    json_out.appendJsonString(group.compatibility());
+    json_out << ",\n            \"description\": ";
+    json_out.appendJsonString(group.description);
+    json_out << ",\n            \"headerfile\": ";
+    json_out.appendJsonString(group.headerfile);
+    json_out << ",\n            \"name\": ";
+    json_out.appendJsonString(group.name);
+    json_out << "\n        }";
+}
 
-        out.push_back(json{
-            {"headerfile",    a.headerfile},
-            {"name",          a.name},
-            {"description",   d.str()},
-            {"changetype",    changetype},
-            {"compatibility", compatibility}
-        });
-    }
-    return out;
+static void render_json_end(ReportBuffer& json_out,
+                            bool empty,
+                            int parsed_status,
+                            int unparsed_status,
+                            const std::string& agg_compatibility,
+                            const char* overall_status,
+                            const char* reason) {
+    json_out << (empty ? "]" : "\n    ]");
+    json_out << ",\n    \"compatibility\": ";
+    json_out.appendJsonString(agg_compatibility);
+    json_out << ",\n    \"overall_status\": ";
+    json_out.appendJsonString(overall_status);
+    json_out << ",\n    \"parsed_status\": ";
+    json_out.appendJsonString(serialize(static_cast<ParsedDiffStatus>(parsed_status)));
+    json_out << ",\n    \"reason\": ";
+    json_out.appendJsonString(reason);
+    json_out << ",\n    \"unparsed_staus\": ";
+    json_out.appendJsonString(serialize(static_cast<UnParsedDiffStatus>(unparsed_status)));
+    json_out << "\n}";
+}
+
+// Rough per-row size, to size the buffers once.
+static size_t expected_report_size(const std::vector<ApiChangeGroup>& groups) {
+    size_t size = 4096;
+    for (const auto& group : groups)
+        size += 256 + group.headerfile.size() + group.name.size() + group.description.size();
+    return size;
 }
 
 } // anonymous namespace
@@ -1451,10 +1462,65 @@ std::pair<std::string, std::string> prepare_report_output_dirs(const std::string
     return {json_out, html_out};
 }
 
-std::vector<json> preprocess_api_changes(const json& api_differences,
-                                         const std::string& header_file_path)
+std::string report_name_for_header(const std::string& file, const std::string& projectRoot)
+{
+    std::filesystem::path header = std::filesystem::path(file).lexically_normal();
+    std::filesystem::path relative = header.lexically_relative(std::filesystem::path(projectRoot).lexically_normal());
+    if (relative.empty() || relative == "." || *relative.begin() == "..")
+        return header.filename().string();
+
+    std::string name;
+    for (const auto& part : relative) {
+        if (!name.empty()) name += '_';
+        name += part.string();
+    }
+    return name;
+}
+
+void create_parent_dirs(const std::string& path)
+{
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(parent, ec);
+    }
+}
+
+std::vector<ApiChangeGroup> group_api_changes(const std::vector<ApiChangeRecord>& processed_data)
+{
+    std::vector<ApiChangeGroup> groups;
+    std::unordered_map<std::string, size_t> index;
+    index.reserve(processed_data.size());
+
+    for (const auto& record : processed_data) {
+        std::string key;
+        key.reserve(record.headerfile.size() + record.name.size() + 1);
+        key.append(record.headerfile).append(1, '\0').append(record.name);
+
+        auto [it, inserted] = index.try_emplace(std::move(key), groups.size());
+        if (inserted) groups.push_back(ApiChangeGroup{record.headerfile, record.name, "", false, false});
+
+        ApiChangeGroup& group = groups[it->second];
+        if (!record.description.empty()) {
+            if (!group.description.empty()) group.description += '\n';
+            group.description += record.description;
+        }
+        group.compatibilityChanged |= record.compatibilityChanged;
+        group.backwardIncompatible |= record.backwardIncompatible;
+    }
+
+    // Reports list APIs ordered by (headerfile, name).
+    std::sort(groups.begin(), groups.end(), [](const ApiChangeGroup& a, const ApiChangeGroup& b) {
+        if (a.headerfile != b.headerfile) return a.headerfile < b.headerfile;
+        return a.name < b.name;
+    });
+    return groups;
+}
+
+std::vector<ApiChangeRecord> preprocess_api_changes(const json& api_differences,
+                                                    const std::string& header_file_path)
 {
-    std::vector<json> processed;
+    std::vector<ApiChangeRecord> processed;
 
     for (const auto& change : api_differences) {
         const std::string nodeType = change.value("nodeType", "");
@@ -1561,7 +1627,7 @@ std::vector<json> preprocess_api_changes(const json& api_differences,
     return processed;
 }
 
-void generate_html_report(const std::vector<json>& processed_data,
+void generate_html_report(const std::vector<ApiChangeGroup>& grouped,
                           const std::string& output_html_path,
                           PARSER parser,
                           int parsed_status,
@@ -1571,79 +1637,22 @@ void generate_html_report(const std::vector<json>& processed_data,
                           const char* reason,
                           std::pair<bool, bool> files_exists
                         ) {
-    std::ofstream html(output_html_path);
-    ParsedDiffStatus parsedStatus = static_cast<ParsedDiffStatus>(parsed_status);
-    UnParsedDiffStatus unParsedStatus = static_cast<UnParsedDiffStatus>(unparsed_status);
-
-    if (processed_data.empty()) {
-
-        const auto& [file1_exists, file2_exists] = files_exists;
-
-        if( file1_exists & file2_exists ){
-            html << "<h2 style=\"margin-bottom: 10px;\">ARMOR v" << TOOL_VERSION << " Report </h2>\n";
-            html << "<p style='margin:6px 0 12px;font-size:12px;'>"
-                    "<a href='" << TOOL_DOCS_URL << "' target='_blank'"
-                    " style='display:inline-block;padding:3px 10px;border-radius:4px;"
-                    "background:#e8f0fe;color:#1a73e8;text-decoration:none;"
-                    "font-weight:500;border:1px solid #c5d8fd;'>"
-                    "&#128196; Docs: " << TOOL_DOCS_URL << "</a></p>\n";
-            html << "<table border=\"1\" style=\"border-collapse: collapse; width: 100%; background-color: #f2f2f2;\">\n";
-            html << "  <tr>\n";
-            html << "    <td style=\"text-align: center; padding: 10px;\">\n";
-            html << "      Skipping ARMOR report generation. Reason: " << reason << "<br>\n";
-            html << "    </td>\n";
-            html << "  </tr>\n";
-            html << "</table>\n";
-        }
-        else{
-            assert( file1_exists | file2_exists );
-            html << SIMPLE_HEADER; 
-            html << "<div style='margin:12px 0;padding:10px;border:1px solid #ccc;"
-            "border-radius:5px;background:#fafafa;font-size:14px;'>\n";
-            html << "<b>Overall status:</b> " << overall_status << "<br/>\n";
-            html << "<b>Reason:</b> " << reason << "<br/>\n";
-            html << "</div>\n";
-            
-        }
-    } 
-    else {
+    ReportBuffer html(expected_report_size(grouped));
 
-        switch (parser) {
-            case ALPHA_PARSER:
-                html << ALPHA_HTML_HEADER;
-                break;
-            case BETA_PARSER:
-                html << BETA_HTML_HEADER;
-                break;
-            default:
-                break;
-        }
-        
-        auto grouped = group_records_by_function(processed_data);
-        for (const auto& entry : grouped) {
-            html << "<tr>\n";
-            html << "<td> " << escape_nl2br(entry.value("headerfile", ""))   << " </td>\n";
-            html << "<td> " << escape_nl2br(entry.value("name", ""))         << " </td>\n";
-            html << "<td> " << escape_nl2br(entry.value("description", ""))  << " </td>\n";
-            html << "<td> " << escape_nl2br(entry.value("changetype", ""))   << " </td>\n";
-
-            const std::string comp = entry.value("compatibility", "");
-            html << "<td> " << render_colored_compatibility(comp) << " </td>\n";
-            html << "</tr>\n";
-        }
-
-        html << "<div style='margin:12px 0;padding:10px;border:1px solid #ccc;"
-            "border-radius:5px;background:#fafafa;font-size:14px;'>\n";
-        html << "<b>Overall status:</b> " << overall_status << "<br/>\n";
-        html << "<b>Reason:</b> " << reason << "<br/>\n";
-        html << "</div>\n";
+    if (grouped.empty()) {
+        render_html_empty(html, overall_status, reason, files_exists);
+    }
+    else {
+        render_html_begin(html, parser);
+        for (const auto& entry : grouped) render_html_row(html, entry);
+        render_status_box(html, overall_status, reason);
     }
 
     html << HTML_FOOTER;
-    html.close();
+    html.writeTo(output_html_path);
 }
 
-void generate_json_report(const std::vector<json>& processed_data,
+void generate_json_report(const std::vector<ApiChangeGroup>& grouped,
                           const std::string& output_json_path,
                           int parsed_status,
                           int unparsed_status,
@@ -1652,17 +1661,50 @@ void generate_json_report(const std::vector<json>& processed_data,
                           const char* reason)
 {
     if (output_json_path.empty()) return;
-    std::ofstream jf(output_json_path);
-    ParsedDiffStatus parsedStatus = static_cast<ParsedDiffStatus>(parsed_status);
-    UnParsedDiffStatus unParsedStatus = static_cast<UnParsedDiffStatus>(unparsed_status);
-    auto grouped = group_records_by_function(processed_data);
-    json wrapper;
-    wrapper["api_diff"]       = grouped;
-    wrapper["parsed_status"]  = serialize(parsedStatus);
-    wrapper["unparsed_staus"] = serialize(unParsedStatus);
-    wrapper["compatibility"]  = agg_compatibility;
-    wrapper["overall_status"] = overall_status;
-    wrapper["reason"]         = reason; 
-    jf << wrapper.dump(4);
-    jf.close();
+    ReportBuffer json_out(expected_report_size(grouped));
+    json_out << "{\n    \"api_diff\": [";
+    for (size_t i = 0; i < grouped.size(); ++i) render_json_row(json_out, grouped[i], i == 0);
+    render_json_end(json_out, grouped.empty(), parsed_status, unparsed_status,
+                    agg_compatibility, overall_status, reason);
+    json_out.writeTo(output_json_path);
+}
+
+void generate_reports(const std::vector<ApiChangeGroup>& grouped,
+                      const std::string& output_html_path,
+                      const std::string& output_json_path,
+                      PARSER parser,
+                      int parsed_status,
+                      int unparsed_status,
+                      const std::string& agg_compatibility,
+                      const char* overall_status,
+                      const char* reason)
+{
+    if (grouped.empty()) {
+        generate_html_report(grouped, output_html_path, parser, parsed_status, unparsed_status,
+                             agg_compatibility, overall_status, reason);
+        generate_json_report(grouped, output_json_path, parsed_status, unparsed_status,
+                             agg_compatibility, overall_status, reason);
+        return;
+    }
+
+    const bool with_json = !output_json_path.empty();
+    const size_t expected_size = expected_report_size(grouped);
+    ReportBuffer html(expected_size);
+    ReportBuffer json_out(with_json ? expected_size : 0);
+
+    render_html_begin(html, parser);
+    if (with_json) json_out << "{\n    \"api_diff\": [";
+    for (size_t i = 0; i < grouped.size(); ++i) {
+        render_html_row(html, grouped[i]);
+        if (with_json) render_json_row(json_out, grouped[i], i == 0);
+    }
+    render_status_box(html, overall_status, reason);
+    html << HTML_FOOTER;
+    html.writeTo(output_html_path);
+
+    if (with_json) {
+        render_json_end(json_out, false, parsed_status, unparsed_status,
+                        agg_compatibility, overall_status, reason);
+        json_out.writeTo(output_json_path);
+    }
 }
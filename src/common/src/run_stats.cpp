@@ -0,0 +1,141 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "run_stats.hpp"
+#include <cstring>
+#include <fstream>
+#include <sys/resource.h>
+#include <nlohmann/json.hpp>
+#include "llvm/Support/Format.h"
+
+namespace {
+
+void addStage(std::vector<std::pair<const char*, uint64_t>>& stages, const char* stage, uint64_t durationUs) {
+    for (auto& [name, us] : stages) {
+        if (std::strcmp(name, stage) == 0) {
+            us += durationUs;
+            return;
+        }
+    }
+    stages.emplace_back(stage, durationUs);
+}
+
+double toMs(uint64_t us) {
+    return static_cast<double>(us) / 1000.0;
+}
+
+} // namespace
+
+void armor::RunStats::enable() {
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void armor::RunStats::beginHeader(const std::string& header) {
+    threadHeader = std::make_unique<HeaderStats>();
+    threadHeader->header = header;
+}
+
+void armor::RunStats::endHeader() {
+    if (!threadHeader) return;
+    std::scoped_lock<std::mutex> lock(mutex);
+    headers.push_back(std::move(*threadHeader));
+    threadHeader.reset();
+}
+
+void armor::RunStats::addStageTime(const char* stage, uint64_t durationUs) {
+    if (threadHeader) {
+        addStage(threadHeader->stageUs, stage, durationUs);
+        return;
+    }
+    std::scoped_lock<std::mutex> lock(mutex);
+    addStage(unattributed.stageUs, stage, durationUs);
+}
+
+std::vector<armor::RunStats::HeaderStats> armor::RunStats::collect() {
+    std::scoped_lock<std::mutex> lock(mutex);
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        unattributed.counters[i] += counters[i].exchange(0, std::memory_order_relaxed);
+    }
+
+    std::vector<HeaderStats> result = headers;
+    HeaderStats total = unattributed;
+    total.header = "(total)";
+    for (const HeaderStats& stats : headers) {
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) total.counters[i] += stats.counters[i];
+        for (const auto& [stage, us] : stats.stageUs) addStage(total.stageUs, stage, us);
+    }
+    result.push_back(std::move(total));
+    return result;
+}
+
+void armor::RunStats::print(llvm::raw_ostream& os) {
+    os << "Run statistics:\n";
+    for (const HeaderStats& stats : collect()) {
+        auto value = [&stats](StatCounter counter) { return stats.counters[static_cast<size_t>(counter)]; };
+
+        os << "  " << stats.header << "\n"
+           << "    decls visited " << value(StatCounter::DeclsVisited)
+           << ", kept " << value(StatCounter::DeclsKept)
+           << " | API nodes " << value(StatCounter::ApiNodesBuilt)
+           << " | unhandled hashes " << value(StatCounter::UnhandledHashes)
+           << " | type strings " << value(StatCounter::TypeStrings)
+           << " | diff nodes " << value(StatCounter::DiffNodesCompared)
+           << " | report bytes " << value(StatCounter::ReportBytes) << "\n";
+
+        if (stats.stageUs.empty()) continue;
+        os << "    ";
+        for (size_t i = 0; i < stats.stageUs.size(); ++i) {
+            if (i > 0) os << " | ";
+            os << stats.stageUs[i].first << " " << llvm::format("%.1f", toMs(stats.stageUs[i].second)) << " ms";
+        }
+        os << "\n";
+    }
+    os << "  process peak RSS " << llvm::format("%.1f", peakRssBytes() / (1024.0 * 1024.0)) << " MB\n";
+}
+
+bool armor::RunStats::writeJson(const std::string& path) {
+    auto toJson = [](const HeaderStats& stats) {
+        nlohmann::ordered_json entry;
+        entry["header"] = stats.header;
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            entry["counters"][counterName(static_cast<StatCounter>(i))] = stats.counters[i];
+        }
+        entry["stages_ms"] = nlohmann::ordered_json::object();
+        for (const auto& [stage, us] : stats.stageUs) entry["stages_ms"][stage] = toMs(us);
+        return entry;
+    };
+
+    std::vector<HeaderStats> all = collect();
+    nlohmann::ordered_json out;
+    out["headers"] = nlohmann::ordered_json::array();
+    for (size_t i = 0; i + 1 < all.size(); ++i) out["headers"].push_back(toJson(all[i]));
+    out["total"] = toJson(all.back());
+    out["process_peak_rss_bytes"] = peakRssBytes();
+
+    std::ofstream file(path, std::ios::trunc);
+    file << out.dump(4) << "\n";
+    return static_cast<bool>(file);
+}
+
+const char* armor::RunStats::counterName(StatCounter counter) {
+    switch (counter) {
+        case StatCounter::DeclsVisited:      return "decls_visited";
+        case StatCounter::DeclsKept:         return "decls_kept";
+        case StatCounter::ApiNodesBuilt:     return "api_nodes_built";
+        case StatCounter::UnhandledHashes:   return "unhandled_hashes";
+        case StatCounter::TypeStrings:       return "type_strings";
+        case StatCounter::DiffNodesCompared: return "diff_nodes_compared";
+        case StatCounter::ReportBytes:       return "report_bytes";
+        case StatCounter::Count:             break;
+    }
+    return "unknown";
+}
+
+uint64_t armor::RunStats::peakRssBytes() {
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;   // kilobytes on Linux
+#endif
+}
@@ -14,11 +14,15 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "session.hpp"
+#include "archive_file_system.hpp"
 #include "ast_normalized_context.hpp"
+#include "header_search.hpp"
 #include "logger.hpp"
+#include "trace.hpp"
 
 namespace {
 
@@ -31,18 +35,31 @@ void setupClangTool(clang::tooling::ClangTool& tool, llvm::raw_ostream* sink,
     tool.appendArgumentsAdjuster(clang::tooling::getInsertArgumentAdjuster("-fno-caret-diagnostics"));
     tool.appendArgumentsAdjuster(clang::tooling::getInsertArgumentAdjuster("-fdiagnostics-show-note-include-stack"));
     tool.appendArgumentsAdjuster(clang::tooling::getInsertArgumentAdjuster("-fdiagnostics-absolute-paths"));
+    tool.appendArgumentsAdjuster([](const clang::tooling::CommandLineArguments& args, llvm::StringRef) {
+        return armor::canonicalizeSearchPaths(args);
+    });
     tool.setPrintErrorMessage(false);
 }
 
 } // namespace
 
-static llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> sDiagOpts;
+// DiagnosticOptions is not thread-safe reference counted, so each thread
+// processing headers gets its own.
+static llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> threadDiagOpts() {
+    static thread_local llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diagOpts = [] {
+        llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> opts(new clang::DiagnosticOptions());
+        opts->ShowColors = 0;
+        return opts;
+    }();
+    return diagOpts;
+}
 
-static void ensureDiagOpts() {
-    if (!sDiagOpts) {
-        sDiagOpts = llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions>(new clang::DiagnosticOptions());
-        sDiagOpts->ShowColors = 0;
-    }
+// A file system with its own working directory: ClangTool moves into the
+// compile directory on this instead of changing the process cwd, which other
+// threads rely on. Mounted archives are visible through it, and lookups of
+// headers the run's directory index rules out fail without a stat.
+static llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> makeToolFileSystem() {
+    return armor::createIndexedFileSystem(armor::createFileSystem(), armor::DirectoryIndex::getInstance());
 }
 
 void armor::APISession::createAlphaContext(const std::string& key) {
@@ -64,16 +81,21 @@ PARSING_STATUS armor::APISession::processFileAlpha(
     std::unique_ptr<clang::tooling::FixedCompilationDatabase> compDB,
     std::unique_ptr<clang::tooling::FrontendActionFactory> factory)
 {
+    armor::TraceScope span("alpha parse", "parse", fileName);
     DebugConfig& debugConfig = DebugConfig::getInstance();
-    llvm::raw_ostream* sink = debugConfig.getSink();
-    ensureDiagOpts();
 
     createAlphaContext(fileName);
 
-    clang::tooling::ClangTool tool(*compDB, {fileName});
-    setupClangTool(tool, sink, sDiagOpts);
+    // Diagnostics are collected per run and appended to the log in one piece,
+    // so parallel runs do not interleave inside the log file.
+    std::string diagnostics;
+    llvm::raw_string_ostream diagSink(diagnostics);
+    clang::tooling::ClangTool tool(*compDB, {fileName}, std::make_shared<clang::PCHContainerOperations>(),
+                                   makeToolFileSystem());
+    setupClangTool(tool, &diagSink, threadDiagOpts());
 
     int rc = tool.run(factory.get());
+    debugConfig.writeToSink(diagSink.str());
     if (rc != 0) {
         armor::error() << "Alpha: error while processing " << fileName << ".\n";
         debugConfig.flush();
@@ -88,16 +110,21 @@ PARSING_STATUS armor::APISession::processFileBeta(
     std::unique_ptr<clang::tooling::FixedCompilationDatabase> compDB,
     std::unique_ptr<clang::tooling::FrontendActionFactory> factory)
 {
+    armor::TraceScope span("beta parse", "parse", fileName);
     DebugConfig& debugConfig = DebugConfig::getInstance();
-    llvm::raw_ostream* sink = debugConfig.getSink();
-    ensureDiagOpts();
 
     createBetaContext(fileName);
 
-    clang::tooling::ClangTool tool(*compDB, {fileName});
-    setupClangTool(tool, sink, sDiagOpts);
+    // Diagnostics are collected per run and appended to the log in one piece,
+    // so parallel runs do not interleave inside the log file.
+    std::string diagnostics;
+    llvm::raw_string_ostream diagSink(diagnostics);
+    clang::tooling::ClangTool tool(*compDB, {fileName}, std::make_shared<clang::PCHContainerOperations>(),
+                                   makeToolFileSystem());
+    setupClangTool(tool, &diagSink, threadDiagOpts());
 
     int rc = tool.run(factory.get());
+    debugConfig.writeToSink(diagSink.str());
     if (rc != 0) {
         armor::error() << "Beta: error while processing " << fileName << ".\n";
         debugConfig.flush();
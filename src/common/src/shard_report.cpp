@@ -0,0 +1,178 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "shard_report.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <system_error>
+#include <nlohmann/json.hpp>
+#include "consolidated_report.hpp"
+#include "header_scheduler.hpp"
+#include "logger.hpp"
+#include "ndjson_writer.hpp"
+#include "report_utils.hpp"
+
+static const char* const REPORT_SUBDIRS[] = {"json_reports", "html_reports"};
+
+void armor::ShardSummary::addHeader(const std::string& header, const HeaderReportSummary& summary) {
+    entries.push_back({header, summary});
+}
+
+bool armor::ShardSummary::isBackwardCompatible() const {
+    return std::all_of(entries.begin(), entries.end(), [](const Entry& entry) {
+        return entry.summary.compatibility == "backward_compatible";
+    });
+}
+
+bool armor::ShardSummary::write(const std::string& path) const {
+    nlohmann::ordered_json out;
+    out["shard"] = shard;
+    out["compatibility"] = isBackwardCompatible() ? "backward_compatible" : "backward_incompatible";
+    out["headers"] = nlohmann::ordered_json::array();
+    for (const Entry& entry : entries) {
+        nlohmann::ordered_json header;
+        header["header"] = entry.header;
+        header["compatibility"] = entry.summary.compatibility;
+        header["overall_status"] = entry.summary.overallStatus;
+        header["reason"] = entry.summary.reason;
+        header["incompatible_changes"] = entry.summary.incompatibleChanges;
+        if (!entry.summary.degradation.empty()) header["degradation"] = entry.summary.degradation;
+        header["changes"] = nlohmann::ordered_json::array();
+        for (const ApiChangeGroup& change : entry.summary.changes) {
+            header["changes"].push_back({{"headerfile", change.headerfile},
+                                         {"name", change.name},
+                                         {"description", change.description},
+                                         {"compatibility_changed", change.compatibilityChanged},
+                                         {"backward_incompatible", change.backwardIncompatible}});
+        }
+        out["headers"].push_back(std::move(header));
+    }
+
+    create_parent_dirs(path);
+    std::ofstream file(path, std::ios::trunc);
+    file << out.dump(4, ' ', false, nlohmann::ordered_json::error_handler_t::replace) << "\n";
+    return static_cast<bool>(file);
+}
+
+bool armor::ShardSummary::read(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+    nlohmann::json root = nlohmann::json::parse(in, nullptr, false);
+    if (!root.is_object() || !root.contains("headers") || !root["headers"].is_array()) return false;
+
+    shard = root.value("shard", "");
+    entries.clear();
+    for (const auto& header : root["headers"]) {
+        Entry entry;
+        entry.header = header.value("header", "");
+        entry.summary.compatibility = header.value("compatibility", "unknown");
+        entry.summary.overallStatus = header.value("overall_status", "");
+        entry.summary.reason = header.value("reason", "");
+        entry.summary.incompatibleChanges = header.value("incompatible_changes", std::vector<std::string>());
+        entry.summary.degradation = header.value("degradation", "");
+        for (const auto& change : header.value("changes", nlohmann::json::array())) {
+            ApiChangeGroup group;
+            group.headerfile = change.value("headerfile", "");
+            group.name = change.value("name", "");
+            group.description = change.value("description", "");
+            group.compatibilityChanged = change.value("compatibility_changed", false);
+            group.backwardIncompatible = change.value("backward_incompatible", false);
+            entry.summary.changes.push_back(std::move(group));
+        }
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+// Copies the per-header reports of one shard, skipping a shard that is outDir itself.
+static void copyShardReports(const std::filesystem::path& shardDir, const std::filesystem::path& outDir) {
+    std::error_code ec;
+    if (std::filesystem::equivalent(shardDir, outDir, ec)) return;
+
+    for (const char* subdir : REPORT_SUBDIRS) {
+        std::filesystem::path from = shardDir / subdir;
+        if (!std::filesystem::is_directory(from, ec)) continue;
+        std::filesystem::create_directories(outDir / subdir, ec);
+        for (const auto& entry : std::filesystem::directory_iterator(from, ec)) {
+            if (!entry.is_regular_file()) continue;
+            std::filesystem::copy_file(entry.path(), outDir / subdir / entry.path().filename(),
+                                       std::filesystem::copy_options::overwrite_existing, ec);
+            if (ec) armor::user_error() << "Failed to copy " << entry.path().string() << ": " << ec.message() << "\n";
+        }
+    }
+}
+
+bool armor::mergeShardReports(const std::vector<std::string>& shardDirs, const std::string& outDir,
+                              ShardSummary& merged) {
+    std::vector<ShardSummary> shards(shardDirs.size());
+    for (size_t i = 0; i < shardDirs.size(); ++i) {
+        std::string path = (std::filesystem::path(shardDirs[i]) / ShardSummary::FILE_NAME).string();
+        if (!shards[i].read(path)) {
+            armor::user_error() << "Failed to read shard summary: " << path << "\n";
+            return false;
+        }
+    }
+
+    // Every shard of one plan names the same count; report gaps and repeats.
+    std::set<unsigned> seen;
+    unsigned count = 0;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        std::optional<ShardSpec> spec = ShardSpec::parse(shards[i].getShard());
+        if (!spec) {
+            armor::user_error() << "Warning: " << shardDirs[i] << " was not produced by a --shard run\n";
+            continue;
+        }
+        if (count != 0 && spec->count != count)
+            armor::user_error() << "Warning: " << shardDirs[i] << " is shard " << spec->toString()
+                                << " but other shards are out of " << count << "\n";
+        count = std::max(count, spec->count);
+        if (!seen.insert(spec->index).second)
+            armor::user_error() << "Warning: shard " << spec->toString() << " given more than once\n";
+    }
+    for (unsigned index = 1; index <= count; ++index) {
+        if (!seen.count(index))
+            armor::user_error() << "Warning: shard " << index << "/" << count << " is missing\n";
+    }
+
+    std::set<std::string> headers;
+    std::vector<ShardSummary::Entry> entries;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        for (const ShardSummary::Entry& entry : shards[i].getEntries()) {
+            if (headers.insert(entry.header).second)
+                entries.push_back(entry);
+            else
+                armor::user_error() << "Warning: " << entry.header << " reported again by " << shardDirs[i] << ", ignored\n";
+        }
+    }
+    std::stable_sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.header < rhs.header;
+    });
+
+    std::filesystem::path out(outDir);
+    std::error_code ec;
+    std::filesystem::create_directories(out, ec);
+    for (const std::string& dir : shardDirs) copyShardReports(dir, out);
+
+    merged = ShardSummary();
+    ConsolidatedReport consolidated;
+    NdjsonWriter ndjson;
+    bool ok = ndjson.open((out / std::filesystem::path(NdjsonWriter::DEFAULT_PATH).filename()).string());
+    for (const ShardSummary::Entry& entry : entries) {
+        merged.addHeader(entry.header, entry.summary);
+        consolidated.addHeader(entry.header, entry.summary);
+        ndjson.writeHeader(entry.header, entry.summary);
+    }
+
+    std::string summaryPath = (out / ShardSummary::FILE_NAME).string();
+    if (!merged.write(summaryPath)) {
+        armor::user_error() << "Failed to write merged summary: " << summaryPath << "\n";
+        ok = false;
+    }
+    std::string htmlPath = (out / std::filesystem::path(ConsolidatedReport::DEFAULT_PATH).filename()).string();
+    if (!consolidated.write(htmlPath)) {
+        armor::user_error() << "Failed to write consolidated report: " << htmlPath << "\n";
+        ok = false;
+    }
+    return ok;
+}
@@ -0,0 +1,69 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "source_region_index.hpp"
+#include <algorithm>
+#include <utility>
+
+void armor::SourceRegionIndex::addComment(unsigned startOffset, unsigned endOffset, uint64_t hash) {
+    regions.push_back({startOffset, endOffset, hash, SourceRegion::Kind::Comment, false});
+    classified = false;
+}
+
+void armor::SourceRegionIndex::addDirective(unsigned startOffset, unsigned endOffset, bool isActive) {
+    SourceRegion::Kind kind = isActive ? SourceRegion::Kind::Directive : SourceRegion::Kind::InactiveBlock;
+    regions.push_back({startOffset, endOffset, static_cast<uint64_t>(-1), kind, false});
+    classified = false;
+}
+
+void armor::SourceRegionIndex::classify() {
+    // Enclosing regions sort before the regions they contain.
+    std::stable_sort(regions.begin(), regions.end(), [](const SourceRegion& lhs, const SourceRegion& rhs) {
+        if (lhs.startOffset != rhs.startOffset) return lhs.startOffset < rhs.startOffset;
+        return lhs.endOffset > rhs.endOffset;
+    });
+
+    std::vector<SourceRegion> kept;
+    kept.reserve(regions.size());
+
+    const size_t none = static_cast<size_t>(-1);
+    size_t lastDirective = none;
+    size_t lastInactiveBlock = none;
+
+    for (SourceRegion& region : regions) {
+        if (!region.isDirective()) {
+            region.inInactiveBlock = lastInactiveBlock != none && kept[lastInactiveBlock].contains(region);
+            kept.push_back(region);
+            continue;
+        }
+
+        if (lastDirective != none && kept[lastDirective].contains(region)) continue;
+
+        lastDirective = kept.size();
+        if (region.kind == SourceRegion::Kind::InactiveBlock) lastInactiveBlock = kept.size();
+        kept.push_back(region);
+    }
+
+    regions = std::move(kept);
+    classified = true;
+}
+
+bool armor::SourceRegionIndex::isClassified() const {
+    return classified;
+}
+
+llvm::ArrayRef<armor::SourceRegion> armor::SourceRegionIndex::getRegions() const {
+    return regions;
+}
+
+llvm::MutableArrayRef<armor::SourceRegion> armor::SourceRegionIndex::getRegions() {
+    return regions;
+}
+
+void armor::SourceRegionIndex::clear() {
+    regions.clear();
+    classified = false;
+}
+
+bool armor::SourceRegionIndex::empty() const {
+    return regions.empty();
+}
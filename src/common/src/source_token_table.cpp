@@ -0,0 +1,72 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "source_token_table.hpp"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Lex/Lexer.h"
+#include <algorithm>
+
+void armor::SourceTokenTable::build(const clang::SourceManager& SM) {
+    clear();
+
+    clang::FileID FID = SM.getMainFileID();
+    llvm::StringRef buffer = SM.getBufferData(FID);
+
+    sourceManager = &SM;
+    bufferStart = buffer.data();
+    bufferSize = buffer.size();
+
+    // Same language options as Lexer::getRawToken uses in FibonacciHash, so the
+    // recorded tokens match what per-range lexing would produce.
+    static const clang::LangOptions langOpts;
+
+    clang::Lexer lexer(SM.getLocForStartOfFile(FID), langOpts,
+                       buffer.begin(), buffer.begin(), buffer.end());
+    lexer.SetCommentRetentionState(true);
+
+    // Rough estimate of one token per four bytes of header text.
+    tokens.reserve(bufferSize / 4);
+
+    clang::Token tok;
+    while (true) {
+        lexer.LexFromRawLexer(tok);
+        if (tok.is(clang::tok::eof)) break;
+
+        unsigned startOffset = SM.getFileOffset(tok.getLocation());
+        tokens.push_back({startOffset, startOffset + tok.getLength(), tok.is(clang::tok::comment)});
+    }
+}
+
+bool armor::SourceTokenTable::covers(const clang::SourceManager& SM) const {
+    if (sourceManager != &SM) return false;
+
+    llvm::StringRef buffer = SM.getBufferData(SM.getMainFileID());
+    return buffer.data() == bufferStart && buffer.size() == bufferSize;
+}
+
+bool armor::SourceTokenTable::tokensInRange(unsigned startOffset, unsigned endOffset,
+                                            llvm::ArrayRef<Token>& result) const {
+    // Tokens are sorted and disjoint, so the first token ending after
+    // startOffset is the only one that can straddle it.
+    auto first = std::upper_bound(tokens.begin(), tokens.end(), startOffset,
+        [](unsigned offset, const Token& token) { return offset < token.endOffset; });
+
+    if (first != tokens.end() && first->startOffset < startOffset) return false;
+
+    auto last = std::lower_bound(first, tokens.end(), endOffset,
+        [](const Token& token, unsigned offset) { return token.startOffset < offset; });
+
+    result = llvm::ArrayRef<Token>(tokens).slice(first - tokens.begin(), last - first);
+    return true;
+}
+
+bool armor::SourceTokenTable::empty() const {
+    return tokens.empty();
+}
+
+void armor::SourceTokenTable::clear() {
+    tokens.clear();
+    sourceManager = nullptr;
+    bufferStart = nullptr;
+    bufferSize = 0;
+}
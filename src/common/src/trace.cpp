@@ -0,0 +1,115 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "trace.hpp"
+#include "run_stats.hpp"
+#include <fstream>
+#include <utility>
+#include <nlohmann/json.hpp>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/raw_ostream.h"
+
+// Clang events shorter than this are dropped, as with -ftime-trace-granularity.
+static constexpr unsigned CLANG_TRACE_GRANULARITY_US = 500;
+
+
+void armor::Tracer::enable(bool includeClang) {
+    std::scoped_lock<std::mutex> lock(mutex);
+    if (enabled.load(std::memory_order_relaxed)) return;
+
+    if (includeClang && !llvm::timeTraceProfilerEnabled()) {
+        llvm::timeTraceProfilerInitialize(CLANG_TRACE_GRANULARITY_US, "armor");
+        clangTrace.store(true);
+    }
+    start = std::chrono::steady_clock::now();
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+// Set on worker threads whose Clang time-trace was started by attachThread().
+static thread_local bool clangTraceAttached = false;
+
+void armor::Tracer::attachThread() {
+    if (!clangTrace.load() || llvm::timeTraceProfilerEnabled()) return;
+    llvm::timeTraceProfilerInitialize(CLANG_TRACE_GRANULARITY_US, "armor");
+    clangTraceAttached = true;
+}
+
+void armor::Tracer::detachThread() {
+    if (!clangTraceAttached) return;
+    llvm::timeTraceProfilerFinishThread();
+    clangTraceAttached = false;
+}
+
+uint64_t armor::Tracer::sinceStartUs(std::chrono::steady_clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - start).count();
+}
+
+void armor::Tracer::record(Event event) {
+    std::scoped_lock<std::mutex> lock(mutex);
+    events.push_back(std::move(event));
+}
+
+bool armor::Tracer::write(const std::string& path) {
+    std::scoped_lock<std::mutex> lock(mutex);
+
+    // Same process and thread ids as LLVM's time-trace, so merged Clang
+    // spans nest under armor's own.
+    int64_t pid = llvm::sys::Process::getProcessId();
+
+    nlohmann::json traceEvents = nlohmann::json::array();
+    traceEvents.push_back({{"ph", "M"}, {"name", "process_name"}, {"pid", pid}, {"tid", 0},
+                           {"args", {{"name", "armor"}}}});
+    for (const Event& event : events) {
+        nlohmann::json entry = {
+            {"name", event.name}, {"cat", event.category}, {"ph", "X"},
+            {"ts", event.startUs}, {"dur", event.durationUs},
+            {"pid", pid}, {"tid", event.threadId}
+        };
+        if (!event.detail.empty()) entry["args"] = {{"detail", event.detail}};
+        traceEvents.push_back(std::move(entry));
+    }
+
+    if (clangTrace) {
+        // LLVM's timestamps are relative to timeTraceProfilerInitialize(),
+        // which enable() calls right before taking our own start time.
+        llvm::SmallString<0> clangJson;
+        llvm::raw_svector_ostream os(clangJson);
+        llvm::timeTraceProfilerWrite(os);
+        llvm::timeTraceProfilerCleanup();
+        clangTrace.store(false);
+
+        nlohmann::json clangTraceJson = nlohmann::json::parse(clangJson.str().str(), nullptr, false);
+        if (clangTraceJson.is_object() && clangTraceJson.contains("traceEvents")) {
+            for (auto& event : clangTraceJson["traceEvents"]) {
+                if (event.value("ph", "") == "M") continue;
+                traceEvents.push_back(std::move(event));
+            }
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out << nlohmann::json{{"traceEvents", std::move(traceEvents)}, {"displayTimeUnit", "ms"}}.dump();
+    return static_cast<bool>(out);
+}
+
+armor::TraceScope::TraceScope(const char* name, const char* category, llvm::StringRef detail)
+    : name(name), category(category),
+      traced(Tracer::getInstance().isEnabled()), timed(RunStats::isEnabled()) {
+    if (!traced && !timed) return;
+    if (traced) this->detail = detail.str();
+    begin = std::chrono::steady_clock::now();
+}
+
+armor::TraceScope::~TraceScope() {
+    if (!traced && !timed) return;
+    auto end = std::chrono::steady_clock::now();
+    uint64_t durationUs = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+    if (timed) RunStats::getInstance().addStageTime(name, durationUs);
+    if (traced) {
+        Tracer& tracer = Tracer::getInstance();
+        tracer.record({name, category, std::move(detail), tracer.sinceStartUs(begin), durationUs, llvm::get_threadid()});
+    }
+}
@@ -5,6 +5,7 @@
 #include "logger.hpp"
 #include "nsr_generator.hpp"
 #include "qualified_name_generator.hpp"
+#include "run_stats.hpp"
 
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Decl.h"
@@ -173,6 +174,7 @@ const std::pair<const std::string,const std::string> getTypesWithAndWithoutTypeR
     if (T.isNull()) {
         return {std::string{}, std::string{}};
     }
+    armor::RunStats::count(armor::StatCounter::TypeStrings, 2);
     
     clang::PrintingPolicy Policy1(Ctx.getLangOpts());
     Policy1.SuppressTagKeyword = false;
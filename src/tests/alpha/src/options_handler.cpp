@@ -82,7 +82,7 @@ bool runArmorTool(int argc, const char **argv) {
         armor::user_print() << "Alpha checking: " << header << "\n";
         PARSING_STATUS status = armor::alpha::processHeaderPairAlpha(
             projectRoot1, file1, projectRoot2, file2,
-            "json", IncludePaths, macros, langOption);
+            "json", IncludePaths, macros, langOption, /*dumpAstDiff*/true);
 
         if (status == FATAL_ERRORS) {
             armor::user_error() << "Fatal parse errors detected in: " << header << "\n";
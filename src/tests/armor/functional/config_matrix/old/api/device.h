@@ -0,0 +1,6 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+int open_device(int id);
+#ifdef FEATURE_ASYNC
+int open_device_async(int id);
+#endif
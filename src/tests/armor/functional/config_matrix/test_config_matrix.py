@@ -0,0 +1,34 @@
+# Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+# SPDX-License-Identifier: BSD-3-Clause
+import json
+import os
+import subprocess
+
+
+def test_config_matrix(armor_path, request):
+    test_dir = os.path.dirname(request.fspath)
+
+    result = subprocess.run(
+        [armor_path, "configs", "--matrix", "configs.json", "--header-dir", "api", "--recursive",
+         "-r", "json", "old", "new"],
+        cwd=test_dir)
+    assert result.returncode == 0
+
+    with open(os.path.join(test_dir, "armor_reports", "armor_configurations.json")) as report:
+        matrix = json.load(report)
+    verdicts = {entry["configuration"]: entry["compatibility"] for entry in matrix["configurations"]}
+    assert verdicts == {"base": "backward_compatible", "async": "backward_incompatible",
+                        "async2": "backward_incompatible"}
+
+    # The identical detail/util.h is settled without a report; the nested extra.h is found.
+    rows = {header["header"]: header["results"] for header in matrix["headers"]}
+    assert sorted(rows) == ["detail/extra.h", "device.h"]
+    assert all(result["compatibility"] == "backward_compatible" for result in rows["detail/extra.h"].values())
+
+    device = rows["device.h"]
+    assert device["base"]["compatibility"] == "backward_compatible"
+    assert device["async"]["compatibility"] == "backward_incompatible"
+    # Same language and macro flags: one comparison, reported under the first configuration.
+    assert device["async2"]["report"] == device["async"]["report"]
+    assert os.path.exists(os.path.join(test_dir, "armor_reports", "json_reports",
+                                       f"api_diff_report_{device['async']['report']}.json"))
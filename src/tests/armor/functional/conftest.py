@@ -22,6 +22,11 @@ def binary_path():
     """Returns the absolute path to the binary."""
     return os.path.join(get_build_dir(), "src/tests/armor/armor_debug")
 
+@pytest.fixture
+def armor_path():
+    """Returns the absolute path to the armor binary, for its subcommands and git modes."""
+    return os.path.join(get_build_dir(), "src/armor/armor")
+
 @pytest.fixture
 def binary_args(request):
     """Returns the arguments for the binary with debug and JSON output enabled."""
@@ -0,0 +1,4 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+int open_device(int id);
+int read_device(int id);
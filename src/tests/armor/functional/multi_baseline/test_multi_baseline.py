@@ -0,0 +1,66 @@
+# Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+# SPDX-License-Identifier: BSD-3-Clause
+import json
+import os
+import shutil
+import subprocess
+
+
+def read_matrix(test_dir):
+    with open(os.path.join(test_dir, "armor_reports", "armor_baselines.json")) as matrix:
+        return json.load(matrix)
+
+
+def verdicts(matrix):
+    return {baseline["baseline"]: baseline["compatibility"] for baseline in matrix["baselines"]}
+
+
+def results(matrix):
+    return {header["header"]: header["results"] for header in matrix["headers"]}
+
+
+def test_multi_baseline(armor_path, request):
+    test_dir = os.path.dirname(request.fspath)
+
+    result = subprocess.run(
+        [armor_path, "multi", "--header-dir", "api", "--recursive", "-r", "json", "new", "base1", "base2"],
+        cwd=test_dir)
+    assert result.returncode == 0
+
+    matrix = read_matrix(test_dir)
+    assert verdicts(matrix) == {"base1": "backward_compatible", "base2": "backward_incompatible"}
+    rows = results(matrix)
+    assert sorted(rows) == ["detail/extra.h", "mylib.h"]
+    assert rows["mylib.h"]["base1"]["compatibility"] == "backward_compatible"
+    assert rows["mylib.h"]["base2"]["compatibility"] == "backward_incompatible"
+    # Only base2 has the nested header; base1 sees it added.
+    assert rows["detail/extra.h"]["base1"]["reason"] == "Missing header in older version"
+    assert rows["detail/extra.h"]["base2"]["compatibility"] == "backward_incompatible"
+    for baseline in ("base1", "base2"):
+        report = rows["mylib.h"][baseline]["report"]
+        assert os.path.exists(os.path.join(test_dir, "armor_reports", "json_reports",
+                                           f"api_diff_report_{report}.json")), report
+
+
+def test_multi_baseline_against_snapshot(armor_path, request):
+    test_dir = os.path.dirname(request.fspath)
+    snapshot_dir = os.path.join(test_dir, "base2_snapshot")
+    shutil.rmtree(snapshot_dir, ignore_errors=True)
+
+    result = subprocess.run(
+        [armor_path, "snapshot", "--header-dir", "api", "--recursive", "-o", snapshot_dir, "base2"],
+        cwd=test_dir)
+    assert result.returncode == 0
+
+    # The headers of a snapshot baseline are found through its snapshot files.
+    result = subprocess.run(
+        [armor_path, "multi", "--header-dir", "api", "--recursive", "-r", "json", "new", "base2_snapshot"],
+        cwd=test_dir)
+    assert result.returncode == 0
+
+    matrix = read_matrix(test_dir)
+    assert verdicts(matrix) == {"base2_snapshot": "backward_incompatible"}
+    rows = results(matrix)
+    assert sorted(rows) == ["detail/extra.h", "mylib.h"]
+    assert rows["detail/extra.h"]["base2_snapshot"]["compatibility"] == "backward_incompatible"
+    assert rows["mylib.h"]["base2_snapshot"]["compatibility"] == "backward_incompatible"
@@ -0,0 +1,60 @@
+# Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+# SPDX-License-Identifier: BSD-3-Clause
+import json
+import os
+import subprocess
+
+
+def read_report(test_dir, name):
+    path = os.path.join(test_dir, "armor_reports", "json_reports", f"api_diff_report_{name}.json")
+    assert os.path.exists(path), path
+    with open(path) as report:
+        return json.load(report)
+
+
+def test_version_chain(armor_path, request):
+    test_dir = os.path.dirname(request.fspath)
+    trace_path = os.path.join(test_dir, "chain_trace.json")
+
+    result = subprocess.run(
+        [armor_path, "chain", "-H", "mylib.h", "-H", "other.h", "-r", "json",
+         "--trace-out", trace_path, "v1", "v2", "v3"],
+        cwd=test_dir)
+    assert result.returncode == 0
+
+    # Every version of a header is parsed once, though the middle one is in two comparisons.
+    with open(trace_path) as trace:
+        events = json.load(trace)["traceEvents"]
+    for phase in ("alpha parse", "beta parse"):
+        parsed = [os.path.normpath(event["args"]["detail"]) for event in events if event["name"] == phase]
+        for file in ("v1/mylib.h", "v2/mylib.h", "v3/mylib.h", "v1/other.h", "v3/other.h"):
+            assert sum(path.endswith(file) for path in parsed) == 1, (phase, file)
+        assert not any(path.endswith("v2/other.h") for path in parsed)
+
+    assert read_report(test_dir, "mylib.h_v1_to_v2")["compatibility"] == "backward_compatible"
+    assert read_report(test_dir, "mylib.h_v2_to_v3")["compatibility"] == "backward_incompatible"
+
+    # other.h is missing from v2: removed going into it, added again coming out of it.
+    removed = read_report(test_dir, "other.h_v1_to_v2")
+    assert removed["compatibility"] == "backward_incompatible"
+    assert removed["reason"] == "Missing header in newer version"
+    added = read_report(test_dir, "other.h_v2_to_v3")
+    assert added["compatibility"] == "backward_compatible"
+    assert added["reason"] == "Missing header in older version"
+
+
+def test_version_chain_finds_headers_like_a_comparison(armor_path, request):
+    test_dir = os.path.dirname(request.fspath)
+
+    result = subprocess.run(
+        [armor_path, "chain", "--header-dir", "api", "--recursive", "--exclude-glob", "*_internal.h",
+         "-r", "json", "v1", "v2", "v3"],
+        cwd=test_dir)
+    assert result.returncode == 0
+
+    assert read_report(test_dir, "api_top.h_v1_to_v2")["compatibility"] == "backward_compatible"
+    assert read_report(test_dir, "api_detail_inner.h_v1_to_v2")["compatibility"] == "backward_compatible"
+    assert read_report(test_dir, "api_detail_inner.h_v2_to_v3")["compatibility"] == "backward_incompatible"
+    # Excluded like in the main mode, though only v2 has it.
+    reports = os.listdir(os.path.join(test_dir, "armor_reports", "json_reports"))
+    assert not any("inner_internal" in report for report in reports)
@@ -0,0 +1,133 @@
+# Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+# SPDX-License-Identifier: BSD-3-Clause
+import fcntl
+import os
+import subprocess
+
+import pytest
+
+GIT_ENV = dict(os.environ,
+               GIT_AUTHOR_NAME="armor", GIT_AUTHOR_EMAIL="armor@example.com",
+               GIT_COMMITTER_NAME="armor", GIT_COMMITTER_EMAIL="armor@example.com")
+
+
+def git(repo, *args):
+    return subprocess.run(["git", "-C", str(repo)] + list(args), env=GIT_ENV, check=True,
+                          capture_output=True, text=True).stdout.strip()
+
+
+@pytest.fixture
+def repo(tmp_path):
+    """A repository whose mylib.h gains a function in each of three commits."""
+    repo = tmp_path / "repo"
+    repo.mkdir()
+    git(repo, "init", "-q")
+    (repo / ".gitignore").write_text("*.o\n")
+    commits = []
+    for version in range(1, 4):
+        (repo / "mylib.h").write_text("".join(f"int f{i}(int x);\n" for i in range(version)))
+        git(repo, "add", "-A")
+        git(repo, "commit", "-q", "-m", f"v{version}")
+        commits.append(git(repo, "rev-parse", "HEAD"))
+    return repo, commits
+
+
+def run_pooled(armor_path, repo, pool, old, new):
+    result = subprocess.run(
+        [armor_path, "mylib.h", "--dev-mode", "--git-ref", old, "--new-ref", new,
+         "--worktree-pool", str(pool), "-r", "json"],
+        cwd=repo, env=GIT_ENV)
+    assert result.returncode == 0
+
+
+def slots(pool):
+    """HEAD of every slot of the pool, by slot name."""
+    (repo_dir,) = pool.iterdir()
+    return {slot.name: git(slot, "rev-parse", "HEAD")
+            for slot in sorted(repo_dir.iterdir()) if slot.is_dir()}
+
+
+def test_slots_match_requested_commits(armor_path, repo, tmp_path):
+    repo, commits = repo
+    pool = tmp_path / "pool"
+    run_pooled(armor_path, repo, pool, commits[0], commits[1])
+    assert sorted(slots(pool).values()) == sorted(commits[:2])
+
+
+def test_released_slot_is_reused_and_cleaned(armor_path, repo, tmp_path):
+    repo, commits = repo
+    pool = tmp_path / "pool"
+    run_pooled(armor_path, repo, pool, commits[0], commits[1])
+    first = slots(pool)
+    (repo_dir,) = pool.iterdir()
+    for name in first:
+        (repo_dir / name / "build.o").write_text("stale")
+
+    run_pooled(armor_path, repo, pool, commits[0], commits[2])
+    second = slots(pool)
+    assert second.keys() == first.keys()
+    assert sorted(second.values()) == sorted([commits[0], commits[2]])
+    # Ignored files left in a slot do not survive its reuse.
+    assert not any((repo_dir / name / "build.o").exists() for name in second)
+
+
+def test_locked_slot_is_skipped(armor_path, repo, tmp_path):
+    repo, commits = repo
+    pool = tmp_path / "pool"
+    run_pooled(armor_path, repo, pool, commits[0], commits[1])
+    first = slots(pool)
+    (repo_dir,) = pool.iterdir()
+
+    # Another run holds every existing slot, so new ones are added.
+    locks = [open(repo_dir / (name + ".lock"), "w") for name in first]
+    try:
+        for lock in locks:
+            fcntl.flock(lock, fcntl.LOCK_EX | fcntl.LOCK_NB)
+        run_pooled(armor_path, repo, pool, commits[0], commits[2])
+    finally:
+        for lock in locks:
+            lock.close()
+
+    second = slots(pool)
+    assert len(second) == len(first) + 2
+    assert {name: second[name] for name in first} == first
+    added = sorted(second[name] for name in second if name not in first)
+    assert added == sorted([commits[0], commits[2]])
+
+
+def test_unopenable_lock_fails_instead_of_adding_slots(armor_path, repo, tmp_path):
+    repo, commits = repo
+    pool = tmp_path / "pool"
+    run_pooled(armor_path, repo, pool, commits[0], commits[1])
+    (repo_dir,) = pool.iterdir()
+    for lock in repo_dir.glob("slot-*.lock"):
+        lock.unlink()
+        lock.mkdir()
+
+    result = subprocess.run(
+        [armor_path, "mylib.h", "--dev-mode", "--git-ref", commits[0], "--new-ref", commits[2],
+         "--worktree-pool", str(pool), "-r", "json"],
+        cwd=repo, env=GIT_ENV, capture_output=True, text=True, timeout=60)
+    assert result.returncode != 0
+    assert "cannot lock a slot" in result.stderr
+    assert sorted(path.name for path in repo_dir.glob("slot-*.lock")) == ["slot-0.lock", "slot-1.lock"]
+
+
+def test_slot_at_the_commit_is_reset_and_cleaned(armor_path, repo, tmp_path):
+    repo, commits = repo
+    pool = tmp_path / "pool"
+    run_pooled(armor_path, repo, pool, commits[0], commits[1])
+    (repo_dir,) = pool.iterdir()
+    for name in slots(pool):
+        slot = repo_dir / name
+        (slot / "mylib.h").write_text("int edited(void);\n")
+        (slot / "staged.h").write_text("int staged;\n")
+        git(slot, "add", "staged.h")
+        (slot / "untracked.h").write_text("int untracked;\n")
+
+    # The same commits again: each slot is reused as is, but left as the commit has it.
+    run_pooled(armor_path, repo, pool, commits[0], commits[1])
+    for name in slots(pool):
+        slot = repo_dir / name
+        assert git(slot, "status", "--porcelain", "--ignored") == ""
+        assert "edited" not in (slot / "mylib.h").read_text()
@@ -12,6 +12,7 @@
 
 #include "alpha/include/header_processor.hpp"
 #include "beta/include/header_processor.hpp"
+#include "file_content_cache.hpp"
 #include "logger.hpp"
 
 #ifndef TOOL_VERSION
@@ -32,9 +33,8 @@ LANG_OPTIONS stringToLangOption(const std::string& lang) {
     return LANG_OPTIONS::CPP; // default to C++
 }
 
-bool filesAreDifferentUsingDiff(const std::string &file1, const std::string &file2) {
-    std::string command = "diff -q " + file1 + " " + file2 + " > /dev/null";
-    return std::system(command.c_str()) != 0;
+bool filesAreDifferent(const std::string &file1, const std::string &file2) {
+    return armor::FileContentCache().filesDiffer(file1, file2);
 }
 
 bool runArmorTool(int argc, const char **argv) {
@@ -144,14 +144,14 @@ bool runArmorTool(int argc, const char **argv) {
             else if (!std::filesystem::exists(file2)) {
                 armor::user_error() << "Missing header in newer version: " << file2 << "\n";
             } 
-            else if (filesAreDifferentUsingDiff(file1, file2)) {
+            else if (filesAreDifferent(file1, file2)) {
                 PARSING_STATUS parsingStatus = armor::alpha::processHeaderPairAlpha(projectRoot1, file1, projectRoot2, file2, reportFormat,
-                                IncludePaths, macros, langOption);
+                                IncludePaths, macros, langOption, dumpAstDiff);
                 switch (parsingStatus) {
                     case NO_FATAL_ERRORS:
                         armor::info() << "Processing Headers again via beta parser\n";
                         armor::beta::processHeaderPairBeta(projectRoot1, file1, projectRoot2, file2, reportFormat,
-                                    IncludePaths, macros, langOption);
+                                    IncludePaths, macros, langOption, dumpAstDiff);
                         break;
                     case FATAL_ERRORS:
                         armor::info() << "Processing Headers stopped at alpha parser\n";
@@ -187,14 +187,14 @@ bool runArmorTool(int argc, const char **argv) {
             else if (!std::filesystem::exists(file2)) {
                 armor::user_error() << "Missing header in newer version: " << file2 << "\n";
             } 
-            else if (filesAreDifferentUsingDiff(file1, file2)) {
+            else if (filesAreDifferent(file1, file2)) {
                 PARSING_STATUS parsingStatus = armor::alpha::processHeaderPairAlpha(projectRoot1, file1, projectRoot2, file2, reportFormat,
-                                IncludePaths, macros, langOption);
+                                IncludePaths, macros, langOption, dumpAstDiff);
                 switch (parsingStatus) {
                     case NO_FATAL_ERRORS:
                         armor::info() << "Processing Headers again via v2\n";
                         armor::beta::processHeaderPairBeta(projectRoot1, file1, projectRoot2, file2, reportFormat,
-                                    IncludePaths, macros, langOption);
+                                    IncludePaths, macros, langOption, dumpAstDiff);
                         break;
                     case FATAL_ERRORS:
                         armor::info() << "Processing Headers stopped at v1\n";
@@ -208,13 +208,6 @@ bool runArmorTool(int argc, const char **argv) {
             }
         }
     }
-    if (processed && !dumpAstDiff) {
-        try {
-            std::filesystem::remove_all("debug_output/ast_diffs");
-        } catch (const std::exception &e) {
-            armor::user_error() << "Failed to remove debug_output directory: " << e.what() << "\n";
-        }
-    }
     if (!processed && headers.empty() && headerSubDir.empty()) {
         const std::string argv0 = argv[0] ? std::string(argv[0]) : std::string("armor");
         armor::user_error() << "Usage: " << argv0 << " <projectroot1> <projectroot2> <header1> <header2> ...\n"
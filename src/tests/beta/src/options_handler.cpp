@@ -87,7 +87,7 @@ bool runArmorTool(int argc, const char **argv) {
         }
 
         armor::beta::processHeaderPairBeta(projectRoot1, file1, projectRoot2, file2,
-                              reportFormat, IncludePaths, macros, langOption);
+                              reportFormat, IncludePaths, macros, langOption, /*dumpAstDiff*/true);
         processed = true;
     }
 
@@ -0,0 +1,71 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include "fibonacci_hash.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Header-like text: identifiers, punctuation and indentation, with the
+// comment-heavy whitespace density CommentHandler typically hashes.
+std::string makeHeaderText(size_t length, unsigned seed) {
+    static const char* fragments[] = {
+        "    int ", "const char* ", "/* ", " */\n", "typedef struct ", "{\n", "};\n",
+        "\t", "uint64_t value", ", ", "(void)", ";\n", " * @param data ", "\n\n",
+    };
+    std::mt19937 rng(seed);
+    std::string text;
+    while (text.size() < length) {
+        text += fragments[rng() % (sizeof(fragments) / sizeof(fragments[0]))];
+    }
+    text.resize(length);
+    return text;
+}
+
+const char* kernelName(FibonacciHash::Kernel kernel) {
+    switch (kernel) {
+        case FibonacciHash::Kernel::Scalar: return "scalar";
+        case FibonacciHash::Kernel::SSE42:  return "sse4.2";
+        case FibonacciHash::Kernel::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+int main() {
+    const size_t sizes[] = {32, 256, 4096, 65536};
+    const FibonacciHash::Kernel kernels[] = {
+        FibonacciHash::Kernel::Scalar, FibonacciHash::Kernel::SSE42, FibonacciHash::Kernel::AVX2,
+    };
+    const size_t bytesPerRun = 64 * 1024 * 1024;
+
+    std::printf("active kernel: %s\n", kernelName(FibonacciHash::activeKernel()));
+    std::printf("%-8s %10s %12s %18s\n", "kernel", "size", "MB/s", "checksum");
+
+    for (size_t size : sizes) {
+        std::string text = makeHeaderText(size, static_cast<unsigned>(size));
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(text.data());
+        size_t iterations = bytesPerRun / size;
+
+        for (FibonacciHash::Kernel kernel : kernels) {
+            if (!FibonacciHash::isKernelSupported(kernel)) continue;
+
+            uint64_t checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                checksum += FibonacciHash::hashWithKernel(kernel, data, size);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            double megabytes = static_cast<double>(iterations * size) / (1024.0 * 1024.0);
+            std::printf("%-8s %10zu %12.1f %18llx\n", kernelName(kernel), size,
+                        megabytes / elapsed.count(), static_cast<unsigned long long>(checksum));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#pragma once
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+
+namespace armor::test {
+
+/**
+ * @class TempDir
+ * @brief A new directory under the system temp directory, removed with its contents on destruction.
+ *
+ * The name is prefix plus a unique suffix, so tests of binaries running in
+ * parallel never share a directory.
+ */
+class TempDir {
+public:
+    explicit TempDir(const std::string& prefix) {
+        llvm::SmallString<128> created;
+        if (std::error_code ec = llvm::sys::fs::createUniqueDirectory(prefix, created))
+            throw std::runtime_error("Cannot create temporary directory for " + prefix + ": " + ec.message());
+        dir = created.str().str();
+    }
+
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::filesystem::path& path() const { return dir; }
+
+private:
+    std::filesystem::path dir;
+};
+
+} // namespace armor::test
@@ -0,0 +1,268 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include "api_database.hpp"
+#include "temp_dir.hpp"
+
+class APIDatabaseTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dbPath = (dir / "armor_api.db").string();
+    }
+
+    static std::shared_ptr<armor::APINode> makeNode(NodeKind kind, const std::string& name,
+                                                    const std::string& type) {
+        auto node = std::make_shared<armor::APINode>();
+        node->kind = kind;
+        node->qualifiedName = name;
+        node->dataType = type;
+        node->caonicalType = type;
+        node->USR = "c:@" + name;
+        node->NSR = name;
+        return node;
+    }
+
+    static void addRoot(armor::ASTNormalizedContext& context, const std::shared_ptr<armor::APINode>& node) {
+        context.addRootNode(node);
+        context.addNode(node->NSR, node);
+        context.usrNodeMap[node->USR] = node;
+    }
+
+    // Functions f and g; g's type varies between releases.
+    static std::unique_ptr<armor::ASTNormalizedContext> makeContext(const std::string& gType) {
+        auto context = std::make_unique<armor::ASTNormalizedContext>();
+        auto f = makeNode(NodeKind::Function, "ns::f", "void (int)");
+        f->children = std::make_unique<llvm::SmallVector<std::shared_ptr<const armor::APINode>, 16>>();
+        f->children->push_back(makeNode(NodeKind::Parameter, "ns::f::x", "int"));
+        addRoot(*context, f);
+        addRoot(*context, makeNode(NodeKind::Function, "ns::g", gType));
+        context->getSourceRangeTracker().getCommentsHashMap()[7] = 1;
+        return context;
+    }
+
+    void addRelease(armor::APIDatabase& db, const std::string& release, const std::string& gType) {
+        std::string error;
+        ASSERT_TRUE(db.addRelease(release, error));
+        ASSERT_TRUE(db.addHeader("api.h", *makeContext(gType), error));
+    }
+
+    armor::test::TempDir tempDir{"armor_api_database_test"};
+    const std::filesystem::path dir = tempDir.path();
+    std::string dbPath;
+};
+
+TEST_F(APIDatabaseTest, UnchangedSymbolsAreStoredOnce) {
+    armor::APIDatabase db;
+    std::string error;
+    ASSERT_TRUE(db.open(dbPath, error));
+    addRelease(db, "v1", "int (void)");
+    size_t nodesAfterFirst = db.getNodeCount();
+    addRelease(db, "v2", "int (void)");
+    EXPECT_EQ(db.getNodeCount(), nodesAfterFirst);
+    addRelease(db, "v3", "long (void)");
+    EXPECT_EQ(db.getNodeCount(), nodesAfterFirst + 1);
+    ASSERT_TRUE(db.commit(error));
+
+    EXPECT_TRUE(db.sameAPI("v1", "v2", "api.h"));
+    EXPECT_FALSE(db.sameAPI("v2", "v3", "api.h"));
+}
+
+TEST_F(APIDatabaseTest, ReopenedDatabaseKeepsReleasesAndAppends) {
+    {
+        armor::APIDatabase db;
+        std::string error;
+        ASSERT_TRUE(db.open(dbPath, error));
+        addRelease(db, "v1", "int (void)");
+        ASSERT_TRUE(db.commit(error));
+    }
+    auto sizeAfterFirst = std::filesystem::file_size(dbPath);
+
+    armor::APIDatabase db;
+    std::string error;
+    ASSERT_TRUE(db.open(dbPath, error));
+    ASSERT_EQ(db.getReleases().size(), 1u);
+    EXPECT_FALSE(db.addRelease("v1", error));
+    addRelease(db, "v2", "long (void)");
+    ASSERT_TRUE(db.commit(error));
+    EXPECT_TRUE(std::filesystem::file_size(dbPath) > sizeAfterFirst);
+
+    armor::APIDatabase reopened;
+    ASSERT_TRUE(reopened.open(dbPath, error));
+    EXPECT_EQ(reopened.getReleases(), (std::vector<std::string>{"v1", "v2"}));
+    EXPECT_EQ(reopened.getHeaders("v2"), std::vector<std::string>{"api.h"});
+    EXPECT_EQ(reopened.getNodeCount(), db.getNodeCount());
+}
+
+TEST_F(APIDatabaseTest, LoadHeaderRebuildsContext) {
+    armor::APIDatabase db;
+    std::string error;
+    ASSERT_TRUE(db.open(dbPath, error));
+    addRelease(db, "v1", "int (void)");
+    ASSERT_TRUE(db.commit(error));
+
+    std::unique_ptr<armor::ASTNormalizedContext> context = db.loadHeader("v1", "api.h");
+    ASSERT_TRUE(context != nullptr);
+    ASSERT_EQ(context->getRootNodes().size(), 2u);
+    const armor::APINode& f = *context->getRootNodes()[0];
+    EXPECT_EQ(f.qualifiedName, "ns::f");
+    ASSERT_TRUE(f.children != nullptr);
+    EXPECT_EQ((*f.children)[0]->dataType, "int");
+    EXPECT_EQ(context->usrNodeMap.lookup("c:@ns::g")->dataType, "int (void)");
+    EXPECT_EQ(context->getSourceRangeTracker().getCommentsHashMap().lookup(7), 1);
+    EXPECT_TRUE(db.loadHeader("v1", "other.h") == nullptr);
+    EXPECT_TRUE(db.loadHeader("v9", "api.h") == nullptr);
+}
+
+TEST_F(APIDatabaseTest, HistoryFlagsReleasesWhereSymbolChanged) {
+    armor::APIDatabase db;
+    std::string error;
+    ASSERT_TRUE(db.open(dbPath, error));
+    addRelease(db, "v1", "int (void)");
+    addRelease(db, "v2", "int (void)");
+    addRelease(db, "v3", "long (void)");
+    ASSERT_TRUE(db.commit(error));
+
+    std::vector<armor::APIDatabase::SymbolVersion> byName = db.history("ns::g");
+    ASSERT_EQ(byName.size(), 3u);
+    EXPECT_FALSE(byName[0].changed);
+    EXPECT_FALSE(byName[1].changed);
+    EXPECT_TRUE(byName[2].changed);
+    EXPECT_EQ(byName[2].release, "v3");
+    EXPECT_EQ(byName[2].dataType, "long (void)");
+
+    EXPECT_EQ(db.history("c:@ns::g").size(), 3u);
+    EXPECT_TRUE(db.history("ns::missing").empty());
+}
+
+TEST_F(APIDatabaseTest, HistoryIgnoresMemberAndBodyChanges) {
+    // Struct s gains a field in v2; h's body changes in v2 and its parameter type in v3.
+    auto makeHeader = [](int release) {
+        auto context = std::make_unique<armor::ASTNormalizedContext>();
+        auto s = makeNode(NodeKind::Struct, "ns::s", "ns::s");
+        s->children = std::make_unique<llvm::SmallVector<std::shared_ptr<const armor::APINode>, 16>>();
+        s->children->push_back(makeNode(NodeKind::Field, "ns::s::a", "int"));
+        if (release >= 2) s->children->push_back(makeNode(NodeKind::Field, "ns::s::b", "int"));
+        addRoot(*context, s);
+        auto h = makeNode(NodeKind::Function, "ns::h", "void (int)");
+        h->stmtHashes.push_back(release >= 2 ? 2 : 1);
+        h->children = std::make_unique<llvm::SmallVector<std::shared_ptr<const armor::APINode>, 16>>();
+        h->children->push_back(makeNode(NodeKind::Parameter, "ns::h::x", release >= 3 ? "long" : "int"));
+        addRoot(*context, h);
+        return context;
+    };
+
+    {
+        armor::APIDatabase db;
+        std::string error;
+        ASSERT_TRUE(db.open(dbPath, error));
+        for (int release = 1; release <= 3; ++release) {
+            ASSERT_TRUE(db.addRelease("v" + std::to_string(release), error));
+            ASSERT_TRUE(db.addHeader("api.h", *makeHeader(release), error));
+        }
+        ASSERT_TRUE(db.commit(error));
+    }
+
+    // The index is read back from the file on open.
+    armor::APIDatabase db;
+    std::string error;
+    ASSERT_TRUE(db.open(dbPath, error));
+    std::vector<armor::APIDatabase::SymbolVersion> s = db.history("ns::s");
+    ASSERT_EQ(s.size(), 3u);
+    EXPECT_FALSE(s[1].changed);
+    EXPECT_FALSE(s[2].changed);
+
+    std::vector<armor::APIDatabase::SymbolVersion> h = db.history("ns::h");
+    ASSERT_EQ(h.size(), 3u);
+    EXPECT_FALSE(h[1].changed);
+    EXPECT_TRUE(h[2].changed);
+    EXPECT_EQ(h[2].release, "v3");
+}
+
+TEST_F(APIDatabaseTest, RejectsForeignFiles) {
+    std::ofstream(dir / "bogus.db") << "not a database";
+    armor::APIDatabase db;
+    std::string error;
+    EXPECT_FALSE(db.open((dir / "bogus.db").string(), error));
+    EXPECT_FALSE(error.empty());
+}
+
+TEST_F(APIDatabaseTest, TornCommitIsCutOffOnOpen) {
+    std::string error;
+    {
+        armor::APIDatabase db;
+        ASSERT_TRUE(db.open(dbPath, error));
+        addRelease(db, "v1", "int (void)");
+        ASSERT_TRUE(db.commit(error));
+    }
+    auto sizeAfterFirst = std::filesystem::file_size(dbPath);
+    {
+        armor::APIDatabase db;
+        ASSERT_TRUE(db.open(dbPath, error));
+        addRelease(db, "v2", "long (void)");
+        ASSERT_TRUE(db.commit(error));
+    }
+    std::filesystem::resize_file(dbPath, std::filesystem::file_size(dbPath) - 12);
+
+    armor::APIDatabase db;
+    ASSERT_TRUE(db.open(dbPath, error)) << error;
+    EXPECT_EQ(db.getReleases(), std::vector<std::string>{"v1"});
+    EXPECT_EQ(std::filesystem::file_size(dbPath), sizeAfterFirst);
+    addRelease(db, "v2", "long (void)");
+    ASSERT_TRUE(db.commit(error));
+    EXPECT_EQ(db.getReleases(), (std::vector<std::string>{"v1", "v2"}));
+    EXPECT_EQ(db.history("ns::g").size(), 2u);
+}
+
+TEST_F(APIDatabaseTest, IndexBlocksAreMergedAcrossCommits) {
+    std::string error;
+    for (int release = 1; release <= 16; ++release) {
+        armor::APIDatabase db;
+        ASSERT_TRUE(db.open(dbPath, error)) << error;
+        addRelease(db, "v" + std::to_string(release), release % 4 ? "int (void)" : "long (void)");
+        ASSERT_TRUE(db.commit(error));
+    }
+
+    armor::APIDatabase db;
+    ASSERT_TRUE(db.open(dbPath, error));
+    EXPECT_LE(db.getIndexLevelCount(), 5u);
+    EXPECT_EQ(db.getReleases().size(), 16u);
+    std::vector<armor::APIDatabase::SymbolVersion> g = db.history("ns::g");
+    ASSERT_EQ(g.size(), 16u);
+    for (int release = 1; release <= 16; ++release) {
+        EXPECT_EQ(g[release - 1].release, "v" + std::to_string(release));
+        EXPECT_EQ(g[release - 1].changed, release > 1 && release % 4 <= 1);
+    }
+    EXPECT_TRUE(db.sameAPI("v1", "v2", "api.h"));
+    EXPECT_FALSE(db.sameAPI("v3", "v4", "api.h"));
+    // Nodes are still shared with every earlier commit: two types of g, f and its parameter.
+    EXPECT_EQ(db.getNodeCount(), 4u);
+}
+
+TEST_F(APIDatabaseTest, ConcurrentWritersAppendInTurn) {
+    auto write = [this](const std::string& release) {
+        armor::APIDatabase db;
+        std::string error;
+        return db.open(dbPath, error) && db.addRelease(release, error) &&
+               db.addHeader("api.h", *makeContext("int (void)"), error) && db.commit(error);
+    };
+    bool first = false, second = false;
+    std::thread other([&] { second = write("v2"); });
+    first = write("v1");
+    other.join();
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+
+    armor::APIDatabase db;
+    std::string error;
+    ASSERT_TRUE(db.open(dbPath, error)) << error;
+    std::vector<std::string> releases = db.getReleases();
+    std::sort(releases.begin(), releases.end());
+    EXPECT_EQ(releases, (std::vector<std::string>{"v1", "v2"}));
+    EXPECT_TRUE(db.sameAPI("v1", "v2", "api.h"));
+    EXPECT_TRUE(db.loadHeader("v2", "api.h") != nullptr);
+}
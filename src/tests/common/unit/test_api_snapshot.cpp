@@ -0,0 +1,166 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "api_snapshot.hpp"
+#include "temp_dir.hpp"
+
+class APISnapshotTest : public ::testing::Test {
+protected:
+    static std::shared_ptr<armor::APINode> makeNode(NodeKind kind, const std::string& name,
+                                                    const std::string& type) {
+        auto node = std::make_shared<armor::APINode>();
+        node->kind = kind;
+        node->qualifiedName = name;
+        node->dataType = type;
+        node->caonicalType = type;
+        node->USR = "c:@" + name;
+        node->NSR = name;
+        return node;
+    }
+
+    // A struct with two fields and a function sharing one of them, as cached nodes are shared.
+    static void fillContext(armor::ASTNormalizedContext& context) {
+        auto record = makeNode(NodeKind::Struct, "S", "struct S");
+        auto field = makeNode(NodeKind::Field, "S::a", "int");
+        field->access = AccessSpec::Public;
+        field->isConst = true;
+        auto other = makeNode(NodeKind::Field, "S::b", "char *");
+        record->children = std::make_unique<llvm::SmallVector<std::shared_ptr<const armor::APINode>, 16>>();
+        record->children->push_back(field);
+        record->children->push_back(other);
+
+        auto function = makeNode(NodeKind::Function, "f", "void (int)");
+        function->isInlined = true;
+        function->stmtHashes.push_back(0x1234);
+        function->stmtHashes.push_back(0xfeedbeef);
+        function->children = std::make_unique<llvm::SmallVector<std::shared_ptr<const armor::APINode>, 16>>();
+        function->children->push_back(field);
+
+        for (const std::shared_ptr<armor::APINode>& node : {record, function}) {
+            context.addRootNode(node);
+            context.addNode(node->NSR, node);
+        }
+        context.usrNodeMap[record->USR] = record;
+        context.usrNodeMap[function->USR] = function;
+        context.unSupportedUsrNodeMap.insert("c:@unsupported");
+
+        armor::SourceRangeTracker& tracker = context.getSourceRangeTracker();
+        tracker.getCommentsHashMap()[11] = 2;
+        tracker.addUnhandledDeclHash(22);
+        tracker.getInactiveUnhandledDeclsHashMap()[33] = 1;
+    }
+
+    std::string path(const std::string& name) const {
+        return (dir / name).string();
+    }
+
+    armor::test::TempDir tempDir{"armor_api_snapshot_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(APISnapshotTest, RoundTripsNodesAndHashMaps) {
+    armor::ASTNormalizedContext context;
+    fillContext(context);
+    ASSERT_TRUE(armor::APISnapshot::write(context, "include/s.h", path("s.armorsnap")));
+
+    std::string header, error;
+    std::unique_ptr<armor::ASTNormalizedContext> loaded =
+        armor::APISnapshot::load(path("s.armorsnap"), header, error);
+    ASSERT_TRUE(loaded != nullptr);
+    EXPECT_EQ(header, "include/s.h");
+    ASSERT_EQ(loaded->getRootNodes().size(), 2u);
+    EXPECT_EQ(loaded->getTree().size(), 2u);
+
+    const armor::APINode& record = *loaded->getRootNodes()[0];
+    EXPECT_EQ(record.kind, NodeKind::Struct);
+    EXPECT_EQ(record.qualifiedName, "S");
+    ASSERT_TRUE(record.children != nullptr);
+    ASSERT_EQ(record.children->size(), 2u);
+    EXPECT_EQ((*record.children)[0]->access, AccessSpec::Public);
+    EXPECT_TRUE((*record.children)[0]->isConst);
+    EXPECT_EQ((*record.children)[1]->dataType, "char *");
+
+    const armor::APINode& function = *loaded->getRootNodes()[1];
+    EXPECT_TRUE(function.isInlined);
+    ASSERT_EQ(function.stmtHashes.size(), 2u);
+    EXPECT_EQ(function.stmtHashes[1], 0xfeedbeefu);
+
+    EXPECT_EQ(loaded->usrNodeMap.size(), 2u);
+    EXPECT_TRUE(loaded->unSupportedUsrNodeMap.count("c:@unsupported"));
+    const armor::SourceRangeTracker& tracker = loaded->getSourceRangeTracker();
+    EXPECT_EQ(tracker.getCommentsHashMap().lookup(11), 2);
+    EXPECT_EQ(tracker.getUnhandledDeclsHashMap().lookup(22), 1);
+    EXPECT_EQ(tracker.getInactiveUnhandledDeclsHashMap().lookup(33), 1);
+}
+
+TEST_F(APISnapshotTest, SharedNodesStaySharedAfterLoad) {
+    armor::ASTNormalizedContext context;
+    fillContext(context);
+    ASSERT_TRUE(armor::APISnapshot::write(context, "s.h", path("s.armorsnap")));
+
+    std::string header, error;
+    auto loaded = armor::APISnapshot::load(path("s.armorsnap"), header, error);
+    ASSERT_TRUE(loaded != nullptr);
+    EXPECT_EQ((*loaded->getRootNodes()[0]->children)[0], (*loaded->getRootNodes()[1]->children)[0]);
+    EXPECT_EQ(loaded->usrNodeMap.lookup("c:@S").get(), loaded->getRootNodes()[0].get());
+}
+
+TEST_F(APISnapshotTest, EmptyChildVectorIsPreserved) {
+    armor::ASTNormalizedContext context;
+    auto node = makeNode(NodeKind::Struct, "E", "struct E");
+    node->children = std::make_unique<llvm::SmallVector<std::shared_ptr<const armor::APINode>, 16>>();
+    context.addRootNode(node);
+    context.addNode(node->NSR, node);
+    auto leaf = makeNode(NodeKind::Variable, "v", "int");
+    context.addRootNode(leaf);
+    context.addNode(leaf->NSR, leaf);
+    ASSERT_TRUE(armor::APISnapshot::write(context, "e.h", path("e.armorsnap")));
+
+    std::string header, error;
+    auto loaded = armor::APISnapshot::load(path("e.armorsnap"), header, error);
+    ASSERT_TRUE(loaded != nullptr);
+    ASSERT_TRUE(loaded->getRootNodes()[0]->children != nullptr);
+    EXPECT_TRUE(loaded->getRootNodes()[0]->children->empty());
+    EXPECT_TRUE(loaded->getRootNodes()[1]->children == nullptr);
+}
+
+TEST_F(APISnapshotTest, RejectsFilesThatAreNotSnapshots) {
+    std::ofstream(path("bogus.armorsnap")) << "#pragma once\nint f();\n";
+
+    std::string header, error;
+    EXPECT_TRUE(armor::APISnapshot::load(path("bogus.armorsnap"), header, error) == nullptr);
+    EXPECT_FALSE(error.empty());
+    error.clear();
+    EXPECT_TRUE(armor::APISnapshot::load(path("missing.armorsnap"), header, error) == nullptr);
+    EXPECT_FALSE(error.empty());
+}
+
+TEST_F(APISnapshotTest, RejectsTruncatedAndCorruptedFiles) {
+    armor::ASTNormalizedContext context;
+    fillContext(context);
+    ASSERT_TRUE(armor::APISnapshot::write(context, "s.h", path("s.armorsnap")));
+    std::filesystem::path file = dir / "s.armorsnap";
+    auto size = std::filesystem::file_size(file);
+
+    std::filesystem::copy_file(file, dir / "cut.armorsnap");
+    std::filesystem::resize_file(dir / "cut.armorsnap", size - 8);
+    std::string header, error;
+    EXPECT_TRUE(armor::APISnapshot::load(path("cut.armorsnap"), header, error) == nullptr);
+
+    // Point the first node's name far past the string pool.
+    std::filesystem::copy_file(file, dir / "bad.armorsnap");
+    std::fstream bad(dir / "bad.armorsnap", std::ios::in | std::ios::out | std::ios::binary);
+    uint64_t nodesOffset = 0;
+    bad.seekg(8 + 4 + 4 + 8 + 8 + 16);   // magic, version, byte order, size, header name, string section
+    bad.read(reinterpret_cast<char*>(&nodesOffset), sizeof(nodesOffset));
+    uint32_t farAway = 0x7fffffff;
+    bad.seekp(static_cast<std::streamoff>(nodesOffset));
+    bad.write(reinterpret_cast<const char*>(&farAway), sizeof(farAway));
+    bad.close();
+    error.clear();
+    EXPECT_TRUE(armor::APISnapshot::load(path("bad.armorsnap"), header, error) == nullptr);
+    EXPECT_FALSE(error.empty());
+}
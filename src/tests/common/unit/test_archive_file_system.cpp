@@ -0,0 +1,167 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <zlib.h>
+#include "archive_file_system.hpp"
+#include "llvm/Support/Path.h"
+#include "temp_dir.hpp"
+
+class ArchiveFileSystemTest : public ::testing::Test {
+protected:
+    // One ustar member; type '5' is a directory, '2' a symbolic link to contents.
+    static void addMember(std::string& tar, const std::string& name, const std::string& contents, char type = '0') {
+        char header[512] = {};
+        std::strncpy(header, name.c_str(), 99);
+        std::snprintf(header + 100, 8, "%07o", 0644);
+        std::snprintf(header + 124, 12, "%011o", type == '0' ? static_cast<unsigned>(contents.size()) : 0u);
+        header[156] = type;
+        if (type == '2') std::strncpy(header + 157, contents.c_str(), 99);
+        std::memcpy(header + 257, "ustar", 6);
+        std::memset(header + 148, ' ', 8);
+        unsigned checksum = 0;
+        for (unsigned char c : header) checksum += c;
+        std::snprintf(header + 148, 8, "%06o", checksum);
+        tar.append(header, 512);
+        if (type != '0') return;
+        tar += contents;
+        tar.append((512 - contents.size() % 512) % 512, '\0');
+    }
+
+    std::string writeTar(std::string tar, const std::string& name) {
+        tar.append(1024, '\0');
+        std::string path = (dir / name).string();
+        std::ofstream(path, std::ios::binary) << tar;
+        return path;
+    }
+
+    std::string writeTarGz(std::string tar, const std::string& name) {
+        tar.append(1024, '\0');
+        std::string path = (dir / name).string();
+        gzFile file = gzopen(path.c_str(), "wb");
+        gzwrite(file, tar.data(), static_cast<unsigned>(tar.size()));
+        gzclose(file);
+        return path;
+    }
+
+    static std::string readMember(const armor::TarArchive& archive, const std::string& name) {
+        const armor::TarArchive::Member* member = archive.find(name);
+        if (!member) return "<missing>";
+        std::unique_ptr<llvm::MemoryBuffer> buffer = archive.read(*member, name);
+        return buffer ? buffer->getBuffer().str() : "<unreadable>";
+    }
+
+    armor::test::TempDir tempDir{"armor_archive_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(ArchiveFileSystemTest, IndexesTarAndStripsSingleTopDirectory) {
+    std::string tar;
+    addMember(tar, "sdk-1.0/", "", '5');
+    addMember(tar, "sdk-1.0/include/api.h", "int api(void);\n");
+    addMember(tar, "sdk-1.0/include/detail/impl.h", "#define IMPL 1\n");
+    addMember(tar, "sdk-1.0/include/alias.h", "detail/impl.h", '2');
+    std::string error;
+    std::shared_ptr<armor::TarArchive> archive = armor::TarArchive::open(writeTar(tar, "sdk.tar"), error);
+    ASSERT_TRUE(archive) << error;
+
+    EXPECT_EQ(readMember(*archive, "include/api.h"), "int api(void);\n");
+    EXPECT_EQ(readMember(*archive, "include/alias.h"), "#define IMPL 1\n");
+    EXPECT_EQ(readMember(*archive, "./include/detail/../api.h"), "int api(void);\n");
+    EXPECT_EQ(archive->find("sdk-1.0/include/api.h"), nullptr);
+    EXPECT_EQ(archive->find("../outside.h"), nullptr);
+    // include/detail has no entry of its own.
+    ASSERT_TRUE(archive->find("include/detail"));
+    EXPECT_TRUE(archive->find("include/detail")->directory);
+    EXPECT_EQ(archive->list("include"), (std::vector<std::string>{"alias.h", "api.h", "detail"}));
+}
+
+TEST_F(ArchiveFileSystemTest, GzipMembersAreReadFromNearestAccessPoint) {
+    std::string tar;
+    std::vector<std::string> contents;
+    for (int i = 0; i < 40; ++i) {
+        // Varied enough that each member compresses to several kilobytes.
+        std::string text;
+        uint32_t state = 2654435761u * (i + 1);
+        for (int j = 0; j < 20000; ++j) {
+            state = state * 1103515245u + 12345u;
+            text += static_cast<char>('a' + (state >> 16) % 26);
+        }
+        contents.push_back(text);
+        addMember(tar, "h" + std::to_string(i) + ".h", text);
+    }
+    addMember(tar, "empty.h", "");
+    std::string error;
+    std::shared_ptr<armor::TarArchive> archive =
+        armor::TarArchive::open(writeTarGz(tar, "headers.tar.gz"), error, /*accessPointSpan=*/64 * 1024);
+    ASSERT_TRUE(archive) << error;
+    EXPECT_GT(archive->getAccessPointCount(), 4u);
+
+    // Out of order, so each read starts from a different access point.
+    for (int i : {39, 0, 17, 38, 1, 25})
+        EXPECT_EQ(readMember(*archive, "h" + std::to_string(i) + ".h"), contents[i]) << i;
+    EXPECT_EQ(readMember(*archive, "empty.h"), "");
+}
+
+TEST_F(ArchiveFileSystemTest, RejectsCorruptArchives) {
+    std::string tar;
+    addMember(tar, "api.h", "int api(void);\n");
+    tar[0] = 'b';   // breaks the header checksum
+    std::string error;
+    EXPECT_FALSE(armor::TarArchive::open(writeTar(tar, "bad.tar"), error));
+    EXPECT_NE(error.find("bad tar header"), std::string::npos);
+
+    std::string truncated;
+    addMember(truncated, "api.h", std::string(2000, 'x'));
+    std::string path = writeTar(truncated, "short.tar");
+    std::filesystem::resize_file(path, 1024);
+    EXPECT_FALSE(armor::TarArchive::open(path, error));
+    EXPECT_NE(error.find("truncated"), std::string::npos);
+}
+
+TEST_F(ArchiveFileSystemTest, MountedArchiveIsVisibleThroughFileSystems) {
+    std::string tar;
+    addMember(tar, "include/api.h", "#include \"types.h\"\n");
+    addMember(tar, "include/types.h", "typedef int T;\n");
+    addMember(tar, "README", "docs\n");
+    std::string error;
+    std::string root = armor::mountArchive(writeTarGz(tar, "project.tgz"), error);
+    ASSERT_FALSE(root.empty()) << error;
+    EXPECT_TRUE(std::filesystem::is_directory(root));
+
+    llvm::vfs::FileSystem& shared = armor::getFileSystem();
+    llvm::ErrorOr<llvm::vfs::Status> status = shared.status(root + "/include/types.h");
+    ASSERT_TRUE(status);
+    EXPECT_TRUE(status->isRegularFile());
+    EXPECT_EQ(status->getSize(), 15u);
+    EXPECT_NE(status->getUniqueID(), shared.status(root + "/include/api.h")->getUniqueID());
+    EXPECT_FALSE(shared.exists(root + "/include/missing.h"));
+    // Real files are still found through the overlay.
+    EXPECT_TRUE(shared.exists(dir.string() + "/project.tgz"));
+
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> tool = armor::createFileSystem();
+    // ClangTool moves into the project root before parsing.
+    ASSERT_FALSE(tool->setCurrentWorkingDirectory(root));
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer = tool->getBufferForFile("include/types.h");
+    ASSERT_TRUE(buffer);
+    EXPECT_EQ((*buffer)->getBuffer(), "typedef int T;\n");
+
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (llvm::vfs::directory_iterator it = tool->dir_begin(root, ec), end; it != end && !ec; it.increment(ec))
+        names.push_back(llvm::sys::path::filename(it->path()).str());
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(names, (std::vector<std::string>{"README", "include"}));
+
+    // Directories inside the archive have no real counterpart.
+    names.clear();
+    for (llvm::vfs::directory_iterator it = shared.dir_begin(root + "/include", ec), end; it != end && !ec;
+         it.increment(ec))
+        names.push_back(llvm::sys::path::filename(it->path()).str());
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(names, (std::vector<std::string>{"api.h", "types.h"}));
+}
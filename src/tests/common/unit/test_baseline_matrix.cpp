@@ -0,0 +1,93 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <nlohmann/json.hpp>
+#include "baseline_matrix.hpp"
+#include "temp_dir.hpp"
+
+class BaselineMatrixTest : public ::testing::Test {
+protected:
+    static HeaderReportSummary makeSummary(bool compatible) {
+        HeaderReportSummary summary;
+        summary.compatibility = compatible ? "backward_compatible" : "backward_incompatible";
+        summary.overallStatus = compatible ? "BACKWARD_COMPATIBLE" : "BACKWARD_INCOMPATIBLE";
+        if (!compatible) {
+            summary.incompatibleChanges.push_back("ns::f removed");
+            summary.changes.push_back({});
+        }
+        return summary;
+    }
+
+    static std::string readFile(const std::filesystem::path& path) {
+        std::ifstream in(path);
+        std::stringstream text;
+        text << in.rdbuf();
+        return text.str();
+    }
+
+    armor::test::TempDir tempDir{"armor_baseline_matrix_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(BaselineMatrixTest, VerdictIsPerBaseline) {
+    armor::BaselineMatrix matrix({"v1", "v2"});
+    matrix.addResult("a.h", 0, makeSummary(false), "a.h_vs_v1");
+    matrix.addResult("a.h", 1, makeSummary(true), "a.h_vs_v2");
+    matrix.addResult("b.h", 1, makeSummary(true), "b.h_vs_v2");
+
+    EXPECT_FALSE(matrix.isBackwardCompatible(0));
+    EXPECT_TRUE(matrix.isBackwardCompatible(1));
+    EXPECT_FALSE(matrix.isBackwardCompatible());
+}
+
+TEST_F(BaselineMatrixTest, FailedComparisonIsAnErrorNotAPass) {
+    armor::BaselineMatrix matrix({"v1", "v2"});
+    matrix.addResult("a.h", 0, makeSummary(true), "a.h_vs_v1");
+    matrix.addFailure("a.h", 1, "Failed to load snapshot: truncated");
+    EXPECT_TRUE(matrix.isBackwardCompatible(0));
+    EXPECT_FALSE(matrix.isBackwardCompatible(1));
+    EXPECT_FALSE(matrix.isBackwardCompatible());
+
+    std::string table;
+    llvm::raw_string_ostream tableStream(table);
+    matrix.print(tableStream);
+    EXPECT_NE(tableStream.str().find("ERROR"), std::string::npos);
+
+    std::string path = (dir / "armor_baselines.json").string();
+    ASSERT_TRUE(matrix.writeJson(path));
+    nlohmann::json root = nlohmann::json::parse(readFile(path));
+    EXPECT_EQ(root["headers"][0]["results"]["v2"]["overall_status"], "ERROR");
+    EXPECT_FALSE(root["headers"][0]["results"]["v2"].contains("report"));
+}
+
+TEST_F(BaselineMatrixTest, JsonHasOneResultPerComparedBaseline) {
+    armor::BaselineMatrix matrix({"v1", "v2"});
+    matrix.addResult("a.h", 0, makeSummary(false), "a.h_vs_v1");
+    matrix.addResult("a.h", 1, makeSummary(true), "a.h_vs_v2");
+    matrix.addResult("b.h", 1, makeSummary(true), "b.h_vs_v2");
+    std::string path = (dir / "armor_baselines.json").string();
+    ASSERT_TRUE(matrix.writeJson(path));
+
+    nlohmann::json root = nlohmann::json::parse(readFile(path));
+    EXPECT_EQ(root["compatibility"], "backward_incompatible");
+    EXPECT_EQ(root["baselines"][1]["compatibility"], "backward_compatible");
+    ASSERT_EQ(root["headers"].size(), 2u);
+    EXPECT_EQ(root["headers"][0]["results"]["v1"]["incompatible_changes"], 1);
+    EXPECT_EQ(root["headers"][0]["results"]["v2"]["report"], "a.h_vs_v2");
+    EXPECT_FALSE(root["headers"][1]["results"].contains("v1"));
+}
+
+TEST_F(BaselineMatrixTest, HtmlLinksEachCellAndEscapesNames) {
+    armor::BaselineMatrix matrix({"<lts>"});
+    matrix.addResult("a.h", 0, makeSummary(true), "a.h_vs_lts");
+    std::string path = (dir / "armor_baselines.html").string();
+    ASSERT_TRUE(matrix.writeHtml(path));
+
+    std::string html = readFile(path);
+    EXPECT_NE(html.find("&lt;lts&gt;"), std::string::npos);
+    EXPECT_EQ(html.find("<lts>"), std::string::npos);
+    EXPECT_NE(html.find("html_reports/api_diff_report_a.h_vs_lts.html"), std::string::npos);
+}
@@ -0,0 +1,84 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <nlohmann/json.hpp>
+#include "configuration_report.hpp"
+#include "temp_dir.hpp"
+
+class ConfigurationReportTest : public ::testing::Test {
+protected:
+    std::string writeFile(const std::string& name, const std::string& text) {
+        std::filesystem::path path = dir / name;
+        std::ofstream(path) << text;
+        return path.string();
+    }
+
+    static HeaderReportSummary makeSummary(const std::vector<std::string>& removed) {
+        HeaderReportSummary summary;
+        summary.compatibility = removed.empty() ? "backward_compatible" : "backward_incompatible";
+        for (const std::string& name : removed) {
+            ApiChangeGroup group;
+            group.name = name;
+            group.description = "Removed";
+            group.compatibilityChanged = true;
+            group.backwardIncompatible = true;
+            summary.changes.push_back(group);
+        }
+        return summary;
+    }
+
+    armor::test::TempDir tempDir{"armor_configuration_report_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(ConfigurationReportTest, LoadsNamedConfigurations) {
+    std::string path = writeFile("matrix.json", R"({"configurations": [
+        {"name": "c_debug", "lang": "C", "macro_flags": "-DDEBUG"},
+        {"name": "cpp_release", "macro_flags": "-DNDEBUG"}]})");
+    std::vector<armor::Configuration> configurations;
+    std::string error;
+    ASSERT_TRUE(armor::loadConfigurations(path, configurations, error));
+    ASSERT_EQ(configurations.size(), 2u);
+    EXPECT_EQ(configurations[0].lang, "c");
+    EXPECT_EQ(configurations[0].macroFlags, "-DDEBUG");
+    EXPECT_EQ(configurations[1].lang, "cpp");
+}
+
+TEST_F(ConfigurationReportTest, RejectsDuplicateNamesAndUnknownLanguages) {
+    std::vector<armor::Configuration> configurations;
+    std::string error;
+    EXPECT_FALSE(armor::loadConfigurations(writeFile("dup.json", R"([{"name": "a"}, {"name": "a"}])"),
+                                           configurations, error));
+    EXPECT_FALSE(error.empty());
+    configurations.clear();
+    error.clear();
+    EXPECT_FALSE(armor::loadConfigurations(writeFile("lang.json", R"([{"name": "a", "lang": "rust"}])"),
+                                           configurations, error));
+    EXPECT_FALSE(error.empty());
+}
+
+TEST_F(ConfigurationReportTest, MergesChangesAcrossConfigurations) {
+    armor::ConfigurationReport report({"debug", "release", "c"});
+    report.addResult("api.h", 0, makeSummary({"f", "g"}), "api.h_debug");
+    report.addResult("api.h", 1, makeSummary({"f"}), "api.h_release");
+    report.addResult("api.h", 2, makeSummary({}), "api.h_c");
+
+    std::vector<armor::ConfigurationReport::MergedChange> changes = report.getChanges("api.h");
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].name, "f");
+    EXPECT_EQ(changes[0].configurations, (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(changes[1].configurations, std::vector<size_t>{0});
+    EXPECT_FALSE(report.isBackwardCompatible(1));
+    EXPECT_TRUE(report.isBackwardCompatible(2));
+
+    std::string path = (dir / "out.json").string();
+    ASSERT_TRUE(report.writeJson(path));
+    std::ifstream in(path);
+    nlohmann::json root = nlohmann::json::parse(in);
+    EXPECT_EQ(root["headers"][0]["changes"][0]["configurations"],
+              (std::vector<std::string>{"debug", "release"}));
+    EXPECT_EQ(root["headers"][0]["results"]["c"]["report"], "api.h_c");
+}
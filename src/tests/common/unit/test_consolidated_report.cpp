@@ -0,0 +1,75 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <nlohmann/json.hpp>
+#include "consolidated_report.hpp"
+#include "temp_dir.hpp"
+
+class ConsolidatedReportTest : public ::testing::Test {
+protected:
+    // The JSON embedded between the data <script> tags.
+    nlohmann::json readEmbeddedData(const std::filesystem::path& path) {
+        std::ifstream in(path);
+        std::stringstream content;
+        content << in.rdbuf();
+        const std::string page = content.str();
+
+        const std::string open = "id=\"armor-data\">";
+        size_t begin = page.find(open) + open.size();
+        size_t end = page.find("</script>", begin);
+        return nlohmann::json::parse(page.substr(begin, end - begin));
+    }
+
+    armor::test::TempDir tempDir{"armor_consolidated_report_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(ConsolidatedReportTest, Write_EmbedsHeadersAndChanges) {
+    armor::ConsolidatedReport report;
+    EXPECT_TRUE(report.empty());
+
+    HeaderReportSummary first;
+    first.overallStatus = "BACKWARD_INCOMPATIBLE";
+    first.reason = "API changed";
+    first.changes.push_back({"a.h", "foo:Function", "Parameter added", true, true});
+    first.changes.push_back({"a.h", "bar:Function", "Function added", false, false});
+    report.addHeader("a.h", first);
+
+    HeaderReportSummary second;
+    second.overallStatus = "BACKWARD_COMPATIBLE";
+    second.reason = "Missing header in older version";
+    report.addHeader("b.h", second);
+
+    std::filesystem::path path = dir / "report.html";
+    ASSERT_TRUE(report.write(path.string()));
+
+    nlohmann::json data = readEmbeddedData(path);
+    ASSERT_EQ(2u, data["headers"].size());
+    EXPECT_EQ("a.h", data["headers"][0][0]);
+    EXPECT_EQ(2, data["headers"][0][3]);
+    EXPECT_EQ(1, data["headers"][0][4]);
+    EXPECT_EQ(0, data["headers"][1][3]);
+
+    ASSERT_EQ(2u, data["changes"].size());
+    EXPECT_EQ(0, data["changes"][0][0]);
+    EXPECT_EQ("foo:Function", data["changes"][0][1]);
+    EXPECT_EQ(1, data["changes"][0][4]);
+    EXPECT_EQ(0, data["changes"][1][3]);
+}
+
+TEST_F(ConsolidatedReportTest, Write_EscapesScriptTerminator) {
+    armor::ConsolidatedReport report;
+    HeaderReportSummary summary;
+    summary.overallStatus = "BACKWARD_INCOMPATIBLE";
+    summary.changes.push_back({"a.h", "f", "Default argument </script><b>x</b>", true, true});
+    report.addHeader("a.h", summary);
+
+    std::filesystem::path path = dir / "report.html";
+    ASSERT_TRUE(report.write(path.string()));
+
+    nlohmann::json data = readEmbeddedData(path);
+    EXPECT_EQ("Default argument </script><b>x</b>", data["changes"][0][2]);
+}
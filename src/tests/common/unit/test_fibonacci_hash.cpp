@@ -0,0 +1,114 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include "fibonacci_hash.hpp"
+#include "source_token_table.hpp"
+#include "clang/Basic/SourceManager.h"
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+
+const char* kHeader =
+    "// leading comment\n"
+    "#ifndef MYLIB_H\n"
+    "#define MYLIB_H\n"
+    "#include <stddef.h>\n"
+    "\n"
+    "/* block */ typedef struct Point { int x; /* inner */ int y; } Point;\n"
+    "#if 0\n"
+    "int disabled(void);\n"
+    "#endif\n"
+    "#define MAX(a, b) ((a) > (b) ? (a) : (b)) \\\n"
+    "    /* continued */\n"
+    "static const char* kName = \"armor // not a comment\";\n"
+    "int   add ( int a,\n"
+    "           int b ) ;   // trailing\n"
+    "#endif\n";
+
+} // namespace
+
+class FibonacciHashTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        file = std::make_unique<clang::SourceManagerForFile>("mylib.h", kHeader);
+        table.build(file->get());
+    }
+    void TearDown() override {}
+
+    clang::SourceManager* SM() { return &file->get(); }
+
+    std::unique_ptr<clang::SourceManagerForFile> file;
+    armor::SourceTokenTable table;
+};
+
+TEST_F(FibonacciHashTest, TokenTable_CoversMainFile) {
+    EXPECT_FALSE(table.empty());
+    EXPECT_TRUE(table.covers(*SM()));
+}
+
+TEST_F(FibonacciHashTest, TokenTable_MatchesRelexForAllRanges) {
+    unsigned size = static_cast<unsigned>(std::string(kHeader).size());
+    for (unsigned start = 0; start < size; ++start) {
+        for (unsigned end = start + 1; end <= size; ++end) {
+            EXPECT_EQ(FibonacciHash::hashFromOffsets(SM(), start, end),
+                      FibonacciHash::hashFromOffsets(SM(), start, end, &table))
+                << "range [" << start << ", " << end << ")";
+        }
+    }
+}
+
+TEST_F(FibonacciHashTest, TokenTable_RejectsOffsetInsideToken) {
+    std::string text(kHeader);
+    unsigned start = static_cast<unsigned>(text.find("Point")) + 2;
+
+    llvm::ArrayRef<armor::SourceTokenTable::Token> tokens;
+    EXPECT_FALSE(table.tokensInRange(start, start + 10, tokens));
+}
+
+TEST_F(FibonacciHashTest, TokenTable_IgnoresWhitespaceAndComments) {
+    std::string text(kHeader);
+    unsigned start = static_cast<unsigned>(text.find("int   add"));
+    unsigned end = static_cast<unsigned>(text.find("// trailing"));
+
+    EXPECT_EQ(FibonacciHash::hash(std::string("intadd(inta,intb);")),
+              FibonacciHash::hashFromOffsets(SM(), start, end, &table));
+}
+
+TEST_F(FibonacciHashTest, TokenTable_StaleTableFallsBack) {
+    clang::SourceManagerForFile other("other.h", "int other(void);\n");
+    EXPECT_FALSE(table.covers(other.get()));
+    EXPECT_EQ(FibonacciHash::hashFromOffsets(&other.get(), 0, 16),
+              FibonacciHash::hashFromOffsets(&other.get(), 0, 16, &table));
+}
+
+TEST_F(FibonacciHashTest, Kernels_MatchScalar) {
+    const FibonacciHash::Kernel kernels[] = {FibonacciHash::Kernel::SSE42, FibonacciHash::Kernel::AVX2};
+    const char alphabet[] = " \t\n\v\f\rabcXYZ_019{}();*/#\x01\x08\x0e\x1f!\x80\xff";
+
+    std::mt19937 rng(2024);
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        std::string text;
+        size_t length = rng() % 200;
+        bool randomBytes = iteration % 4 == 0;
+        for (size_t i = 0; i < length; ++i) {
+            text += randomBytes ? static_cast<char>(rng()) : alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(text.data());
+        uint64_t expected = FibonacciHash::hashWithKernel(FibonacciHash::Kernel::Scalar, data, text.size());
+        for (FibonacciHash::Kernel kernel : kernels) {
+            ASSERT_EQ(expected, FibonacciHash::hashWithKernel(kernel, data, text.size()))
+                << "kernel " << static_cast<int>(kernel) << " length " << text.size();
+        }
+    }
+}
+
+TEST_F(FibonacciHashTest, Kernels_KnownValues) {
+    // Pinned values of the original byte-at-a-time implementation.
+    EXPECT_EQ(FibonacciHash::hash(std::string("")), 0x8c9a09c97e8f0dbfULL);
+    EXPECT_EQ(FibonacciHash::hash(std::string("int add(int a, int b);")),
+              FibonacciHash::hash(std::string("  int\tadd(int a,\n int b) ;  ")));
+    EXPECT_EQ(FibonacciHash::hash(std::string(kHeader)), 0x950f4d051f6b29f0ULL);
+}
@@ -0,0 +1,77 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "file_content_cache.hpp"
+#include "temp_dir.hpp"
+
+class FileContentCacheTest : public ::testing::Test {
+protected:
+    std::string write(const std::string& name, const std::string& content) {
+        std::filesystem::path path = dir / name;
+        std::ofstream(path, std::ios::binary) << content;
+        return path.string();
+    }
+
+    armor::test::TempDir tempDir{"armor file content cache test"};
+    const std::filesystem::path dir = tempDir.path();
+    armor::FileContentCache cache;
+};
+
+TEST_F(FileContentCacheTest, IdenticalFiles_NotDifferent) {
+    std::string file1 = write("v1 mylib.h", "int foo();\n");
+    std::string file2 = write("v2 mylib.h", "int foo();\n");
+    EXPECT_FALSE(cache.filesDiffer(file1, file2));
+}
+
+TEST_F(FileContentCacheTest, SameSizeDifferentContent_Different) {
+    std::string file1 = write("v1.h", "int foo();\n");
+    std::string file2 = write("v2.h", "int bar();\n");
+    EXPECT_TRUE(cache.filesDiffer(file1, file2));
+}
+
+TEST_F(FileContentCacheTest, DifferentSize_Different) {
+    std::string file1 = write("v1.h", "int foo();\n");
+    std::string file2 = write("v2.h", "int foo(int);\n");
+    EXPECT_TRUE(cache.filesDiffer(file1, file2));
+}
+
+TEST_F(FileContentCacheTest, MissingFile_Different) {
+    std::string file1 = write("v1.h", "int foo();\n");
+    EXPECT_TRUE(cache.filesDiffer(file1, (dir / "missing.h").string()));
+    EXPECT_EQ(cache.getBuffer((dir / "missing.h").string()), nullptr);
+}
+
+TEST_F(FileContentCacheTest, Release_DropsTheMappedContents) {
+    std::string file1 = write("v1.h", "int foo();\n");
+    ASSERT_NE(cache.getBuffer(file1), nullptr);
+    EXPECT_EQ(cache.getBuffer(file1)->getBuffer(), "int foo();\n");
+
+    cache.release(file1);
+    write("v1.h", "int bar(int);\n");
+    ASSERT_NE(cache.getBuffer(file1), nullptr);
+    EXPECT_EQ(cache.getBuffer(file1)->getBuffer(), "int bar(int);\n");
+}
+
+TEST_F(FileContentCacheTest, ContentHash_KeyedOnContentAndKeptAfterRelease) {
+    std::string file1 = write("v1.h", "int foo();\n");
+    std::string file2 = write("v2.h", "int foo();\n");
+    std::optional<uint64_t> hash1 = cache.getContentHash(file1);
+    ASSERT_TRUE(hash1.has_value());
+    EXPECT_EQ(hash1, cache.getContentHash(file2));
+    EXPECT_FALSE(cache.getContentHash((dir / "missing.h").string()).has_value());
+
+    // Another cache, e.g. of a later stage, reuses the hash.
+    cache.release(file1);
+    armor::FileContentCache later;
+    EXPECT_EQ(hash1, later.getContentHash(file1));
+    EXPECT_FALSE(later.filesDiffer(file1, file2));
+
+    // A file that changed is hashed again.
+    write("v1.h", "int foo(int);\n");
+    std::optional<uint64_t> changed = later.getContentHash(file1);
+    ASSERT_TRUE(changed.has_value());
+    EXPECT_NE(hash1, changed);
+    EXPECT_EQ(later.getBuffer(file1)->getBuffer(), "int foo(int);\n");
+}
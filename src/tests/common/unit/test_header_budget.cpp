@@ -0,0 +1,65 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <thread>
+#include "header_budget.hpp"
+
+class HeaderBudgetTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(HeaderBudgetTest, NoScope_NeverExceeded) {
+    EXPECT_FALSE(armor::HeaderBudget::exceeded());
+    EXPECT_TRUE(armor::HeaderBudget::reason() == armor::HeaderBudget::Reason::None);
+}
+
+TEST_F(HeaderBudgetTest, Unlimited_NeverExceeded) {
+    armor::HeaderBudget::Scope budget({});
+    EXPECT_FALSE(armor::HeaderBudget::exceeded());
+}
+
+TEST_F(HeaderBudgetTest, TimeLimit_ExceededAndSticky) {
+    armor::HeaderBudget::Limits limits;
+    limits.time = std::chrono::milliseconds(5);
+    armor::HeaderBudget::Scope budget(limits);
+    EXPECT_FALSE(armor::HeaderBudget::exceeded());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_TRUE(armor::HeaderBudget::exceeded());
+    EXPECT_TRUE(armor::HeaderBudget::exceeded());
+    EXPECT_TRUE(armor::HeaderBudget::reason() == armor::HeaderBudget::Reason::Time);
+    EXPECT_EQ("time budget of 0.005s", armor::HeaderBudget::describe());
+}
+
+TEST_F(HeaderBudgetTest, MemoryLimit_ComparesResidentSet) {
+    ASSERT_TRUE(armor::HeaderBudget::residentBytes() > 0);
+
+    armor::HeaderBudget::Limits limits;
+    limits.memoryBytes = 1;
+    armor::HeaderBudget::Scope budget(limits);
+    EXPECT_TRUE(armor::HeaderBudget::exceeded());
+    EXPECT_TRUE(armor::HeaderBudget::reason() == armor::HeaderBudget::Reason::Memory);
+}
+
+TEST_F(HeaderBudgetTest, Scope_RestoresOuterBudget) {
+    armor::HeaderBudget::Limits limits;
+    limits.memoryBytes = 1;
+    armor::HeaderBudget::Scope outer(limits);
+    {
+        armor::HeaderBudget::Scope inner({});
+        EXPECT_FALSE(armor::HeaderBudget::exceeded());
+    }
+    EXPECT_TRUE(armor::HeaderBudget::exceeded());
+}
+
+TEST_F(HeaderBudgetTest, Scope_IsPerThread) {
+    armor::HeaderBudget::Limits limits;
+    limits.memoryBytes = 1;
+    armor::HeaderBudget::Scope budget(limits);
+
+    bool otherThreadExceeded = true;
+    std::thread([&] { otherThreadExceeded = armor::HeaderBudget::exceeded(); }).join();
+    EXPECT_FALSE(otherThreadExceeded);
+}
@@ -0,0 +1,149 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include "header_discovery.hpp"
+#include "temp_dir.hpp"
+
+class HeaderDiscoveryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir1 = (dir / "v1").string();
+        dir2 = (dir / "v2").string();
+        std::filesystem::create_directories(dir1);
+        std::filesystem::create_directories(dir2);
+    }
+
+    static void writeFile(const std::string& root, const std::string& name, const std::string& text) {
+        std::filesystem::path path = std::filesystem::path(root) / name;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path) << text;
+    }
+
+    static armor::HeaderFilter makeFilter(const std::vector<std::string>& includes = {},
+                                          const std::vector<std::string>& excludes = {}) {
+        std::string error;
+        std::optional<armor::HeaderFilter> filter = armor::HeaderFilter::create(includes, excludes, error);
+        EXPECT_TRUE(filter.has_value());
+        return *filter;
+    }
+
+    armor::test::TempDir tempDir{"armor_header_discovery_test"};
+    const std::filesystem::path dir = tempDir.path();
+    std::string dir1;
+    std::string dir2;
+};
+
+TEST_F(HeaderDiscoveryTest, FilterMatchesNamesAndPaths) {
+    armor::HeaderFilter filter = makeFilter({}, {"*_internal.h", "detail/*"});
+    EXPECT_TRUE(filter.matches("api.h"));
+    EXPECT_TRUE(filter.matches("sub/api.hpp"));
+    EXPECT_FALSE(filter.matches("api.c"));
+    EXPECT_FALSE(filter.matches("sub/api_internal.h"));
+    EXPECT_FALSE(filter.matches("detail/impl.h"));
+    EXPECT_TRUE(filter.matches("sub/detail/impl.h"));
+
+    std::string error;
+    EXPECT_FALSE(armor::HeaderFilter::create({"[a-"}, {}, error).has_value());
+    EXPECT_NE(error.find("[a-"), std::string::npos);
+}
+
+TEST_F(HeaderDiscoveryTest, FindsHeadersRecursivelyOnlyWhenAsked) {
+    writeFile(dir1, "a.h", "");
+    writeFile(dir1, "notes.txt", "");
+    writeFile(dir1, "sub/b.hpp", "");
+    writeFile(dir1, "sub/deeper/c.h", "");
+
+    armor::HeaderFilter filter = makeFilter();
+    EXPECT_EQ(armor::findHeaders(dir1, filter, false), std::vector<std::string>{"a.h"});
+    EXPECT_EQ(armor::findHeaders(dir1, filter, true),
+              (std::vector<std::string>{"a.h", "sub/b.hpp", "sub/deeper/c.h"}));
+}
+
+TEST_F(HeaderDiscoveryTest, PairsByPathThenContentThenSimilarity) {
+    std::string body;
+    for (int i = 0; i < 10; ++i) body += "int function" + std::to_string(i) + "(void);\n";
+
+    writeFile(dir1, "same.h", "int same;\n");
+    writeFile(dir2, "same.h", "int same;\n");
+    writeFile(dir1, "changed.h", "int before;\n");
+    writeFile(dir2, "changed.h", "int after;\n");
+    writeFile(dir1, "old/moved.h", "struct Moved { int x; };\n");
+    writeFile(dir2, "new/moved.h", "struct Moved { int x; };\n");
+    writeFile(dir1, "legacy_name.h", body);
+    writeFile(dir2, "modern_name.h", body + "int function10(void);\n");
+    writeFile(dir1, "removed.h", "int gone;\n");
+    writeFile(dir2, "added.h", "double fresh;\n");
+
+    std::vector<armor::DiscoveredHeader> found =
+        armor::discoverHeaders(dir1, dir2, makeFilter(), /*recursive=*/true, /*jobs=*/2);
+    ASSERT_EQ(found.size(), 6u);
+    // Sorted by new path, removed headers by old path.
+    EXPECT_EQ(found[0].newPath, "added.h");
+    EXPECT_TRUE(found[0].oldPath.empty());
+    EXPECT_EQ(found[1].oldPath, "changed.h");
+    EXPECT_EQ(found[1].newPath, "changed.h");
+    EXPECT_FALSE(found[1].identical);
+    EXPECT_EQ(found[2].oldPath, "legacy_name.h");
+    EXPECT_EQ(found[2].newPath, "modern_name.h");
+    EXPECT_TRUE(found[2].isRenamed());
+    EXPECT_FALSE(found[2].identical);
+    EXPECT_GT(found[2].similarity, 0.9);
+    EXPECT_EQ(found[3].oldPath, "old/moved.h");
+    EXPECT_EQ(found[3].newPath, "new/moved.h");
+    EXPECT_TRUE(found[3].identical);
+    EXPECT_EQ(found[4].oldPath, "removed.h");
+    EXPECT_TRUE(found[4].newPath.empty());
+    EXPECT_EQ(found[5].newPath, "same.h");
+    EXPECT_TRUE(found[5].identical);
+    EXPECT_FALSE(found[5].isRenamed());
+}
+
+TEST_F(HeaderDiscoveryTest, IdenticalCopiesPreferTheSameFileName) {
+    writeFile(dir1, "a/config.h", "#define X 1\n");
+    writeFile(dir2, "b/other.h", "#define X 1\n");
+    writeFile(dir2, "b/config.h", "#define X 1\n");
+
+    std::vector<armor::DiscoveredHeader> found =
+        armor::discoverHeaders(dir1, dir2, makeFilter(), /*recursive=*/true, /*jobs=*/1);
+    ASSERT_EQ(found.size(), 2u);
+    EXPECT_EQ(found[0].oldPath, "a/config.h");
+    EXPECT_EQ(found[0].newPath, "b/config.h");
+    EXPECT_TRUE(found[1].oldPath.empty());
+    EXPECT_EQ(found[1].newPath, "b/other.h");
+}
+
+TEST_F(HeaderDiscoveryTest, SimilarityScoresTheSameFileNameAmongManyCandidates) {
+    std::string body;
+    for (int i = 0; i < 10; ++i) body += "int widget" + std::to_string(i) + "(void);\n";
+    writeFile(dir1, "a/widget.h", body);
+    // More unrelated headers of the same length than are scored by line count alone.
+    for (int k = 0; k < 100; ++k) {
+        std::string other;
+        for (int i = 0; i < 10; ++i) other += "int other" + std::to_string(k) + "_" + std::to_string(i) + ";\n";
+        writeFile(dir2, "n/other" + std::to_string(k) + ".h", other);
+    }
+    std::string edited;
+    for (int i = 0; i < 10; ++i) edited += "int widget" + std::to_string(i < 6 ? i : i + 10) + "(void);\n";
+    writeFile(dir2, "b/widget.h", edited);
+    // Holds every line of the old header, but is too long to reach half of its lines in common.
+    std::string longer = body;
+    for (int i = 0; i < 30; ++i) longer += "int padding" + std::to_string(i) + ";\n";
+    writeFile(dir2, "c/long.h", longer);
+
+    std::vector<armor::DiscoveredHeader> found =
+        armor::discoverHeaders(dir1, dir2, makeFilter(), /*recursive=*/true, /*jobs=*/2);
+    auto widget = std::find_if(found.begin(), found.end(),
+                               [](const armor::DiscoveredHeader& header) { return header.oldPath == "a/widget.h"; });
+    ASSERT_TRUE(widget != found.end());
+    EXPECT_EQ(widget->newPath, "b/widget.h");
+    EXPECT_DOUBLE_EQ(widget->similarity, 0.6);
+}
+
+TEST_F(HeaderDiscoveryTest, LineSimilarityIgnoresIndentationAndBlankLines) {
+    EXPECT_DOUBLE_EQ(armor::lineSimilarity("int a;\n\nint b;\n", "    int a;\nint b;"), 1.0);
+    EXPECT_DOUBLE_EQ(armor::lineSimilarity("int a;\nint b;\n", "int a;\nint c;\n"), 0.5);
+    EXPECT_DOUBLE_EQ(armor::lineSimilarity("int a;\n", "int z;\n"), 0.0);
+}
@@ -0,0 +1,46 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include "comm_def.hpp"
+#include "diff_utils.hpp"
+#include "header_processor_utils.hpp"
+#include "temp_dir.hpp"
+
+class HeaderProcessorUtilsTest : public ::testing::Test {
+protected:
+    // Reports are written under the working directory.
+    void SetUp() override {
+        previousDir = std::filesystem::current_path();
+        std::filesystem::current_path(dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::current_path(previousDir);
+    }
+
+    static nlohmann::json unchangedDiff() {
+        nlohmann::json diffResult;
+        diffResult[PARSED_STATUS] = ParsedDiffStatus::COMMENTS_UPDATED;
+        diffResult[UNPARSED_STATUS] = UnParsedDiffStatus::UN_CHANGED;
+        diffResult[HEADER_RESOLUTION_FAILURES] = nlohmann::json::array();
+        diffResult[AST_DIFF] = nlohmann::json::array();
+        return diffResult;
+    }
+
+    armor::test::TempDir tempDir{"armor_header_processor_utils_test"};
+    const std::filesystem::path dir = tempDir.path();
+    std::filesystem::path previousDir;
+};
+
+TEST_F(HeaderProcessorUtilsTest, SameFileNameInOtherDirectoriesGetsOwnReports) {
+    armor::emitHeaderDiffReport(unchangedDiff(), "v1/a/config.h", "v1", "json", BETA_PARSER, false);
+    armor::emitHeaderDiffReport(unchangedDiff(), "v1/b/config.h", "v1", "json", BETA_PARSER, false);
+
+    EXPECT_TRUE(std::filesystem::exists(dir / "armor_reports/html_reports/api_diff_report_a_config.h.html"));
+    EXPECT_TRUE(std::filesystem::exists(dir / "armor_reports/html_reports/api_diff_report_b_config.h.html"));
+    EXPECT_TRUE(std::filesystem::exists(dir / "armor_reports/json_reports/api_diff_report_a_config.h.json"));
+    EXPECT_TRUE(std::filesystem::exists(dir / "armor_reports/json_reports/api_diff_report_b_config.h.json"));
+    EXPECT_FALSE(std::filesystem::exists(dir / "armor_reports/html_reports/api_diff_report_config.h.html"));
+}
@@ -0,0 +1,73 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include "header_scheduler.hpp"
+#include "temp_dir.hpp"
+
+class HeaderSchedulerTest : public ::testing::Test {
+protected:
+    std::string write(const std::string& name, const std::string& content) {
+        std::filesystem::path path = dir / name;
+        std::ofstream(path) << content;
+        return path.string();
+    }
+
+    armor::test::TempDir tempDir{"armor_header_scheduler_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(HeaderSchedulerTest, CountIncludes_DirectivesOnly) {
+    EXPECT_EQ(3u, armor::HeaderCostModel::countIncludes(
+        "#include <a.h>\n  #  include \"b.h\"\n// #include <c.h>\nint include;\n#include_next <d.h>\n"));
+}
+
+TEST_F(HeaderSchedulerTest, Estimate_ScalesSizeByHistory) {
+    std::string small = write("small.h", std::string(100, ' '));
+    std::string large = write("large.h", std::string(400, ' '));
+
+    armor::HeaderCostModel model;
+    model.addHistory("small.h", 20.0);
+    std::vector<double> costs = model.estimate({{"small.h", small, small}, {"large.h", large, large}});
+
+    ASSERT_EQ(2u, costs.size());
+    EXPECT_DOUBLE_EQ(20.0, costs[0]);
+    EXPECT_DOUBLE_EQ(80.0, costs[1]);
+}
+
+TEST_F(HeaderSchedulerTest, Estimate_MissingFilesCostNothing) {
+    armor::HeaderCostModel model;
+    std::vector<double> costs = model.estimate({{"gone.h", (dir / "a.h").string(), (dir / "b.h").string()}});
+
+    ASSERT_EQ(1u, costs.size());
+    EXPECT_DOUBLE_EQ(0.0, costs[0]);
+}
+
+TEST_F(HeaderSchedulerTest, RunLongestFirst_SingleWorkerRunsInCostOrder) {
+    std::vector<size_t> order;
+    armor::runLongestFirst({1.0, 5.0, 3.0}, 1, [&](size_t index) { order.push_back(index); });
+
+    EXPECT_EQ((std::vector<size_t>{1, 2, 0}), order);
+}
+
+TEST_F(HeaderSchedulerTest, RunLongestFirst_RunsEveryTaskOnce) {
+    std::vector<double> costs(64);
+    for (size_t i = 0; i < costs.size(); ++i) costs[i] = static_cast<double>(i % 7);
+    std::vector<std::atomic<int>> runs(costs.size());
+
+    armor::runLongestFirst(costs, 4, [&](size_t index) { ++runs[index]; });
+
+    for (const std::atomic<int>& count : runs) EXPECT_EQ(1, count.load());
+}
+
+TEST_F(HeaderSchedulerTest, RunLongestFirst_RethrowsTaskError) {
+    std::atomic<int> runs{0};
+    EXPECT_THROW(armor::runLongestFirst({1.0, 2.0, 3.0}, 2, [&](size_t index) {
+        ++runs;
+        if (index == 1) throw std::runtime_error("task failed");
+    }), std::runtime_error);
+    EXPECT_EQ(3, runs.load());
+}
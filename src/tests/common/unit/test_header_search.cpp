@@ -0,0 +1,125 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "archive_file_system.hpp"
+#include "header_search.hpp"
+#include "temp_dir.hpp"
+
+class HeaderSearchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::filesystem::create_directories(dir + "/include/sub");
+        std::filesystem::create_directories(dir + "/src");
+        std::ofstream(dir + "/include/api.h") << "int api;\n";
+        std::ofstream(dir + "/include/sub/detail.h") << "int detail;\n";
+    }
+
+    armor::test::TempDir tempDir{"armor_header_search_test"};
+    const std::string dir = tempDir.path().string();
+};
+
+// Looks every path up in lower case, like the default volumes of macOS and Windows.
+class CaseInsensitiveFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+    using ProxyFileSystem::ProxyFileSystem;
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override {
+        return ProxyFileSystem::status(llvm::StringRef(path.str()).lower());
+    }
+
+    llvm::vfs::directory_iterator dir_begin(const llvm::Twine& dir, std::error_code& ec) override {
+        return ProxyFileSystem::dir_begin(llvm::StringRef(dir.str()).lower(), ec);
+    }
+};
+
+TEST_F(HeaderSearchTest, CanonicalizesAndDropsRepeatedOrMissingDirectories) {
+    std::vector<std::string> arguments = {
+        "clang-tool", "-std=c++17",
+        "-I" + dir + "/include/",
+        "-I", dir + "/./include",
+        "-isystem", dir + "//include",
+        "-I" + dir + "/missing",
+        "-isystem" + dir + "/include/api.h",
+        "-Irelative/./dir",
+        "-DNAME=1", "header.h"};
+    EXPECT_EQ(armor::canonicalizeSearchPaths(arguments),
+              (std::vector<std::string>{"clang-tool", "-std=c++17", "-I" + dir + "/include",
+                                        "-isystem" + dir + "/include", "-Irelative/dir", "-DNAME=1", "header.h"}));
+}
+
+TEST_F(HeaderSearchTest, SearchDirectoriesAreCheckedThroughTheEnabledIndex) {
+    std::vector<std::string> arguments = {"clang-tool", "-I" + dir + "/include", "-I" + dir + "/missing",
+                                          "-I" + dir + "/include/api.h", "header.h"};
+    const std::vector<std::string> expected = {"clang-tool", "-I" + dir + "/include", "header.h"};
+    armor::DirectoryIndex& index = armor::DirectoryIndex::getInstance();
+    armor::DirectoryIndex::Scope scope;
+    EXPECT_EQ(armor::canonicalizeSearchPaths(arguments), expected);
+    size_t listed = index.getListedDirectoryCount();
+    EXPECT_GT(listed, 0u);
+
+    // Later parses are answered from the listings, even once the tree changes.
+    std::filesystem::create_directories(dir + "/missing");
+    EXPECT_EQ(armor::canonicalizeSearchPaths(arguments), expected);
+    EXPECT_EQ(index.getListedDirectoryCount(), listed);
+    EXPECT_TRUE(index.isKnownMissing(dir + "/include/absent.h"));
+    EXPECT_EQ(index.getListedDirectoryCount(), listed);
+}
+
+TEST_F(HeaderSearchTest, IndexRulesOutAbsentFilesFromListings) {
+    armor::DirectoryIndex index(armor::getFileSystem());
+    EXPECT_FALSE(index.isKnownMissing(dir + "/include/api.h"));
+    EXPECT_FALSE(index.isKnownMissing(dir + "/include/sub/detail.h"));
+    EXPECT_FALSE(index.isKnownMissing(dir + "/include/./sub"));
+    EXPECT_TRUE(index.isKnownMissing(dir + "/include/other.h"));
+    EXPECT_TRUE(index.isKnownMissing(dir + "/src/api.h"));
+    // Nothing below a missing directory is looked up.
+    EXPECT_TRUE(index.isKnownMissing(dir + "/nowhere/deeper/api.h"));
+    // ".." may follow a symbolic link, so it is left to the file system.
+    EXPECT_FALSE(index.isKnownMissing(dir + "/include/../nothing.h"));
+    EXPECT_EQ(index.getAvoidedLookupCount(), 3u);
+
+    // Listings are kept until cleared.
+    std::ofstream(dir + "/include/other.h") << "int other;\n";
+    EXPECT_TRUE(index.isKnownMissing(dir + "/include/other.h"));
+    index.clear();
+    EXPECT_FALSE(index.isKnownMissing(dir + "/include/other.h"));
+}
+
+TEST_F(HeaderSearchTest, IndexedFileSystemFailsOnlyWhileEnabled) {
+    std::ofstream(dir + "/include/late.h") << "int late;\n";
+    armor::DirectoryIndex& index = armor::DirectoryIndex::getInstance();
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> fileSystem =
+        armor::createIndexedFileSystem(armor::createFileSystem(), index);
+    ASSERT_FALSE(fileSystem->setCurrentWorkingDirectory(dir + "/include"));
+    {
+        armor::DirectoryIndex::Scope scope;
+        EXPECT_TRUE(fileSystem->status("api.h"));
+        EXPECT_TRUE(fileSystem->openFileForRead("sub/detail.h"));
+        EXPECT_EQ(fileSystem->status("absent.h").getError(), std::errc::no_such_file_or_directory);
+        EXPECT_EQ(fileSystem->openFileForRead("sub/absent.h").getError(), std::errc::no_such_file_or_directory);
+        EXPECT_EQ(index.getAvoidedLookupCount(), 2u);
+        EXPECT_GT(index.getListedDirectoryCount(), 0u);
+    }
+    EXPECT_FALSE(index.isEnabled());
+    EXPECT_EQ(index.getListedDirectoryCount(), 0u);
+    EXPECT_FALSE(fileSystem->status("absent.h"));
+    EXPECT_EQ(index.getAvoidedLookupCount(), 0u);
+}
+
+TEST_F(HeaderSearchTest, IndexLeavesOtherCasesToTheFileSystem) {
+    auto memory = llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>();
+    memory->addFile("/case/include/api.h", 0, llvm::MemoryBuffer::getMemBuffer("int api;\n"));
+    CaseInsensitiveFileSystem fileSystem(memory);
+    armor::DirectoryIndex index(fileSystem);
+
+    EXPECT_FALSE(index.isKnownMissing("/case/include/API.h"));
+    EXPECT_FALSE(index.isKnownMissing("/case/Include/api.h"));
+    EXPECT_TRUE(index.isDirectory("/case/INCLUDE"));
+    EXPECT_FALSE(index.isKnownMissing("/case/include/\xC3\x84pi.h"));
+    // A name no entry has in any case is still ruled out.
+    EXPECT_TRUE(index.isKnownMissing("/case/include/absent.h"));
+    EXPECT_TRUE(index.isKnownMissing("/case/Include/absent.h"));
+    EXPECT_EQ(index.getAvoidedLookupCount(), 2u);
+}
@@ -0,0 +1,117 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "include_graph.hpp"
+#include "temp_dir.hpp"
+
+class IncludeGraphTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root1 = (dir / "v1").string();
+        root2 = (dir / "v2").string();
+    }
+
+    static void writeFile(const std::string& root, const std::string& name, const std::string& text) {
+        std::filesystem::path path = std::filesystem::path(root) / name;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path) << text;
+    }
+
+    armor::test::TempDir tempDir{"armor_include_graph_test"};
+    const std::filesystem::path dir = tempDir.path();
+    std::string root1;
+    std::string root2;
+};
+
+TEST_F(IncludeGraphTest, ScanSkipsCommentsAndFlagsComputedIncludes) {
+    armor::FileIncludes includes = armor::scanIncludes(
+        "#include \"a.h\"\n"
+        "  #  include <sys/b.h> // trailing\n"
+        "// #include \"commented.h\"\n"
+        "/* #include \"block.h\"\n"
+        "   still comment */ #include \"after_comment.h\"\n"
+        "#include_next \\\n"
+        "  \"next.h\"\n"
+        "#include CONFIG_HEADER\n");
+    ASSERT_EQ(includes.directives.size(), 4u);
+    EXPECT_EQ(includes.directives[0].name, "a.h");
+    EXPECT_FALSE(includes.directives[0].angled);
+    EXPECT_EQ(includes.directives[1].name, "sys/b.h");
+    EXPECT_TRUE(includes.directives[1].angled);
+    EXPECT_EQ(includes.directives[2].name, "after_comment.h");
+    EXPECT_EQ(includes.directives[3].name, "next.h");
+    EXPECT_TRUE(includes.computed);
+}
+
+TEST_F(IncludeGraphTest, PrivateHeaderChangeAffectsItsPublicIncluders) {
+    writeFile(root1, "include/api.h", "#include \"detail/impl.h\"\n");
+    writeFile(root1, "include/other.h", "#include <stdio.h>\n");
+    writeFile(root1, "include/detail/impl.h", "#include \"../../src/types.h\"\n");
+    writeFile(root1, "src/types.h", "typedef int T;\n");
+
+    armor::IncludeGraph graph({});
+    graph.addHeader(root1, "include/api.h");
+    graph.addHeader(root1, "include/other.h");
+    graph.build();
+
+    EXPECT_EQ(graph.getIncludes("include/api.h"), std::vector<std::string>{"include/detail/impl.h"});
+    EXPECT_EQ(graph.getAffectedHeaders({"src/types.h"}), std::vector<std::string>{"include/api.h"});
+    EXPECT_EQ(graph.getAffectedHeaders({"include/other.h"}), std::vector<std::string>{"include/other.h"});
+    EXPECT_TRUE(graph.getAffectedHeaders({"README.md"}).empty());
+}
+
+TEST_F(IncludeGraphTest, EdgesOfBothVersionsCount) {
+    // v1 includes old.h, v2 includes new.h: a change to either affects api.h.
+    writeFile(root1, "api.h", "#include \"old.h\"\n");
+    writeFile(root1, "old.h", "");
+    writeFile(root2, "api.h", "#include \"new.h\"\n");
+    writeFile(root2, "new.h", "");
+
+    armor::IncludeGraph graph({});
+    graph.addHeader(root1, "api.h");
+    graph.addHeader(root2, "api.h");
+    graph.build();
+
+    EXPECT_EQ(graph.getAffectedHeaders({"old.h"}), std::vector<std::string>{"api.h"});
+    EXPECT_EQ(graph.getAffectedHeaders({"new.h"}), std::vector<std::string>{"api.h"});
+}
+
+TEST_F(IncludeGraphTest, IncludePathsAndComputedIncludes) {
+    writeFile(root1, "api.h", "#include <dep.h>\n");
+    writeFile(root1, "third_party/dep.h", "");
+    writeFile(root1, "config.h", "#include CONFIG\n");
+
+    armor::IncludeGraph graph({"third_party"});
+    graph.addHeader(root1, "api.h");
+    graph.addHeader(root1, "config.h");
+    graph.build();
+
+    EXPECT_EQ(graph.getIncludes("api.h"), std::vector<std::string>{"third_party/dep.h"});
+    // config.h's include cannot be followed, so it is always affected.
+    EXPECT_EQ(graph.getAffectedHeaders({}), std::vector<std::string>{"config.h"});
+}
+
+TEST_F(IncludeGraphTest, CacheSkipsRescanningUnchangedFiles) {
+    writeFile(root1, "api.h", "#include \"dep.h\"\n");
+    writeFile(root1, "dep.h", "");
+    writeFile(root2, "api.h", "#include \"dep.h\"\n");
+    writeFile(root2, "dep.h", "int x;\n");
+    std::string cachePath = (dir / "cache.json").string();
+
+    armor::IncludeGraph first({});
+    first.addHeader(root1, "api.h");
+    first.build();
+    EXPECT_EQ(first.getScannedFileCount(), 2u);
+    ASSERT_TRUE(first.saveCache(cachePath));
+
+    armor::IncludeGraph second({});
+    ASSERT_TRUE(second.loadCache(cachePath));
+    second.addHeader(root1, "api.h");
+    second.addHeader(root2, "api.h");
+    second.build();
+    // Only v2's dep.h has new contents.
+    EXPECT_EQ(second.getScannedFileCount(), 1u);
+    EXPECT_EQ(second.getIncludes("api.h"), std::vector<std::string>{"dep.h"});
+}
@@ -0,0 +1,75 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "lexical_diff.hpp"
+#include "temp_dir.hpp"
+
+class LexicalDiffTest : public ::testing::Test {
+protected:
+    std::optional<ParsedDiffStatus> classify(const std::string& v1, const std::string& v2, LANG_OPTIONS lang = CPP) {
+        std::string file1 = write("v1.h", v1);
+        std::string file2 = write("v2.h", v2);
+        return armor::classifyLexicalChange(file1, file2, lang);
+    }
+
+    std::string write(const std::string& name, const std::string& content) {
+        std::filesystem::path path = dir / name;
+        std::ofstream(path) << content;
+        return path.string();
+    }
+
+    armor::test::TempDir tempDir{"armor_lexical_diff_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(LexicalDiffTest, WhitespaceOnly_NonFunctional) {
+    auto status = classify("int  foo(int a);\nstruct S { int x; };\n",
+                           "int foo(int a);\n\nstruct S {\n    int x;\n};\n");
+    ASSERT_TRUE(status.has_value());
+    EXPECT_EQ(ParsedDiffStatus::NON_FUNCTIONAL_CHANGES, *status);
+}
+
+TEST_F(LexicalDiffTest, CommentMoved_NonFunctional) {
+    auto status = classify("// a\nint foo();\n// b\nint bar();\n",
+                           "// b\nint foo();\n// a\nint bar();\n");
+    ASSERT_TRUE(status.has_value());
+    EXPECT_EQ(ParsedDiffStatus::NON_FUNCTIONAL_CHANGES, *status);
+}
+
+TEST_F(LexicalDiffTest, CommentEdited_CommentsUpdated) {
+    auto status = classify("/* Adds two ints. */\nint add(int, int);\n",
+                           "/* Adds two integers. */\nint add(int, int);\n", C);
+    ASSERT_TRUE(status.has_value());
+    EXPECT_EQ(ParsedDiffStatus::COMMENTS_UPDATED, *status);
+}
+
+TEST_F(LexicalDiffTest, CommentInsideIncludeGuard_CommentsUpdated) {
+    auto status = classify("#ifndef MYLIB_H\n#define MYLIB_H\n// old\nint foo();\n#endif\n",
+                           "#ifndef MYLIB_H\n#define MYLIB_H\n// new\nint foo();\n#endif\n");
+    ASSERT_TRUE(status.has_value());
+    EXPECT_EQ(ParsedDiffStatus::COMMENTS_UPDATED, *status);
+}
+
+TEST_F(LexicalDiffTest, TokenChanged_NeedsParse) {
+    EXPECT_FALSE(classify("int foo(int a);\n", "long foo(int a);\n").has_value());
+}
+
+TEST_F(LexicalDiffTest, DirectiveLineBreak_NeedsParse) {
+    EXPECT_FALSE(classify("#define A 1\nint x;\n", "#define A\n1\nint x;\n").has_value());
+}
+
+TEST_F(LexicalDiffTest, FunctionLikeMacroSpacing_NeedsParse) {
+    EXPECT_FALSE(classify("#define F(x) x\n", "#define F (x) x\n").has_value());
+}
+
+TEST_F(LexicalDiffTest, CommentInsideConditional_NeedsParse) {
+    EXPECT_FALSE(classify("#if 0\n// old\nint foo();\n#endif\n",
+                          "#if 0\n// new\nint foo();\n#endif\n").has_value());
+}
+
+TEST_F(LexicalDiffTest, MissingFile_NeedsParse) {
+    std::string file1 = write("v1.h", "int foo();\n");
+    EXPECT_FALSE(armor::classifyLexicalChange(file1, (dir / "missing.h").string(), CPP).has_value());
+}
@@ -0,0 +1,73 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include "ndjson_writer.hpp"
+#include "temp_dir.hpp"
+
+class NdjsonWriterTest : public ::testing::Test {
+protected:
+    std::vector<nlohmann::json> readLines(const std::filesystem::path& path) {
+        std::vector<nlohmann::json> lines;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) lines.push_back(nlohmann::json::parse(line));
+        return lines;
+    }
+
+    armor::test::TempDir tempDir{"armor_ndjson_writer_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(NdjsonWriterTest, WriteHeader_ChangeLinesThenSummary) {
+    std::filesystem::path path = dir / "out" / "report.ndjson";
+    armor::NdjsonWriter writer;
+    ASSERT_TRUE(writer.open(path.string()));
+    EXPECT_FALSE(writer.writesToStdout());
+
+    HeaderReportSummary summary;
+    summary.compatibility = "backward_incompatible";
+    summary.overallStatus = "BACKWARD_INCOMPATIBLE";
+    summary.reason = "API changed";
+    summary.changes.push_back({"include/mylib.h", "foo:Function", "Parameter added\nReturn type changed", true, true});
+    summary.changes.push_back({"include/mylib.h", "bar:Function", "Function added", false, false});
+    writer.writeHeader("include/mylib.h", summary);
+
+    std::vector<nlohmann::json> lines = readLines(path);
+    ASSERT_EQ(3u, lines.size());
+    EXPECT_EQ("change", lines[0]["type"]);
+    EXPECT_EQ("foo:Function", lines[0]["name"]);
+    EXPECT_EQ("Parameter added\nReturn type changed", lines[0]["description"]);
+    EXPECT_EQ("backward_incompatible", lines[0]["compatibility"]);
+    EXPECT_EQ("Functionality Added", lines[1]["changetype"]);
+    EXPECT_EQ("header", lines[2]["type"]);
+    EXPECT_EQ("include/mylib.h", lines[2]["header"]);
+    EXPECT_EQ(2, lines[2]["changes"]);
+    EXPECT_EQ(1, lines[2]["incompatible_changes"]);
+}
+
+TEST_F(NdjsonWriterTest, WriteHeader_NoChanges) {
+    std::filesystem::path path = dir / "report.ndjson";
+    armor::NdjsonWriter writer;
+    ASSERT_TRUE(writer.open(path.string()));
+
+    HeaderReportSummary summary;
+    summary.compatibility = "backward_compatible";
+    summary.overallStatus = "BACKWARD_COMPATIBLE";
+    summary.reason = "Missing header in older version";
+    writer.writeHeader("include/new.h", summary);
+
+    std::vector<nlohmann::json> lines = readLines(path);
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_EQ("BACKWARD_COMPATIBLE", lines[0]["overall_status"]);
+    EXPECT_EQ(0, lines[0]["changes"]);
+}
+
+TEST_F(NdjsonWriterTest, Open_Stdout) {
+    armor::NdjsonWriter writer;
+    EXPECT_FALSE(writer.isOpen());
+    ASSERT_TRUE(writer.open("-"));
+    EXPECT_TRUE(writer.writesToStdout());
+}
@@ -0,0 +1,105 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include "progress_reporter.hpp"
+
+class ProgressReporterTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+
+    std::string output;
+    llvm::raw_string_ostream os{output};
+};
+
+TEST_F(ProgressReporterTest, Snapshot_CountsFinishedHeaders) {
+    armor::ProgressReporter progress(os);
+    progress.enable(armor::ProgressReporter::Mode::Records);
+    progress.start(3);
+
+    progress.headerStarted("a.h");
+    progress.headerFinished("a.h");
+    progress.headerFinished("a.h");
+    progress.headerStarted("b.h");
+
+    armor::ProgressReporter::Snapshot snapshot = progress.snapshot();
+    EXPECT_EQ(1u, snapshot.done);
+    EXPECT_EQ(3u, snapshot.total);
+    EXPECT_EQ(1u, snapshot.running);
+    EXPECT_EQ("b.h", snapshot.current);
+    EXPECT_LE(0.0, snapshot.etaSeconds);
+}
+
+TEST_F(ProgressReporterTest, Snapshot_EtaSharesRemainingHeadersAmongWorkers) {
+    armor::ProgressReporter progress(os);
+    progress.enable(armor::ProgressReporter::Mode::Records);
+    progress.start(10);
+
+    const std::vector<std::string> headers = {"a.h", "b.h", "c.h", "d.h"};
+    for (const std::string& header : headers) progress.headerStarted(header);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (const std::string& header : headers) progress.headerFinished(header);
+
+    // Six headers of about 50ms left on four workers: about 75ms, not 300ms.
+    armor::ProgressReporter::Snapshot snapshot = progress.snapshot();
+    EXPECT_EQ(4u, snapshot.done);
+    EXPECT_LE(0.07, snapshot.etaSeconds);
+    EXPECT_GT(0.2, snapshot.etaSeconds);
+}
+
+TEST_F(ProgressReporterTest, Finish_EmitsFinalRecord) {
+    {
+        armor::ProgressReporter progress(os);
+        progress.enable(armor::ProgressReporter::Mode::Records);
+        progress.start(1);
+        progress.headerStarted("a.h");
+        progress.headerFinished("a.h");
+        progress.finish();
+    }
+
+    std::string last = output.substr(output.rfind('\n', output.size() - 2) + 1);
+    nlohmann::json record = nlohmann::json::parse(last);
+    EXPECT_EQ("progress", record["type"]);
+    EXPECT_EQ(1, record["done"]);
+    EXPECT_EQ(1, record["total"]);
+    EXPECT_TRUE(record["current"].is_null());
+}
+
+TEST_F(ProgressReporterTest, Disabled_WritesNothing) {
+    armor::ProgressReporter progress(os);
+    progress.start(2);
+    progress.headerStarted("a.h");
+    progress.headerFinished("a.h");
+    progress.finish();
+
+    EXPECT_TRUE(output.empty());
+}
+
+TEST_F(ProgressReporterTest, FormatLine_ShowsEtaAndCurrentHeader) {
+    armor::ProgressReporter::Snapshot snapshot;
+    snapshot.done = 5;
+    snapshot.total = 20;
+    snapshot.headersPerSecond = 0.5;
+    snapshot.etaSeconds = 187;
+    snapshot.running = 1;
+    snapshot.current = "big.h";
+    snapshot.currentSeconds = 42;
+
+    EXPECT_EQ("[5/20]  25% | 0.50 hdr/s | ETA 3m07s | big.h (42s)",
+              armor::ProgressReporter::formatLine(snapshot, 0));
+    EXPECT_EQ("[5/20]  25%", armor::ProgressReporter::formatLine(snapshot, 11));
+
+    snapshot.running = 3;
+    EXPECT_EQ("[5/20]  25% | 0.50 hdr/s | ETA 3m07s | 3 running, longest big.h (42s)",
+              armor::ProgressReporter::formatLine(snapshot, 0));
+}
+
+TEST_F(ProgressReporterTest, FormatRecord_UnknownEtaIsNull) {
+    armor::ProgressReporter::Snapshot snapshot;
+    snapshot.total = 4;
+
+    nlohmann::json record = nlohmann::json::parse(armor::ProgressReporter::formatRecord(snapshot));
+    EXPECT_TRUE(record["eta_s"].is_null());
+    EXPECT_EQ(0, record["done"]);
+}
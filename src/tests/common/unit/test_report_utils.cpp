@@ -0,0 +1,65 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include "report_utils.hpp"
+
+class ReportUtilsTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(ReportUtilsTest, GroupApiChanges_MergesByHeaderAndName) {
+    std::vector<ApiChangeRecord> records = {
+        {"mylib.h", "foo:Function", "Parameter added", true, true},
+        {"mylib.h", "bar:Function", "Function added", false, false},
+        {"mylib.h", "foo:Function", "Return type changed", true, false},
+    };
+
+    std::vector<ApiChangeGroup> grouped = group_api_changes(records);
+    ASSERT_EQ(2u, grouped.size());
+
+    EXPECT_EQ("bar:Function", grouped[0].name);
+    EXPECT_EQ(std::string("Functionality Added"), grouped[0].changeType());
+    EXPECT_EQ(std::string("backward_compatible"), grouped[0].compatibility());
+
+    EXPECT_EQ("foo:Function", grouped[1].name);
+    EXPECT_EQ("Parameter added\nReturn type changed", grouped[1].description);
+    EXPECT_EQ(std::string("Compatibility Changed"), grouped[1].changeType());
+    EXPECT_EQ(std::string("backward_incompatible"), grouped[1].compatibility());
+}
+
+TEST_F(ReportUtilsTest, GroupApiChanges_OrdersByHeaderThenName) {
+    std::vector<ApiChangeRecord> records = {
+        {"b.h", "a", "x", true, false},
+        {"a.h", "z", "x", true, false},
+        {"a.h", "c", "x", true, false},
+    };
+
+    std::vector<ApiChangeGroup> grouped = group_api_changes(records);
+    ASSERT_EQ(3u, grouped.size());
+    EXPECT_EQ("c", grouped[0].name);
+    EXPECT_EQ("z", grouped[1].name);
+    EXPECT_EQ("b.h", grouped[2].headerfile);
+}
+
+TEST_F(ReportUtilsTest, GroupApiChanges_SkipsEmptyDescriptions) {
+    std::vector<ApiChangeRecord> records = {
+        {"mylib.h", "S:Struct", "", true, false},
+        {"mylib.h", "S:Struct", "Field added", true, false},
+    };
+
+    std::vector<ApiChangeGroup> grouped = group_api_changes(records);
+    ASSERT_EQ(1u, grouped.size());
+    EXPECT_EQ("Field added", grouped[0].description);
+}
+
+TEST_F(ReportUtilsTest, ReportNameForHeader_KeepsDirectories) {
+    EXPECT_EQ("mylib.h", report_name_for_header("v1/mylib.h", "v1"));
+    EXPECT_EQ("a_config.h", report_name_for_header("v1/a/config.h", "v1/"));
+    EXPECT_EQ("b_config.h", report_name_for_header("/src/v1/./b//config.h", "/src/v1"));
+    EXPECT_EQ("include_a_config.h", report_name_for_header("a/../include/a/config.h", "."));
+    // Outside the project root only the file name is left.
+    EXPECT_EQ("config.h", report_name_for_header("/other/a/config.h", "/src/v1"));
+    EXPECT_EQ("config.h", report_name_for_header("/src/a/config.h", "src"));
+}
@@ -0,0 +1,93 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include "run_stats.hpp"
+#include "trace.hpp"
+#include "temp_dir.hpp"
+
+class RunStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        armor::RunStats::getInstance().enable();
+    }
+
+    const armor::RunStats::HeaderStats* find(const std::vector<armor::RunStats::HeaderStats>& all,
+                                             const std::string& header) {
+        for (const auto& stats : all) {
+            if (stats.header == header) return &stats;
+        }
+        return nullptr;
+    }
+
+    uint64_t counter(const armor::RunStats::HeaderStats& stats, armor::StatCounter c) {
+        return stats.counters[static_cast<size_t>(c)];
+    }
+
+    armor::test::TempDir tempDir{"armor_run_stats_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(RunStatsTest, Collect_AttributesCountersToOpenHeader) {
+    {
+        armor::HeaderStatsScope scope("stats_a.h");
+        armor::RunStats::count(armor::StatCounter::ApiNodesBuilt, 3);
+        armor::RunStats::count(armor::StatCounter::DeclsVisited);
+    }
+    {
+        armor::HeaderStatsScope scope("stats_b.h");
+        armor::RunStats::count(armor::StatCounter::ApiNodesBuilt);
+    }
+
+    std::vector<armor::RunStats::HeaderStats> all = armor::RunStats::getInstance().collect();
+    const auto* a = find(all, "stats_a.h");
+    const auto* b = find(all, "stats_b.h");
+    ASSERT_TRUE(a != nullptr);
+    ASSERT_TRUE(b != nullptr);
+    EXPECT_EQ(3u, counter(*a, armor::StatCounter::ApiNodesBuilt));
+    EXPECT_EQ(1u, counter(*a, armor::StatCounter::DeclsVisited));
+    EXPECT_EQ(1u, counter(*b, armor::StatCounter::ApiNodesBuilt));
+    EXPECT_EQ(0u, counter(*b, armor::StatCounter::DeclsVisited));
+
+    EXPECT_EQ("(total)", all.back().header);
+    EXPECT_LE(4u, counter(all.back(), armor::StatCounter::ApiNodesBuilt));
+}
+
+TEST_F(RunStatsTest, Collect_SumsSpanTimePerStage) {
+    {
+        armor::HeaderStatsScope scope("stats_stage.h");
+        { armor::TraceScope span("stats test stage", "test"); }
+        { armor::TraceScope span("stats test stage", "test"); }
+    }
+
+    std::vector<armor::RunStats::HeaderStats> all = armor::RunStats::getInstance().collect();
+    const auto* stats = find(all, "stats_stage.h");
+    ASSERT_TRUE(stats != nullptr);
+    ASSERT_EQ(1u, stats->stageUs.size());
+    EXPECT_EQ(std::string("stats test stage"), stats->stageUs[0].first);
+}
+
+TEST_F(RunStatsTest, WriteJson_HeadersAndTotal) {
+    {
+        armor::HeaderStatsScope scope("stats_json.h");
+        armor::RunStats::count(armor::StatCounter::ReportBytes, 42);
+    }
+
+    std::string path = (dir / "stats.json").string();
+    ASSERT_TRUE(armor::RunStats::getInstance().writeJson(path));
+    nlohmann::json stats = nlohmann::json::parse(std::ifstream(path));
+
+    bool found = false;
+    for (const auto& header : stats["headers"]) {
+        if (header["header"] != "stats_json.h") continue;
+        found = true;
+        EXPECT_EQ(42u, header["counters"]["report_bytes"].get<uint64_t>());
+        EXPECT_FALSE(header.contains("peak_rss_bytes"));
+    }
+    EXPECT_TRUE(found);
+    EXPECT_EQ("(total)", stats["total"]["header"]);
+    // Peak RSS is the process's, reported once.
+    EXPECT_NE(0u, stats["process_peak_rss_bytes"].get<uint64_t>());
+}
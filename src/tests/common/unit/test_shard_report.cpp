@@ -0,0 +1,160 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "header_budget.hpp"
+#include "header_processor_utils.hpp"
+#include "header_scheduler.hpp"
+#include "shard_report.hpp"
+#include "temp_dir.hpp"
+
+class ShardReportTest : public ::testing::Test {
+protected:
+    static HeaderReportSummary makeSummary(bool compatible) {
+        HeaderReportSummary summary;
+        summary.compatibility = compatible ? "backward_compatible" : "backward_incompatible";
+        summary.overallStatus = compatible ? "BACKWARD_COMPATIBLE" : "BACKWARD_INCOMPATIBLE";
+        if (!compatible) {
+            ApiChangeGroup change;
+            change.headerfile = "b.h";
+            change.name = "foo";
+            change.description = "Function removed";
+            change.compatibilityChanged = true;
+            change.backwardIncompatible = true;
+            summary.changes.push_back(change);
+            summary.incompatibleChanges.push_back("Function removed");
+        }
+        return summary;
+    }
+
+    // Writes a shard output directory holding a summary and one per-header report.
+    std::string writeShard(const std::string& name, const std::string& spec,
+                           const std::string& header, bool compatible) {
+        std::filesystem::path shardDir = dir / name;
+        armor::ShardSummary summary;
+        summary.setShard(spec);
+        summary.addHeader(header, makeSummary(compatible));
+        EXPECT_TRUE(summary.write((shardDir / armor::ShardSummary::FILE_NAME).string()));
+        std::filesystem::create_directories(shardDir / "json_reports");
+        std::ofstream(shardDir / "json_reports" / ("api_diff_report_" + header + ".json")) << "{}";
+        return shardDir.string();
+    }
+
+    std::vector<armor::HeaderPair> makePairs(size_t count) {
+        std::vector<armor::HeaderPair> pairs;
+        for (size_t i = 0; i < count; ++i) {
+            std::string header = "h" + std::to_string(i) + ".h";
+            pairs.push_back({header, header, header});
+        }
+        return pairs;
+    }
+
+    armor::test::TempDir tempDir{"armor_shard_report_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(ShardReportTest, ParseSpec_Validates) {
+    ASSERT_TRUE(armor::ShardSpec::parse("2/4").has_value());
+    EXPECT_EQ(2u, armor::ShardSpec::parse("2/4")->index);
+    EXPECT_EQ(4u, armor::ShardSpec::parse("2/4")->count);
+    EXPECT_FALSE(armor::ShardSpec::parse("0/4").has_value());
+    EXPECT_FALSE(armor::ShardSpec::parse("5/4").has_value());
+    EXPECT_FALSE(armor::ShardSpec::parse("1").has_value());
+}
+
+TEST_F(ShardReportTest, SelectShard_HashPartitionsEveryHeaderOnce) {
+    std::vector<armor::HeaderPair> pairs = makePairs(50);
+    std::vector<int> owners(pairs.size(), 0);
+    for (unsigned index = 1; index <= 3; ++index) {
+        armor::ShardSpec shard{index, 3, armor::ShardSpec::Strategy::Hash};
+        for (size_t selected : armor::selectShard(pairs, {}, shard)) ++owners[selected];
+    }
+    for (int owner : owners) EXPECT_EQ(1, owner);
+}
+
+TEST_F(ShardReportTest, SelectShard_CostBalancesIndependentlyOfOrder) {
+    std::vector<armor::HeaderPair> pairs = makePairs(4);
+    std::vector<double> costs = {10.0, 6.0, 4.0, 1.0};
+    armor::ShardSpec first{1, 2, armor::ShardSpec::Strategy::Cost};
+    armor::ShardSpec second{2, 2, armor::ShardSpec::Strategy::Cost};
+
+    EXPECT_EQ((std::vector<size_t>{0, 3}), armor::selectShard(pairs, costs, first));
+    EXPECT_EQ((std::vector<size_t>{1, 2}), armor::selectShard(pairs, costs, second));
+
+    std::vector<armor::HeaderPair> reversed(pairs.rbegin(), pairs.rend());
+    std::vector<double> reversedCosts(costs.rbegin(), costs.rend());
+    EXPECT_EQ((std::vector<size_t>{0, 3}), armor::selectShard(reversed, reversedCosts, first));
+}
+
+TEST_F(ShardReportTest, Summary_RoundTrips) {
+    armor::ShardSummary summary;
+    summary.setShard("1/2");
+    summary.addHeader("b.h", makeSummary(false));
+    std::string path = (dir / armor::ShardSummary::FILE_NAME).string();
+    ASSERT_TRUE(summary.write(path));
+
+    armor::ShardSummary loaded;
+    ASSERT_TRUE(loaded.read(path));
+    EXPECT_EQ("1/2", loaded.getShard());
+    ASSERT_EQ(1u, loaded.getEntries().size());
+    const HeaderReportSummary& entry = loaded.getEntries()[0].summary;
+    EXPECT_EQ("backward_incompatible", entry.compatibility);
+    ASSERT_EQ(1u, entry.changes.size());
+    EXPECT_EQ("foo", entry.changes[0].name);
+    EXPECT_TRUE(entry.changes[0].backwardIncompatible);
+    EXPECT_FALSE(loaded.isBackwardCompatible());
+}
+
+TEST_F(ShardReportTest, BetaBudgetOverrun_NotBackwardCompatible) {
+    armor::HeaderBudget::Limits limits;
+    limits.time = std::chrono::milliseconds(1);
+    armor::HeaderBudget::Scope budget(limits);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(armor::HeaderBudget::exceeded());
+
+    // The alpha pass never diffs the AST, so on its own it always looks compatible.
+    HeaderReportSummary summary = makeSummary(true);
+    armor::markAlphaOnly(summary);
+    EXPECT_EQ("unknown", summary.compatibility);
+    EXPECT_EQ("NOT_CATEGORIZED", summary.overallStatus);
+    EXPECT_EQ("alpha_only", summary.degradation);
+
+    armor::ShardSummary shard;
+    shard.addHeader("a.h", makeSummary(true));
+    shard.addHeader("b.h", summary);
+    EXPECT_FALSE(shard.isBackwardCompatible());
+
+    std::string path = (dir / armor::ShardSummary::FILE_NAME).string();
+    ASSERT_TRUE(shard.write(path));
+    armor::ShardSummary loaded;
+    ASSERT_TRUE(loaded.read(path));
+    EXPECT_EQ("unknown", loaded.getEntries()[1].summary.compatibility);
+    EXPECT_FALSE(loaded.isBackwardCompatible());
+}
+
+TEST_F(ShardReportTest, Merge_CombinesShardsAndVerdict) {
+    std::string shard2 = writeShard("shard2", "2/2", "b.h", false);
+    std::string shard1 = writeShard("shard1", "1/2", "a.h", true);
+    std::filesystem::path out = dir / "merged";
+
+    armor::ShardSummary merged;
+    ASSERT_TRUE(armor::mergeShardReports({shard2, shard1}, out.string(), merged));
+
+    ASSERT_EQ(2u, merged.getEntries().size());
+    EXPECT_EQ("a.h", merged.getEntries()[0].header);
+    EXPECT_EQ("b.h", merged.getEntries()[1].header);
+    EXPECT_FALSE(merged.isBackwardCompatible());
+    EXPECT_TRUE(std::filesystem::exists(out / "json_reports" / "api_diff_report_a.h.json"));
+    EXPECT_TRUE(std::filesystem::exists(out / "json_reports" / "api_diff_report_b.h.json"));
+    EXPECT_TRUE(std::filesystem::exists(out / armor::ShardSummary::FILE_NAME));
+    EXPECT_TRUE(std::filesystem::exists(out / "armor_report.html"));
+    EXPECT_TRUE(std::filesystem::exists(out / "armor_report.ndjson"));
+}
+
+TEST_F(ShardReportTest, Merge_FailsWithoutSummary) {
+    std::filesystem::create_directories(dir / "empty");
+    armor::ShardSummary merged;
+    EXPECT_FALSE(armor::mergeShardReports({(dir / "empty").string()}, (dir / "merged").string(), merged));
+}
@@ -0,0 +1,85 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include "source_region_index.hpp"
+
+class SourceRegionIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+
+    armor::SourceRegionIndex index;
+};
+
+TEST_F(SourceRegionIndexTest, Classify_SortsByOffset) {
+    index.addComment(40, 50, 2);
+    index.addDirective(0, 10, true);
+    index.addComment(20, 30, 1);
+    index.classify();
+
+    llvm::ArrayRef<armor::SourceRegion> regions = index.getRegions();
+    ASSERT_EQ(3u, regions.size());
+    EXPECT_EQ(0u, regions[0].startOffset);
+    EXPECT_EQ(20u, regions[1].startOffset);
+    EXPECT_EQ(40u, regions[2].startOffset);
+    EXPECT_TRUE(index.isClassified());
+}
+
+TEST_F(SourceRegionIndexTest, Classify_DropsDirectivesInsideInactiveBlock) {
+    // Callback order for "#if 0 ... #endif": If, Endif, then SourceRangeSkipped.
+    index.addDirective(100, 105, true);
+    index.addDirective(140, 146, true);
+    index.addDirective(100, 146, false);
+    index.classify();
+
+    llvm::ArrayRef<armor::SourceRegion> regions = index.getRegions();
+    ASSERT_EQ(1u, regions.size());
+    EXPECT_EQ(armor::SourceRegion::Kind::InactiveBlock, regions[0].kind);
+    EXPECT_EQ(100u, regions[0].startOffset);
+    EXPECT_EQ(146u, regions[0].endOffset);
+}
+
+TEST_F(SourceRegionIndexTest, Classify_KeepsDisjointDirectives) {
+    index.addDirective(0, 15, true);
+    index.addDirective(16, 40, true);
+    index.addDirective(60, 90, false);
+    index.addDirective(91, 97, true);
+    index.classify();
+
+    EXPECT_EQ(4u, index.getRegions().size());
+}
+
+TEST_F(SourceRegionIndexTest, Classify_FlagsCommentsInsideInactiveBlock) {
+    index.addComment(5, 12, 1);
+    index.addDirective(100, 200, false);
+    index.addComment(120, 130, 2);
+    index.addComment(190, 210, 3);
+    index.addComment(250, 260, 4);
+    index.classify();
+
+    llvm::ArrayRef<armor::SourceRegion> regions = index.getRegions();
+    ASSERT_EQ(5u, regions.size());
+    EXPECT_FALSE(regions[0].inInactiveBlock);
+    EXPECT_TRUE(regions[2].inInactiveBlock);
+    EXPECT_FALSE(regions[3].inInactiveBlock);
+    EXPECT_FALSE(regions[4].inInactiveBlock);
+}
+
+TEST_F(SourceRegionIndexTest, Classify_ActiveDirectiveDoesNotShadowComments) {
+    index.addDirective(0, 40, true);
+    index.addComment(20, 30, 1);
+    index.classify();
+
+    llvm::ArrayRef<armor::SourceRegion> regions = index.getRegions();
+    ASSERT_EQ(2u, regions.size());
+    EXPECT_FALSE(regions[1].inInactiveBlock);
+}
+
+TEST_F(SourceRegionIndexTest, Clear_ResetsIndex) {
+    index.addComment(0, 4, 1);
+    index.classify();
+    index.clear();
+
+    EXPECT_TRUE(index.empty());
+    EXPECT_FALSE(index.isClassified());
+}
@@ -0,0 +1,56 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include "trace.hpp"
+#include "temp_dir.hpp"
+
+class TraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        armor::Tracer::getInstance().enable(false);
+    }
+
+    const nlohmann::json* findEvent(const nlohmann::json& trace, const std::string& name) {
+        for (const auto& event : trace["traceEvents"]) {
+            if (event.value("name", "") == name) return &event;
+        }
+        return nullptr;
+    }
+
+    armor::test::TempDir tempDir{"armor_trace_test"};
+    const std::filesystem::path dir = tempDir.path();
+};
+
+TEST_F(TraceTest, Write_NestedSpansAsCompleteEvents) {
+    {
+        armor::TraceScope header("test header", "header", "include/foo.h");
+        armor::TraceScope parse("test parse", "parse");
+    }
+
+    std::string path = (dir / "trace.json").string();
+    ASSERT_TRUE(armor::Tracer::getInstance().write(path));
+    nlohmann::json trace = nlohmann::json::parse(std::ifstream(path));
+
+    const nlohmann::json* header = findEvent(trace, "test header");
+    const nlohmann::json* parse = findEvent(trace, "test parse");
+    ASSERT_TRUE(header != nullptr);
+    ASSERT_TRUE(parse != nullptr);
+
+    EXPECT_EQ("X", (*header)["ph"]);
+    EXPECT_EQ("header", (*header)["cat"]);
+    EXPECT_EQ("include/foo.h", (*header)["args"]["detail"]);
+    EXPECT_FALSE(parse->contains("args"));
+    EXPECT_EQ((*header)["tid"], (*parse)["tid"]);
+
+    uint64_t headerStart = (*header)["ts"];
+    uint64_t parseStart = (*parse)["ts"];
+    EXPECT_LE(headerStart, parseStart);
+    EXPECT_LE(parseStart + (*parse)["dur"].get<uint64_t>(), headerStart + (*header)["dur"].get<uint64_t>());
+}
+
+TEST_F(TraceTest, Write_UnwritablePath_ReturnsFalse) {
+    EXPECT_FALSE(armor::Tracer::getInstance().write((dir / "missing" / "trace.json").string()));
+}